@@ -193,6 +193,12 @@ CMD_ANSWER configureWireGuard(boost::archive::text_iarchive &ia)
 }
 
 CMD_ANSWER getWireGuardStatus(boost::archive::text_iarchive &ia)
+{
+    UNUSED(ia);
+    return currentWireGuardStatus();
+}
+
+CMD_ANSWER currentWireGuardStatus()
 {
     CMD_ANSWER answer;
     unsigned int errorCode = 0;
@@ -54,3 +54,5 @@ static const std::map<const int, std::function<CMD_ANSWER(boost::archive::text_i
 };
 
 CMD_ANSWER processCommand(int cmdId, const std::string packet);
+// the answer of HELPER_CMD_GET_WIREGUARD_STATUS, also used by Server for HELPER_CMD_WAIT_WIREGUARD_STATUS
+CMD_ANSWER currentWireGuardStatus();
@@ -4,6 +4,7 @@
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
 #include <boost/serialization/vector.hpp>
+#include <algorithm>
 #include <codecvt>
 #include <stdlib.h>
 #include <string>
@@ -39,7 +40,7 @@ Server::~Server()
     unlink(SOCK_PATH);
 }
 
-bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer)
+bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer, wait_ptr &outWait)
 {
     // not enough data for read command
     if (buf->size() < sizeof(int)*3) {
@@ -80,11 +81,21 @@ bool Server::readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf,
     std::vector<char> vector(length);
     memcpy(&vector[0], bufPtr + headerSize, length);
     std::string str(vector.begin(), vector.end());
-    std::istringstream stream(str);
-    outCmdAnswer = processCommand(cmdId, str);
-
     buf->consume(headerSize + length);
 
+    if (cmdId == HELPER_CMD_WAIT_WIREGUARD_STATUS) {
+        outWait.reset(new WireGuardStatusWait(service_));
+        std::istringstream stream(str);
+        boost::archive::text_iarchive ia(stream, boost::archive::no_header);
+        ia >> outWait->cmd;
+        outWait->cmd.timeoutMs = std::min(outWait->cmd.timeoutMs, kMaxWireGuardStatusWaitMs);
+        waitSockets_.insert(sock.get());
+        outWait->startTime = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    outCmdAnswer = processCommand(cmdId, str);
+
     return true;
 }
 
@@ -96,23 +107,76 @@ void Server::receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::st
         // read and handle commands
         while (true) {
             CMD_ANSWER cmdAnswer;
-            if (!readAndHandleCommand(sock, buf.get(), cmdAnswer)) {
+            wait_ptr wait;
+            if (!readAndHandleCommand(sock, buf.get(), cmdAnswer, wait)) {
                 // goto receive next commands
                 boost::asio::async_read(*sock, *buf, boost::asio::transfer_at_least(1),
                                         boost::bind(&Server::receiveCmdHandle, this, sock, buf, _1, _2));
                 break;
+            } else if (wait) {
+                // the next commands are received after the answer
+                checkWireGuardStatus(sock, buf, wait);
+                break;
             } else {
                 if (!sendAnswerCmd(sock, cmdAnswer)) {
-                    Logger::instance().out("client app disconnected");
-                    HelperSecurity::instance().reset();
+                    onClientDisconnected(sock);
                     return;
                 }
             }
         }
     } else {
-        Logger::instance().out("client app disconnected");
-        HelperSecurity::instance().reset();
+        onClientDisconnected(sock);
+    }
+}
+
+void Server::onClientDisconnected(socket_ptr sock)
+{
+    if (waitSockets_.erase(sock.get())) {
+        Logger::instance().out("WireGuard status wait cancelled by the client");
+        return;
+    }
+    Logger::instance().out("client app disconnected");
+    HelperSecurity::instance().reset();
+}
+
+bool Server::isClientClosed(socket_ptr sock)
+{
+    // the client doesn't send anything while waiting, so a readable socket means it was closed
+    char c;
+    const ssize_t res = recv(sock->native_handle(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return res == 0 || (res < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+}
+
+void Server::checkWireGuardStatus(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, wait_ptr wait)
+{
+    const CMD_ANSWER cmdAnswer = currentWireGuardStatus();
+    const auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - wait->startTime).count();
+
+    const bool isStateChanged = cmdAnswer.cmdId != wait->cmd.lastState;
+    const bool isStatisticsChanged = cmdAnswer.cmdId == kWgStateActive
+                                     && (cmdAnswer.customInfoValue[0] != wait->cmd.lastBytesReceived || cmdAnswer.customInfoValue[1] != wait->cmd.lastBytesTransmitted)
+                                     && elapsedMs >= wait->cmd.statisticsIntervalMs;
+    if (!isStateChanged && !isStatisticsChanged && elapsedMs < wait->cmd.timeoutMs) {
+        wait->timer.expires_after(std::chrono::milliseconds(kWireGuardStatusCheckMs));
+        wait->timer.async_wait([this, sock, buf, wait](const boost::system::error_code &ec) {
+            if (ec)
+                return;
+            // the client cancels the wait by closing the connection, it is not waited until the timeout then
+            if (isClientClosed(sock)) {
+                onClientDisconnected(sock);
+                return;
+            }
+            checkWireGuardStatus(sock, buf, wait);
+        });
+        return;
+    }
+
+    if (!sendAnswerCmd(sock, cmdAnswer)) {
+        onClientDisconnected(sock);
+        return;
     }
+    // handle the commands received while waiting, then continue reading
+    receiveCmdHandle(sock, buf, boost::system::error_code(), 0);
 }
 
 void Server::acceptHandler(const boost::system::error_code & ec, socket_ptr sock)
@@ -2,12 +2,15 @@
 
 #define BOOST_BIND_GLOBAL_PLACEHOLDERS 1
 
+#include <chrono>
 #include <stdio.h>
 #include <vector>
 #include <thread>
 #include <boost/asio.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/thread.hpp>
 #include <list>
+#include <set>
 
 #include "../../posix_common/helper_commands.h"
 #include "routes_manager/routes_manager.h"
@@ -28,7 +31,29 @@ private:
     boost::asio::io_service service_;
     boost::asio::local::stream_protocol::acceptor *acceptor_;
 
-    bool readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer);
+    // HELPER_CMD_WAIT_WIREGUARD_STATUS in progress, the commands from its socket are not read until it's answered
+    struct WireGuardStatusWait
+    {
+        WireGuardStatusWait(boost::asio::io_service &service) : timer(service) {}
+
+        CMD_WAIT_WIREGUARD_STATUS cmd;
+        std::chrono::steady_clock::time_point startTime;
+        boost::asio::steady_timer timer;
+    };
+    typedef boost::shared_ptr<WireGuardStatusWait> wait_ptr;
+
+    // the WireGuard device doesn't notify about the handshakes and the counters, so it is checked locally with this interval
+    static constexpr int kWireGuardStatusCheckMs = 100;
+    // the client asks for 10 seconds at most, a longer wait is cut to this
+    static constexpr unsigned int kMaxWireGuardStatusWaitMs = 60000;
+
+    // the connections used for HELPER_CMD_WAIT_WIREGUARD_STATUS, closing them is a normal cancel of the wait, not an app disconnect
+    std::set<boost::asio::local::stream_protocol::socket *> waitSockets_;
+
+    bool readAndHandleCommand(socket_ptr sock, boost::asio::streambuf *buf, CMD_ANSWER &outCmdAnswer, wait_ptr &outWait);
+    void checkWireGuardStatus(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, wait_ptr wait);
+    bool isClientClosed(socket_ptr sock);
+    void onClientDisconnected(socket_ptr sock);
 
     void receiveCmdHandle(socket_ptr sock, boost::shared_ptr<boost::asio::streambuf> buf, const boost::system::error_code& ec, std::size_t bytes_transferred);
     void acceptHandler(const boost::system::error_code & ec, socket_ptr sock);
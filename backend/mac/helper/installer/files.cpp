@@ -1,4 +1,7 @@
 #include "files.h"
+
+#include <algorithm>
+
 #include "../logger.h"
 
 Files::Files(const std::wstring &archivePath, const std::wstring &installPath, uid_t userId, gid_t groupId) : userId_(userId),
@@ -46,38 +49,27 @@ int Files::executeStep()
         fillPathList();
 
         archive_->calcTotal(fileList_, pathList_);
-        curFileInd_ = 0;
+        archive_->startExtraction();
         state_++;
         return 0;
     }
     else
     {
-        SRes res = archive_->extractionFile(curFileInd_);
-        if (res != SZ_OK)
+        // the archive is extracted on its own threads, the steps only report the progress
+        if (!archive_->waitForExtraction(100))
+        {
+            return std::min(archive_->getExtractionProgress(), 99);
+        }
+
+        archive_->finish();
+        if (archive_->extractionResult() != SZ_OK)
         {
-            archive_->finish();
             LOG("Can't extract files");
             lastError_ = "Can't extract file.";
             return -1;
         }
-        else
-        {
-            int progress = ((double)curFileInd_ / (double)archive_->getNumFiles()) * 100.0;
-
-            if (curFileInd_ >= (archive_->getNumFiles() - 1))
-            {
-                archive_->finish();
-                return 100;
-            }
-            else
-            {
-                curFileInd_++;
-            }
-            return progress;
-        }
+        return 100;
     }
-
-    return 100;
 }
 
 void Files::eraseSubStr(std::wstring &mainStr, const std::wstring &toErase)
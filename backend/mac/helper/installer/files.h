@@ -21,7 +21,6 @@ private:
     std::wstring installPath_;
     Archive *archive_;
     int state_;
-    unsigned int curFileInd_;
     std::list<std::wstring> fileList_;
     std::list<std::wstring> pathList_;
     std::string lastError_;
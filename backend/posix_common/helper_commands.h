@@ -40,6 +40,7 @@
 #define HELPER_CMD_START_STUNNEL                     33
 #define HELPER_CMD_START_WSTUNNEL                    34
 #define HELPER_CMD_INSTALLER_CREATE_CLI_SYMLINK_DIR  35
+#define HELPER_CMD_WAIT_WIREGUARD_STATUS             36 // answered when the status changes, Linux only
 
 // enums
 
@@ -185,6 +186,14 @@ struct CMD_APPLY_CUSTOM_DNS {
     std::string networkService;
 };
 
+struct CMD_WAIT_WIREGUARD_STATUS {
+    unsigned long lastState;                // CmdWireGuardServiceState known to the client
+    unsigned long long lastBytesReceived;
+    unsigned long long lastBytesTransmitted;
+    unsigned int timeoutMs;                 // answer with the current status after this time anyway
+    unsigned int statisticsIntervalMs;      // answer with the changed statistics not more often than this
+};
+
 struct CMD_CHANGE_MTU {
     int mtu;
     std::string adapterName;
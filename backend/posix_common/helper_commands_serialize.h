@@ -141,6 +141,17 @@ void serialize(Archive &ar, CMD_APPLY_CUSTOM_DNS &a, const unsigned int version)
     ar & a.networkService;
 }
 
+template<class Archive>
+void serialize(Archive &ar, CMD_WAIT_WIREGUARD_STATUS &a, const unsigned int version)
+{
+    UNUSED(version);
+    ar & a.lastState;
+    ar & a.lastBytesReceived;
+    ar & a.lastBytesTransmitted;
+    ar & a.timeoutMs;
+    ar & a.statisticsIntervalMs;
+}
+
 template<class Archive>
 void serialize(Archive &ar, CMD_CHANGE_MTU &a, const unsigned int version)
 {
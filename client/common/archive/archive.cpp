@@ -1,5 +1,8 @@
 #include "archive.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #ifndef _WIN32
 #include <locale>
 #include <codecvt>
@@ -8,6 +11,9 @@
 #include "LZMA_SDK/C/7zAlloc.h"
 #include "LZMA_SDK/C/7zCrc.h"
 #include "LZMA_SDK/C/7zTypes.h"
+#include "LZMA_SDK/C/Bra.h"
+#include "LZMA_SDK/C/Lzma2Dec.h"
+#include "LZMA_SDK/C/LzmaDec.h"
 
 static const ISzAlloc g_Alloc = { SzAlloc, SzFree };
 
@@ -117,6 +123,12 @@ Archive::Archive(const wstring &name, uid_t userId, gid_t groupId) : file_size(0
 
 Archive::~Archive()
 {
+    if (extractionThread_.joinable())
+    {
+        isExtractionStopped_ = true;
+        extractionThread_.join();
+    }
+
 #ifdef _WIN32
     FreeResource(hGlobal); // done with data
 #endif
@@ -150,6 +162,8 @@ bool Archive::isCorrect() const
 
 void Archive::Print(const char *s)
 {
+    // the extraction threads log concurrently
+    std::lock_guard<std::mutex> lock(logMutex_);
 #ifndef GUI
 #ifdef _WIN32
 	fputs(s, stdout);
@@ -489,11 +503,13 @@ void Archive::PrintError(const char *s)
     PrintLF();
 
     string s1 = s;
+    std::lock_guard<std::mutex> lock(logMutex_);
     last_error = wstring(s1.begin(), s1.end());
 }
 
 wstring Archive::getLastError()
 {
+    std::lock_guard<std::mutex> lock(logMutex_);
     return last_error;
 }
 
@@ -1024,3 +1040,636 @@ string Archive::ConvertToString(const wstring &str)
     return str1;
 }
 
+
+namespace {
+
+const UInt32 kMethodCopy = 0;
+const UInt32 kMethodLzma2 = 0x21;
+const UInt32 kMethodLzma = 0x30101;
+const UInt32 kMethodBcj = 0x3030103;
+
+// the files without data (empty files) have no folder
+const UInt32 kNoFolder = static_cast<UInt32>(-1);
+
+// the size of the pieces decoded and written to the files
+const size_t kStreamBufSize = static_cast<size_t>(1) << 20;
+
+UInt64 lzma2DictSize(unsigned prop)
+{
+    if (prop >= 40)
+        return 0xFFFFFFFF;
+    return static_cast<UInt64>(2 | (prop & 1)) << (prop / 2 + 11);
+}
+
+// Decodes the first coder of a folder piece by piece. The packed stream is in memory.
+class CoderStream
+{
+public:
+    CoderStream()
+    {
+        LzmaDec_CONSTRUCT(&lzma_);
+        Lzma2Dec_CONSTRUCT(&lzma2_);
+    }
+
+    ~CoderStream()
+    {
+        LzmaDec_Free(&lzma_, &g_Alloc);
+        Lzma2Dec_Free(&lzma2_, &g_Alloc);
+    }
+
+    SRes init(const CSzCoderInfo &coder, const Byte *props, const Byte *src, UInt64 srcSize, UInt64 unpackSize)
+    {
+        method_ = coder.MethodID;
+        src_ = src;
+        srcSize_ = srcSize;
+        remaining_ = unpackSize;
+
+        // the dictionary is not larger than the output, the solid blocks of the update are much smaller
+        // than the dictionary of the ultra compression
+        if (method_ == kMethodCopy)
+        {
+            return srcSize == unpackSize ? SZ_OK : SZ_ERROR_DATA;
+        }
+        else if (method_ == kMethodLzma)
+        {
+            if (coder.PropsSize != LZMA_PROPS_SIZE)
+                return SZ_ERROR_UNSUPPORTED;
+            Byte lzmaProps[LZMA_PROPS_SIZE];
+            memcpy(lzmaProps, props, LZMA_PROPS_SIZE);
+            if (GetUi32(lzmaProps + 1) > unpackSize)
+            {
+                SetUi32(lzmaProps + 1, static_cast<UInt32>(unpackSize));
+            }
+            RINOK(LzmaDec_Allocate(&lzma_, lzmaProps, LZMA_PROPS_SIZE, &g_Alloc));
+            LzmaDec_Init(&lzma_);
+            return SZ_OK;
+        }
+        else if (method_ == kMethodLzma2)
+        {
+            if (coder.PropsSize != 1)
+                return SZ_ERROR_UNSUPPORTED;
+            unsigned prop = props[0];
+            while (prop > 0 && prop <= 40 && lzma2DictSize(prop - 1) >= unpackSize)
+            {
+                prop--;
+            }
+            RINOK(Lzma2Dec_Allocate(&lzma2_, static_cast<Byte>(prop), &g_Alloc));
+            Lzma2Dec_Init(&lzma2_);
+            return SZ_OK;
+        }
+        return SZ_ERROR_UNSUPPORTED;
+    }
+
+    // decodes up to *size bytes, can decode nothing if only the service data of the stream was read
+    SRes read(Byte *dest, size_t *size)
+    {
+        SizeT destLen = *size;
+        if (destLen > remaining_)
+            destLen = static_cast<SizeT>(remaining_);
+        *size = 0;
+        if (destLen == 0)
+            return SZ_OK;
+
+        if (method_ == kMethodCopy)
+        {
+            memcpy(dest, src_, destLen);
+            src_ += destLen;
+            srcSize_ -= destLen;
+        }
+        else
+        {
+            SizeT srcLen = static_cast<SizeT>(srcSize_);
+            ELzmaStatus status;
+            SRes res;
+            if (method_ == kMethodLzma)
+                res = LzmaDec_DecodeToBuf(&lzma_, dest, &destLen, src_, &srcLen, LZMA_FINISH_ANY, &status);
+            else
+                res = Lzma2Dec_DecodeToBuf(&lzma2_, dest, &destLen, src_, &srcLen, LZMA_FINISH_ANY, &status);
+            if (res != SZ_OK)
+                return res;
+            // the stream is truncated or ended before the declared size
+            if (destLen == 0 && srcLen == 0)
+                return SZ_ERROR_DATA;
+            src_ += srcLen;
+            srcSize_ -= srcLen;
+        }
+
+        remaining_ -= destLen;
+        *size = destLen;
+        return SZ_OK;
+    }
+
+    UInt64 remaining() const { return remaining_; }
+
+private:
+    UInt32 method_ = 0;
+    const Byte *src_ = nullptr;
+    UInt64 srcSize_ = 0;
+    UInt64 remaining_ = 0;
+    CLzmaDec lzma_;
+    CLzma2Dec lzma2_;
+};
+
+} // namespace
+
+// Receives the unpacked data of a folder and splits it into the files of the folder.
+class Archive::FolderWriter
+{
+public:
+    FolderWriter(Archive *archive, UInt32 folderIndex, UInt32 firstFile, UInt32 endFile) : archive_(archive),
+        folderIndex_(folderIndex), nextFile_(firstFile), endFile_(endFile)
+    {
+    }
+
+    ~FolderWriter()
+    {
+        if (isFileOpen_)
+            File_Close(&file_);
+    }
+
+    SRes write(const Byte *data, size_t size)
+    {
+        while (size > 0)
+        {
+            if (fileRemaining_ == 0)
+            {
+                RINOK(beginNextFile());
+                if (curFile_ == kNoFolder)
+                {
+                    // more data than the files of the folder
+                    return SZ_ERROR_DATA;
+                }
+            }
+
+            size_t n = size;
+            if (n > fileRemaining_)
+                n = static_cast<size_t>(fileRemaining_);
+
+            const ExtractionEntry &entry = archive_->entries_[curFile_];
+            if (!entry.destination.empty())
+            {
+                crc_ = CrcUpdate(crc_, data, n);
+                if (entry.isSymLink)
+                {
+                    symLinkTarget_.append(reinterpret_cast<const char *>(data), n);
+                }
+                else
+                {
+                    size_t processedSize = n;
+                    if (File_Write(&file_, data, &processedSize) != 0 || processedSize != n)
+                    {
+                        archive_->PrintError("can not write output file");
+                        return SZ_ERROR_FAIL;
+                    }
+                }
+                archive_->extractedBytes_ += n;
+            }
+
+            data += n;
+            size -= n;
+            fileRemaining_ -= n;
+            if (fileRemaining_ == 0)
+            {
+                RINOK(endFile());
+            }
+        }
+        return SZ_OK;
+    }
+
+    // writes the remaining empty files, fails if the data was not complete
+    SRes finish()
+    {
+        if (fileRemaining_ != 0)
+            return SZ_ERROR_DATA;
+        RINOK(beginNextFile());
+        return curFile_ == kNoFolder ? SZ_OK : SZ_ERROR_DATA;
+    }
+
+private:
+    Archive *archive_;
+    UInt32 folderIndex_;
+    UInt32 nextFile_;
+    UInt32 endFile_;
+    UInt32 curFile_ = kNoFolder;
+    UInt64 fileRemaining_ = 0;
+    UInt32 crc_ = CRC_INIT_VAL;
+    bool isFileOpen_ = false;
+    CSzFile file_;
+    std::string symLinkTarget_;
+
+    // opens the next file with data, the empty files on the way are written at once
+    SRes beginNextFile()
+    {
+        curFile_ = kNoFolder;
+        while (nextFile_ < endFile_)
+        {
+            const UInt32 i = nextFile_++;
+            if (archive_->db.FileToFolder[i] != folderIndex_)
+                continue;
+
+            curFile_ = i;
+            fileRemaining_ = SzArEx_GetFileSize(&archive_->db, i);
+            crc_ = CRC_INIT_VAL;
+
+            const ExtractionEntry &entry = archive_->entries_[i];
+            if (!entry.destination.empty())
+            {
+                archive_->Print(("Extracting " + entry.logName + "\n").c_str());
+                if (entry.isSymLink)
+                {
+                    symLinkTarget_.clear();
+                }
+                else
+                {
+                    if (archive_->OutFile_OpenUtf16(&file_, reinterpret_cast<const UInt16 *>(entry.destination.c_str())))
+                    {
+                        archive_->PrintError("can not open output file");
+                        return SZ_ERROR_FAIL;
+                    }
+                    isFileOpen_ = true;
+                }
+            }
+
+            if (fileRemaining_ != 0)
+                return SZ_OK;
+            RINOK(endFile());
+            curFile_ = kNoFolder;
+        }
+        return SZ_OK;
+    }
+
+    SRes endFile()
+    {
+        const ExtractionEntry &entry = archive_->entries_[curFile_];
+        if (entry.destination.empty())
+            return SZ_OK;
+
+        if (isFileOpen_)
+        {
+            isFileOpen_ = false;
+            if (File_Close(&file_))
+            {
+                archive_->PrintError("can not close output file");
+                return SZ_ERROR_FAIL;
+            }
+        }
+
+        if (SzBitWithVals_Check(&archive_->db.CRCs, curFile_) && CRC_GET_DIGEST(crc_) != archive_->db.CRCs.Vals[curFile_])
+        {
+            archive_->PrintError("CRC error");
+            return SZ_ERROR_CRC;
+        }
+
+//Create the symlink or set the file permission(for OS X only)
+#ifndef _WIN32
+        CBuf buf;
+        Buf_Init(&buf);
+        SRes result = archive_->Utf16_To_Char(&buf, reinterpret_cast<const UInt16 *>(entry.destination.c_str()));
+        if (result == SZ_OK)
+        {
+            const char *path = reinterpret_cast<const char *>(buf.data);
+            if (entry.isSymLink)
+            {
+                symlink(symLinkTarget_.c_str(), path);
+                lchown(path, archive_->userId_, archive_->groupId_);
+            }
+            else
+            {
+                if (chmod(path, entry.permissions) != 0)
+                {
+                    result = SZ_ERROR_FAIL;
+                }
+                // set file owner
+                chown(path, archive_->userId_, archive_->groupId_);
+            }
+        }
+        Buf_Free(&buf, &g_Alloc);
+        return result;
+#else
+        return SZ_OK;
+#endif
+    }
+};
+
+void Archive::startExtraction(unsigned maxThreads)
+{
+    if (extractionThread_.joinable())
+        return;
+
+    isExtractionDone_ = false;
+    isExtractionStopped_ = false;
+    extractionResult_ = SZ_OK;
+    extractedBytes_ = 0;
+    extractionElapsedMs_ = 0;
+    extractionStart_ = std::chrono::steady_clock::now();
+    extractionThread_ = std::thread(&Archive::extractAll, this, maxThreads);
+}
+
+bool Archive::waitForExtraction(unsigned timeoutMs)
+{
+    {
+        std::unique_lock<std::mutex> lock(extractionMutex_);
+        if (!extractionDone_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return isExtractionDone_; }))
+            return false;
+    }
+    if (extractionThread_.joinable())
+        extractionThread_.join();
+    return true;
+}
+
+SRes Archive::extractionResult() const
+{
+    return extractionResult_;
+}
+
+int Archive::getExtractionProgress() const
+{
+    if (Total == 0)
+        return 0;
+    return static_cast<int>(std::min<UInt64>(extractedBytes_ * 100 / Total, 100));
+}
+
+UInt64 Archive::getExtractedBytes() const
+{
+    return extractedBytes_;
+}
+
+UInt64 Archive::getExtractionSpeed() const
+{
+    UInt64 elapsedMs = extractionElapsedMs_;
+    if (elapsedMs == 0)
+    {
+        elapsedMs = static_cast<UInt64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - extractionStart_).count());
+    }
+    return elapsedMs == 0 ? 0 : extractedBytes_ * 1000 / elapsedMs;
+}
+
+void Archive::setExtractionError(SRes error)
+{
+    SRes expected = SZ_OK;
+    extractionResult_.compare_exchange_strong(expected, error);
+    isExtractionStopped_ = true;
+}
+
+SRes Archive::prepareExtraction()
+{
+    std::unordered_map<wstring, size_t> fileIndexes;
+    size_t n = 0;
+    for (auto it = file_list.cbegin(); it != file_list.cend(); ++it, ++n)
+    {
+        fileIndexes.emplace(*it, n);
+    }
+    const std::vector<wstring> paths(path_list.cbegin(), path_list.cend());
+
+    entries_.assign(db.NumFiles, ExtractionEntry());
+    for (UInt32 i = 0; i < db.NumFiles; i++)
+    {
+        u16string file_name = getFileName(i, temp, tempSize);
+        if (res != SZ_OK)
+            return res;
+
+        auto found = fileIndexes.find(wstring(file_name.begin(), file_name.end()));
+        if (found == fileIndexes.end() || found->second >= paths.size() || SzArEx_IsDir(&db, i))
+            continue;
+#ifdef _WIN32
+        if (SzArEx_GetFileSize(&db, i) == 0)
+            continue;
+#endif
+
+        ExtractionEntry &entry = entries_[i];
+
+        //To take file name from a path
+        const wstring &path = paths[found->second];
+        u16string destination = u16string(path.begin(), path.end()) + u16string(1, '/') + file_name.substr(file_name.rfind('/') + 1);
+
+        //To create folders, the workers only write the files
+        for (size_t j = 0; j < destination.length(); j++)
+        {
+            if (destination[j] == '/' || destination[j] == '\\')
+            {
+                destination[j] = 0;
+                MyCreateDir(reinterpret_cast<const UInt16 *>(destination.c_str()));
+                destination[j] = CHAR_PATH_SEPARATOR;
+            }
+        }
+        entry.destination = destination;
+
+        CBuf buf;
+        Buf_Init(&buf);
+        if (Utf16_To_Char(&buf, temp
+#ifndef _USE_UTF8
+            , CP_OEMCP
+#endif
+            ) == SZ_OK)
+        {
+            entry.logName = reinterpret_cast<const char *>(buf.data);
+        }
+        Buf_Free(&buf, &g_Alloc);
+
+#ifndef _WIN32
+        const UInt32 attrVal = SzBitWithVals_Check(&db.Attribs, i) ? db.Attribs.Vals[i] : 0;
+        entry.isSymLink = (attrVal >> 16) & 0x2000;
+        entry.permissions = attrVal >> 16;
+#endif
+    }
+    return SZ_OK;
+}
+
+void Archive::extractAll(unsigned maxThreads)
+{
+    SRes result = prepareExtraction();
+    if (result != SZ_OK)
+        setExtractionError(result);
+
+    // the folders with the files to extract, the largest first so that a large one does not finish last alone
+    std::vector<UInt32> folders;
+    for (UInt32 f = 0; f < db.db.NumFolders && !isExtractionStopped_; f++)
+    {
+        for (UInt32 i = db.FolderToFile[f]; i < db.FolderToFile[f + 1]; i++)
+        {
+            if (db.FileToFolder[i] == f && !entries_[i].destination.empty())
+            {
+                folders.push_back(f);
+                break;
+            }
+        }
+    }
+    std::sort(folders.begin(), folders.end(), [this](UInt32 a, UInt32 b) {
+        return SzAr_GetFolderUnpackSize(&db.db, a) > SzAr_GetFolderUnpackSize(&db.db, b);
+    });
+
+    for (UInt32 i = 0; i < db.NumFiles && !isExtractionStopped_; i++)
+    {
+        if (db.FileToFolder[i] == kNoFolder && !entries_[i].destination.empty())
+        {
+            FolderWriter writer(this, kNoFolder, i, i + 1);
+            result = writer.finish();
+            if (result != SZ_OK)
+                setExtractionError(result);
+        }
+    }
+
+    unsigned numThreads = maxThreads != 0 ? maxThreads : std::thread::hardware_concurrency();
+    numThreads = static_cast<unsigned>(std::min<size_t>(std::max(numThreads, 1u), std::max<size_t>(folders.size(), 1)));
+
+    std::atomic<size_t> nextFolder{0};
+    auto worker = [this, &folders, &nextFolder]() {
+        std::vector<Byte> buffer(kStreamBufSize);
+        while (!isExtractionStopped_)
+        {
+            const size_t ind = nextFolder++;
+            if (ind >= folders.size())
+                break;
+            const SRes folderResult = extractFolder(folders[ind], buffer);
+            if (folderResult != SZ_OK)
+                setExtractionError(folderResult);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < numThreads; t++)
+    {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (auto &thread : workers)
+    {
+        thread.join();
+    }
+
+    const UInt64 elapsedMs = static_cast<UInt64>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - extractionStart_).count());
+    extractionElapsedMs_ = std::max<UInt64>(elapsedMs, 1);
+
+    char s[32];
+    string summary = "Extracted ";
+    ConvertUInt64ToString(extractedBytes_, s);
+    summary += s;
+    summary += " bytes in ";
+    ConvertUInt64ToString(elapsedMs, s);
+    summary += s;
+    summary += " ms (";
+    ConvertUInt64ToString(getExtractionSpeed() / 1024, s);
+    summary += s;
+    summary += " KB/s), threads: ";
+    ConvertUInt32ToString(numThreads, s);
+    summary += s;
+    summary += "\n";
+    Print(summary.c_str());
+
+    {
+        std::lock_guard<std::mutex> lock(extractionMutex_);
+        res = extractionResult_;
+        isExtractionDone_ = true;
+    }
+    extractionDone_.notify_all();
+}
+
+SRes Archive::extractFolder(UInt32 folderIndex, std::vector<Byte> &buffer)
+{
+    const CSzAr *ar = &db.db;
+    const Byte *coders = ar->CodersData + ar->FoCodersOffsets[folderIndex];
+    CSzFolder folder;
+    CSzData sd;
+    sd.Data = coders;
+    sd.Size = ar->FoCodersOffsets[folderIndex + 1] - ar->FoCodersOffsets[folderIndex];
+    RINOK(SzGetNextFolderItem(&folder, &sd));
+
+    FolderWriter writer(this, folderIndex, db.FolderToFile[folderIndex], db.FolderToFile[folderIndex + 1]);
+
+    const UInt64 *unpackSizes = ar->CoderUnpackSizes + ar->FoToCoderUnpackSizes[folderIndex];
+    const UInt64 unpackSize = SzAr_GetFolderUnpackSize(ar, folderIndex);
+    const CSzCoderInfo &coder = folder.Coders[0];
+
+    // LZMA, LZMA2 or stored data, optionally followed by the x86 filter
+    const bool hasBcj = folder.NumCoders == 2 && folder.Coders[1].MethodID == kMethodBcj && folder.Coders[1].NumStreams == 1
+                        && folder.Coders[1].PropsSize == 0 && folder.NumBonds == 1
+                        && folder.Bonds[0].InIndex == 1 && folder.Bonds[0].OutIndex == 0;
+    const bool isStreamable = sd.Size == 0 && (folder.NumCoders == 1 || hasBcj)
+                              && folder.NumPackStreams == 1 && folder.PackStreams[0] == 0 && coder.NumStreams == 1
+                              && (coder.MethodID == kMethodCopy || coder.MethodID == kMethodLzma || coder.MethodID == kMethodLzma2)
+                              && unpackSizes[0] == unpackSize;
+    if (!isStreamable)
+    {
+        return extractFolderInMemory(folderIndex, writer);
+    }
+
+    const UInt32 packIndex = ar->FoStartPackStreamIndex[folderIndex];
+    const UInt64 packOffset = db.dataPos + ar->PackPositions[packIndex];
+    const UInt64 packSize = ar->PackPositions[packIndex + 1] - ar->PackPositions[packIndex];
+    if (packOffset > file_size || packSize > file_size - packOffset)
+        return SZ_ERROR_INPUT_EOF;
+
+    CoderStream stream;
+    RINOK(stream.init(coder, coders + coder.PropsOffset, pData + packOffset, packSize, unpackSize));
+
+    // the filter converts a piece except a few bytes at the end, they are moved to the beginning of the next piece
+    UInt32 bcjState = Z7_BRANCH_CONV_ST_X86_STATE_INIT_VAL;
+    UInt32 bcjPc = 0;
+    size_t pending = 0;
+    while (stream.remaining() != 0)
+    {
+        if (isExtractionStopped_)
+            return SZ_ERROR_PROGRESS;
+
+        size_t size = buffer.size() - pending;
+        RINOK(stream.read(buffer.data() + pending, &size));
+        size += pending;
+
+        size_t ready = size;
+        if (hasBcj)
+        {
+            Byte *end = z7_BranchConvSt_X86_Dec(buffer.data(), size, bcjPc, &bcjState);
+            if (stream.remaining() != 0)
+            {
+                ready = static_cast<size_t>(end - buffer.data());
+                bcjPc += static_cast<UInt32>(ready);
+            }
+        }
+
+        RINOK(writer.write(buffer.data(), ready));
+        pending = size - ready;
+        memmove(buffer.data(), buffer.data() + ready, pending);
+    }
+    return writer.finish();
+}
+
+SRes Archive::extractFolderInMemory(UInt32 folderIndex, FolderWriter &writer)
+{
+    // the other methods (PPMd, BCJ2, the other filters) are decoded as before, the whole folder at once
+    const UInt64 unpackSize = SzAr_GetFolderUnpackSize(&db.db, folderIndex);
+    const size_t outSize = static_cast<size_t>(unpackSize);
+    if (outSize != unpackSize)
+        return SZ_ERROR_MEM;
+
+    // every thread reads the archive through its own stream
+    CFileInStream1 stream;
+    stream.file.pData = pData;
+    stream.file.Position = 0;
+    stream.file.Length = file_size;
+    FileInStream_CreateVTable1(&stream);
+
+    CLookToRead2 look;
+    LookToRead2_CreateVTable(&look, False);
+    look.buf = static_cast<Byte*>(ISzAlloc_Alloc(&allocImp, kInputBufSize));
+    Byte *out = static_cast<Byte*>(ISzAlloc_Alloc(&allocImp, outSize));
+
+    SRes result = SZ_ERROR_MEM;
+    if (look.buf != nullptr && (out != nullptr || outSize == 0))
+    {
+        look.bufSize = kInputBufSize;
+        look.realStream = &stream.vt;
+        LookToRead2_INIT(&look);
+
+        result = SzAr_DecodeFolder(&db.db, folderIndex, &look.vt, db.dataPos, out, outSize, &allocImp);
+        if (result == SZ_OK)
+            result = writer.write(out, outSize);
+        if (result == SZ_OK)
+            result = writer.finish();
+    }
+
+    ISzAlloc_Free(&allocImp, out);
+    ISzAlloc_Free(&allocImp, look.buf);
+    return result;
+}
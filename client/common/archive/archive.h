@@ -6,7 +6,11 @@
 #include <Windows.h>
 #endif
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
 #include <stdio.h>
 #include <string.h>
 
@@ -45,6 +49,8 @@ typedef struct
 #include <string>
 #include <list>
 #include <fstream>
+#include <thread>
+#include <vector>
 
 typedef struct
 {
@@ -111,6 +117,33 @@ private:
     UInt64 max_percent;
     std::string path_to_the_log;
     std::wstring last_error;
+    std::mutex logMutex_;
+
+    // the state of startExtraction()
+    class FolderWriter;
+    struct ExtractionEntry
+    {
+        std::u16string destination;     // empty if the file is not extracted
+        std::string logName;
+        bool isSymLink = false;
+        UInt32 permissions = 0;
+    };
+    std::vector<ExtractionEntry> entries_;
+    std::thread extractionThread_;
+    std::mutex extractionMutex_;
+    std::condition_variable extractionDone_;
+    bool isExtractionDone_ = false;
+    std::atomic<bool> isExtractionStopped_{false};
+    std::atomic<SRes> extractionResult_{SZ_OK};
+    std::atomic<UInt64> extractedBytes_{0};
+    std::atomic<UInt64> extractionElapsedMs_{0};   // set when the extraction is done
+    std::chrono::steady_clock::time_point extractionStart_;
+
+    void extractAll(unsigned maxThreads);
+    SRes prepareExtraction();
+    SRes extractFolder(UInt32 folderIndex, std::vector<Byte> &buffer);
+    SRes extractFolderInMemory(UInt32 folderIndex, FolderWriter &writer);
+    void setExtractionError(SRes error);
 
     void Print(const char *s);
     int Buf_EnsureSize(CBuf *dest, size_t size);
@@ -179,6 +212,17 @@ private:
     void calcTotal(const std::list<std::wstring> &files, const std::list<std::wstring> &paths);
     UInt32 getNumFiles();
     SRes extractionFile(const UInt32 &i);
+
+    // Extracts the files passed to calcTotal() on a background thread. The output is decoded in pieces and written
+    // straight to the files, so the memory use does not depend on the size of the solid blocks. The independent
+    // folders (solid blocks) are decoded in parallel by up to maxThreads threads (0 - the number of the cores).
+    void startExtraction(unsigned maxThreads = 0);
+    // returns true if the extraction is done, then extractionResult() can be checked and finish() called
+    bool waitForExtraction(unsigned timeoutMs);
+    SRes extractionResult() const;
+    int getExtractionProgress() const;          // 0..100
+    UInt64 getExtractedBytes() const;
+    UInt64 getExtractionSpeed() const;          // bytes per second
     UInt64 getPercent();
     UInt64 getMaxPercent();
     bool is_finish();
@@ -0,0 +1,164 @@
+// Benchmark of the archive extraction over a synthetic archive.
+//
+// The LZMA SDK has only the decoder, so the archive is packed by 7-Zip:
+//   archive_benchmark generate /tmp/payload
+//   7z a -t7z -mx=5 -ms=16m /tmp/payload.7z /tmp/payload/*
+//   archive_benchmark extract /tmp/payload.7z /tmp/out legacy    # the file by file extraction
+//   archive_benchmark extract /tmp/payload.7z /tmp/out 1         # streaming, one thread
+//   archive_benchmark extract /tmp/payload.7z /tmp/out           # streaming, all the cores
+// -ms=16m splits the archive into solid blocks of 16 MB, which can be decoded in parallel.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <list>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "../archive.h"
+
+namespace {
+
+const size_t kTotalSize = 200 * 1024 * 1024;
+
+long peakRssKb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+// Text-like data compresses like the libraries and the resources of the app, random data like the images.
+void writeFile(const std::filesystem::path &path, size_t size, bool isText, std::mt19937 &rng)
+{
+    static const char *words[] = { "windscribe", "connect", "location", "server", "tunnel", "protocol", "firewall",
+                                   "wireguard", "openvpn", "network", "adapter", "packet", "route", "dns", "ping" };
+    std::string data;
+    data.reserve(size);
+    while (data.size() < size)
+    {
+        if (isText)
+        {
+            data += words[rng() % (sizeof(words) / sizeof(words[0]))];
+            data += (rng() % 8 == 0) ? '\n' : ' ';
+        }
+        else
+        {
+            const unsigned int v = rng();
+            data.append(reinterpret_cast<const char *>(&v), sizeof(v));
+        }
+    }
+    data.resize(size);
+
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+int generate(const std::string &dir)
+{
+    std::mt19937 rng(12345);
+    size_t total = 0;
+    int count = 0;
+    while (total < kTotalSize)
+    {
+        // mostly small files and a few large ones
+        size_t size = (count % 50 == 0) ? (8 + rng() % 24) * 1024 * 1024 : (4 + rng() % 252) * 1024;
+        if (size > kTotalSize - total)
+            size = kTotalSize - total;
+        const bool isText = rng() % 4 != 0;
+        const std::filesystem::path path = std::filesystem::path(dir) / ("dir" + std::to_string(count % 16)) / ("file" + std::to_string(count) + ".bin");
+        writeFile(path, size, isText, rng);
+        total += size;
+        count++;
+    }
+    printf("%d files, %zu bytes in %s\n", count, total, dir.c_str());
+    printf("now pack them: 7z a -t7z -mx=5 -ms=16m %s.7z %s/*\n", dir.c_str(), dir.c_str());
+    return 0;
+}
+
+int extract(const std::string &archivePath, const std::string &outDir, const std::string &mode)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    Archive archive(std::wstring(archivePath.begin(), archivePath.end()), getuid(), getgid());
+    if (!archive.isCorrect())
+    {
+        printf("can't open %s\n", archivePath.c_str());
+        return 1;
+    }
+
+    std::list<std::wstring> files;
+    if (archive.fileList(files) != SZ_OK)
+    {
+        printf("can't read the file list\n");
+        return 1;
+    }
+    std::list<std::wstring> paths;
+    for (const auto &file : files)
+    {
+        std::wstring path = std::wstring(outDir.begin(), outDir.end()) + L"/" + file;
+        paths.push_back(path.substr(0, path.rfind(L'/')));
+    }
+    archive.calcTotal(files, paths);
+
+    SRes res;
+    if (mode == "legacy")
+    {
+        res = SZ_OK;
+        for (UInt32 i = 0; i < archive.getNumFiles() && res == SZ_OK; i++)
+        {
+            res = archive.extractionFile(i);
+        }
+    }
+    else
+    {
+        archive.startExtraction(mode.empty() ? 0 : static_cast<unsigned>(atoi(mode.c_str())));
+        while (!archive.waitForExtraction(500))
+        {
+            printf("  %d%%, %llu KB/s\n", archive.getExtractionProgress(),
+                   static_cast<unsigned long long>(archive.getExtractionSpeed() / 1024));
+        }
+        res = archive.extractionResult();
+    }
+    archive.finish();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    UInt64 totalSize = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(outDir))
+    {
+        if (entry.is_regular_file())
+            totalSize += entry.file_size();
+    }
+
+    printf("mode: %s, result: %d\n", mode.empty() ? "parallel" : mode.c_str(), res);
+    printf("extracted %llu bytes in %.2f s, %.1f MB/s\n", static_cast<unsigned long long>(totalSize), seconds,
+           totalSize / seconds / (1024 * 1024));
+    printf("peak RSS: %ld KB (the archive is loaded in memory)\n", peakRssKb());
+    return res == SZ_OK ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc == 3 && strcmp(argv[1], "generate") == 0)
+        return generate(argv[2]);
+    if ((argc == 4 || argc == 5) && strcmp(argv[1], "extract") == 0)
+        return extract(argv[2], argv[3], argc == 5 ? argv[4] : "");
+
+    printf("usage: %s generate <dir>\n", argv[0]);
+    printf("       %s extract <file.7z> <outDir> [legacy|<threads>]\n", argv[0]);
+    return 1;
+}
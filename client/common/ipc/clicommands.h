@@ -417,5 +417,57 @@ public:
     static std::string getCommandStringId() { return "CliCommands::SignedOut";  }
 };
 
+class GetMetrics : public Command
+{
+public:
+    GetMetrics() {}
+    explicit GetMetrics(char *buf, int size)
+    {
+        Q_UNUSED(buf)
+        Q_UNUSED(size)
+    }
+
+    std::vector<char> getData() const override
+    {
+        return std::vector<char>();
+    }
+
+    std::string getStringId() const override { return getCommandStringId(); }
+    std::string getDebugString() const override
+    {
+        return "CliCommands::GetMetrics debug string";
+    }
+    static std::string getCommandStringId() { return "CliCommands::GetMetrics";  }
+};
+
+class Metrics : public Command
+{
+public:
+    Metrics() {}
+    explicit Metrics(char *buf, int size)
+    {
+        QByteArray arr(buf, size);
+        QDataStream ds(&arr, QIODevice::ReadOnly);
+        ds >> text_;
+    }
+
+    std::vector<char> getData() const override
+    {
+        QByteArray arr;
+        QDataStream ds(&arr, QIODevice::WriteOnly);
+        ds << text_;
+        return std::vector<char>(arr.begin(), arr.end());
+    }
+
+    std::string getStringId() const override { return getCommandStringId(); }
+    std::string getDebugString() const override
+    {
+        return "CliCommands::Metrics debug string";
+    }
+    static std::string getCommandStringId() { return "CliCommands::Metrics";  }
+
+    QString text_;      // in the Prometheus text format
+};
+
 } // namespace CliCommands
 } // namespace IPC
@@ -73,6 +73,14 @@ Command *CommandFactory::makeCommand(const std::string strId, char *buf, int siz
     {
         return new IPC::CliCommands::SignedOut(buf, size);
     }
+    else if (strId == IPC::CliCommands::GetMetrics::getCommandStringId())
+    {
+        return new IPC::CliCommands::GetMetrics(buf, size);
+    }
+    else if (strId == IPC::CliCommands::Metrics::getCommandStringId())
+    {
+        return new IPC::CliCommands::Metrics(buf, size);
+    }
 
     WS_ASSERT(false);
     return NULL;
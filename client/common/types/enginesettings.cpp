@@ -5,6 +5,7 @@
 #include "utils/extraconfig.h"
 #include "utils/languagesutil.h"
 #include "utils/logger.h"
+#include "utils/settingsstore.h"
 #include "utils/simplecrypt.h"
 #include "utils/utils.h"
 
@@ -12,6 +13,11 @@ const int typeIdEngineSettings = qRegisterMetaType<types::EngineSettings>("types
 
 namespace types {
 
+namespace {
+const SettingsKey<QString> kEngineSettingsKey { "engineSettings" };
+const SettingsKey<QString> kLegacyEngineSettingsKey { "engineSettings2" };
+}
+
 EngineSettings::EngineSettings() : d(new EngineSettingsData)
 {
 }
@@ -123,10 +129,8 @@ void EngineSettings::saveToSettings()
               d->isAntiCensorship;
     }
 
-    QSettings settings;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    settings.setValue("engineSettings", simpleCrypt.encryptToString(arr));
-    settings.sync();
+    SettingsStore::instance().setValue(kEngineSettingsKey, simpleCrypt.encryptToString(arr));
 }
 
 bool EngineSettings::loadFromSettings()
@@ -134,9 +138,9 @@ bool EngineSettings::loadFromSettings()
     bool bLoaded = false;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
 
-    QSettings settings;
-    if (settings.contains("engineSettings")) {
-        QString str = settings.value("engineSettings", "").toString();
+    SettingsStore &settings = SettingsStore::instance();
+    if (settings.contains(kEngineSettingsKey)) {
+        QString str = settings.value(kEngineSettingsKey);
         QByteArray arr = simpleCrypt.decryptToByteArray(str);
 
         QDataStream ds(&arr, QIODevice::ReadOnly);
@@ -167,16 +171,16 @@ bool EngineSettings::loadFromSettings()
         }
     }
 
-    if (!bLoaded && settings.contains("engineSettings2")) {
+    if (!bLoaded && settings.contains(kLegacyEngineSettingsKey)) {
         // try load from legacy protobuf
         // todo remove this code at some point later
-        QString str = settings.value("engineSettings2", "").toString();
+        QString str = settings.value(kLegacyEngineSettingsKey);
         QByteArray arr = simpleCrypt.decryptToByteArray(str);
         if (LegacyProtobufSupport::loadEngineSettings(arr, *this)) {
             bLoaded = true;
         }
 
-        settings.remove("engineSettings2");
+        settings.remove(kLegacyEngineSettingsKey);
     }
 
     if (!bLoaded) {
@@ -0,0 +1,103 @@
+#include "locationsdelta.h"
+
+#include <QHash>
+#include "utils/ws_assert.h"
+
+namespace types {
+
+namespace {
+
+bool isCityEqualExceptPing(const City &c1, const City &c2)
+{
+    City c = c2;
+    c.pingTimeMs = c1.pingTimeMs;
+    return c1 == c;
+}
+
+bool isLocationEqualExceptPing(const Location &l1, const Location &l2)
+{
+    if (l1.id != l2.id || l1.name != l2.name || l1.countryCode != l2.countryCode ||
+        l1.isPremiumOnly != l2.isPremiumOnly || l1.isNoP2P != l2.isNoP2P || l1.cities.size() != l2.cities.size()) {
+        return false;
+    }
+
+    for (int i = 0; i < l1.cities.size(); ++i) {
+        if (!isCityEqualExceptPing(l1.cities[i], l2.cities[i]))
+            return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool LocationsDelta::isEmpty() const
+{
+    return !isReset && removedLocations.isEmpty() && addedLocations.isEmpty() && changedLocations.isEmpty() && order.isEmpty();
+}
+
+QVector<Location> LocationsDelta::allLocations() const
+{
+    WS_ASSERT(isReset);
+    QVector<Location> locations;
+    locations.reserve(addedLocations.size());
+    for (const auto &it : addedLocations)
+        locations << it.second;
+    return locations;
+}
+
+LocationsDelta LocationsDelta::makeReset(const QVector<Location> &locations)
+{
+    LocationsDelta delta;
+    delta.isReset = true;
+    delta.addedLocations.reserve(locations.size());
+    for (int i = 0; i < locations.size(); ++i)
+        delta.addedLocations << qMakePair(i, locations[i]);
+    return delta;
+}
+
+LocationsDelta LocationsDelta::make(const QVector<Location> &oldLocations, const QVector<Location> &newLocations)
+{
+    LocationsDelta delta;
+
+    QHash<LocationID, int> oldMap;
+    oldMap.reserve(oldLocations.size());
+    for (int i = 0; i < oldLocations.size(); ++i)
+        oldMap[oldLocations[i].id] = i;
+
+    QHash<LocationID, int> newMap;
+    newMap.reserve(newLocations.size());
+    for (int i = 0; i < newLocations.size(); ++i)
+        newMap[newLocations[i].id] = i;
+
+    // the remaining locations in the old order, to detect movements
+    QVector<LocationID> oldRemainingOrder;
+    for (const Location &l : oldLocations) {
+        if (newMap.contains(l.id))
+            oldRemainingOrder << l.id;
+        else
+            delta.removedLocations << l.id;
+    }
+
+    QVector<LocationID> newRemainingOrder;
+    for (int i = 0; i < newLocations.size(); ++i) {
+        const Location &l = newLocations[i];
+        auto it = oldMap.constFind(l.id);
+        if (it == oldMap.constEnd()) {
+            delta.addedLocations << qMakePair(i, l);
+        } else {
+            newRemainingOrder << l.id;
+            if (!isLocationEqualExceptPing(oldLocations[it.value()], l))
+                delta.changedLocations << l;
+        }
+    }
+
+    if (oldRemainingOrder != newRemainingOrder) {
+        delta.order.reserve(newLocations.size());
+        for (const Location &l : newLocations)
+            delta.order << l.id;
+    }
+
+    return delta;
+}
+
+} //namespace types
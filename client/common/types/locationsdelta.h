@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QPair>
+#include <QVector>
+#include "location.h"
+
+namespace types {
+
+// The structural difference between two successive lists of locations, keyed by LocationID.
+// It is calculated once in the engine when the server list is updated, so that only the changes are sent to the GUI.
+// Changed locations are sent with the complete (small) list of cities, the receiver applies the city changes itself.
+// Ping times are not taken into account when comparing, they are delivered separately.
+struct LocationsDelta
+{
+    bool isReset = false;                               // addedLocations contains the complete list, the receiver must drop its current list
+    QVector<LocationID> removedLocations;
+    QVector<QPair<int, Location> > addedLocations;      // index in the new list and the location, sorted by index
+    QVector<Location> changedLocations;
+    QVector<LocationID> order;                          // the order of all locations in the new list, empty if the order has not changed
+
+    bool isEmpty() const;
+    QVector<Location> allLocations() const;             // applicable only for the reset delta
+
+    static LocationsDelta makeReset(const QVector<Location> &locations);
+    static LocationsDelta make(const QVector<Location> &oldLocations, const QVector<Location> &newLocations);
+};
+
+} //namespace types
@@ -34,6 +34,8 @@ const QString WS_SERVERLIST_COUNTRY_OVERRIDE = WS_PREFIX + "serverlist-country-o
 
 const QString WS_USE_OPENVPN_DCO = WS_PREFIX + "use-openvpn-dco";
 
+const QString WS_METRICS_PORT = WS_PREFIX + "metrics-port";
+
 void ExtraConfig::writeConfig(const QString &cfg)
 {
     QMutexLocker locker(&mutex_);
@@ -222,6 +224,16 @@ int ExtraConfig::getTunnelTestAttempts(bool &success)
     return attempts;
 }
 
+int ExtraConfig::getMetricsPort(bool &success)
+{
+    int port = getIntFromExtraConfigLines(WS_METRICS_PORT, success);
+    if (success && (port <= 0 || port > 65535)) {
+        success = false;
+    }
+
+    return port;
+}
+
 bool ExtraConfig::getIsTunnelTestNoError()
 {
     return getFlagFromExtraConfigLines(WS_TT_NO_ERROR_STR);
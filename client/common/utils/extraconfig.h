@@ -46,6 +46,9 @@ public:
     int getTunnelTestAttempts(bool &success);
     bool getIsTunnelTestNoError();
 
+    // the port of the local Prometheus endpoint of the engine metrics, disabled if not set
+    int getMetricsPort(bool &success);
+
     bool getOverrideUpdateChannelToInternal();
     bool getIsStaging();
 
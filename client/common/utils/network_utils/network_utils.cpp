@@ -1,5 +1,7 @@
 #include "network_utils.h"
 
+#include <future>
+
 #include "../utils.h"
 
 #if defined Q_OS_WIN
@@ -64,11 +66,28 @@ bool NetworkUtils::pingWithMtu(const QString &url, int mtu)
 #elif defined Q_OS_MAC
     return NetworkUtils_mac::pingWithMtu(url, mtu);
 #elif defined Q_OS_LINUX
-    // This method is not currently used on Linux.
-    Q_UNUSED(url)
-    Q_UNUSED(mtu)
-    return false;
+    return NetworkUtils_linux::pingWithMtu(url, mtu);
+#endif
+}
+
+QVector<bool> NetworkUtils::pingWithMtus(const QString &url, const QVector<int> &mtus, int timeoutMs)
+{
+#if defined Q_OS_LINUX
+    QVector<bool> socketResult;
+    if (NetworkUtils_linux::pingWithMtus(url, mtus, timeoutMs, socketResult))
+        return socketResult;
+    // the group of the user is not in net.ipv4.ping_group_range, use the ping utility as on the other platforms
 #endif
+    // the system ping utility takes one size at a time and has its own 1 second timeout, so run them in parallel
+    Q_UNUSED(timeoutMs)
+    std::vector<std::future<bool>> futures;
+    for (int mtu : mtus)
+        futures.push_back(std::async(std::launch::async, [url, mtu]() { return pingWithMtu(url, mtu); }));
+
+    QVector<bool> result;
+    for (auto &future : futures)
+        result << future.get();
+    return result;
 }
 
 QString NetworkUtils::getLocalIP()
@@ -16,5 +16,8 @@ namespace NetworkUtils
     QString networkInterfacesToString(const QVector<types::NetworkInterface> &networkInterfaces, bool includeIndex);
 
     bool pingWithMtu(const QString &url, int mtu);
+    // Sends the pings with all the given sizes at once with the "don't fragment" flag set.
+    // Returns for each size whether the reply came within timeoutMs.
+    QVector<bool> pingWithMtus(const QString &url, const QVector<int> &mtus, int timeoutMs);
     QString getLocalIP();
 }
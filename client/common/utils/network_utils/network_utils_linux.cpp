@@ -1,11 +1,17 @@
 #include "network_utils_linux.h"
 
+#include <QElapsedTimer>
 #include <QHostAddress>
 #include <QScopeGuard>
 
 #include <arpa/inet.h>
+#include <errno.h>
 #include <linux/rtnetlink.h>
 #include <net/if.h>
+#include <netdb.h>
+#include <netinet/ip_icmp.h>
+#include <poll.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "../logger.h"
@@ -85,6 +91,91 @@ QString getLocalIP()
     return sLocalIP;
 }
 
+bool pingWithMtus(const QString &url, const QVector<int> &mtus, int timeoutMs, QVector<bool> &outResult)
+{
+    outResult = QVector<bool>(mtus.size(), false);
+    if (mtus.isEmpty())
+        return true;
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *addrInfo = nullptr;
+    if (getaddrinfo(url.toUtf8().constData(), nullptr, &hints, &addrInfo) != 0 || addrInfo == nullptr) {
+        qCDebug(LOG_PACKET_SIZE) << "pingWithMtus could not resolve" << url;
+        return true;
+    }
+    sockaddr_in addr;
+    memcpy(&addr, addrInfo->ai_addr, sizeof(addr));
+    freeaddrinfo(addrInfo);
+
+    // The unprivileged ICMP socket (net.ipv4.ping_group_range), the kernel sets the echo identifier and filters the replies.
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, IPPROTO_ICMP);
+    if (fd < 0) {
+        const int error = errno;
+        qCDebug(LOG_PACKET_SIZE) << "pingWithMtus could not open the ICMP socket:" << error;
+        return error != EACCES && error != EPERM;
+    }
+    auto closeSocket = qScopeGuard([fd] { close(fd); });
+
+    // Set DF and do not limit the probes by the path MTU cached in the kernel, otherwise the larger sizes are never sent.
+    int pmtuDiscover = IP_PMTUDISC_PROBE;
+    if (setsockopt(fd, IPPROTO_IP, IP_MTU_DISCOVER, &pmtuDiscover, sizeof(pmtuDiscover)) != 0) {
+        qCDebug(LOG_PACKET_SIZE) << "pingWithMtus could not set IP_MTU_DISCOVER:" << errno;
+        return true;
+    }
+
+    // the index of the size is the sequence number of the probe
+    const quint16 firstSequence = static_cast<quint16>(Utils::generateIntegerRandom(0, 0xFFFF));
+    int pending = 0;
+    for (int i = 0; i < mtus.size(); ++i) {
+        QByteArray packet(sizeof(icmphdr) + mtus[i], 0);
+        icmphdr *header = reinterpret_cast<icmphdr *>(packet.data());
+        header->type = ICMP_ECHO;
+        header->un.echo.sequence = htons(static_cast<quint16>(firstSequence + i));
+        // EMSGSIZE means that the size is larger than the MTU of the outgoing interface
+        if (sendto(fd, packet.constData(), packet.size(), 0, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+            continue;
+        pending++;
+    }
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    QByteArray buffer(65536, 0);
+    while (pending > 0) {
+        const int remainingMs = timeoutMs - static_cast<int>(elapsedTimer.elapsed());
+        if (remainingMs <= 0)
+            break;
+
+        pollfd pfd = { fd, POLLIN, 0 };
+        const int ret = poll(&pfd, 1, remainingMs);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            break;
+
+        const ssize_t len = recv(fd, buffer.data(), buffer.size(), 0);
+        if (len < static_cast<ssize_t>(sizeof(icmphdr)))
+            continue;
+        const icmphdr *reply = reinterpret_cast<const icmphdr *>(buffer.constData());
+        if (reply->type != ICMP_ECHOREPLY)
+            continue;
+        const int ind = static_cast<quint16>(ntohs(reply->un.echo.sequence) - firstSequence);
+        if (ind < mtus.size() && !outResult[ind] && len == static_cast<ssize_t>(sizeof(icmphdr) + mtus[ind])) {
+            outResult[ind] = true;
+            pending--;
+        }
+    }
+    return true;
+}
+
+bool pingWithMtu(const QString &url, int mtu)
+{
+    const QString cmd = QString("ping -c 1 -W 1 -M do -s %1 %2 2> /dev/null").arg(mtu).arg(url);
+    const QString result = Utils::execCmd(cmd).trimmed();
+    return result.contains("icmp_seq=");
+}
+
 static QString getNetlinkIP(int family, const char* buffer)
 {
     char dst[INET6_ADDRSTRLEN] = {0};
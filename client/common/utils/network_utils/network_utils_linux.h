@@ -2,11 +2,16 @@
 
 #include <QList>
 #include <QString>
+#include <QVector>
 
 namespace NetworkUtils_linux
 {
     void getDefaultRoute(QString &outGatewayIp, QString &outInterfaceName, QString &outAdapterIp);
     QString getLocalIP();
+    // ICMP echo with the DF flag over an unprivileged ping socket, all the sizes are probed in parallel.
+    // Returns false if the socket is not permitted for the user (net.ipv4.ping_group_range).
+    bool pingWithMtus(const QString &url, const QVector<int> &mtus, int timeoutMs, QVector<bool> &outResult);
+    bool pingWithMtu(const QString &url, int mtu);
 
     class RoutingTableEntry
     {
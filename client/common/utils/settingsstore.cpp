@@ -0,0 +1,114 @@
+#include "settingsstore.h"
+
+#include <QSettings>
+#include <QThread>
+
+SettingsStore::SettingsStore()
+{
+    thread_ = QThread::create([this] { run(); });
+    thread_->setObjectName("SettingsStore");
+    thread_->start(QThread::LowPriority);
+}
+
+SettingsStore::~SettingsStore()
+{
+    {
+        QMutexLocker locker(&mutex_);
+        isStopping_ = true;
+        // the application is gone at this point, QSettings would write to a file without the organization and application names
+        pending_.clear();
+    }
+    condition_.wakeAll();
+    thread_->wait();
+    delete thread_;
+}
+
+bool SettingsStore::contains(const QString &key) const
+{
+    QMutexLocker locker(&mutex_);
+    return cachedValue(key).isValid();
+}
+
+QVariant SettingsStore::value(const QString &key, const QVariant &defaultValue) const
+{
+    QMutexLocker locker(&mutex_);
+    const QVariant v = cachedValue(key);
+    return v.isValid() ? v : defaultValue;
+}
+
+void SettingsStore::setValue(const QString &key, const QVariant &value)
+{
+    QMutexLocker locker(&mutex_);
+    setPending(key, value);
+}
+
+void SettingsStore::remove(const QString &key)
+{
+    QMutexLocker locker(&mutex_);
+    // the legacy keys are removed on every start, don't write for nothing
+    if (cachedValue(key).isValid())
+        setPending(key, QVariant());
+}
+
+void SettingsStore::flush()
+{
+    writePending();
+}
+
+QVariant SettingsStore::cachedValue(const QString &key) const
+{
+    auto it = cache_.constFind(key);
+    if (it == cache_.constEnd()) {
+        QSettings settings;
+        it = cache_.insert(key, settings.value(key));
+    }
+    return *it;
+}
+
+void SettingsStore::setPending(const QString &key, const QVariant &value)
+{
+    cache_[key] = value;
+    const bool wasIdle = pending_.isEmpty();
+    pending_[key] = value;
+    if (wasIdle)
+        condition_.wakeAll();
+}
+
+void SettingsStore::run()
+{
+    QMutexLocker locker(&mutex_);
+    while (!isStopping_) {
+        if (pending_.isEmpty()) {
+            condition_.wait(&mutex_);
+            continue;
+        }
+        // let the changes of a burst of setters accumulate
+        condition_.wait(&mutex_, kFlushDelayMs);
+        if (isStopping_)
+            break;
+        locker.unlock();
+        writePending();
+        locker.relock();
+    }
+}
+
+void SettingsStore::writePending()
+{
+    QMutexLocker writeLocker(&writeMutex_);
+    QHash<QString, QVariant> changes;
+    {
+        QMutexLocker locker(&mutex_);
+        changes.swap(pending_);
+    }
+    if (changes.isEmpty())
+        return;
+
+    QSettings settings;
+    for (auto it = changes.cbegin(); it != changes.cend(); ++it) {
+        if (it.value().isValid())
+            settings.setValue(it.key(), it.value());
+        else
+            settings.remove(it.key());
+    }
+    settings.sync();
+}
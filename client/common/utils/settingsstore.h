@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+#include <QWaitCondition>
+
+class QThread;
+
+// A typed key of the settings. The name is the QSettings key, so the values written by the previous versions are read as is.
+template <typename T>
+struct SettingsKey
+{
+    const char *name;
+};
+
+// Write-behind cache over the default QSettings, shared by the GUI and the engine threads.
+// A key is read from QSettings once, later reads and all the writes go to memory and mark the key as dirty.
+// A background thread writes the dirty keys and syncs kFlushDelayMs after the first change, so a burst of setters costs one sync.
+// QSettings replaces the ini/plist file with an atomic rename (QSaveFile), the registry on Windows is updated per value,
+// so a crash loses the changes of the last kFlushDelayMs at most and never leaves a half-written file.
+// flush() must be called before the QCoreApplication is destroyed, the changes made after that are not written.
+class SettingsStore
+{
+public:
+    static SettingsStore &instance()
+    {
+        static SettingsStore s;
+        return s;
+    }
+
+    bool contains(const QString &key) const;
+    QVariant value(const QString &key, const QVariant &defaultValue = QVariant()) const;
+    void setValue(const QString &key, const QVariant &value);
+    void remove(const QString &key);
+
+    template <typename T>
+    bool contains(SettingsKey<T> key) const { return contains(QString::fromLatin1(key.name)); }
+    template <typename T>
+    T value(SettingsKey<T> key, const T &defaultValue = T()) const
+    {
+        const QVariant v = value(QString::fromLatin1(key.name));
+        return v.isValid() ? v.value<T>() : defaultValue;
+    }
+    template <typename T>
+    void setValue(SettingsKey<T> key, const T &value) { setValue(QString::fromLatin1(key.name), QVariant::fromValue(value)); }
+    template <typename T>
+    void remove(SettingsKey<T> key) { remove(QString::fromLatin1(key.name)); }
+
+    // writes the pending changes on the calling thread
+    void flush();
+
+private:
+    static constexpr unsigned long kFlushDelayMs = 1000;
+
+    SettingsStore();
+    ~SettingsStore();
+
+    QVariant cachedValue(const QString &key) const;   // mutex_ must be locked
+    void setPending(const QString &key, const QVariant &value);   // mutex_ must be locked
+    void run();
+    void writePending();
+
+    mutable QMutex mutex_;
+    QWaitCondition condition_;
+    // the last known value of each accessed key, an invalid QVariant for a missing key
+    mutable QHash<QString, QVariant> cache_;
+    // the changes not written yet, an invalid QVariant removes the key
+    QHash<QString, QVariant> pending_;
+    bool isStopping_ = false;
+
+    // serializes the writers, so an older snapshot of the changes is never written over a newer one
+    QMutex writeMutex_;
+    QThread *thread_;
+
+    Q_DISABLE_COPY(SettingsStore)
+};
@@ -0,0 +1,123 @@
+#include <QtTest>
+#include <QSettings>
+#include "utils/settingsstore.h"
+
+// The store is a singleton, so each test uses its own keys.
+class TestSettingsStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testReadAfterWrite();
+    void testFlush();
+    void testBackgroundWrite();
+    void testRemove();
+    void testExistingValue();
+    void testTypedKey();
+
+private:
+    static const QStringList kKeys;
+};
+
+const QStringList TestSettingsStore::kKeys = { "readAfterWrite", "flush", "backgroundWrite", "remove", "existing", "typed" };
+
+void TestSettingsStore::initTestCase()
+{
+    // the settings of the test are not mixed with the ones of the app
+    QCoreApplication::setOrganizationName("WindscribeTest");
+    QCoreApplication::setApplicationName("settingsstore.test");
+    QSettings settings;
+    for (const QString &key : kKeys)
+        settings.remove(key);
+}
+
+void TestSettingsStore::cleanupTestCase()
+{
+    for (const QString &key : kKeys)
+        SettingsStore::instance().remove(key);
+    SettingsStore::instance().flush();
+}
+
+void TestSettingsStore::testReadAfterWrite()
+{
+    SettingsStore &store = SettingsStore::instance();
+    QVERIFY(!store.contains("readAfterWrite"));
+    QCOMPARE(store.value("readAfterWrite", 7).toInt(), 7);
+
+    // the pending value is read before it is written
+    store.setValue("readAfterWrite", 42);
+    QVERIFY(store.contains("readAfterWrite"));
+    QCOMPARE(store.value("readAfterWrite").toInt(), 42);
+    store.setValue("readAfterWrite", 43);
+    QCOMPARE(store.value("readAfterWrite", 7).toInt(), 43);
+}
+
+void TestSettingsStore::testFlush()
+{
+    SettingsStore &store = SettingsStore::instance();
+    store.setValue("flush", QString("value"));
+    store.flush();
+
+    QSettings settings;
+    QCOMPARE(settings.value("flush").toString(), QString("value"));
+}
+
+void TestSettingsStore::testBackgroundWrite()
+{
+    SettingsStore::instance().setValue("backgroundWrite", 5);
+    // written by the background thread a second after the change
+    QTRY_COMPARE_WITH_TIMEOUT(QSettings().value("backgroundWrite").toInt(), 5, 5000);
+}
+
+void TestSettingsStore::testRemove()
+{
+    SettingsStore &store = SettingsStore::instance();
+    store.setValue("remove", 1);
+    store.flush();
+    QVERIFY(QSettings().contains("remove"));
+
+    store.remove("remove");
+    QVERIFY(!store.contains("remove"));
+    QVERIFY(!store.value("remove").isValid());
+    store.flush();
+    QVERIFY(!QSettings().contains("remove"));
+
+    // a pending value is removed before it is written
+    store.setValue("remove", 2);
+    store.remove("remove");
+    store.flush();
+    QVERIFY(!store.contains("remove"));
+    QVERIFY(!QSettings().contains("remove"));
+}
+
+void TestSettingsStore::testExistingValue()
+{
+    // a value written by a previous version of the app
+    {
+        QSettings settings;
+        settings.setValue("existing", QByteArray("data"));
+        settings.sync();
+    }
+    QVERIFY(SettingsStore::instance().contains("existing"));
+    QCOMPARE(SettingsStore::instance().value("existing").toByteArray(), QByteArray("data"));
+}
+
+void TestSettingsStore::testTypedKey()
+{
+    static constexpr SettingsKey<bool> kTyped{"typed"};
+    SettingsStore &store = SettingsStore::instance();
+    QVERIFY(!store.contains(kTyped));
+    QCOMPARE(store.value(kTyped, true), true);
+
+    store.setValue(kTyped, false);
+    QVERIFY(store.contains(kTyped));
+    QCOMPARE(store.value(kTyped, true), false);
+    store.remove(kTyped);
+    QVERIFY(!store.contains(kTyped));
+}
+
+QTEST_MAIN(TestSettingsStore)
+#include "settingsstore.test.moc"
@@ -0,0 +1,253 @@
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace tracing {
+
+namespace {
+
+constexpr int kEventsPerThread = 4096;
+
+struct Event
+{
+    char phase;             // 'X' - complete span, 'b'/'e' - begin/end of an async span
+    int tid;
+    const char *category;
+    const char *name;
+    qint64 timestampUs;
+    qint64 durationUs;
+    quint64 id;
+    qint64 value;
+};
+
+// Written only by the thread which owns it, read by the export at any time.
+// Every slot is a seqlock: seq is 0 while the slot is being written, and the index + 1 of the event once it's complete.
+class ThreadBuffer
+{
+public:
+    void add(const Event &event)
+    {
+        const quint64 index = head_.load(std::memory_order_relaxed);
+        Slot &slot = slots_[index % kEventsPerThread];
+        slot.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.phase.store(event.phase, std::memory_order_relaxed);
+        slot.tid.store(event.tid, std::memory_order_relaxed);
+        slot.category.store(event.category, std::memory_order_relaxed);
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.timestampUs.store(event.timestampUs, std::memory_order_relaxed);
+        slot.durationUs.store(event.durationUs, std::memory_order_relaxed);
+        slot.id.store(event.id, std::memory_order_relaxed);
+        slot.value.store(event.value, std::memory_order_relaxed);
+        slot.seq.store(index + 1, std::memory_order_release);
+        head_.store(index + 1, std::memory_order_release);
+    }
+
+    void read(std::vector<Event> &out) const
+    {
+        const quint64 head = head_.load(std::memory_order_acquire);
+        for (quint64 index = head > kEventsPerThread ? head - kEventsPerThread : 0; index < head; ++index)
+        {
+            const Slot &slot = slots_[index % kEventsPerThread];
+            if (slot.seq.load(std::memory_order_acquire) != index + 1)
+                continue;
+            Event event;
+            event.phase = slot.phase.load(std::memory_order_relaxed);
+            event.tid = slot.tid.load(std::memory_order_relaxed);
+            event.category = slot.category.load(std::memory_order_relaxed);
+            event.name = slot.name.load(std::memory_order_relaxed);
+            event.timestampUs = slot.timestampUs.load(std::memory_order_relaxed);
+            event.durationUs = slot.durationUs.load(std::memory_order_relaxed);
+            event.id = slot.id.load(std::memory_order_relaxed);
+            event.value = slot.value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // overwritten by the owner while it was copied
+            if (slot.seq.load(std::memory_order_relaxed) != index + 1)
+                continue;
+            out.push_back(event);
+        }
+    }
+
+private:
+    struct Slot
+    {
+        std::atomic<quint64> seq { 0 };
+        std::atomic<char> phase { 0 };
+        std::atomic<int> tid { 0 };
+        std::atomic<const char *> category { nullptr };
+        std::atomic<const char *> name { nullptr };
+        std::atomic<qint64> timestampUs { 0 };
+        std::atomic<qint64> durationUs { 0 };
+        std::atomic<quint64> id { 0 };
+        std::atomic<qint64> value { 0 };
+    };
+
+    std::atomic<quint64> head_ { 0 };
+    Slot slots_[kEventsPerThread];
+};
+
+// The buffers are never freed, the buffer of a finished thread is reused by the next new thread.
+// The mutex is taken only when a thread records its first event and on export.
+class Buffers
+{
+public:
+    static Buffers &instance()
+    {
+        static Buffers buffers;
+        return buffers;
+    }
+
+    ThreadBuffer *acquire(int &tid)
+    {
+        QMutexLocker locker(&mutex_);
+        tid = ++lastTid_;
+        QThread *thread = QThread::currentThread();
+        if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+            threadNames_[tid] = "main";
+        else if (!thread->objectName().isEmpty())
+            threadNames_[tid] = thread->objectName();
+        else
+            threadNames_[tid] = QString("thread %1").arg(tid);
+
+        if (!free_.empty())
+        {
+            ThreadBuffer *buffer = free_.back();
+            free_.pop_back();
+            return buffer;
+        }
+        all_.emplace_back(new ThreadBuffer());
+        return all_.back().get();
+    }
+
+    void release(ThreadBuffer *buffer)
+    {
+        QMutexLocker locker(&mutex_);
+        free_.push_back(buffer);
+    }
+
+    void read(std::vector<Event> &events, QHash<int, QString> &threadNames)
+    {
+        QMutexLocker locker(&mutex_);
+        for (const auto &buffer : all_)
+            buffer->read(events);
+        threadNames = threadNames_;
+    }
+
+    const char *intern(const QString &name)
+    {
+        QMutexLocker locker(&mutex_);
+        auto it = interned_.find(name);
+        if (it == interned_.end())
+            it = interned_.insert(name, name.toUtf8());
+        return it.value().constData();
+    }
+
+private:
+    QMutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> all_;
+    std::vector<ThreadBuffer *> free_;
+    QHash<int, QString> threadNames_;
+    int lastTid_ = 0;
+    QHash<QString, QByteArray> interned_;
+};
+
+struct ThreadBufferHolder
+{
+    ThreadBufferHolder() { buffer = Buffers::instance().acquire(tid); }
+    ~ThreadBufferHolder() { Buffers::instance().release(buffer); }
+
+    ThreadBuffer *buffer;
+    int tid;
+};
+
+qint64 nowUs()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void record(char phase, const char *category, const char *name, qint64 timestampUs, qint64 durationUs, quint64 id, qint64 value)
+{
+    thread_local ThreadBufferHolder holder;
+    holder.buffer->add(Event { phase, holder.tid, category, name, timestampUs, durationUs, id, value });
+}
+
+} // namespace
+
+Span::Span(const char *category, const char *name, qint64 value) : category_(category), name_(name), value_(value), startUs_(nowUs())
+{
+}
+
+Span::~Span()
+{
+    record('X', category_, name_, startUs_, nowUs() - startUs_, 0, value_);
+}
+
+void asyncBegin(const char *category, const char *name, const void *id)
+{
+    record('b', category, name, nowUs(), 0, reinterpret_cast<quintptr>(id), -1);
+}
+
+void asyncEnd(const char *category, const char *name, const void *id)
+{
+    record('e', category, name, nowUs(), 0, reinterpret_cast<quintptr>(id), -1);
+}
+
+const char *internName(const QString &name)
+{
+    return Buffers::instance().intern(name);
+}
+
+QByteArray chromeTraceJson()
+{
+    std::vector<Event> events;
+    QHash<int, QString> threadNames;
+    Buffers::instance().read(events, threadNames);
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (auto it = threadNames.cbegin(); it != threadNames.cend(); ++it)
+    {
+        QJsonObject metadata;
+        metadata["ph"] = "M";
+        metadata["name"] = "thread_name";
+        metadata["pid"] = pid;
+        metadata["tid"] = it.key();
+        metadata["args"] = QJsonObject { { "name", it.value() } };
+        traceEvents.append(metadata);
+    }
+    for (const Event &event : events)
+    {
+        QJsonObject obj;
+        obj["ph"] = QString(QChar(event.phase));
+        obj["cat"] = event.category;
+        obj["name"] = event.name;
+        obj["pid"] = pid;
+        obj["tid"] = event.tid;
+        obj["ts"] = event.timestampUs;
+        if (event.phase == 'X')
+            obj["dur"] = event.durationUs;
+        else
+            obj["id"] = "0x" + QString::number(event.id, 16);
+        if (event.value >= 0)
+            obj["args"] = QJsonObject { { "value", event.value } };
+        traceEvents.append(obj);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+} // namespace tracing
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+// Lightweight tracing of the hot paths, exported in the Chrome trace event format (opens in Perfetto and chrome://tracing).
+// The events are recorded into a lock-free ring buffer of the current thread, so only the recent events of each thread are kept.
+// The macros below compile to nothing unless the project is built with WS_TRACING (the DEFINE_USE_TRACING_MACRO cmake option),
+// their arguments are not evaluated then.
+//
+//   WS_TRACE_SCOPE("engine", "Engine::connectClickImpl");           - a span of the current scope
+//   WS_TRACE_SCOPE_VALUE("helper", "Helper::runCommand", cmdId);    - the same with a number shown in the arguments of the span
+//   WS_TRACE_ASYNC_BEGIN("api", name, reply);                       - a span which ends in another function, the pointer identifies it
+//   WS_TRACE_ASYNC_END("api", name, reply);
+//
+// The category and the name must outlive the trace, use string literals or tracing::internName().
+namespace tracing {
+
+class Span
+{
+public:
+    Span(const char *category, const char *name, qint64 value = -1);
+    ~Span();
+
+private:
+    const char *category_;
+    const char *name_;
+    const qint64 value_;
+    const qint64 startUs_;
+
+    Q_DISABLE_COPY(Span)
+};
+
+void asyncBegin(const char *category, const char *name, const void *id);
+void asyncEnd(const char *category, const char *name, const void *id);
+
+// returns a copy of the string which lives until the process exits, for the names not known at compile time
+const char *internName(const QString &name);
+
+// all the events kept in the buffers as a JSON document in the Chrome trace event format
+QByteArray chromeTraceJson();
+
+} // namespace tracing
+
+#ifdef WS_TRACING
+    #define WS_TRACE_CONCAT_IMPL(a, b) a##b
+    #define WS_TRACE_CONCAT(a, b) WS_TRACE_CONCAT_IMPL(a, b)
+    #define WS_TRACE_SCOPE(category, name) tracing::Span WS_TRACE_CONCAT(wsTraceSpan, __LINE__)(category, name)
+    #define WS_TRACE_SCOPE_VALUE(category, name, value) tracing::Span WS_TRACE_CONCAT(wsTraceSpan, __LINE__)(category, name, value)
+    #define WS_TRACE_ASYNC_BEGIN(category, name, id) tracing::asyncBegin(category, name, id)
+    #define WS_TRACE_ASYNC_END(category, name, id) tracing::asyncEnd(category, name, id)
+#else
+    #define WS_TRACE_SCOPE(category, name) do {} while (false)
+    #define WS_TRACE_SCOPE_VALUE(category, name, value) do {} while (false)
+    #define WS_TRACE_ASYNC_BEGIN(category, name, id) do {} while (false)
+    #define WS_TRACE_ASYNC_END(category, name, id) do {} while (false)
+#endif
@@ -1,6 +1,8 @@
 #include "apiinfo.h"
 
+#include <QElapsedTimer>
 #include <QSettings>
+#include <QStandardPaths>
 
 #include "utils/ws_assert.h"
 #include "utils/logger.h"
@@ -33,12 +35,14 @@ void ApiInfo::setSessionStatus(const types::SessionStatus &value)
 void ApiInfo::setLocations(const QVector<apiinfo::Location> &value)
 {
     isLocationsInit_ = true;
+    snapshot_.reset();
     locations_ = value;
     mergeWindflixLocations();
 }
 
 QVector<apiinfo::Location> ApiInfo::getLocations() const
 {
+    loadLocationsIfNeed();
     return locations_;
 }
 
@@ -142,15 +146,35 @@ StaticIps ApiInfo::getStaticIps() const
 
 void ApiInfo::saveToSettings()
 {
-    QByteArray arr;
-    {
+    // the snapshot file must be unmapped before it can be replaced
+    loadLocationsIfNeed();
+    snapshot_.reset();
+
+    auto serialize = [](const auto &value) {
+        QByteArray arr;
         QDataStream ds(&arr, QIODevice::WriteOnly);
-        ds << magic_;
-        ds << versionForSerialization_;
-        ds << sessionStatus_ << locations_ << serverCredentials_ << ovpnConfig_ << portMap_ << staticIps_;
-    }
+        ds << value;
+        return arr;
+    };
+
+    QMap<SnapshotFile::Section, QByteArray> sections;
+    sections[SnapshotFile::kSessionStatus] = serialize(sessionStatus_);
+    sections[SnapshotFile::kLocations] = serialize(locations_);
+    sections[SnapshotFile::kServerCredentials] = serialize(serverCredentials_);
+    sections[SnapshotFile::kOvpnConfig] = serialize(ovpnConfig_);
+    sections[SnapshotFile::kPortMap] = serialize(portMap_);
+    sections[SnapshotFile::kStaticIps] = serialize(staticIps_);
+
     QSettings settings;
-    settings.setValue("apiInfo", simpleCrypt_.encryptToString(arr));
+    if (SnapshotFile::write(snapshotPath(), sections))
+    {
+        settings.remove("apiInfo");
+    }
+    else
+    {
+        qCDebug(LOG_BASIC) << "ApiInfo::saveToSettings, can't write the snapshot file";
+    }
+
     if (!sessionStatus_.getRevisionHash().isEmpty())
     {
         settings.setValue("revisionHash", sessionStatus_.getRevisionHash());
@@ -168,6 +192,7 @@ void ApiInfo::removeFromSettings()
         settings.remove("apiInfo");
         settings.remove("authHash");
     }
+    QFile::remove(snapshotPath());
     // remove from first version too
     {
         QSettings settings1("Windscribe", "Windscribe");
@@ -178,12 +203,92 @@ void ApiInfo::removeFromSettings()
 
 bool ApiInfo::isEverythingInit() const
 {
+    // the locations of the snapshot count only if they can be decoded
+    loadLocationsIfNeed();
     return isSessionStatusInit_ && isLocationsInit_ && isForceDisconnectInit_  &&
            isOvpnConfigInit_ && isPortMapInit_ && isStaticIpsInit_ && serverCredentials_.isInitialized();
 }
 
 bool ApiInfo::loadFromSettings()
 {
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    QSharedPointer<SnapshotFile> snapshot(new SnapshotFile(snapshotPath()));
+    if (!snapshot->open())
+    {
+        // not saved yet in the snapshot format
+        return loadFromLegacySettings();
+    }
+
+    // everything except the locations is small and needed right away
+    auto deserialize = [&snapshot](SnapshotFile::Section section, auto &value) {
+        QByteArray arr;
+        if (!snapshot->read(section, arr))
+            return false;
+        QDataStream ds(&arr, QIODevice::ReadOnly);
+        ds >> value;
+        return ds.status() == QDataStream::Ok;
+    };
+
+    if (!snapshot->contains(SnapshotFile::kLocations) ||
+        !deserialize(SnapshotFile::kSessionStatus, sessionStatus_) ||
+        !deserialize(SnapshotFile::kServerCredentials, serverCredentials_) ||
+        !deserialize(SnapshotFile::kOvpnConfig, ovpnConfig_) ||
+        !deserialize(SnapshotFile::kPortMap, portMap_) ||
+        !deserialize(SnapshotFile::kStaticIps, staticIps_))
+    {
+        return false;
+    }
+
+    QSettings settings;
+    locations_.clear();
+    snapshot_ = snapshot;
+    forceDisconnectNodes_.clear();
+    sessionStatus_.setRevisionHash(settings.value("revisionHash", "").toString());
+    isSessionStatusInit_ = true;
+    isLocationsInit_ = true;
+    isForceDisconnectInit_ = true;
+    isOvpnConfigInit_ = true;
+    isPortMapInit_ = true;
+    isStaticIpsInit_ = true;
+    checkPortMapForUnavailableProtocolAndFix();
+    qCDebug(LOG_BASIC) << "ApiInfo::loadFromSettings, loaded in" << elapsedTimer.elapsed() << "ms";
+    return true;
+}
+
+void ApiInfo::loadLocationsIfNeed() const
+{
+    if (!snapshot_)
+        return;
+
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
+    bool isCorrupt = true;
+    QByteArray arr;
+    if (snapshot_->read(SnapshotFile::kLocations, arr))
+    {
+        QDataStream ds(&arr, QIODevice::ReadOnly);
+        ds >> locations_;
+        isCorrupt = ds.status() != QDataStream::Ok;
+    }
+    if (isCorrupt)
+    {
+        // not init until the server list is fetched again, so the empty list doesn't replace the section in the snapshot
+        qCDebug(LOG_BASIC) << "ApiInfo::loadLocationsIfNeed, the locations section of the snapshot is corrupt";
+        locations_.clear();
+        isLocationsInit_ = false;
+    }
+    snapshot_.reset();
+    qCDebug(LOG_BASIC) << "ApiInfo::loadLocationsIfNeed, loaded in" << elapsedTimer.elapsed() << "ms";
+}
+
+bool ApiInfo::loadFromLegacySettings()
+{
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+
     QSettings settings;
     QString s = settings.value("apiInfo", "").toString();
     if (!s.isEmpty())
@@ -214,12 +319,18 @@ bool ApiInfo::loadFromSettings()
             isPortMapInit_ = true;
             isStaticIpsInit_ = true;
             checkPortMapForUnavailableProtocolAndFix();
+            qCDebug(LOG_BASIC) << "ApiInfo::loadFromLegacySettings, loaded in" << elapsedTimer.elapsed() << "ms";
             return true;
         }
     }
     return false;
 }
 
+QString ApiInfo::snapshotPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/apiinfo.bin";
+}
+
 void ApiInfo::mergeWindflixLocations()
 {
     // Build a new list of server locations to merge, removing them from the old list.
@@ -5,10 +5,12 @@
 #include <QVector>
 #include <QSet>
 #include <QMap>
+#include <QSharedPointer>
 #include "types/portmap.h"
 #include "servercredentials.h"
 #include "utils/simplecrypt.h"
 #include "location.h"
+#include "snapshotfile.h"
 #include "staticips.h"
 #include "types/sessionstatus.h"
 
@@ -16,6 +18,7 @@ namespace apiinfo {
 
 // Contains data from the Server API that is minimally necessary for the program to switch from the Login screen to Connect Screen
 // It can also read and save all data in settings.
+// The data is stored in a SnapshotFile. The locations section is the largest one, it is decoded only when first requested.
 class ApiInfo
 {
 public:
@@ -63,12 +66,15 @@ public:
 
 private:
     void mergeWindflixLocations();
+    void loadLocationsIfNeed() const;
+    bool loadFromLegacySettings();
+    static QString snapshotPath();
 
     // remove all not supported protocols on this OS from portMap_
     void checkPortMapForUnavailableProtocolAndFix();
 
     types::SessionStatus sessionStatus_;
-    QVector<Location> locations_;
+    mutable QVector<Location> locations_;
     QStringList forceDisconnectNodes_;
     ServerCredentials serverCredentials_;
     QString ovpnConfig_;
@@ -76,15 +82,19 @@ private:
     StaticIps staticIps_;
 
     bool isSessionStatusInit_ = false;
-    bool isLocationsInit_ = false;
+    // reset when the locations section of the snapshot turns out to be corrupt, so they are not saved until fetched again
+    mutable bool isLocationsInit_ = false;
     bool isForceDisconnectInit_ = false;
     bool isOvpnConfigInit_ = false;
     bool isPortMapInit_ = false;
     bool isStaticIpsInit_ = false;
 
+    // the snapshot stays mapped until the locations are decoded
+    mutable QSharedPointer<SnapshotFile> snapshot_;
+
     SimpleCrypt simpleCrypt_;
 
-    // for serialization
+    // for serialization to QSettings (before the SnapshotFile), only for loading
     static constexpr quint32 magic_ = 0x7605A2AE;
     static constexpr quint32 versionForSerialization_ = 1;  // should increment the version if the data format is changed
 };
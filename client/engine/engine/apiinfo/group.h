@@ -81,6 +81,7 @@ public:
 
     friend QDataStream& operator <<(QDataStream& stream, const Group& g);
     friend QDataStream& operator >>(QDataStream& stream, Group& g);
+    friend class ServerListParser;
 
 
 private:
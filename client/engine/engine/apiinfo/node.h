@@ -40,6 +40,7 @@ public:
 
     friend QDataStream& operator <<(QDataStream &stream, const Node &n);
     friend QDataStream& operator >>(QDataStream &stream, Node &n);
+    friend class ServerListParser;
 
 private:
     QSharedDataPointer<NodeData> d;
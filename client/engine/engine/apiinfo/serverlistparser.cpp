@@ -0,0 +1,381 @@
+#include "serverlistparser.h"
+
+#include <limits>
+#include "utils/logger.h"
+
+namespace apiinfo {
+
+namespace {
+
+constexpr quint32 bit(int key) { return 1u << key; }
+
+} // namespace
+
+ServerListParser::ServerListParser() : reader_(this), key_(kUnknownKey), isObject_(false), hasInfo_(false), hasData_(false),
+    isChanged_(false), revision_(0), hasCountryOverride_(false), dataIndex_(0), locationFields_(0), isLocationValid_(false),
+    groupFields_(0), isGroupValid_(false), nodeFields_(0)
+{
+}
+
+bool ServerListParser::addData(const QByteArray &data)
+{
+    return reader_.addData(data);
+}
+
+bool ServerListParser::finish()
+{
+    return reader_.finish();
+}
+
+void ServerListParser::startObject()
+{
+    stack_ << startContainer(true);
+}
+
+void ServerListParser::endObject()
+{
+    endContainer();
+}
+
+void ServerListParser::startArray()
+{
+    stack_ << startContainer(false);
+}
+
+void ServerListParser::endArray()
+{
+    endContainer();
+}
+
+void ServerListParser::key(const QByteArray &utf8)
+{
+    key_ = keyFromString(utf8);
+}
+
+void ServerListParser::stringValue(const QByteArray &utf8)
+{
+    handleValue(Value { Value::kString, &utf8, 0 });
+}
+
+void ServerListParser::numberValue(double value)
+{
+    handleValue(Value { Value::kNumber, nullptr, value });
+}
+
+void ServerListParser::boolValue(bool value)
+{
+    Q_UNUSED(value);
+    handleValue(Value { Value::kBool, nullptr, 0 });
+}
+
+void ServerListParser::nullValue()
+{
+    handleValue(Value { Value::kNull, nullptr, 0 });
+}
+
+ServerListParser::Context ServerListParser::startContainer(bool isObject)
+{
+    if (stack_.isEmpty()) {
+        isObject_ = isObject;
+        return isObject ? Context::kRoot : Context::kSkip;
+    }
+
+    const Value undefined { Value::kUndefined, nullptr, 0 };
+    switch (stack_.last()) {
+        case Context::kRoot:
+            handleValue(undefined);
+            if (key_ == kInfoKey && isObject)
+                return Context::kInfo;
+            if (key_ == kDataKey && !isObject)
+                return Context::kData;
+            return Context::kSkip;
+        case Context::kData:
+            if (isObject) {
+                beginLocation();
+                return Context::kLocation;
+            }
+            handleValue(undefined);
+            return Context::kSkip;
+        case Context::kLocation:
+            handleValue(undefined);
+            return (key_ == kGroups && !isObject) ? Context::kGroups : Context::kSkip;
+        case Context::kGroups:
+            if (isObject) {
+                beginGroup();
+                return Context::kGroup;
+            }
+            handleValue(undefined);
+            return Context::kSkip;
+        case Context::kGroup:
+            handleValue(undefined);
+            return (key_ == kNodes && !isObject) ? Context::kNodes : Context::kSkip;
+        case Context::kNodes:
+            if (isObject) {
+                beginNode();
+                return Context::kNode;
+            }
+            handleValue(undefined);
+            return Context::kSkip;
+        case Context::kInfo:
+        case Context::kNode:
+            handleValue(undefined);
+            return Context::kSkip;
+        case Context::kSkip:
+            return Context::kSkip;
+    }
+    return Context::kSkip;
+}
+
+void ServerListParser::endContainer()
+{
+    switch (stack_.takeLast()) {
+        case Context::kLocation:
+            endLocation();
+            break;
+        case Context::kGroup:
+            endGroup();
+            break;
+        case Context::kNode:
+            endNode();
+            break;
+        default:
+            break;
+    }
+}
+
+void ServerListParser::handleValue(const Value &value)
+{
+    if (stack_.isEmpty())
+        return;
+
+    switch (stack_.last()) {
+        case Context::kRoot:
+            if (key_ == kInfoKey)
+                hasInfo_ = true;
+            else if (key_ == kDataKey)
+                hasData_ = true;
+            break;
+
+        case Context::kInfo:
+            if (key_ == kChanged)
+                isChanged_ = toInt(value, 0) != 0;
+            else if (key_ == kRevision)
+                revision_ = toInt(value, 0);
+            else if (key_ == kRevisionHash)
+                revisionHash_ = toString(value);
+            else if (key_ == kCountryOverride) {
+                hasCountryOverride_ = true;
+                countryOverride_ = toString(value);
+            }
+            break;
+
+        case Context::kData:
+            qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping non-object 'data' element at index" << dataIndex_;
+            dataIndex_++;
+            break;
+
+        case Context::kLocation:
+            locationFields_ |= bit(key_);
+            switch (key_) {
+                case kId: location_.d->id_ = toInt(value, 0); break;
+                case kName: location_.d->name_ = toString(value); break;
+                case kCountryCode: location_.d->countryCode_ = toString(value); break;
+                case kPremiumOnly: location_.d->premiumOnly_ = toInt(value, 0); break;
+                case kP2P: location_.d->p2p_ = toInt(value, 0); break;
+                case kDnsHostName: location_.d->dnsHostName_ = toString(value); break;
+                default: break;
+            }
+            break;
+
+        case Context::kGroups:
+            // not an object is an invalid group
+            isLocationValid_ = false;
+            break;
+
+        case Context::kGroup:
+            groupFields_ |= bit(key_);
+            switch (key_) {
+                case kId: group_.d->id_ = toInt(value, 0); break;
+                case kCity: group_.d->city_ = toString(value); break;
+                case kNick: group_.d->nick_ = toString(value); break;
+                case kPro: group_.d->pro_ = toInt(value, 0); break;
+                case kPingIp: group_.d->pingIp_ = toString(value); break;
+                case kPingHost: group_.d->pingHost_ = toString(value); break;
+                case kWgPubKey: group_.d->wg_pubkey_ = toString(value); break;
+                case kOvpnX509: group_.d->ovpn_x509_ = toString(value); break;
+                case kLinkSpeed:
+                {
+                    // the link speed comes as a string
+                    bool bConverted = false;
+                    if (value.type == Value::kString)
+                        group_.d->link_speed_ = value.str->toInt(&bConverted);
+                    if (!bConverted)
+                        group_.d->link_speed_ = 100;
+                    break;
+                }
+                case kHealth:
+                    group_.d->health_ = toInt(value, -1);
+                    if ((group_.d->health_ < 0) || (group_.d->health_ > 100))
+                        group_.d->health_ = -1;
+                    break;
+                default: break;
+            }
+            break;
+
+        case Context::kNodes:
+            // not an object is an invalid node
+            isGroupValid_ = false;
+            break;
+
+        case Context::kNode:
+            nodeFields_ |= bit(key_);
+            switch (key_) {
+                case kIp: nodeIps_[0] = toString(value); break;
+                case kIp2: nodeIps_[1] = toString(value); break;
+                case kIp3: nodeIps_[2] = toString(value); break;
+                case kHostname: node_.d->hostname_ = toString(value); break;
+                case kWeight: node_.d->weight_ = toInt(value, 0); break;
+                case kForceDisconnect: node_.d->forceDisconnect_ = toInt(value, 0); break;
+                default: break;
+            }
+            break;
+
+        case Context::kSkip:
+            break;
+    }
+}
+
+void ServerListParser::beginLocation()
+{
+    location_ = Location();
+    locationFields_ = 0;
+    isLocationValid_ = true;
+    locationForceDisconnectNodes_.clear();
+}
+
+void ServerListParser::endLocation()
+{
+    const quint32 kRequired = bit(kId) | bit(kName) | bit(kCountryCode) | bit(kPremiumOnly) | bit(kP2P) | bit(kGroups);
+    const bool hasRequiredFields = (locationFields_ & kRequired) == kRequired;
+
+    // the same as Location::initFromJson, which reads the groups only if the required fields are present
+    if (hasRequiredFields)
+        forceDisconnectNodes_ << locationForceDisconnectNodes_;
+
+    if (hasRequiredFields && isLocationValid_) {
+        location_.d->isValid_ = true;
+        locations_ << location_;
+    } else {
+        qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping invalid/incomplete 'data' element at index" << dataIndex_
+                                << "(id =" << ((locationFields_ & bit(kId)) ? QString::number(location_.d->id_) : QString("none")) << ")";
+    }
+    location_ = Location();
+    dataIndex_++;
+}
+
+void ServerListParser::beginGroup()
+{
+    group_ = Group();
+    groupFields_ = 0;
+    isGroupValid_ = true;
+    groupForceDisconnectNodes_.clear();
+}
+
+void ServerListParser::endGroup()
+{
+    // Location::initFromJson stops on the first invalid group
+    if (!isLocationValid_)
+        return;
+
+    const quint32 kRequired = bit(kId) | bit(kCity) | bit(kNick) | bit(kPro) | bit(kPingIp) | bit(kWgPubKey);
+    if ((groupFields_ & kRequired) != kRequired) {
+        isLocationValid_ = false;
+        return;
+    }
+
+    locationForceDisconnectNodes_ << groupForceDisconnectNodes_;
+    if (!isGroupValid_) {
+        isLocationValid_ = false;
+        return;
+    }
+
+    if (!(groupFields_ & bit(kHealth)))
+        group_.d->health_ = -1;
+    group_.d->isValid_ = true;
+    location_.d->groups_ << group_;
+    group_ = Group();
+}
+
+void ServerListParser::beginNode()
+{
+    node_ = Node();
+    nodeFields_ = 0;
+    for (QString &ip : nodeIps_)
+        ip.clear();
+}
+
+void ServerListParser::endNode()
+{
+    // Group::initFromJson stops on the first invalid node
+    if (!isGroupValid_)
+        return;
+
+    const quint32 kRequired = bit(kIp) | bit(kIp2) | bit(kIp3) | bit(kHostname) | bit(kWeight);
+    if ((nodeFields_ & kRequired) != kRequired) {
+        isGroupValid_ = false;
+        return;
+    }
+
+    node_.d->ips_ = { nodeIps_[0], nodeIps_[1], nodeIps_[2] };
+    node_.d->isValid_ = true;
+
+    // not add node with flag force_diconnect, but add it to another list
+    if (node_.isForceDisconnect())
+        groupForceDisconnectNodes_ << node_.getHostname();
+    else
+        group_.d->nodes_ << node_;
+    node_ = Node();
+}
+
+QString ServerListParser::toString(const Value &value)
+{
+    if (value.type != Value::kString)
+        return QString();
+
+    auto it = strings_.constFind(*value.str);
+    if (it != strings_.constEnd())
+        return it.value();
+
+    const QString str = QString::fromUtf8(*value.str);
+    // deep copy of the key, so that the reader's buffer stays not shared
+    strings_.insert(QByteArray(value.str->constData(), value.str->size()), str);
+    return str;
+}
+
+int ServerListParser::toInt(const Value &value, int defaultValue)
+{
+    // the same as QJsonValue::toInt()
+    if (value.type != Value::kNumber)
+        return defaultValue;
+    const double d = value.number;
+    if (d >= std::numeric_limits<int>::min() && d <= std::numeric_limits<int>::max() && int(d) == d)
+        return int(d);
+    return defaultValue;
+}
+
+ServerListParser::Key ServerListParser::keyFromString(const QByteArray &utf8)
+{
+    static const QHash<QByteArray, Key> keys = {
+        { "info", kInfoKey }, { "data", kDataKey }, { "changed", kChanged }, { "revision", kRevision },
+        { "revision_hash", kRevisionHash }, { "country_override", kCountryOverride },
+        { "id", kId }, { "name", kName }, { "country_code", kCountryCode }, { "premium_only", kPremiumOnly },
+        { "p2p", kP2P }, { "dns_hostname", kDnsHostName }, { "groups", kGroups },
+        { "city", kCity }, { "nick", kNick }, { "pro", kPro }, { "ping_ip", kPingIp }, { "ping_host", kPingHost },
+        { "wg_pubkey", kWgPubKey }, { "ovpn_x509", kOvpnX509 }, { "link_speed", kLinkSpeed }, { "health", kHealth },
+        { "nodes", kNodes }, { "ip", kIp }, { "ip2", kIp2 }, { "ip3", kIp3 }, { "hostname", kHostname },
+        { "weight", kWeight }, { "force_disconnect", kForceDisconnect }
+    };
+    return keys.value(utf8, kUnknownKey);
+}
+
+} //namespace apiinfo
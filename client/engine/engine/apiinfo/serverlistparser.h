@@ -0,0 +1,110 @@
+#pragma once
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+#include "location.h"
+#include "engine/utils/jsonstreamreader.h"
+
+namespace apiinfo {
+
+// Builds the locations directly from the serverlist response, without a QJsonDocument. The data can be added in chunks as it is
+// received from the network. The result is the same as Location::initFromJson() gives for every element of the "data" array.
+// Repeated string values (country codes, cities, hostnames, keys, ...) are interned, so the equal values share one QString.
+class ServerListParser : private JsonStreamReader::Handler
+{
+public:
+    ServerListParser();
+
+    bool addData(const QByteArray &data);
+    // returns false if the response is not a correct JSON
+    bool finish();
+    QString errorString() const { return reader_.errorString(); }
+
+    // the values below are valid after finish()
+    bool isObject() const { return isObject_; }
+    bool hasInfo() const { return hasInfo_; }
+    bool hasData() const { return hasData_; }
+
+    bool isChanged() const { return isChanged_; }
+    int revision() const { return revision_; }
+    QString revisionHash() const { return revisionHash_; }
+    bool hasCountryOverride() const { return hasCountryOverride_; }
+    QString countryOverride() const { return countryOverride_; }
+
+    QVector<Location> locations() const { return locations_; }
+    QStringList forceDisconnectNodes() const { return forceDisconnectNodes_; }
+
+private:
+    enum class Context { kRoot, kInfo, kData, kLocation, kGroups, kGroup, kNodes, kNode, kSkip };
+    enum Key { kUnknownKey, kInfoKey, kDataKey, kChanged, kRevision, kRevisionHash, kCountryOverride,
+               kId, kName, kCountryCode, kPremiumOnly, kP2P, kDnsHostName, kGroups,
+               kCity, kNick, kPro, kPingIp, kPingHost, kWgPubKey, kOvpnX509, kLinkSpeed, kHealth, kNodes,
+               kIp, kIp2, kIp3, kHostname, kWeight, kForceDisconnect };
+
+    // JSON value in the terms of QJsonValue, a container is passed as kUndefined
+    struct Value
+    {
+        enum Type { kString, kNumber, kBool, kNull, kUndefined };
+        Type type;
+        const QByteArray *str;
+        double number;
+    };
+
+    JsonStreamReader reader_;
+    QVector<Context> stack_;
+    Key key_;
+    QHash<QByteArray, QString> strings_;
+
+    bool isObject_;
+    bool hasInfo_;
+    bool hasData_;
+    bool isChanged_;
+    int revision_;
+    QString revisionHash_;
+    bool hasCountryOverride_;
+    QString countryOverride_;
+    QVector<Location> locations_;
+    QStringList forceDisconnectNodes_;
+
+    // the element being parsed, the fields masks are bitmasks of Key
+    int dataIndex_;
+    Location location_;
+    quint32 locationFields_;
+    bool isLocationValid_;
+    QStringList locationForceDisconnectNodes_;
+    Group group_;
+    quint32 groupFields_;
+    bool isGroupValid_;
+    QStringList groupForceDisconnectNodes_;
+    Node node_;
+    quint32 nodeFields_;
+    QString nodeIps_[3];
+
+    void startObject() override;
+    void endObject() override;
+    void startArray() override;
+    void endArray() override;
+    void key(const QByteArray &utf8) override;
+    void stringValue(const QByteArray &utf8) override;
+    void numberValue(double value) override;
+    void boolValue(bool value) override;
+    void nullValue() override;
+
+    Context startContainer(bool isObject);
+    void endContainer();
+    void handleValue(const Value &value);
+
+    void beginLocation();
+    void endLocation();
+    void beginGroup();
+    void endGroup();
+    void beginNode();
+    void endNode();
+
+    QString toString(const Value &value);
+    static int toInt(const Value &value, int defaultValue);
+    static Key keyFromString(const QByteArray &utf8);
+};
+
+} //namespace apiinfo
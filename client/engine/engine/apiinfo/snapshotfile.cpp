@@ -0,0 +1,220 @@
+#include "snapshotfile.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#include "types/global_consts.h"
+#include "utils/logger.h"
+
+namespace apiinfo {
+
+SnapshotFile::SnapshotFile(const QString &path) : file_(path), data_(nullptr), size_(0)
+{
+}
+
+SnapshotFile::~SnapshotFile()
+{
+    close();
+}
+
+bool SnapshotFile::open()
+{
+    close();
+    if (!file_.open(QIODevice::ReadOnly))
+        return false;
+
+    size_ = file_.size();
+    if (size_ < kHeaderSize) {
+        close();
+        return false;
+    }
+    data_ = file_.map(0, size_);
+    if (!data_) {
+        qCDebug(LOG_BASIC) << "SnapshotFile::open, can't map the file" << file_.fileName();
+        close();
+        return false;
+    }
+
+    if (qFromLittleEndian<quint32>(data_) != kMagic || qFromLittleEndian<quint32>(data_ + 4) > kVersion) {
+        close();
+        return false;
+    }
+
+    const quint32 sectionsCount = qFromLittleEndian<quint32>(data_ + 8);
+    if ((quint64)kHeaderSize + (quint64)sectionsCount * kSectionEntrySize > (quint64)size_) {
+        close();
+        return false;
+    }
+
+    for (quint32 i = 0; i < sectionsCount; ++i) {
+        const uchar *p = data_ + kHeaderSize + i * kSectionEntrySize;
+        const quint32 id = qFromLittleEndian<quint32>(p);
+        const SectionEntry entry { qFromLittleEndian<quint64>(p + 4), qFromLittleEndian<quint64>(p + 12) };
+        if (entry.offset > (quint64)size_ || entry.size > (quint64)size_ - entry.offset || entry.size < kNonceSize + kTagSize) {
+            close();
+            return false;
+        }
+        sections_[id] = entry;
+    }
+    return true;
+}
+
+void SnapshotFile::close()
+{
+    if (data_) {
+        file_.unmap(const_cast<uchar *>(data_));
+        data_ = nullptr;
+    }
+    file_.close();
+    size_ = 0;
+    sections_.clear();
+}
+
+bool SnapshotFile::contains(Section section) const
+{
+    return sections_.contains(section);
+}
+
+bool SnapshotFile::read(Section section, QByteArray &outData) const
+{
+    auto it = sections_.constFind(section);
+    if (it == sections_.constEnd())
+        return false;
+
+    if (!decrypt(section, data_ + it->offset, it->size, outData)) {
+        qCDebug(LOG_BASIC) << "SnapshotFile::read, section" << (int)section << "failed the authentication";
+        return false;
+    }
+    return true;
+}
+
+bool SnapshotFile::write(const QString &path, const QMap<Section, QByteArray> &sections)
+{
+    QVector<QByteArray> encryptedSections;
+    for (auto it = sections.constBegin(); it != sections.constEnd(); ++it) {
+        QByteArray encrypted;
+        if (!encrypt(it.key(), it.value(), encrypted))
+            return false;
+        encryptedSections << encrypted;
+    }
+
+    QByteArray arr(kHeaderSize + sections.size() * kSectionEntrySize, Qt::Uninitialized);
+    uchar *p = reinterpret_cast<uchar *>(arr.data());
+    qToLittleEndian<quint32>(kMagic, p);
+    qToLittleEndian<quint32>(kVersion, p + 4);
+    qToLittleEndian<quint32>(sections.size(), p + 8);
+
+    quint64 offset = arr.size();
+    int ind = 0;
+    for (auto it = sections.constBegin(); it != sections.constEnd(); ++it, ++ind) {
+        uchar *entry = p + kHeaderSize + ind * kSectionEntrySize;
+        qToLittleEndian<quint32>(it.key(), entry);
+        qToLittleEndian<quint64>(offset, entry + 4);
+        qToLittleEndian<quint64>(encryptedSections[ind].size(), entry + 12);
+        offset += encryptedSections[ind].size();
+    }
+    for (const QByteArray &encrypted : qAsConst(encryptedSections))
+        arr.append(encrypted);
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(LOG_BASIC) << "SnapshotFile::write, can't open the file" << path << file.errorString();
+        return false;
+    }
+    if (file.write(arr) != arr.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+QByteArray SnapshotFile::key()
+{
+    // The key is derived from the same built-in constant SimpleCrypt used for the QSettings storage,
+    // so the confidentiality is unchanged, but the data is now authenticated.
+    QByteArray seed("windscribe-apiinfo-snapshot");
+    quint64 k = SIMPLE_CRYPT_KEY;
+    seed.append(reinterpret_cast<const char *>(&k), sizeof(k));
+    return QCryptographicHash::hash(seed, QCryptographicHash::Sha256);
+}
+
+QByteArray SnapshotFile::associatedData(quint32 sectionId)
+{
+    QByteArray arr(12, Qt::Uninitialized);
+    uchar *p = reinterpret_cast<uchar *>(arr.data());
+    qToLittleEndian<quint32>(kMagic, p);
+    qToLittleEndian<quint32>(kVersion, p + 4);
+    qToLittleEndian<quint32>(sectionId, p + 8);
+    return arr;
+}
+
+bool SnapshotFile::encrypt(quint32 sectionId, const QByteArray &plain, QByteArray &outEncrypted)
+{
+    const QByteArray k = key();
+    const QByteArray aad = associatedData(sectionId);
+
+    outEncrypted.resize(kNonceSize + plain.size() + kTagSize);
+    uchar *nonce = reinterpret_cast<uchar *>(outEncrypted.data());
+    uchar *cipher = nonce + kNonceSize;
+    if (RAND_bytes(nonce, kNonceSize) != 1)
+        return false;
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (!ctx)
+        return false;
+
+    int len = 0;
+    int cipherLen = 0;
+    bool ok = EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, kNonceSize, nullptr) == 1 &&
+              EVP_EncryptInit_ex(ctx, nullptr, nullptr, reinterpret_cast<const uchar *>(k.constData()), nonce) == 1 &&
+              EVP_EncryptUpdate(ctx, nullptr, &len, reinterpret_cast<const uchar *>(aad.constData()), aad.size()) == 1 &&
+              EVP_EncryptUpdate(ctx, cipher, &len, reinterpret_cast<const uchar *>(plain.constData()), plain.size()) == 1;
+    if (ok) {
+        cipherLen = len;
+        ok = EVP_EncryptFinal_ex(ctx, cipher + cipherLen, &len) == 1;
+        cipherLen += len;
+    }
+    if (ok)
+        ok = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, kTagSize, cipher + cipherLen) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    return ok;
+}
+
+bool SnapshotFile::decrypt(quint32 sectionId, const uchar *encrypted, qint64 size, QByteArray &outPlain)
+{
+    const QByteArray k = key();
+    const QByteArray aad = associatedData(sectionId);
+
+    const uchar *nonce = encrypted;
+    const uchar *cipher = encrypted + kNonceSize;
+    const int cipherSize = size - kNonceSize - kTagSize;
+    // the tag is passed through a copy, since EVP_CIPHER_CTX_ctrl takes a non-const pointer
+    QByteArray tag(reinterpret_cast<const char *>(cipher + cipherSize), kTagSize);
+
+    EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+    if (!ctx)
+        return false;
+
+    outPlain.resize(cipherSize);
+    int len = 0;
+    bool ok = EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, nullptr, nullptr) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, kNonceSize, nullptr) == 1 &&
+              EVP_DecryptInit_ex(ctx, nullptr, nullptr, reinterpret_cast<const uchar *>(k.constData()), nonce) == 1 &&
+              EVP_DecryptUpdate(ctx, nullptr, &len, reinterpret_cast<const uchar *>(aad.constData()), aad.size()) == 1 &&
+              EVP_DecryptUpdate(ctx, reinterpret_cast<uchar *>(outPlain.data()), &len, cipher, cipherSize) == 1 &&
+              EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, kTagSize, tag.data()) == 1 &&
+              EVP_DecryptFinal_ex(ctx, reinterpret_cast<uchar *>(outPlain.data()) + len, &len) == 1;
+    EVP_CIPHER_CTX_free(ctx);
+    if (!ok)
+        outPlain.clear();
+    return ok;
+}
+
+} //namespace apiinfo
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QMap>
+
+namespace apiinfo {
+
+// Versioned binary file of independently encrypted sections, used to persist ApiInfo instead of QSettings.
+// Each section is encrypted and authenticated with AES-256-GCM, the magic, version and section id are the associated data.
+// The file is memory mapped and a section is decrypted only when requested, so data not needed at startup is not touched.
+//
+// Layout (little endian):
+//   magic(4) version(4) sectionsCount(4)
+//   sectionsCount * { id(4) offset(8) size(8) }
+//   sections: nonce(12) ciphertext tag(16)
+class SnapshotFile
+{
+public:
+    enum Section { kSessionStatus = 1, kLocations, kServerCredentials, kOvpnConfig, kPortMap, kStaticIps };
+
+    explicit SnapshotFile(const QString &path);
+    ~SnapshotFile();
+
+    // maps the file and validates the header, returns false if the file does not exist or is corrupted
+    bool open();
+    void close();
+    bool contains(Section section) const;
+    // decrypts the section, returns false if the section is missing or fails the authentication
+    bool read(Section section, QByteArray &outData) const;
+
+    // writes the file atomically (through a temporary file and rename)
+    static bool write(const QString &path, const QMap<Section, QByteArray> &sections);
+
+private:
+    struct SectionEntry
+    {
+        quint64 offset;
+        quint64 size;
+    };
+
+    static constexpr quint32 kMagic = 0x7605A2AF;
+    static constexpr quint32 kVersion = 1;      // should increment the version if the data format is changed
+    static constexpr int kNonceSize = 12;
+    static constexpr int kTagSize = 16;
+    static constexpr int kHeaderSize = 12;
+    static constexpr int kSectionEntrySize = 20;
+
+    QFile file_;
+    const uchar *data_;
+    qint64 size_;
+    QHash<quint32, SectionEntry> sections_;
+
+    static QByteArray key();
+    static QByteArray associatedData(quint32 sectionId);
+    static bool encrypt(quint32 sectionId, const QByteArray &plain, QByteArray &outEncrypted);
+    static bool decrypt(quint32 sectionId, const uchar *encrypted, qint64 size, QByteArray &outPlain);
+};
+
+} //namespace apiinfo
@@ -19,8 +19,8 @@ ApiResourcesManager::ApiResourcesManager(QObject *parent, server_api::ServerAPI
     connect(waitForNetworkConnectivity_, &WaitForNetworkConnectivity::connectivityOnline, this, &ApiResourcesManager::onConnectivityOnline);
     connect(waitForNetworkConnectivity_, &WaitForNetworkConnectivity::timeoutExpired, this, &ApiResourcesManager::onConnectivityTimeoutExpired);
 
-    fetchTimer_ = new QTimer(this);
-    connect(fetchTimer_, &QTimer::timeout, this, &ApiResourcesManager::onFetchTimer);
+    fetchTimer_ = new WheelTimer(this);
+    connect(fetchTimer_, &WheelTimer::timeout, this, &ApiResourcesManager::onFetchTimer);
 }
 
 ApiResourcesManager::~ApiResourcesManager()
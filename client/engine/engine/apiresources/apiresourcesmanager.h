@@ -5,6 +5,7 @@
 #include "engine/connectstatecontroller/iconnectstatecontroller.h"
 #include "engine/serverapi/requests/sessionerrorcode.h"
 #include "engine/networkdetectionmanager/waitfornetworkconnectivity.h"
+#include "engine/utils/timerwheel.h"
 #include "types/notification.h"
 
 namespace api_resources {
@@ -90,7 +91,7 @@ private:
 
     QHash<RequestType, qint64> lastUpdateTimeMs_;
     QHash<RequestType, QPointer<server_api::BaseRequest>> requestsInProgress_;
-    QTimer *fetchTimer_;
+    WheelTimer *fetchTimer_;
 
     types::SessionStatus prevSessionStatus_;
     types::SessionStatus prevSessionForLogging_;
@@ -8,8 +8,8 @@ namespace api_resources {
 CheckUpdateManager::CheckUpdateManager(QObject *parent, server_api::ServerAPI *serverAPI) : QObject(parent),
     serverAPI_(serverAPI), curRequest_(nullptr)
 {
-    fetchTimer_ = new QTimer(this);
-    connect(fetchTimer_, &QTimer::timeout, this, &CheckUpdateManager::onFetchTimer);
+    fetchTimer_ = new WheelTimer(this);
+    connect(fetchTimer_, &WheelTimer::timeout, this, &CheckUpdateManager::onFetchTimer);
 }
 
 CheckUpdateManager::~CheckUpdateManager()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/serverapi/serverapi.h"
+#include "engine/utils/timerwheel.h"
 #include "types/checkupdate.h"
 
 namespace api_resources {
@@ -26,7 +27,7 @@ private:
     server_api::ServerAPI *serverAPI_;
     UPDATE_CHANNEL updateChannel_;
     server_api::BaseRequest *curRequest_;
-    QTimer *fetchTimer_;
+    WheelTimer *fetchTimer_;
 
     static constexpr int k24Hours = 24 * 60 * 60 * 1000;
     static constexpr int kMinute = 60 * 1000;
@@ -1,7 +1,5 @@
 #include "myipmanager.h"
 
-#include <QTimer>
-
 #include "engine/serverapi/serverapi.h"
 #include "engine/serverapi/requests/myiprequest.h"
 #include "utils/utils.h"
@@ -18,7 +16,7 @@ MyIpManager::MyIpManager(QObject *parent, server_api::ServerAPI *serverAPI, INet
     curRequest_(nullptr)
 {
     connect(connectStateController, &IConnectStateController::stateChanged, this, &MyIpManager::onConnectStateChanged);
-    connect(&timer_, &QTimer::timeout, this, &MyIpManager::onTimer);
+    connect(&timer_, &WheelTimer::timeout, this, &MyIpManager::onTimer);
     timer_.setSingleShot(true);
 
 }
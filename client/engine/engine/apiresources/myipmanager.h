@@ -2,10 +2,10 @@
 
 #include <QObject>
 #include <QQueue>
-#include <QTimer>
 #include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
 #include "engine/connectstatecontroller/iconnectstatecontroller.h"
 #include "engine/serverapi/serverapi.h"
+#include "engine/utils/timerwheel.h"
 
 namespace api_resources {
 
@@ -34,7 +34,7 @@ private:
 
     server_api::BaseRequest *curRequest_;
     bool requestForTimerIsDisconnected_;
-    QTimer timer_;
+    WheelTimer timer_;
 };
 
 } // namespace api_resources
@@ -4,8 +4,6 @@
 #include <QFile>
 #include <QStandardPaths>
 
-#include "engine/networkaccessmanager/networkaccessmanager.h"
-#include "engine/networkaccessmanager/networkreply.h"
 #include "names.h"
 #include "utils/logger.h"
 #include "utils/ws_assert.h"
@@ -30,8 +28,8 @@ DownloadHelper::DownloadHelper(QObject *parent, NetworkAccessManager *networkAcc
 
 DownloadHelper::~DownloadHelper()
 {
-    abortAllReplies();
-    deleteAllReplies();
+    abortAllDownloads();
+    deleteAllDownloads();
 }
 
 const QString DownloadHelper::downloadInstallerPath()
@@ -70,7 +68,7 @@ const QString DownloadHelper::downloadInstallerPathWithoutExtension()
     return path;
 }
 
-void DownloadHelper::get(QMap<QString, QString> downloads)
+void DownloadHelper::get(QMap<QString, QString> downloads, QMap<QString, QString> sha256Hashes)
 {
     // assume get() should only run one set of downloads at a time
     if (busy_)
@@ -80,10 +78,15 @@ void DownloadHelper::get(QMap<QString, QString> downloads)
     }
 
     busy_ = true;
+    state_ = DOWNLOAD_STATE_RUNNING;
     progressPercent_ = 0;
-    for (const auto & download : downloads.keys())
+    for (const auto & url : downloads.keys())
     {
-        getInner(download, downloads[download]);
+        SegmentedDownload *download = new SegmentedDownload(this, networkAccessManager_, url, downloads[url], sha256Hashes.value(url));
+        downloads_.insert(download, false);
+        connect(download, &SegmentedDownload::finished, this, &DownloadHelper::onDownloadFinished);
+        connect(download, &SegmentedDownload::progressChanged, this, &DownloadHelper::onDownloadProgressChanged);
+        download->start();
     }
 }
 
@@ -96,9 +99,10 @@ void DownloadHelper::stop()
     }
 
     qCDebug(LOG_DOWNLOADER) << "Stopping download";
-    abortAllReplies();
-    deleteAllReplies();
+    abortAllDownloads();
+    deleteAllDownloads();
     busy_ = false;
+    state_ = DOWNLOAD_STATE_INIT;
 }
 
 DownloadHelper::DownloadState DownloadHelper::state()
@@ -106,120 +110,71 @@ DownloadHelper::DownloadState DownloadHelper::state()
     return state_;
 }
 
-void DownloadHelper::onReplyFinished()
+void DownloadHelper::onDownloadFinished(SegmentedDownload::Result result)
 {
-    NetworkReply *reply = static_cast<NetworkReply*>(sender());
-    if (!replies_.contains(reply))
+    SegmentedDownload *download = static_cast<SegmentedDownload*>(sender());
+    if (!downloads_.contains(download))
     {
-        qCDebug(LOG_DOWNLOADER) << "Failed to find reply that finished in monitored replies list";
+        qCDebug(LOG_DOWNLOADER) << "Failed to find download that finished in monitored downloads list";
         return;
     }
-    replies_[reply].done = true;
+    downloads_[download] = true;
 
-    // if any reply fails, we fail
-    if (!reply->isSuccess())
+    // if any download fails, we fail
+    if (result != SegmentedDownload::SUCCESS)
     {
         qCDebug(LOG_DOWNLOADER) << "Download failed";
-        abortAllReplies();
-        deleteAllReplies();
+        abortAllDownloads();
+        deleteAllDownloads();
         busy_ = false;
-        emit finished(DOWNLOAD_STATE_FAIL);
+        state_ = (result == SegmentedDownload::HASH_MISMATCH) ? DOWNLOAD_STATE_HASH_MISMATCH : DOWNLOAD_STATE_FAIL;
+        emit finished(state_);
         return;
     }
 
-    if (allRepliesDone())
+    if (allDownloadsDone())
     {
         qCDebug(LOG_DOWNLOADER) << "Download finished successfully";
-        deleteAllReplies();
+        deleteAllDownloads();
         busy_ = false;
-        emit finished(DOWNLOAD_STATE_SUCCESS);
+        state_ = DOWNLOAD_STATE_SUCCESS;
+        emit finished(state_);
         return;
     }
 
-    // still waiting on replies
+    // still waiting on downloads
     qCDebug(LOG_DOWNLOADER) << "Download single file successful";
 }
 
-void DownloadHelper::onReplyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal)
+void DownloadHelper::onDownloadProgressChanged()
 {
-    NetworkReply *reply = static_cast<NetworkReply*>(sender());
-    if (!replies_.contains(reply))
-    {
-        qCDebug(LOG_DOWNLOADER) << "Failed to find reply that progressed in monitored replies list";
-        return;
-    }
-    replies_[reply].bytesReceived = bytesReceived;
-    replies_[reply].bytesTotal = bytesTotal;
-
     // recompute total progress
     qint64 sum = 0;
     qint64 total = 0;
-    for (const auto & fileAndProgress : replies_.values())
+    for (const auto & download : downloads_.keys())
     {
-        sum += fileAndProgress.bytesReceived;
-        total += fileAndProgress.bytesTotal;
+        sum += download->bytesReceived();
+        total += download->bytesTotal();
     }
-
-    // qCDebug(LOG_DOWNLOADER) << "Bytes received: " << bytesReceived << ", Bytes Total: " << bytesTotal;
-    progressPercent_ = (double) sum / (double) total * 100;
-
-    // qCDebug(LOG_DOWNLOADER) << "Downloading: " << progressPercent_;
-    emit progressChanged(progressPercent_);
-}
-
-void DownloadHelper::onReplyReadyRead()
-{
-    NetworkReply *reply = static_cast<NetworkReply*>(sender());
-    if (!replies_.contains(reply))
+    if (total <= 0)
     {
-        qCDebug(LOG_DOWNLOADER) << "Failed to find reply that emitted ready read in monitored replies list";
         return;
     }
-    QByteArray arr = reply->readAll();
-
-    if (!arr.isEmpty())
-    {
-        auto &file = replies_[reply].file;
-        if (file->isOpen())
-        {
-            file->write(arr);
-        }
-        else
-        {
-            qCDebug(LOG_DOWNLOADER) << "Download error occurred (file not opened)";
-        }
-    }
-}
 
-void DownloadHelper::getInner(const QString url, const QString targetFilenamePath)
-{
-    // remove a previously used file if it exists
-    QFile::remove(targetFilenamePath);
-    qCDebug(LOG_DOWNLOADER) << "Starting download from url: " << url;
-
-    FileAndProgress fileAndProgess;
-    fileAndProgess.file = QSharedPointer<QFile>::create(targetFilenamePath); // unnecessary copy?
-    if (!fileAndProgess.file->open(QIODevice::WriteOnly))
+    const uint progressPercent = qMin<qint64>(sum * 100 / total, 100);
+    if (progressPercent != progressPercent_)
     {
-        qCDebug(LOG_DOWNLOADER) << "Failed to open file for download" << url;
-        return;
+        progressPercent_ = progressPercent;
+        emit progressChanged(progressPercent_);
     }
-
-    NetworkRequest request(QUrl(url), 60000 * 5, true);     // timeout 5 mins
-    request.setRemoveFromWhitelistIpsAfterFinish();
-
-    NetworkReply *reply = networkAccessManager_->get(request);
-    replies_.insert(reply, fileAndProgess);
-    connect(reply, &NetworkReply::finished, this, &DownloadHelper::onReplyFinished);
-    connect(reply, &NetworkReply::progress, this, &DownloadHelper::onReplyDownloadProgress);
-    connect(reply, &NetworkReply::readyRead, this, &DownloadHelper::onReplyReadyRead);
 }
 
 void DownloadHelper::removeAutoUpdateInstallerFiles()
 {
     // remove a previously used auto-update installer/dmg upon app startup if it exists
+    // unless it is a partial download to continue
     const QString installerPath = downloadInstallerPath();
-    if (QFile::exists(installerPath))
+    if (QFile::exists(installerPath) && !SegmentedDownload::hasState(installerPath))
     {
         qCDebug(LOG_DOWNLOADER) << "Removing auto-update installer";
         QFile::remove(installerPath);
@@ -237,12 +192,11 @@ void DownloadHelper::removeAutoUpdateInstallerFiles()
 #endif
 }
 
-bool DownloadHelper::allRepliesDone()
+bool DownloadHelper::allDownloadsDone()
 {
-    for (const auto &fp : replies_.values())
+    for (bool done : downloads_.values())
     {
-        // breaks
-        if (!fp.done)
+        if (!done)
         {
             return false;
         }
@@ -250,21 +204,21 @@ bool DownloadHelper::allRepliesDone()
     return true;
 }
 
-void DownloadHelper::abortAllReplies()
+void DownloadHelper::abortAllDownloads()
 {
-    for (const auto &reply : replies_.keys())
+    for (const auto &download : downloads_.keys())
     {
-        reply->abort();
+        download->abort();
     }
 }
 
-void DownloadHelper::deleteAllReplies()
+void DownloadHelper::deleteAllDownloads()
 {
-    while (!replies_.empty())
+    while (!downloads_.empty())
     {
-        NetworkReply *reply = replies_.firstKey();
-        disconnect(reply);
-        replies_.remove(reply);
-        reply->deleteLater();
+        SegmentedDownload *download = downloads_.firstKey();
+        disconnect(download);
+        downloads_.remove(download);
+        download->deleteLater();
     }
 }
@@ -2,12 +2,10 @@
 
 #include <QString>
 #include <QObject>
-#include <QFile>
-#include <QSharedPointer>
 #include <QMap>
+#include "segmenteddownload.h"
 
 class NetworkAccessManager;
-class NetworkReply;
 
 class DownloadHelper : public QObject
 {
@@ -20,13 +18,16 @@ public:
         DOWNLOAD_STATE_INIT,
         DOWNLOAD_STATE_RUNNING,
         DOWNLOAD_STATE_SUCCESS,
-        DOWNLOAD_STATE_FAIL
+        DOWNLOAD_STATE_FAIL,
+        DOWNLOAD_STATE_HASH_MISMATCH
     };
 
     const QString downloadInstallerPath();
     const QString downloadInstallerPathWithoutExtension();
 
-    void get(QMap<QString, QString> downloads);
+    // downloads are the target paths by urls, sha256Hashes are the expected hex hashes by urls.
+    // A download interrupted by stop() or a failure continues from where it stopped on the next get().
+    void get(QMap<QString, QString> downloads, QMap<QString, QString> sha256Hashes = QMap<QString, QString>());
     void stop();
 
     DownloadState state();
@@ -36,21 +37,13 @@ signals:
     void progressChanged(uint progressPercent);
 
 private slots:
-    void onReplyFinished();
-    void onReplyDownloadProgress(qint64 bytesReceived, qint64 bytesTotal);
-    void onReplyReadyRead();
+    void onDownloadFinished(SegmentedDownload::Result result);
+    void onDownloadProgressChanged();
 
 private:
     NetworkAccessManager *networkAccessManager_;
 
-    struct FileAndProgress {
-        QSharedPointer<QFile> file;
-        qint64 bytesReceived = 0;
-        qint64 bytesTotal = 0;
-        bool done = false;
-    };
-
-    QMap<NetworkReply*, FileAndProgress> replies_;
+    QMap<SegmentedDownload *, bool> downloads_;     // the downloads and whether they are done
     bool busy_;
     const QString platform_;
 
@@ -58,9 +51,8 @@ private:
     uint progressPercent_;
     DownloadState state_;
 
-    void getInner(const QString url, const QString targetFilenamePath);
     void removeAutoUpdateInstallerFiles();
-    bool allRepliesDone();
-    void abortAllReplies();
-    void deleteAllReplies();
+    bool allDownloadsDone();
+    void abortAllDownloads();
+    void deleteAllDownloads();
 };
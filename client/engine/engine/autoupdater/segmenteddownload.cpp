@@ -0,0 +1,591 @@
+#include "segmenteddownload.h"
+
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QTimer>
+#include <atomic>
+
+#include "engine/networkaccessmanager/networkaccessmanager.h"
+#include "engine/networkaccessmanager/networkreply.h"
+#include "utils/logger.h"
+
+namespace {
+const int kRequestTimeoutMs = 60000 * 5;
+const int kSaveStateIntervalMs = 1000;
+const qint64 kHashChunkSize = 1024 * 1024;
+}
+
+// The file shared by the write callbacks of the segments on the curl thread.
+struct SegmentedDownload::Storage
+{
+    QMutex mutex;
+    QFile file;
+    bool isStopped = false;                         // guarded by the mutex, the late chunks of the aborted requests are dropped
+    std::atomic<bool> isRangeConfirmed { false };   // the server has answered a range request with 206
+    std::atomic<bool> isRangeUnsupported { false }; // the server has answered a range request with the whole file
+    std::atomic<bool> isRangeNotSatisfiable { false };  // the server has answered a range request with 416
+    std::atomic<bool> isValidatorMismatch { false };    // the ETag or Last-Modified of the file has changed
+    QString etag;                                   // guarded by the mutex, empty until a response tells it
+    QString lastModified;                           // guarded by the mutex, empty until a response tells it
+};
+
+// The bytes [start, end) of the file. end is changed under the mutex of the storage only.
+struct SegmentedDownload::Segment
+{
+    qint64 start = 0;
+    qint64 end = -1;                        // -1 until the size of the file is known
+    std::atomic<qint64> received { 0 };     // the bytes written to the file from start
+    NetworkReply *reply = nullptr;
+    int retries = 0;
+    bool isDone = false;
+};
+
+SegmentedDownload::SegmentedDownload(QObject *parent, NetworkAccessManager *networkAccessManager, const QString &url,
+                                     const QString &filePath, const QString &expectedSha256) : QObject(parent)
+  , networkAccessManager_(networkAccessManager)
+  , url_(url)
+  , filePath_(filePath)
+  , expectedSha256_(expectedSha256)
+  , hash_(QCryptographicHash::Sha256)
+{
+}
+
+SegmentedDownload::~SegmentedDownload()
+{
+    abortSegments();
+}
+
+void SegmentedDownload::start()
+{
+    isFinished_ = false;
+    isStartedOver_ = false;
+    hash_.reset();
+    hashedBytes_ = 0;
+    saveStateTimer_.start();
+
+    if (loadState() && openStorage(true))
+    {
+        qCDebug(LOG_DOWNLOADER) << "Resuming download from url:" << url_ << ", downloaded" << bytesReceived() << "of" << totalSize_;
+        isSingleStream_ = false;
+        storage_->isRangeConfirmed = true;
+        storage_->etag = etag_;
+        storage_->lastModified = lastModified_;
+        for (const auto &segment : qAsConst(segments_))
+        {
+            if (isSegmentComplete(*segment))
+                segment->isDone = true;
+            else
+                startSegment(segment);
+        }
+        checkFinished();
+    }
+    else
+    {
+        qCDebug(LOG_DOWNLOADER) << "Starting download from url:" << url_;
+        startFresh(false);
+    }
+}
+
+void SegmentedDownload::abort()
+{
+    if (isFinished_)
+        return;
+    saveState();
+    abortSegments();
+    hashFile_.close();
+    isFinished_ = true;
+}
+
+qint64 SegmentedDownload::bytesReceived() const
+{
+    qint64 received = 0;
+    for (const auto &segment : segments_)
+        received += segment->received;
+    return received;
+}
+
+qint64 SegmentedDownload::bytesTotal() const
+{
+    return totalSize_;
+}
+
+QString SegmentedDownload::statePath(const QString &filePath)
+{
+    return filePath + ".state";
+}
+
+bool SegmentedDownload::hasState(const QString &filePath)
+{
+    return QFile::exists(statePath(filePath));
+}
+
+void SegmentedDownload::removeState(const QString &filePath)
+{
+    QFile::remove(statePath(filePath));
+}
+
+bool SegmentedDownload::loadState()
+{
+    QFile file(statePath(filePath_));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonObject json = QJsonDocument::fromJson(file.readAll()).object();
+    const qint64 size = json["size"].toInteger();
+    if (json["url"].toString() != url_ || size <= 0 || QFileInfo(filePath_).size() != size)
+    {
+        qCDebug(LOG_DOWNLOADER) << "The saved download state does not match, starting over";
+        return false;
+    }
+
+    // the segments must cover the file without gaps
+    QVector<QSharedPointer<Segment>> segments;
+    qint64 offset = 0;
+    const QJsonArray jsonSegments = json["segments"].toArray();
+    for (const auto &it : jsonSegments)
+    {
+        const QJsonObject jsonSegment = it.toObject();
+        QSharedPointer<Segment> segment(new Segment);
+        segment->start = jsonSegment["start"].toInteger();
+        segment->end = jsonSegment["end"].toInteger();
+        segment->received = jsonSegment["received"].toInteger();
+        if (segment->start != offset || segment->end <= segment->start || segment->received < 0 ||
+            segment->received > segment->end - segment->start)
+        {
+            qCDebug(LOG_DOWNLOADER) << "The saved download state is incorrect, starting over";
+            return false;
+        }
+        offset = segment->end;
+        segments << segment;
+    }
+    if (offset != size)
+    {
+        qCDebug(LOG_DOWNLOADER) << "The saved download state is incorrect, starting over";
+        return false;
+    }
+
+    segments_ = segments;
+    totalSize_ = size;
+    etag_ = json["etag"].toString();
+    lastModified_ = json["lastModified"].toString();
+    return true;
+}
+
+void SegmentedDownload::saveState()
+{
+    // nothing to continue from until the file is split into the ranges
+    if (isSingleStream_ || totalSize_ <= 0 || segments_.isEmpty() || segments_.last()->end != totalSize_)
+        return;
+
+    QJsonArray jsonSegments;
+    for (const auto &segment : qAsConst(segments_))
+    {
+        QJsonObject jsonSegment;
+        jsonSegment["start"] = segment->start;
+        jsonSegment["end"] = segment->end;
+        jsonSegment["received"] = segment->received.load();
+        jsonSegments << jsonSegment;
+    }
+    QJsonObject json;
+    json["url"] = url_;
+    json["size"] = totalSize_;
+    json["segments"] = jsonSegments;
+    if (storage_)
+    {
+        QMutexLocker locker(&storage_->mutex);
+        json["etag"] = storage_->etag;
+        json["lastModified"] = storage_->lastModified;
+    }
+
+    QSaveFile file(statePath(filePath_));
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(json).toJson(QJsonDocument::Compact)) < 0 || !file.commit())
+        qCDebug(LOG_DOWNLOADER) << "Failed to save the download state";
+    saveStateTimer_.restart();
+}
+
+bool SegmentedDownload::openStorage(bool isResume)
+{
+    storage_.reset(new Storage);
+    storage_->file.setFileName(filePath_);
+    // unbuffered, the file is read back for the hash while the segments are written
+    const QIODevice::OpenMode mode = QIODevice::ReadWrite | QIODevice::Unbuffered | (isResume ? QIODevice::OpenMode() : QIODevice::Truncate);
+    if (!storage_->file.open(mode))
+    {
+        qCDebug(LOG_DOWNLOADER) << "Failed to open file for download" << filePath_;
+        return false;
+    }
+    return true;
+}
+
+void SegmentedDownload::startFresh(bool isSingleStream)
+{
+    abortSegments();
+    segments_.clear();
+    isSingleStream_ = isSingleStream;
+    totalSize_ = 0;
+    hash_.reset();
+    hashedBytes_ = 0;
+    hashFile_.close();
+    removeState(filePath_);
+
+    if (!openStorage(false))
+    {
+        finish(FAIL);
+        return;
+    }
+
+    // the whole file from the beginning, it is split once the server confirms the range and tells the size
+    QSharedPointer<Segment> segment(new Segment);
+    segments_ << segment;
+    startSegment(segment);
+}
+
+void SegmentedDownload::startSegment(const QSharedPointer<Segment> &segment)
+{
+    const qint64 offset = segment->start + segment->received;
+    NetworkRequest request(QUrl(url_), kRequestTimeoutMs, true);
+    request.setRemoveFromWhitelistIpsAfterFinish();
+    if (!isSingleStream_)
+        request.setRange(offset, segment->end >= 0 ? segment->end - 1 : -1);
+
+    QSharedPointer<Storage> storage = storage_;
+    request.setHeaderCallback([storage](long httpCode, const QByteArray &header)
+    {
+        readHeader(storage.data(), httpCode, header);
+    });
+    request.setWriteCallback([storage, segment, offset](long httpCode, const char *data, size_t size)
+    {
+        return writeData(storage.data(), segment.data(), httpCode, offset, data, static_cast<qint64>(size));
+    });
+
+    NetworkReply *reply = networkAccessManager_->get(request);
+    segment->reply = reply;
+    connect(reply, &NetworkReply::progress, this, [this, segment, offset](qint64 /*bytesReceived*/, qint64 bytesTotal)
+    {
+        // the first request is for the rest of the file, so it tells the size of the file
+        if (totalSize_ == 0 && segment->start == 0 && segment->end < 0)
+            totalSize_ = offset + bytesTotal;
+        onReplyProgress(segment);
+    });
+    connect(reply, &NetworkReply::finished, this, [this, segment, reply]()
+    {
+        onReplyFinished(segment, reply);
+    });
+}
+
+void SegmentedDownload::readHeader(Storage *storage, long httpCode, const QByteArray &header)
+{
+    if (httpCode == 416)
+    {
+        storage->isRangeNotSatisfiable = true;
+        return;
+    }
+    // the headers of the redirects don't describe the file
+    if (httpCode != 200 && httpCode != 206)
+        return;
+
+    const int ind = header.indexOf(':');
+    if (ind < 0)
+        return;
+    const QByteArray name = header.left(ind).trimmed().toLower();
+    if (name != "etag" && name != "last-modified")
+        return;
+    const QString value = QString::fromLatin1(header.mid(ind + 1).trimmed());
+
+    // the first response tells the validators, all the next ones must match them
+    QMutexLocker locker(&storage->mutex);
+    QString &validator = (name == "etag") ? storage->etag : storage->lastModified;
+    if (validator.isEmpty())
+        validator = value;
+    else if (validator != value)
+        storage->isValidatorMismatch = true;
+}
+
+bool SegmentedDownload::writeData(Storage *storage, Segment *segment, long httpCode, qint64 requestOffset, const char *data, qint64 size)
+{
+    if (httpCode == 206)
+    {
+        storage->isRangeConfirmed = true;
+    }
+    else if (httpCode == 200)
+    {
+        // the whole file is useful only if it was requested from the beginning
+        storage->isRangeUnsupported = true;
+        if (requestOffset != 0)
+            return false;
+    }
+    else
+    {
+        return false;
+    }
+
+    QMutexLocker locker(&storage->mutex);
+    if (storage->isStopped || storage->isValidatorMismatch)
+        return false;
+
+    const qint64 pos = segment->start + segment->received;
+    qint64 count = size;
+    // the rest belongs to the next segment, which has been split off from this one
+    if (segment->end >= 0 && pos + count > segment->end)
+        count = segment->end - pos;
+    if (count > 0)
+    {
+        if (!storage->file.seek(pos) || storage->file.write(data, count) != count)
+            return false;
+        segment->received += count;
+    }
+    return count == size;
+}
+
+void SegmentedDownload::splitSegments()
+{
+    const QSharedPointer<Segment> first = segments_.first();
+    const int count = static_cast<int>(qBound<qint64>(1, totalSize_ / kMinSegmentSize, kMaxSegments));
+    {
+        QMutexLocker locker(&storage_->mutex);
+        if (!storage_->file.resize(totalSize_))
+            qCDebug(LOG_DOWNLOADER) << "Failed to preallocate the downloaded file";
+        // the first request goes on, it keeps what it has already received
+        first->end = qMin(qMax(totalSize_ / count, first->received.load()), totalSize_);
+    }
+
+    const qint64 rest = totalSize_ - first->end;
+    const int restCount = static_cast<int>(qBound<qint64>(1, rest / kMinSegmentSize, count - 1));
+    qCDebug(LOG_DOWNLOADER) << "Downloading" << totalSize_ << "bytes in" << (rest > 0 ? restCount + 1 : 1) << "segments";
+    for (int i = 0; rest > 0 && i < restCount; ++i)
+    {
+        QSharedPointer<Segment> segment(new Segment);
+        segment->start = first->end + rest * i / restCount;
+        segment->end = first->end + rest * (i + 1) / restCount;
+        segments_ << segment;
+        startSegment(segment);
+    }
+    saveState();
+}
+
+void SegmentedDownload::abortSegments()
+{
+    if (storage_)
+    {
+        QMutexLocker locker(&storage_->mutex);
+        storage_->isStopped = true;
+        storage_->file.close();
+    }
+    storage_.reset();
+
+    for (const auto &segment : qAsConst(segments_))
+    {
+        if (segment->reply)
+        {
+            disconnect(segment->reply, nullptr, this, nullptr);
+            segment->reply->abort();
+            segment->reply->deleteLater();
+            segment->reply = nullptr;
+        }
+    }
+}
+
+void SegmentedDownload::onReplyProgress(const QSharedPointer<Segment> &segment)
+{
+    if (isFinished_ || !segments_.contains(segment))
+        return;
+
+    if (!isSingleStream_ && segments_.size() == 1 && segment->end < 0)
+    {
+        if (storage_->isRangeUnsupported)
+        {
+            qCDebug(LOG_DOWNLOADER) << "The server does not support ranges, downloading as one stream";
+            isSingleStream_ = true;
+        }
+        else if (storage_->isRangeConfirmed && totalSize_ > 0)
+        {
+            splitSegments();
+        }
+    }
+
+    advanceHash();
+    if (saveStateTimer_.elapsed() >= kSaveStateIntervalMs)
+        saveState();
+    emit progressChanged();
+}
+
+void SegmentedDownload::onReplyFinished(const QSharedPointer<Segment> &segment, NetworkReply *reply)
+{
+    if (segment->reply != reply)
+        return;
+    const bool isSuccess = reply->isSuccess();
+    segment->reply = nullptr;
+    reply->deleteLater();
+    if (isFinished_)
+        return;
+
+    // the downloaded part does not belong to the file on the server anymore
+    if (storage_->isRangeNotSatisfiable || storage_->isValidatorMismatch)
+    {
+        if (storage_->isRangeNotSatisfiable)
+            qCDebug(LOG_DOWNLOADER) << "The server refused the range of the download";
+        else
+            qCDebug(LOG_DOWNLOADER) << "The file on the server has changed during the download";
+        startOver();
+        return;
+    }
+
+    // a request up to the end of the file which has finished normally received the whole rest of it
+    if (isSuccess && segment->end < 0 && segment->received > 0)
+    {
+        QMutexLocker locker(&storage_->mutex);
+        segment->end = segment->start + segment->received;
+        totalSize_ = segment->end;
+    }
+
+    // the request of a split segment ends with a write error when it reaches the next segment
+    if (isSegmentComplete(*segment))
+    {
+        segment->isDone = true;
+        emit progressChanged();
+        checkFinished();
+        return;
+    }
+
+    if (!isSingleStream_ && storage_->isRangeUnsupported)
+    {
+        qCDebug(LOG_DOWNLOADER) << "The server does not support ranges, downloading as one stream";
+        startFresh(true);
+        return;
+    }
+
+    if (segment->retries >= kMaxRetries)
+    {
+        qCDebug(LOG_DOWNLOADER) << "Download failed";
+        finish(FAIL);
+        return;
+    }
+
+    segment->retries++;
+    qCDebug(LOG_DOWNLOADER) << "Download segment failed at offset" << segment->start + segment->received
+                            << ", retry" << segment->retries << "of" << kMaxRetries;
+    QTimer::singleShot(kRetryDelayMs * segment->retries, this, [this, segment]()
+    {
+        if (isFinished_ || !segments_.contains(segment))
+            return;
+        if (isSingleStream_)
+        {
+            // a single stream can't be continued, the file is downloaded again
+            const int retries = segment->retries;
+            startFresh(true);
+            if (!segments_.isEmpty())
+                segments_.first()->retries = retries;
+        }
+        else
+        {
+            startSegment(segment);
+        }
+    });
+}
+
+void SegmentedDownload::startOver()
+{
+    // once only, a server which keeps refusing the ranges or changing the validators fails the download
+    if (isStartedOver_)
+    {
+        qCDebug(LOG_DOWNLOADER) << "Download failed";
+        // the state is dropped, so the next attempt does not continue from it either
+        abortSegments();
+        segments_.clear();
+        removeState(filePath_);
+        finish(FAIL);
+        return;
+    }
+    qCDebug(LOG_DOWNLOADER) << "Starting the download over";
+    isStartedOver_ = true;
+    startFresh(false);
+}
+
+void SegmentedDownload::checkFinished()
+{
+    for (const auto &segment : qAsConst(segments_))
+    {
+        if (!segment->isDone)
+            return;
+    }
+
+    if (!advanceHash())
+    {
+        qCDebug(LOG_DOWNLOADER) << "Failed to read the downloaded file" << filePath_;
+        finish(FAIL);
+        return;
+    }
+    if (!expectedSha256_.isEmpty())
+    {
+        const QString sha256 = hash_.result().toHex();
+        if (sha256.compare(expectedSha256_, Qt::CaseInsensitive) != 0)
+        {
+            qCDebug(LOG_DOWNLOADER) << "Downloaded file hash mismatch, expected:" << expectedSha256_ << ", actual:" << sha256;
+            finish(HASH_MISMATCH);
+            return;
+        }
+    }
+
+    qCDebug(LOG_DOWNLOADER) << "Download finished successfully:" << filePath_;
+    finish(SUCCESS);
+}
+
+bool SegmentedDownload::isSegmentComplete(const Segment &segment)
+{
+    return segment.isDone || (segment.end >= 0 && segment.start + segment.received >= segment.end);
+}
+
+bool SegmentedDownload::advanceHash()
+{
+    if (expectedSha256_.isEmpty())
+        return true;
+
+    // the downloaded part from the beginning of the file
+    qint64 end = 0;
+    for (const auto &segment : qAsConst(segments_))
+    {
+        end = segment->start + segment->received;
+        if (!isSegmentComplete(*segment))
+            break;
+    }
+    if (end <= hashedBytes_)
+        return true;
+
+    // unbuffered, the read-ahead would get the preallocated zeros of the parts not downloaded yet
+    if (!hashFile_.isOpen())
+    {
+        hashFile_.setFileName(filePath_);
+        if (!hashFile_.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+            return false;
+    }
+    if (!hashFile_.seek(hashedBytes_))
+        return false;
+    while (hashedBytes_ < end)
+    {
+        const QByteArray data = hashFile_.read(qMin(kHashChunkSize, end - hashedBytes_));
+        if (data.isEmpty())
+            return false;
+        hash_.addData(data);
+        hashedBytes_ += data.size();
+    }
+    return true;
+}
+
+void SegmentedDownload::finish(Result result)
+{
+    isFinished_ = true;
+    // a failed download is continued by the next attempt
+    if (result == FAIL)
+        saveState();
+    else
+        removeState(filePath_);
+    abortSegments();
+    hashFile_.close();
+    if (result == HASH_MISMATCH)
+        QFile::remove(filePath_);
+    emit finished(result);
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QSharedPointer>
+#include <QVector>
+
+class NetworkAccessManager;
+class NetworkReply;
+
+// Downloads one file with HTTP range requests. The first request asks for the whole file from the beginning,
+// once the server confirms the range support and the size, the rest of the file is split into segments which are
+// downloaded in parallel and written straight to the file at their offsets on the curl thread.
+// A failed segment is requested again from where it stopped. The progress of the segments is saved next to the file,
+// so the download continues after a restart of the engine. If the server refuses the saved range (416) or the ETag or
+// Last-Modified of the file has changed, the download starts over. If the server does not support ranges, the file is
+// downloaded as one stream. The SHA-256 of the file is computed while the downloaded part grows.
+class SegmentedDownload : public QObject
+{
+    Q_OBJECT
+public:
+    enum Result { SUCCESS, FAIL, HASH_MISMATCH };
+    Q_ENUM(Result)
+
+    // expectedSha256 is a hex string, the file is not verified if it is empty
+    explicit SegmentedDownload(QObject *parent, NetworkAccessManager *networkAccessManager, const QString &url,
+                               const QString &filePath, const QString &expectedSha256);
+    ~SegmentedDownload();
+
+    void start();
+    // stops the transfers, the downloaded part and the state are kept to continue later
+    void abort();
+
+    qint64 bytesReceived() const;
+    qint64 bytesTotal() const;      // 0 if not known yet
+
+    // the file of the download state next to the downloaded file
+    static QString statePath(const QString &filePath);
+    static bool hasState(const QString &filePath);
+    static void removeState(const QString &filePath);
+
+    static constexpr int kMaxSegments = 4;
+    static constexpr qint64 kMinSegmentSize = 1024 * 1024;
+    static constexpr int kMaxRetries = 5;
+    static constexpr int kRetryDelayMs = 500;         // multiplied by the number of the retries of the segment
+
+signals:
+    void progressChanged();
+    void finished(SegmentedDownload::Result result);
+
+private:
+    struct Storage;
+    struct Segment;
+
+    NetworkAccessManager *networkAccessManager_;
+    const QString url_;
+    const QString filePath_;
+    const QString expectedSha256_;
+
+    QSharedPointer<Storage> storage_;
+    QVector<QSharedPointer<Segment>> segments_;     // ordered by the offset
+    qint64 totalSize_ = 0;                          // 0 if not known yet
+    bool isSingleStream_ = false;                   // the server does not support ranges
+    bool isFinished_ = false;
+    bool isStartedOver_ = false;                    // the download has been started over since start()
+    QString etag_;                                  // the validators from the saved state
+    QString lastModified_;
+
+    QCryptographicHash hash_;
+    qint64 hashedBytes_ = 0;
+    QFile hashFile_;
+
+    QElapsedTimer saveStateTimer_;
+
+    bool loadState();
+    void saveState();
+    bool openStorage(bool isResume);
+    void startFresh(bool isSingleStream);
+    void startSegment(const QSharedPointer<Segment> &segment);
+    void splitSegments();
+    void abortSegments();
+    void onReplyProgress(const QSharedPointer<Segment> &segment);
+    void onReplyFinished(const QSharedPointer<Segment> &segment, NetworkReply *reply);
+    void startOver();
+    void checkFinished();
+    static bool isSegmentComplete(const Segment &segment);
+    static void readHeader(Storage *storage, long httpCode, const QByteArray &header);
+    static bool writeData(Storage *storage, Segment *segment, long httpCode, qint64 requestOffset, const char *data, qint64 size);
+    bool advanceHash();
+    void finish(Result result);
+};
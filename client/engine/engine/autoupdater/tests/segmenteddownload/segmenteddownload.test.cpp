@@ -0,0 +1,293 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QRandomGenerator>
+#include <QRegularExpression>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#ifdef Q_OS_WIN
+#include <WinSock2.h>
+#endif
+#include "engine/autoupdater/segmenteddownload.h"
+#include "engine/networkaccessmanager/networkaccessmanager.h"
+
+// A local HTTP server with the Range support, one request per connection.
+// The body is sent in small chunks, so the transfers last long enough to be split, interrupted and failed.
+class TestHttpServer : public QTcpServer
+{
+    Q_OBJECT
+
+public:
+    explicit TestHttpServer(const QByteArray &content) : content_(content)
+    {
+        connect(this, &QTcpServer::newConnection, this, &TestHttpServer::onNewConnection);
+        listen(QHostAddress::LocalHost);
+    }
+
+    QString url() const { return QString("http://127.0.0.1:%1/installer").arg(serverPort()); }
+
+    bool isRangeSupported = true;
+    int failingRequests = 0;        // the number of the first requests whose connection is dropped in the middle of the body
+    int notSatisfiableRequests = 0; // the number of the next requests from a non-zero offset answered with 416
+    QByteArray etag;                // sent with the responses if not empty
+    QList<qint64> rangeStarts;      // the offsets of the requests, 0 for a request without a range
+
+private slots:
+    void onNewConnection()
+    {
+        while (QTcpSocket *socket = nextPendingConnection())
+        {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]()
+            {
+                QByteArray &request = requests_[socket];
+                request += socket->readAll();
+                if (request.contains("\r\n\r\n"))
+                {
+                    onRequest(socket, request);
+                    requests_.remove(socket);
+                }
+            });
+        }
+    }
+
+private:
+    const QByteArray content_;
+    QHash<QTcpSocket *, QByteArray> requests_;
+
+    void onRequest(QTcpSocket *socket, const QByteArray &request)
+    {
+        static const QRegularExpression rangeRegExp("^Range: bytes=(\\d+)-(\\d*)\\r$",
+                                                    QRegularExpression::MultilineOption | QRegularExpression::CaseInsensitiveOption);
+        const QRegularExpressionMatch match = rangeRegExp.match(QString::fromLatin1(request));
+
+        qint64 from = 0;
+        qint64 to = content_.size() - 1;
+        QByteArray header;
+        if (match.hasMatch() && isRangeSupported && match.captured(1).toLongLong() > 0 && notSatisfiableRequests > 0)
+        {
+            notSatisfiableRequests--;
+            rangeStarts << match.captured(1).toLongLong();
+            socket->write("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */" + QByteArray::number(content_.size()) +
+                          "\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            socket->disconnectFromHost();
+            return;
+        }
+        else if (match.hasMatch() && isRangeSupported)
+        {
+            from = match.captured(1).toLongLong();
+            if (!match.captured(2).isEmpty())
+                to = qMin(to, match.captured(2).toLongLong());
+            header = "HTTP/1.1 206 Partial Content\r\nContent-Range: bytes " + QByteArray::number(from) + "-" +
+                     QByteArray::number(to) + "/" + QByteArray::number(content_.size()) + "\r\n";
+        }
+        else
+        {
+            header = "HTTP/1.1 200 OK\r\n";
+        }
+        rangeStarts << from;
+        if (!etag.isEmpty())
+            header += "ETag: " + etag + "\r\n";
+        header += "Content-Length: " + QByteArray::number(to - from + 1) + "\r\nConnection: close\r\n\r\n";
+        socket->write(header);
+
+        const qint64 dropAt = (failingRequests-- > 0) ? from + (to - from + 1) / 2 : -1;
+        QTimer *timer = new QTimer(socket);
+        connect(timer, &QTimer::timeout, socket, [this, socket, timer, pos = from, to, dropAt]() mutable
+        {
+            const qint64 chunkEnd = qMin(pos + 32 * 1024, to + 1);
+            if (dropAt >= 0 && chunkEnd > dropAt)
+            {
+                socket->write(content_.mid(pos, dropAt - pos));
+                socket->flush();
+                timer->stop();
+                socket->abort();
+                return;
+            }
+            socket->write(content_.mid(pos, chunkEnd - pos));
+            pos = chunkEnd;
+            if (pos > to)
+            {
+                timer->stop();
+                socket->disconnectFromHost();
+            }
+        });
+        timer->start(2);
+    }
+};
+
+class TestSegmentedDownload : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestSegmentedDownload();
+    ~TestSegmentedDownload();
+
+private slots:
+    void init();
+    void testSegments();
+    void testFailures();
+    void testRangeNotSupported();
+    void testResume();
+    void testResumeRangeNotSatisfiable();
+    void testResumeFileChanged();
+    void testHashMismatch();
+
+private:
+    QByteArray content_;
+    QString sha256_;
+    QTemporaryDir dir_;
+    QString filePath_;
+    NetworkAccessManager *manager_;
+
+    SegmentedDownload::Result download(SegmentedDownload *segmentedDownload);
+    QByteArray fileContent();
+    void interruptDownload(TestHttpServer *server);
+};
+
+TestSegmentedDownload::TestSegmentedDownload()
+{
+#ifdef Q_OS_WIN
+    // Initialize Winsock
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2,2), &wsaData);
+#endif
+    // big enough for all the segments
+    QRandomGenerator generator(12345);
+    content_.resize(SegmentedDownload::kMaxSegments * SegmentedDownload::kMinSegmentSize + 12345);
+    for (auto &c : content_)
+        c = static_cast<char>(generator.generate());
+    sha256_ = QCryptographicHash::hash(content_, QCryptographicHash::Sha256).toHex();
+    manager_ = new NetworkAccessManager(this);
+}
+
+TestSegmentedDownload::~TestSegmentedDownload()
+{
+}
+
+void TestSegmentedDownload::init()
+{
+    filePath_ = dir_.filePath("installer");
+    QFile::remove(filePath_);
+    SegmentedDownload::removeState(filePath_);
+}
+
+void TestSegmentedDownload::testSegments()
+{
+    TestHttpServer server(content_);
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, sha256_.toUpper());
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::SUCCESS);
+    QCOMPARE(fileContent(), content_);
+    QVERIFY(server.rangeStarts.size() > 1);
+    QVERIFY(!SegmentedDownload::hasState(filePath_));
+}
+
+void TestSegmentedDownload::testFailures()
+{
+    TestHttpServer server(content_);
+    server.failingRequests = 3;
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, sha256_);
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::SUCCESS);
+    QCOMPARE(fileContent(), content_);
+    // the failed requests are continued from where they stopped
+    QVERIFY(server.rangeStarts.size() > SegmentedDownload::kMaxSegments);
+    QCOMPARE(server.rangeStarts.count(0), 1);
+}
+
+void TestSegmentedDownload::testRangeNotSupported()
+{
+    TestHttpServer server(content_);
+    server.isRangeSupported = false;
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, sha256_);
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::SUCCESS);
+    QCOMPARE(fileContent(), content_);
+    QCOMPARE(server.rangeStarts.size(), 1);
+}
+
+void TestSegmentedDownload::testResume()
+{
+    TestHttpServer server(content_);
+    interruptDownload(&server);
+
+    // a new instance, as after a restart of the engine
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, sha256_);
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::SUCCESS);
+    QCOMPARE(fileContent(), content_);
+    QVERIFY(!server.rangeStarts.contains(0));
+    QVERIFY(!SegmentedDownload::hasState(filePath_));
+}
+
+void TestSegmentedDownload::testResumeRangeNotSatisfiable()
+{
+    TestHttpServer server(content_);
+    interruptDownload(&server);
+
+    // the saved ranges are refused, the download starts over instead of failing on every attempt
+    server.notSatisfiableRequests = 1;
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, sha256_);
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::SUCCESS);
+    QCOMPARE(fileContent(), content_);
+    QVERIFY(server.rangeStarts.contains(0));
+    QVERIFY(!SegmentedDownload::hasState(filePath_));
+}
+
+void TestSegmentedDownload::testResumeFileChanged()
+{
+    TestHttpServer server(content_);
+    server.etag = "\"v1\"";
+    interruptDownload(&server);
+
+    // the saved part belongs to the previous version of the file
+    server.etag = "\"v2\"";
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, sha256_);
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::SUCCESS);
+    QCOMPARE(fileContent(), content_);
+    QVERIFY(server.rangeStarts.contains(0));
+    QVERIFY(!SegmentedDownload::hasState(filePath_));
+}
+
+void TestSegmentedDownload::testHashMismatch()
+{
+    TestHttpServer server(content_);
+    SegmentedDownload segmentedDownload(this, manager_, server.url(), filePath_, QString(64, '0'));
+    QCOMPARE(download(&segmentedDownload), SegmentedDownload::HASH_MISMATCH);
+    QVERIFY(!QFile::exists(filePath_));
+    QVERIFY(!SegmentedDownload::hasState(filePath_));
+}
+
+SegmentedDownload::Result TestSegmentedDownload::download(SegmentedDownload *segmentedDownload)
+{
+    QSignalSpy signalFinished(segmentedDownload, &SegmentedDownload::finished);
+    segmentedDownload->start();
+    if (signalFinished.isEmpty())
+        signalFinished.wait(60000);
+    if (signalFinished.count() != 1)
+        return SegmentedDownload::FAIL;
+    return signalFinished.first().first().value<SegmentedDownload::Result>();
+}
+
+// leaves the half downloaded file with the saved state, as after a restart of the engine
+void TestSegmentedDownload::interruptDownload(TestHttpServer *server)
+{
+    {
+        SegmentedDownload segmentedDownload(this, manager_, server->url(), filePath_, sha256_);
+        segmentedDownload.start();
+        QTRY_VERIFY_WITH_TIMEOUT(segmentedDownload.bytesReceived() > content_.size() / 2, 20000);
+        segmentedDownload.abort();
+    }
+    QVERIFY(SegmentedDownload::hasState(filePath_));
+    server->rangeStarts.clear();
+}
+
+QByteArray TestSegmentedDownload::fileContent()
+{
+    QFile file(filePath_);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return file.readAll();
+}
+
+QTEST_MAIN(TestSegmentedDownload)
+#include "segmenteddownload.test.moc"
@@ -10,6 +10,7 @@
 #include "openvpnconnection.h"
 #include "engine/crossplatformobjectfactory.h"
 
+#include "utils/tracing.h"
 #include "utils/ws_assert.h"
 #include "utils/utils.h"
 #include "types/enums.h"
@@ -31,6 +32,14 @@
 #include "connectionmanager.h"
 
 
+namespace {
+// the steps of ConnectPreflight
+const QString kPreflightCtrld = "ctrld";
+const QString kPreflightOvpnConfig = "ovpn config";
+const QString kPreflightTunnelProcess = "tunnel process";
+const QString kPreflightWireGuardConfig = "wireguard config";
+}
+
 #ifdef Q_OS_WIN
     #include "sleepevents_win.h"
     #include "ikev2connection_win.h"
@@ -67,7 +76,11 @@ ConnectionManager::ConnectionManager(QObject *parent, IHelper *helper, INetworkD
     state_(STATE_DISCONNECTED),
     bLastIsOnline_(true),
     bWakeSignalReceived_(false),
-    currentConnectionDescr_()
+    currentConnectionDescr_(),
+    isConnectTraced_(false),
+    tunnelTraceId_(nullptr),
+    tunnelProcessGeneration_(-1),
+    wireGuardConfigGeneration_(-1)
 {
     connect(&timerReconnection_, &QTimer::timeout, this, &ConnectionManager::onTimerReconnection);
     connect(&connectTimer_, &QTimer::timeout, this, &ConnectionManager::onConnectTrigger);
@@ -104,6 +117,9 @@ ConnectionManager::ConnectionManager(QObject *parent, IHelper *helper, INetworkD
 
     getWireGuardConfig_ = new GetWireGuardConfig(this, serverAPI);
     connect(getWireGuardConfig_, &GetWireGuardConfig::getWireGuardConfigAnswer, this, &ConnectionManager::onGetWireGuardConfigAnswer);
+
+    preflight_ = new ConnectPreflight(this);
+    connect(preflight_, &ConnectPreflight::finished, this, &ConnectionManager::doConnectPart3);
 }
 
 ConnectionManager::~ConnectionManager()
@@ -117,6 +133,7 @@ ConnectionManager::~ConnectionManager()
     SAFE_DELETE(makeOVPNFileFromCustom_);
     SAFE_DELETE(sleepEvents_);
     SAFE_DELETE(getWireGuardConfig_);
+    SAFE_DELETE(preflight_);
 }
 
 QString ConnectionManager::udpStuffingWithNtp(const QString &ip, const quint16 port)
@@ -146,7 +163,12 @@ void ConnectionManager::clickConnect(const QString &ovpnConfig, const apiinfo::S
                                          const types::PortMap &portMap, const types::ProxySettings &proxySettings,
                                          bool bEmitAuthError, const QString &customConfigPath)
 {
+    WS_TRACE_SCOPE("connection", "ConnectionManager::clickConnect");
     WS_ASSERT(state_ == STATE_DISCONNECTED);
+    // ends when the tunnel is up, or when the attempt is given up
+    endConnectTrace();
+    WS_TRACE_ASYNC_BEGIN("connection", "connect", this);
+    isConnectTraced_ = true;
 
     lastOvpnConfig_ = ovpnConfig;
     lastServerCredentials_ = serverCredentials;
@@ -156,6 +178,7 @@ void ConnectionManager::clickConnect(const QString &ovpnConfig, const apiinfo::S
     bli_ = bli;
 
     bWasSuccessfullyConnectionAttempt_ = false;
+    clickElapsedTimer_.start();
 
     usernameForCustomOvpn_.clear();
     passwordForCustomOvpn_.clear();
@@ -186,6 +209,8 @@ void ConnectionManager::clickDisconnect()
     timerWaitNetworkConnectivity_.stop();
     connectTimer_.stop();
     connectingTimer_.stop();
+    endTunnelTrace();
+    endConnectTrace();
 
     if (state_ != STATE_DISCONNECTING_FROM_USER_CLICK)
     {
@@ -349,6 +374,13 @@ void ConnectionManager::onConnectionConnected(const AdapterGatewayInfo &connecti
         return;
     }
 
+    endTunnelTrace();
+    endConnectTrace();
+    if (clickElapsedTimer_.isValid()) {
+        qCDebug(LOG_CONNECTION) << "Connected in" << clickElapsedTimer_.elapsed() << "ms after the click";
+        // the reconnects are not measured from the click
+        clickElapsedTimer_.invalidate();
+    }
     timerReconnection_.stop();
     connectingTimer_.stop();
     state_ = STATE_CONNECTED;
@@ -534,6 +566,7 @@ void ConnectionManager::onConnectionReconnecting()
 
 void ConnectionManager::onConnectionError(CONNECT_ERROR err)
 {
+    endTunnelTrace();
     if (state_ == STATE_DISCONNECTING_FROM_USER_CLICK || state_ == STATE_RECONNECTION_TIME_EXCEED ||
         state_ == STATE_AUTO_DISCONNECT || state_ == STATE_ERROR_DURING_CONNECTION)
     {
@@ -824,6 +857,8 @@ void ConnectionManager::onTimerReconnection()
 {
     qCDebug(LOG_CONNECTION) << "Time for reconnection exceed";
     state_ = STATE_RECONNECTION_TIME_EXCEED;
+    endTunnelTrace();
+    endConnectTrace();
     if (connector_)
     {
         connector_->startDisconnect();
@@ -838,11 +873,12 @@ void ConnectionManager::onTimerReconnection()
 
 void ConnectionManager::onWstunnelStarted()
 {
-    doConnectPart3();
+    preflight_->finishStep(kPreflightTunnelProcess, tunnelProcessGeneration_);
 }
 
 void ConnectionManager::doConnect()
 {
+    WS_TRACE_SCOPE("connection", "ConnectionManager::doConnect");
     if (!networkDetectionManager_->isOnline())
     {
         startReconnectionTimer();
@@ -865,11 +901,13 @@ void ConnectionManager::doConnect()
         connectingTimer_.start();
     }
 
+    WS_TRACE_ASYNC_BEGIN("connection", "resolve hostnames", connSettingsPolicy_.get());
     connSettingsPolicy_->resolveHostnames();
 }
 
 void ConnectionManager::doConnectPart2()
 {
+    WS_TRACE_SCOPE("connection", "ConnectionManager::doConnectPart2");
     bIgnoreConnectionErrorsForOpenVpn_ = false;
 
     currentConnectionDescr_ = connSettingsPolicy_->getCurrentConnectionSettings();
@@ -894,34 +932,9 @@ void ConnectionManager::doConnectPart2()
     }
 #endif
 
-    // start ctrld utility
-    if (connectedDnsInfo_.type == CONNECTED_DNS_TYPE_CUSTOM) {
-        bool bStarted = false;
-        if (connectedDnsInfo_.isSplitDns)
-            bStarted = ctrldManager_->runProcess(connectedDnsInfo_.upStream1, connectedDnsInfo_.upStream2, connectedDnsInfo_.hostnames);
-        else
-            bStarted = ctrldManager_->runProcess(connectedDnsInfo_.upStream1, QString(), QStringList());
-
-        if (!bStarted) {
-            disconnect();
-            timerReconnection_.stop();
-            emit errorDuringConnection(CONNECT_ERROR::CTRLD_START_FAILED);
-            return;
-        }
-    #ifdef Q_OS_WIN
-        // we need to exclude these DNS-addresses from DNS leak protection on Windows
-        QStringList dnsIps;
-        dnsIps << ctrldManager_->listenIp();
-        if (IpValidation::isIp(connectedDnsInfo_.upStream1)) {
-            dnsIps << connectedDnsInfo_.upStream1;
-        }
-        dynamic_cast<Helper_win*>(helper_)->setCustomDnsIps(dnsIps);
-    #endif
-    } else {
-#ifdef Q_OS_WIN
-        dynamic_cast<Helper_win*>(helper_)->setCustomDnsIps(QStringList());
-#endif
-    }
+    // the steps before the tunnel, the independent ones overlap: the WireGuard config request and the stunnel/wstunnel launch
+    // are started first, so they go on while ctrld is being started; doConnectPart3() is called when all of them are done
+    preflight_->reset();
 
     if (currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_DEFAULT ||
             currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_STATIC_IPS)
@@ -960,38 +973,31 @@ void ConnectionManager::doConnectPart2()
                 } else {
                     localPort = wstunnelManager_->getPort();
                 }
+                // finished in onWstunnelStarted slot
+                preflight_->addStep(kPreflightTunnelProcess, QStringList(), [this]() { startTunnelProcess(); });
             }
 
-            const bool bOvpnSuccess = makeOVPNFile_->generate(
-                lastOvpnConfig_, currentConnectionDescr_.ip, currentConnectionDescr_.protocol,
-                currentConnectionDescr_.port, localPort, mss, defaultAdapterInfo_.gateway(),
-                currentConnectionDescr_.verifyX509name,
-                connectedDnsTypeAuto() ? "" : ctrldManager_->listenIp());
-            if (!bOvpnSuccess) {
-                qCDebug(LOG_CONNECTION) << "Failed create ovpn config";
-                WS_ASSERT(false);
-                return;
-            }
-
-            if (currentConnectionDescr_.protocol == types::Protocol::STUNNEL) {
-                if (!stunnelManager_->runProcess(currentConnectionDescr_.ip, currentConnectionDescr_.port)) {
-                    disconnect();
-                    timerReconnection_.stop();
-                    emit errorDuringConnection(CONNECT_ERROR::EXE_VERIFY_STUNNEL_ERROR);
-                    return;
-                }
-                // call doConnectPart2 in onWstunnelStarted slot
-                return;
-            } else if (currentConnectionDescr_.protocol == types::Protocol::WSTUNNEL) {
-                if (!wstunnelManager_->runProcess(currentConnectionDescr_.ip, currentConnectionDescr_.port)) {
+            addCtrldPreflightStep();
+            // the config has the listen address of ctrld
+            preflight_->addStep(kPreflightOvpnConfig, QStringList() << kPreflightCtrld, [this, localPort, mss]()
+            {
+                const bool bOvpnSuccess = makeOVPNFile_->generate(
+                    lastOvpnConfig_, currentConnectionDescr_.ip, currentConnectionDescr_.protocol,
+                    currentConnectionDescr_.port, localPort, mss, defaultAdapterInfo_.gateway(),
+                    currentConnectionDescr_.verifyX509name,
+                    connectedDnsTypeAuto() ? "" : ctrldManager_->listenIp());
+                if (!bOvpnSuccess) {
+                    // the preflight would wait for this step forever, so the connection fails here
+                    qCDebug(LOG_CONNECTION) << "Failed create ovpn config";
+                    stunnelManager_->killProcess();
+                    wstunnelManager_->killProcess();
                     disconnect();
                     timerReconnection_.stop();
-                    emit errorDuringConnection(CONNECT_ERROR::EXE_VERIFY_WSTUNNEL_ERROR);
+                    emit errorDuringConnection(CONNECT_ERROR::CANT_RUN_OPENVPN);
                     return;
                 }
-                // call doConnectPart2 in onWstunnelStarted slot
-                return;
-            }
+                preflight_->finishStep(kPreflightOvpnConfig);
+            });
         }
         else if (currentConnectionDescr_.protocol.isIkev2Protocol())
         {
@@ -1004,13 +1010,19 @@ void ConnectionManager::doConnectPart2()
                 qCDebug(LOG_CONNECTION) << "Use data from extra config: hostname=" << currentConnectionDescr_.hostname << ", ip=" << currentConnectionDescr_.ip << ", remoteId=" << currentConnectionDescr_.dnsHostName;
 
             }
+            addCtrldPreflightStep();
         }
         else if (currentConnectionDescr_.protocol.isWireGuardProtocol())
         {
-            qCDebug(LOG_CONNECTION) << "Requesting WireGuard config for hostname =" << currentConnectionDescr_.hostname;
-            QString deviceId = (isStaticIpsLocation() ? GetDeviceId::instance().getDeviceId() : QString());
-            getWireGuardConfig_->getWireGuardConfig(currentConnectionDescr_.hostname, false, deviceId);
-            return;
+            // finished in onGetWireGuardConfigAnswer slot
+            preflight_->addStep(kPreflightWireGuardConfig, QStringList(), [this]()
+            {
+                qCDebug(LOG_CONNECTION) << "Requesting WireGuard config for hostname =" << currentConnectionDescr_.hostname;
+                wireGuardConfigGeneration_ = preflight_->generation();
+                QString deviceId = (isStaticIpsLocation() ? GetDeviceId::instance().getDeviceId() : QString());
+                getWireGuardConfig_->getWireGuardConfig(currentConnectionDescr_.hostname, false, deviceId);
+            });
+            addCtrldPreflightStep();
         }
     }
     else if (currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_CUSTOM_CONFIG)
@@ -1040,17 +1052,76 @@ void ConnectionManager::doConnectPart2()
                 return;
             }
         }
+        addCtrldPreflightStep();
     }
     else
     {
         WS_ASSERT(false);
     }
 
-    doConnectPart3();
+    preflight_->start();
+}
+
+void ConnectionManager::addCtrldPreflightStep()
+{
+    preflight_->addStep(kPreflightCtrld, QStringList(), [this]()
+    {
+        // start ctrld utility
+        if (connectedDnsInfo_.type == CONNECTED_DNS_TYPE_CUSTOM) {
+            bool bStarted = false;
+            if (connectedDnsInfo_.isSplitDns)
+                bStarted = ctrldManager_->runProcess(connectedDnsInfo_.upStream1, connectedDnsInfo_.upStream2, connectedDnsInfo_.hostnames);
+            else
+                bStarted = ctrldManager_->runProcess(connectedDnsInfo_.upStream1, QString(), QStringList());
+
+            if (!bStarted) {
+                // the tunnel process may have been started already
+                stunnelManager_->killProcess();
+                wstunnelManager_->killProcess();
+                disconnect();
+                timerReconnection_.stop();
+                emit errorDuringConnection(CONNECT_ERROR::CTRLD_START_FAILED);
+                return;
+            }
+        #ifdef Q_OS_WIN
+            // we need to exclude these DNS-addresses from DNS leak protection on Windows
+            QStringList dnsIps;
+            dnsIps << ctrldManager_->listenIp();
+            if (IpValidation::isIp(connectedDnsInfo_.upStream1)) {
+                dnsIps << connectedDnsInfo_.upStream1;
+            }
+            dynamic_cast<Helper_win*>(helper_)->setCustomDnsIps(dnsIps);
+        #endif
+        } else {
+#ifdef Q_OS_WIN
+            dynamic_cast<Helper_win*>(helper_)->setCustomDnsIps(QStringList());
+#endif
+        }
+        preflight_->finishStep(kPreflightCtrld);
+    });
+}
+
+void ConnectionManager::startTunnelProcess()
+{
+    tunnelProcessGeneration_ = preflight_->generation();
+    if (currentConnectionDescr_.protocol == types::Protocol::STUNNEL) {
+        if (!stunnelManager_->runProcess(currentConnectionDescr_.ip, currentConnectionDescr_.port)) {
+            disconnect();
+            timerReconnection_.stop();
+            emit errorDuringConnection(CONNECT_ERROR::EXE_VERIFY_STUNNEL_ERROR);
+        }
+    } else {
+        if (!wstunnelManager_->runProcess(currentConnectionDescr_.ip, currentConnectionDescr_.port)) {
+            disconnect();
+            timerReconnection_.stop();
+            emit errorDuringConnection(CONNECT_ERROR::EXE_VERIFY_WSTUNNEL_ERROR);
+        }
+    }
 }
 
 void ConnectionManager::doConnectPart3()
 {
+    WS_TRACE_SCOPE("connection", "ConnectionManager::doConnectPart3");
     if (currentConnectionDescr_.protocol.isWireGuardProtocol())
     {
         WireGuardConfig* pConfig = (currentConnectionDescr_.connectionNodeType == CONNECTION_NODE_CUSTOM_CONFIG ? currentConnectionDescr_.wgCustomConfig.get() : &wireGuardConfig_);
@@ -1149,6 +1220,10 @@ void ConnectionManager::doConnectPart3()
         }
     }
 
+    // from the start of the tunnel process to the end of the handshake
+    endTunnelTrace();
+    WS_TRACE_ASYNC_BEGIN("connection", "tunnel", connector_);
+    tunnelTraceId_ = connector_;
     lastIp_ = currentConnectionDescr_.ip;
 }
 
@@ -1156,6 +1231,10 @@ void ConnectionManager::doConnectPart3()
 bool ConnectionManager::checkFails()
 {
     connSettingsPolicy_->putFailedConnection();
+    // the failover has moved on from the first protocol and may get to WireGuard, its key-pair is registered
+    // while the next protocols are tried (nothing is done if there is one already)
+    if (connSettingsPolicy_->isAutomaticMode() && !connSettingsPolicy_->isFailed() && !bli_->locationId().isCustomConfigsLocation())
+        getWireGuardConfig_->prefetchKeyPair();
     return connSettingsPolicy_->isFailed();
 }
 
@@ -1263,6 +1342,7 @@ void ConnectionManager::restoreConnectionAfterWakeUp()
 
 void ConnectionManager::onTunnelTestsFinished(bool bSuccess, const QString &ipAddress)
 {
+    WS_TRACE_ASYNC_END("connection", "tunnel tests", testVPNTunnel_);
     bool hasAttempts = false;
     int attempts = ExtraConfig::instance().getTunnelTestAttempts(hasAttempts);
     bool noError = ExtraConfig::instance().getIsTunnelTestNoError();
@@ -1332,6 +1412,7 @@ void ConnectionManager::onTimerWaitNetworkConnectivity()
 
 void ConnectionManager::onHostnamesResolved()
 {
+    WS_TRACE_ASYNC_END("connection", "resolve hostnames", connSettingsPolicy_.get());
     doConnectPart2();
 }
 
@@ -1361,7 +1442,7 @@ void ConnectionManager::onGetWireGuardConfigAnswer(WireGuardConfigRetCode retCod
             return;
         }
 
-        doConnectPart3();
+        preflight_->finishStep(kPreflightWireGuardConfig, wireGuardConfigGeneration_);
     }
     else
     {
@@ -1417,6 +1498,7 @@ void ConnectionManager::setPacketSize(types::PacketSize ps)
 
 void ConnectionManager::startTunnelTests()
 {
+    WS_TRACE_ASYNC_BEGIN("connection", "tunnel tests", testVPNTunnel_);
     testVPNTunnel_->startTests(currentConnectionDescr_.protocol);
 }
 
@@ -1512,10 +1594,30 @@ bool ConnectionManager::connectedDnsTypeAuto() const
 
 void ConnectionManager::disconnect()
 {
+    preflight_->reset();
+    endTunnelTrace();
+    endConnectTrace();
     Logger::instance().endConnectionMode();
     state_ = STATE_DISCONNECTED;
 }
 
+void ConnectionManager::endConnectTrace()
+{
+    if (isConnectTraced_) {
+        WS_TRACE_ASYNC_END("connection", "connect", this);
+        isConnectTraced_ = false;
+    }
+}
+
+void ConnectionManager::endTunnelTrace()
+{
+    // the connector may have been replaced since the span was begun
+    if (tunnelTraceId_) {
+        WS_TRACE_ASYNC_END("connection", "tunnel", tunnelTraceId_);
+        tunnelTraceId_ = nullptr;
+    }
+}
+
 void ConnectionManager::onConnectTrigger()
 {
     doConnect();
@@ -1528,6 +1630,8 @@ void ConnectionManager::setLastKnownGoodProtocol(const types::Protocol protocol)
 void ConnectionManager::onConnectingTimeout()
 {
     qCDebug(LOG_CONNECTION) << "Connection timed out";
+    preflight_->reset();
+    endTunnelTrace();
     state_ = STATE_RECONNECTING;
     emit reconnecting();
     startReconnectionTimer();
@@ -10,6 +10,7 @@
 #include "makeovpnfilefromcustom.h"
 
 #include "iconnection.h"
+#include "connectpreflight.h"
 #include "testvpntunnel.h"
 #include "engine/wireguardconfig/wireguardconfig.h"
 #include "engine/wireguardconfig/getwireguardconfig.h"
@@ -202,6 +203,15 @@ private:
     WireGuardConfig wireGuardConfig_;
     GetWireGuardConfig *getWireGuardConfig_;
 
+    ConnectPreflight *preflight_;
+    // the preflight generations of the steps finished from the slots, see ConnectPreflight::generation()
+    int tunnelProcessGeneration_;
+    int wireGuardConfigGeneration_;
+    QElapsedTimer clickElapsedTimer_;
+    // the "connect" span from the click and the "tunnel" span of the current connector, ended on every way out
+    bool isConnectTraced_;
+    const void *tunnelTraceId_;
+
     AdapterGatewayInfo defaultAdapterInfo_;
     AdapterGatewayInfo vpnAdapterInfo_;
 
@@ -213,6 +223,8 @@ private:
 
     void doConnect();
     void doConnectPart2();
+    void addCtrldPreflightStep();
+    void startTunnelProcess();
     void doConnectPart3();
     bool checkFails();
 
@@ -229,4 +241,6 @@ private:
 
     bool connectedDnsTypeAuto() const;
     void disconnect();
+    void endConnectTrace();
+    void endTunnelTrace();
 };
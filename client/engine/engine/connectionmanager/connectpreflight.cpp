@@ -0,0 +1,139 @@
+#include "connectpreflight.h"
+
+#include "utils/logger.h"
+#include "utils/tracing.h"
+#include "utils/ws_assert.h"
+
+ConnectPreflight::ConnectPreflight(QObject *parent) : QObject(parent),
+    isRunning_(false), isStartingSteps_(false), generation_(0)
+{
+}
+
+void ConnectPreflight::reset()
+{
+    steps_.clear();
+    isRunning_ = false;
+    isStartingSteps_ = false;
+    generation_++;
+}
+
+void ConnectPreflight::addStep(const QString &name, const QStringList &dependsOn, std::function<void()> start)
+{
+    WS_ASSERT(!isRunning_);
+    WS_ASSERT(indexOf(name) == -1);
+    // the dependencies are added first, so the graph has no cycles
+    for (const QString &dependency : dependsOn)
+        WS_ASSERT(indexOf(dependency) != -1);
+
+    Step step;
+    step.name = name;
+    step.dependsOn = dependsOn;
+    step.start = std::move(start);
+    steps_ << step;
+}
+
+void ConnectPreflight::start()
+{
+    WS_ASSERT(!isRunning_);
+    isRunning_ = true;
+    elapsedTimer_.start();
+    startReadySteps();
+}
+
+void ConnectPreflight::finishStep(const QString &name)
+{
+    const int ind = indexOf(name);
+    if (!isRunning_ || ind == -1 || steps_[ind].state != kRunning)
+        return;
+
+    steps_[ind].state = kDone;
+    steps_[ind].finishMs = elapsedTimer_.elapsed();
+    WS_TRACE_ASYNC_END("connection", tracing::internName("preflight: " + name), &steps_[ind]);
+    startReadySteps();
+}
+
+void ConnectPreflight::finishStep(const QString &name, int generation)
+{
+    if (generation == generation_)
+        finishStep(name);
+}
+
+bool ConnectPreflight::isRunning() const
+{
+    return isRunning_;
+}
+
+bool ConnectPreflight::isStepRunning(const QString &name) const
+{
+    const int ind = indexOf(name);
+    return isRunning_ && ind != -1 && steps_[ind].state == kRunning;
+}
+
+QString ConnectPreflight::timingsLogString() const
+{
+    QStringList list;
+    qint64 totalMs = 0;
+    for (const Step &step : steps_) {
+        if (step.state == kDone) {
+            list << QString("%1 %2-%3 ms").arg(step.name).arg(step.startMs).arg(step.finishMs);
+            totalMs = qMax(totalMs, step.finishMs);
+        } else {
+            list << QString("%1 not finished").arg(step.name);
+        }
+    }
+    return list.join(", ") + QString("; total %1 ms").arg(totalMs);
+}
+
+int ConnectPreflight::indexOf(const QString &name) const
+{
+    for (int i = 0; i < steps_.size(); ++i) {
+        if (steps_[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+bool ConnectPreflight::isReady(const Step &step) const
+{
+    for (const QString &dependency : step.dependsOn) {
+        if (steps_[indexOf(dependency)].state != kDone)
+            return false;
+    }
+    return true;
+}
+
+void ConnectPreflight::startReadySteps()
+{
+    // a step which finishes inside its start function is picked up by the loop below
+    if (isStartingSteps_)
+        return;
+    isStartingSteps_ = true;
+
+    const int generation = generation_;
+    bool isStarted = true;
+    while (isStarted) {
+        isStarted = false;
+        for (int i = 0; i < steps_.size(); ++i) {
+            if (steps_[i].state != kWaiting || !isReady(steps_[i]))
+                continue;
+            steps_[i].state = kRunning;
+            steps_[i].startMs = elapsedTimer_.elapsed();
+            isStarted = true;
+            WS_TRACE_ASYNC_BEGIN("connection", tracing::internName("preflight: " + steps_[i].name), &steps_[i]);
+            // a copy, the step may reset the preflight (a failed step) and clear the steps
+            std::function<void()> start = steps_[i].start;
+            start();
+            if (generation != generation_)
+                return;
+        }
+    }
+    isStartingSteps_ = false;
+
+    for (const Step &step : steps_) {
+        if (step.state != kDone)
+            return;
+    }
+    isRunning_ = false;
+    qCDebug(LOG_CONNECTION) << "Connect preflight:" << timingsLogString();
+    emit finished();
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <functional>
+
+// Runs the preparation steps of a connection attempt (before the tunnel is started) as a dependency graph:
+// a step starts as soon as all the steps it depends on are done, so the independent ones overlap.
+// A step is a function which starts the work; the work reports back with finishStep(), either right away or later
+// from a slot. Everything runs on the thread of the owner, the steps overlap because they wait on the network or
+// on other processes. The start and the duration of each step are logged when all of them are done.
+class ConnectPreflight : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ConnectPreflight(QObject *parent);
+
+    // forgets the steps of the previous run; a late finishStep() of its steps is ignored while the step of that name
+    // is not running, the ones that may come later must pass the generation
+    void reset();
+    void addStep(const QString &name, const QStringList &dependsOn, std::function<void()> start);
+    void start();
+    void finishStep(const QString &name);
+    // for the work that reports back later: the generation taken when the step started, so an answer which belongs
+    // to a previous run doesn't finish the step of the same name in the current one
+    int generation() const { return generation_; }
+    void finishStep(const QString &name, int generation);
+
+    bool isRunning() const;
+    bool isStepRunning(const QString &name) const;
+    QString timingsLogString() const;
+
+signals:
+    void finished();
+
+private:
+    enum StepState { kWaiting, kRunning, kDone };
+
+    struct Step
+    {
+        QString name;
+        QStringList dependsOn;
+        std::function<void()> start;
+        StepState state = kWaiting;
+        qint64 startMs = 0;
+        qint64 finishMs = 0;
+    };
+
+    QVector<Step> steps_;
+    QElapsedTimer elapsedTimer_;
+    bool isRunning_;
+    bool isStartingSteps_;
+    // incremented on every reset, so a run that was reset from inside a step is not continued
+    int generation_;
+
+    int indexOf(const QString &name) const;
+    bool isReady(const Step &step) const;
+    void startReadySteps();
+};
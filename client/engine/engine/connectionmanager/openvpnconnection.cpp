@@ -1,4 +1,5 @@
 #include <QStringRef>
+#include <cctype>
 
 #include "openvpnconnection.h"
 #include "utils/ws_assert.h"
@@ -342,40 +343,53 @@ void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t
     if (err.value() == 0)
     {
         std::istream is(stateVariables_.buffer.get());
-        std::string resultLine;
-        std::getline(is, resultLine);
+        std::getline(is, readLine_);
 
-        QString serverReply = QString::fromStdString(resultLine).trimmed();
+        // trimmed without a copy, the QString is created only when it is needed
+        const char *begin = readLine_.data();
+        const char *end = begin + readLine_.size();
+        while (begin < end && isspace(static_cast<unsigned char>(*begin)))
+            ++begin;
+        while (end > begin && isspace(static_cast<unsigned char>(*(end - 1))))
+            --end;
+        const QByteArray line = QByteArray::fromRawData(begin, static_cast<int>(end - begin));
+
+        const OpenVPNManagementParser::Message reply = managementParser_.parse(line);
 
         boost::system::error_code write_error;
         // skip log out BYTECOUNT
-        if (!serverReply.contains(">BYTECOUNT:", Qt::CaseInsensitive))
+        if (reply.type != OpenVPNManagementParser::BYTECOUNT)
         {
-            qCDebug(LOG_OPENVPN) << serverReply;
+            qCDebug(LOG_OPENVPN) << QString::fromUtf8(line);
         }
-        if (serverReply.contains("HOLD:Waiting for hold release", Qt::CaseInsensitive))
+
+        switch (reply.type)
         {
+        case OpenVPNManagementParser::HOLD_WAITING_RELEASE:
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer("state on all\n"), boost::asio::transfer_all(), write_error);
-        }
-        else if (serverReply.startsWith("END") && stateVariables_.bWasStateNotification)
-        {
-            boost::asio::write(*stateVariables_.socket, boost::asio::buffer("log on\n"), boost::asio::transfer_all(), write_error);
-        }
-        else if (serverReply.contains("SUCCESS: real-time state notification set to ON", Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::END:
+            if (stateVariables_.bWasStateNotification)
+            {
+                boost::asio::write(*stateVariables_.socket, boost::asio::buffer("log on\n"), boost::asio::transfer_all(), write_error);
+            }
+            break;
+
+        case OpenVPNManagementParser::STATE_NOTIFICATION_ON:
             stateVariables_.bWasStateNotification = true;
             stateVariables_.isAcceptSigTermCommand_ = true;
-        }
-        else if (serverReply.contains("SUCCESS: real-time log notification set to ON", Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::LOG_NOTIFICATION_ON:
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer("bytecount 1\n"), boost::asio::transfer_all(), write_error);
-        }
-        else if (serverReply.contains("SUCCESS: bytecount interval changed", Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::BYTECOUNT_INTERVAL_CHANGED:
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer("hold release\n"), boost::asio::transfer_all(), write_error);
-        }
-        else if (serverReply.contains("PASSWORD:Need 'Auth' username/password", Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::NEED_AUTH_USERNAME:
             if (!username_.isEmpty())
             {
                 char message[1024];
@@ -386,21 +400,25 @@ void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t
             {
                 emit requestUsername();
             }
-        }
-        else if (serverReply.contains("PASSWORD:Need 'HTTP Proxy' username/password", Qt::CaseInsensitive))
+            break;
+
+        case OpenVPNManagementParser::NEED_PROXY_USERNAME:
         {
             char message[1024];
             snprintf(message, 1024, "username \"HTTP Proxy\" %s\n", proxySettings_.getUsername().toUtf8().data());
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer(message,strlen(message)), boost::asio::transfer_all(), write_error);
+            break;
         }
-        else if (serverReply.contains("'HTTP Proxy' username entered, but not yet verified", Qt::CaseInsensitive))
+
+        case OpenVPNManagementParser::PROXY_USERNAME_ENTERED:
         {
             char message[1024];
             snprintf(message, 1024, "password \"HTTP Proxy\" %s\n", proxySettings_.getPassword().toUtf8().data());
             boost::asio::write(*stateVariables_.socket, boost::asio::buffer(message, strlen(message)), boost::asio::transfer_all(), write_error);
+            break;
         }
-        else if (serverReply.contains("'Auth' username entered, but not yet verified", Qt::CaseInsensitive))
-        {
+
+        case OpenVPNManagementParser::AUTH_USERNAME_ENTERED:
             if (!password_.isEmpty())
             {
                 // See Command Parsing paragraph in management-notes.txt file of openvpn sources.
@@ -417,9 +435,9 @@ void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t
             {
                 emit requestPassword();
             }
-        }
-        else if (serverReply.contains("PASSWORD:Verification Failed: 'Auth'", Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::AUTH_VERIFICATION_FAILED:
             emit error(CONNECT_ERROR::AUTH_ERROR);
             if (!stateVariables_.bSigTermSent)
             {
@@ -427,10 +445,9 @@ void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t
                 helper_->clearUnblockingCmd(stateVariables_.lastCmdId);
                 stateVariables_.bSigTermSent = true;
             }
-        }
-        else if (serverReply.contains("There are no TAP-Windows", Qt::CaseInsensitive) && serverReply.contains("Wintun",Qt::CaseInsensitive) &&
-                 serverReply.contains("adapters on this system.",Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::NO_TAP_ADAPTERS:
             if (!stateVariables_.bTapErrorEmited)
             {
                 emit error(CONNECT_ERROR::NO_INSTALLED_TUN_TAP);
@@ -442,153 +459,138 @@ void OpenVPNConnection::handleRead(const boost::system::error_code &err, size_t
                     stateVariables_.bSigTermSent = true;
                 }
             }
-        }
-        else if (serverReply.startsWith(">BYTECOUNT:", Qt::CaseInsensitive))
-        {
-            QStringList pars = serverReply.split(":");
-            if (pars.count() > 1)
-            {
-                QStringList pars2 = pars[1].split(",");
-                if (pars2.count() == 2)
-                {
-                    quint64 l1 = pars2[0].toULongLong();
-                    quint64 l2 = pars2[1].toULongLong();
-                    if (stateVariables_.bFirstCalcStat)
-                    {
-                        stateVariables_.prevBytesRcved = l1;
-                        stateVariables_.prevBytesXmited = l2;
-                        emit statisticsUpdated(stateVariables_.prevBytesRcved, stateVariables_.prevBytesXmited, false);
-                        stateVariables_.bFirstCalcStat = false;
-                    }
-                    else
-                    {
-                        emit statisticsUpdated(l1 - stateVariables_.prevBytesRcved, l2 - stateVariables_.prevBytesXmited, false);
-                        stateVariables_.prevBytesRcved = l1;
-                        stateVariables_.prevBytesXmited = l2;
-                    }
-                }
-            }
-        }
-        else if (serverReply.startsWith(">STATE:", Qt::CaseInsensitive))
-        {
-            if (serverReply.contains("CONNECTED,SUCCESS", Qt::CaseInsensitive))
-            {
-#ifdef Q_OS_WIN
-                AdapterGatewayInfo windscribeAdapter = AdapterUtils_win::getConnectedAdapterInfo(QString::fromWCharArray(kOpenVPNAdapterIdentifier));
-                if (!windscribeAdapter.isEmpty())
-                {
-                    if (connectionAdapterInfo_.adapterIp() != windscribeAdapter.adapterIp())
-                    {
-                        qCDebug(LOG_CONNECTION) << "Error: Adapter IP detected from openvpn log not equal to the adapter IP from AdapterUtils_win::getWindscribeConnectedAdapterInfo()";
-                        WS_ASSERT(false);
-                    }
-                    connectionAdapterInfo_.setAdapterName(windscribeAdapter.adapterName());
-                    connectionAdapterInfo_.setAdapterIp(windscribeAdapter.adapterIp());
-                    connectionAdapterInfo_.setDnsServers(windscribeAdapter.dnsServers());
-                    connectionAdapterInfo_.setIfIndex(windscribeAdapter.ifIndex());
-                }
-                else
-                {
-                    qCDebug(LOG_CONNECTION) << "Can't detect connected Windscribe adapter";
-                }
-#endif
+            break;
 
-                QString remoteIp;
-                if (parseConnectedSuccessReply(serverReply, remoteIp))
-                {
-                    connectionAdapterInfo_.setRemoteIp(remoteIp);
-                }
-                else
-                {
-                    qCDebug(LOG_CONNECTION) << "Can't parse CONNECTED,SUCCESS control message";
-                }
-                setCurrentState(STATUS_CONNECTED);
-                emit connected(connectionAdapterInfo_);
-            }
-            else if (serverReply.contains("CONNECTED,ERROR", Qt::CaseInsensitive))
+        case OpenVPNManagementParser::BYTECOUNT:
+            if (stateVariables_.bFirstCalcStat)
             {
-                setCurrentState(STATUS_CONNECTED);
-                emit error(CONNECT_ERROR::CONNECTED_ERROR);
+                stateVariables_.prevBytesRcved = reply.bytesReceived;
+                stateVariables_.prevBytesXmited = reply.bytesSent;
+                emit statisticsUpdated(stateVariables_.prevBytesRcved, stateVariables_.prevBytesXmited, false);
+                stateVariables_.bFirstCalcStat = false;
             }
-            else if (serverReply.contains("RECONNECTING", Qt::CaseInsensitive))
+            else
             {
-                stateVariables_.isAcceptSigTermCommand_ = false;
-                stateVariables_.bWasStateNotification = false;
-                setCurrentState(STATUS_CONNECTED_TO_SOCKET);
-                emit reconnecting();
+                emit statisticsUpdated(reply.bytesReceived - stateVariables_.prevBytesRcved, reply.bytesSent - stateVariables_.prevBytesXmited, false);
+                stateVariables_.prevBytesRcved = reply.bytesReceived;
+                stateVariables_.prevBytesXmited = reply.bytesSent;
             }
-        }
-        else if (serverReply.startsWith(">LOG:", Qt::CaseInsensitive))
+            break;
+
+        case OpenVPNManagementParser::STATE_CONNECTED_SUCCESS:
         {
-            bool bContainsUDPWord = serverReply.contains("UDP", Qt::CaseInsensitive);
-            if (bContainsUDPWord && serverReply.contains("No buffer space available (WSAENOBUFS) (code=10055)", Qt::CaseInsensitive))
-            {
-                emit error(CONNECT_ERROR::UDP_CANT_ASSIGN);
-            }
-            else if (bContainsUDPWord && serverReply.contains("No Route to Host (WSAEHOSTUNREACH) (code=10065)", Qt::CaseInsensitive))
-            {
-                emit error(CONNECT_ERROR::UDP_CANT_ASSIGN);
-            }
-            else if (bContainsUDPWord && serverReply.contains("Can't assign requested address (code=49)", Qt::CaseInsensitive))
-            {
-                emit error(CONNECT_ERROR::UDP_CANT_ASSIGN);
-            }
-            else if (bContainsUDPWord && serverReply.contains("No buffer space available (code=55)", Qt::CaseInsensitive))
+#ifdef Q_OS_WIN
+            AdapterGatewayInfo windscribeAdapter = AdapterUtils_win::getConnectedAdapterInfo(QString::fromWCharArray(kOpenVPNAdapterIdentifier));
+            if (!windscribeAdapter.isEmpty())
             {
-                emit error(CONNECT_ERROR::UDP_NO_BUFFER_SPACE);
+                if (connectionAdapterInfo_.adapterIp() != windscribeAdapter.adapterIp())
+                {
+                    qCDebug(LOG_CONNECTION) << "Error: Adapter IP detected from openvpn log not equal to the adapter IP from AdapterUtils_win::getWindscribeConnectedAdapterInfo()";
+                    WS_ASSERT(false);
+                }
+                connectionAdapterInfo_.setAdapterName(windscribeAdapter.adapterName());
+                connectionAdapterInfo_.setAdapterIp(windscribeAdapter.adapterIp());
+                connectionAdapterInfo_.setDnsServers(windscribeAdapter.dnsServers());
+                connectionAdapterInfo_.setIfIndex(windscribeAdapter.ifIndex());
             }
-            else if (bContainsUDPWord && serverReply.contains("Network is down (code=50)", Qt::CaseInsensitive))
+            else
             {
-                emit error(CONNECT_ERROR::UDP_NETWORK_DOWN);
+                qCDebug(LOG_CONNECTION) << "Can't detect connected Windscribe adapter";
             }
-            else if (serverReply.contains("write_wintun", Qt::CaseInsensitive) && serverReply.contains("head/tail value is over capacity", Qt::CaseInsensitive))
+#endif
+
+            QString remoteIp;
+            if (parseConnectedSuccessReply(QString::fromUtf8(line), remoteIp))
             {
-                emit error(CONNECT_ERROR::WINTUN_OVER_CAPACITY);
+                connectionAdapterInfo_.setRemoteIp(remoteIp);
             }
-            else if (serverReply.contains("TCP:", Qt::CaseInsensitive) && serverReply.contains("failed", Qt::CaseInsensitive))
+            else
             {
-                emit error(CONNECT_ERROR::TCP_ERROR);
+                qCDebug(LOG_CONNECTION) << "Can't parse CONNECTED,SUCCESS control message";
             }
-            else if (serverReply.contains("Initialization Sequence Completed With Errors", Qt::CaseInsensitive))
+            setCurrentState(STATUS_CONNECTED);
+            emit connected(connectionAdapterInfo_);
+            break;
+        }
+
+        case OpenVPNManagementParser::STATE_CONNECTED_ERROR:
+            setCurrentState(STATUS_CONNECTED);
+            emit error(CONNECT_ERROR::CONNECTED_ERROR);
+            break;
+
+        case OpenVPNManagementParser::STATE_RECONNECTING:
+            stateVariables_.isAcceptSigTermCommand_ = false;
+            stateVariables_.bWasStateNotification = false;
+            setCurrentState(STATUS_CONNECTED_TO_SOCKET);
+            emit reconnecting();
+            break;
+
+        case OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN:
+            emit error(CONNECT_ERROR::UDP_CANT_ASSIGN);
+            break;
+
+        case OpenVPNManagementParser::LOG_UDP_NO_BUFFER_SPACE:
+            emit error(CONNECT_ERROR::UDP_NO_BUFFER_SPACE);
+            break;
+
+        case OpenVPNManagementParser::LOG_UDP_NETWORK_DOWN:
+            emit error(CONNECT_ERROR::UDP_NETWORK_DOWN);
+            break;
+
+        case OpenVPNManagementParser::LOG_WINTUN_OVER_CAPACITY:
+            emit error(CONNECT_ERROR::WINTUN_OVER_CAPACITY);
+            break;
+
+        case OpenVPNManagementParser::LOG_TCP_ERROR:
+            emit error(CONNECT_ERROR::TCP_ERROR);
+            break;
+
+        case OpenVPNManagementParser::LOG_INITIALIZATION_COMPLETED_WITH_ERRORS:
+            emit error(CONNECT_ERROR::INITIALIZATION_SEQUENCE_COMPLETED_WITH_ERRORS);
+            break;
+
+        case OpenVPNManagementParser::LOG_DEVICE_OPENED:
+        {
+            QString deviceName;
+            if (parseDeviceOpenedReply(QString::fromUtf8(line), deviceName))
             {
-                emit error(CONNECT_ERROR::INITIALIZATION_SEQUENCE_COMPLETED_WITH_ERRORS);
+                connectionAdapterInfo_.setAdapterName(deviceName);
             }
-#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
-            else if (serverReply.contains("device", Qt::CaseInsensitive) && serverReply.contains("opened", Qt::CaseInsensitive))
+            break;
+        }
+
+        case OpenVPNManagementParser::LOG_PUSH_REPLY:
+        {
+            bool isRedirectDefaultGateway = true;
+            if (!parsePushReply(QString::fromUtf8(line), connectionAdapterInfo_, isRedirectDefaultGateway))
             {
-                QString deviceName;
-                if (parseDeviceOpenedReply(serverReply, deviceName))
-                {
-                    connectionAdapterInfo_.setAdapterName(deviceName);
-                }
+                qCDebug(LOG_CONNECTION) << "Can't parse PUSH Received control message";
             }
-#endif
-            else if (serverReply.contains("PUSH: Received control message:", Qt::CaseInsensitive))
-            {
-                bool isRedirectDefaultGateway = true;
-                if (!parsePushReply(serverReply, connectionAdapterInfo_, isRedirectDefaultGateway))
-                {
-                    qCDebug(LOG_CONNECTION) << "Can't parse PUSH Received control message";
-                }
 
-                if (isRedirectDefaultGateway)
-                {
-                    // We are going to set up the default gateway, so firewall is allowed after
-                    // we have connected (unless the current custom config explicitly forbits this).
-                    isAllowFirewallAfterCustomConfigConnection_ = true;
-                }
-            } else if (serverReply.contains("write UDP: Unknown error (code=10065)") || serverReply.contains("write UDP: Unknown error (code=10054)")) {
-                // These errors indicate socket was closed or otherwise unavailable for writing.
-                setCurrentStateAndEmitDisconnected(STATUS_DISCONNECTED);
+            if (isRedirectDefaultGateway)
+            {
+                // We are going to set up the default gateway, so firewall is allowed after
+                // we have connected (unless the current custom config explicitly forbits this).
+                isAllowFirewallAfterCustomConfigConnection_ = true;
             }
+            break;
         }
-        else if (serverReply.contains(">FATAL:All tap-windows6 adapters on this system are currently in use", Qt::CaseInsensitive))
-        {
+
+        case OpenVPNManagementParser::LOG_WRITE_UDP_ERROR:
+            // These errors indicate socket was closed or otherwise unavailable for writing.
+            setCurrentStateAndEmitDisconnected(STATUS_DISCONNECTED);
+            break;
+
+        case OpenVPNManagementParser::FATAL_ALL_TAP_IN_USE:
             emit error(CONNECT_ERROR::ALL_TAP_IN_USE);
-        }
-        else if (serverReply.contains(">FATAL:All wintun adapters on this system are currently in use", Qt::CaseInsensitive))
-        {
+            break;
+
+        case OpenVPNManagementParser::FATAL_ALL_WINTUN_IN_USE:
             emit error(CONNECT_ERROR::WINTUN_FATAL_ERROR);
+            break;
+
+        case OpenVPNManagementParser::UNKNOWN:
+            break;
         }
 
         checkErrorAndContinue(write_error, true);
@@ -6,9 +6,11 @@
 #include <QMutex>
 #include "engine/helper/ihelper.h"
 #include "iconnection.h"
+#include "openvpnmanagementparser.h"
 #include "types/proxysettings.h"
 #include "utils/boost_includes.h"
 #include <atomic>
+#include <string>
 
 class OpenVPNConnection : public IConnection
 {
@@ -117,6 +119,9 @@ private:
 
     AdapterGatewayInfo connectionAdapterInfo_;
 
+    OpenVPNManagementParser managementParser_;
+    std::string readLine_;      // reused between the reads
+
     void funcRunOpenVPN();
     void funcConnectToOpenVPN(const boost::system::error_code& err);
     void handleRead(const boost::system::error_code& err, size_t bytes_transferred);
@@ -0,0 +1,205 @@
+#include "openvpnmanagementparser.h"
+
+#include <QByteArrayMatcher>
+#include <vector>
+
+namespace {
+
+struct Rule
+{
+    OpenVPNManagementParser::MessageType type;
+    // all the patterns must be found, the rarest one goes first
+    std::vector<QByteArrayMatcher> patterns;
+    // searched in the original line instead of the lowercase one
+    bool isCaseSensitive = false;
+};
+
+typedef std::vector<Rule> Rules;
+
+// The lowercase patterns are searched in the lowercase line. The first matching rule wins.
+const Rules &successRules()
+{
+    static const Rules rules = {
+        { OpenVPNManagementParser::STATE_NOTIFICATION_ON, { QByteArrayMatcher("success: real-time state notification set to on") } },
+        { OpenVPNManagementParser::LOG_NOTIFICATION_ON, { QByteArrayMatcher("success: real-time log notification set to on") } },
+        { OpenVPNManagementParser::BYTECOUNT_INTERVAL_CHANGED, { QByteArrayMatcher("success: bytecount interval changed") } },
+        { OpenVPNManagementParser::PROXY_USERNAME_ENTERED, { QByteArrayMatcher("'http proxy' username entered, but not yet verified") } },
+        { OpenVPNManagementParser::AUTH_USERNAME_ENTERED, { QByteArrayMatcher("'auth' username entered, but not yet verified") } },
+    };
+    return rules;
+}
+
+const Rules &holdRules()
+{
+    static const Rules rules = {
+        { OpenVPNManagementParser::HOLD_WAITING_RELEASE, { QByteArrayMatcher("hold:waiting for hold release") } },
+    };
+    return rules;
+}
+
+const Rules &passwordRules()
+{
+    static const Rules rules = {
+        { OpenVPNManagementParser::NEED_AUTH_USERNAME, { QByteArrayMatcher("password:need 'auth' username/password") } },
+        { OpenVPNManagementParser::NEED_PROXY_USERNAME, { QByteArrayMatcher("password:need 'http proxy' username/password") } },
+        { OpenVPNManagementParser::AUTH_VERIFICATION_FAILED, { QByteArrayMatcher("password:verification failed: 'auth'") } },
+    };
+    return rules;
+}
+
+const Rules &stateRules()
+{
+    static const Rules rules = {
+        { OpenVPNManagementParser::STATE_CONNECTED_SUCCESS, { QByteArrayMatcher("connected,success") } },
+        { OpenVPNManagementParser::STATE_CONNECTED_ERROR, { QByteArrayMatcher("connected,error") } },
+        { OpenVPNManagementParser::STATE_RECONNECTING, { QByteArrayMatcher("reconnecting") } },
+    };
+    return rules;
+}
+
+const Rule &noTapAdaptersRule()
+{
+    static const Rule rule = { OpenVPNManagementParser::NO_TAP_ADAPTERS,
+                               { QByteArrayMatcher("there are no tap-windows"), QByteArrayMatcher("adapters on this system."), QByteArrayMatcher("wintun") } };
+    return rule;
+}
+
+const Rules &logRules()
+{
+    static const Rules rules = {
+        noTapAdaptersRule(),
+        { OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN, { QByteArrayMatcher("no buffer space available (wsaenobufs) (code=10055)"), QByteArrayMatcher("udp") } },
+        { OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN, { QByteArrayMatcher("no route to host (wsaehostunreach) (code=10065)"), QByteArrayMatcher("udp") } },
+        { OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN, { QByteArrayMatcher("can't assign requested address (code=49)"), QByteArrayMatcher("udp") } },
+        { OpenVPNManagementParser::LOG_UDP_NO_BUFFER_SPACE, { QByteArrayMatcher("no buffer space available (code=55)"), QByteArrayMatcher("udp") } },
+        { OpenVPNManagementParser::LOG_UDP_NETWORK_DOWN, { QByteArrayMatcher("network is down (code=50)"), QByteArrayMatcher("udp") } },
+        { OpenVPNManagementParser::LOG_WINTUN_OVER_CAPACITY, { QByteArrayMatcher("head/tail value is over capacity"), QByteArrayMatcher("write_wintun") } },
+        { OpenVPNManagementParser::LOG_TCP_ERROR, { QByteArrayMatcher("tcp:"), QByteArrayMatcher("failed") } },
+        { OpenVPNManagementParser::LOG_INITIALIZATION_COMPLETED_WITH_ERRORS, { QByteArrayMatcher("initialization sequence completed with errors") } },
+#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
+        { OpenVPNManagementParser::LOG_DEVICE_OPENED, { QByteArrayMatcher("opened"), QByteArrayMatcher("device") } },
+#endif
+        { OpenVPNManagementParser::LOG_PUSH_REPLY, { QByteArrayMatcher("push: received control message:") } },
+        { OpenVPNManagementParser::LOG_WRITE_UDP_ERROR, { QByteArrayMatcher("write UDP: Unknown error (code=10065)") }, true },
+        { OpenVPNManagementParser::LOG_WRITE_UDP_ERROR, { QByteArrayMatcher("write UDP: Unknown error (code=10054)") }, true },
+    };
+    return rules;
+}
+
+const Rules &fatalRules()
+{
+    static const Rules rules = {
+        noTapAdaptersRule(),
+        { OpenVPNManagementParser::FATAL_ALL_TAP_IN_USE, { QByteArrayMatcher(">fatal:all tap-windows6 adapters on this system are currently in use") } },
+        { OpenVPNManagementParser::FATAL_ALL_WINTUN_IN_USE, { QByteArrayMatcher(">fatal:all wintun adapters on this system are currently in use") } },
+    };
+    return rules;
+}
+
+OpenVPNManagementParser::MessageType matchRules(const Rules &rules, const QByteArray &line, const QByteArray &lowerLine)
+{
+    for (const Rule &rule : rules) {
+        const QByteArray &text = rule.isCaseSensitive ? line : lowerLine;
+        bool isMatched = true;
+        for (const QByteArrayMatcher &pattern : rule.patterns) {
+            if (pattern.indexIn(text) < 0) {
+                isMatched = false;
+                break;
+            }
+        }
+        if (isMatched) {
+            return rule.type;
+        }
+    }
+    return OpenVPNManagementParser::UNKNOWN;
+}
+
+bool startsWithNoCase(const char *data, int size, const char *prefix, int prefixSize)
+{
+    return size >= prefixSize && qstrnicmp(data, prefix, prefixSize) == 0;
+}
+
+} // namespace
+
+OpenVPNManagementParser::Message OpenVPNManagementParser::parse(const QByteArray &line)
+{
+    Message message;
+    const char *data = line.constData();
+    const int size = line.size();
+
+    if (size == 0) {
+        return message;
+    }
+
+    if (data[0] != '>') {
+        // a reply to a command
+        if (line.startsWith("END")) {
+            message.type = END;
+        } else if (startsWithNoCase(data, size, "SUCCESS:", 8)) {
+            message.type = matchRules(successRules(), line, toLower(line));
+        }
+        return message;
+    }
+
+    // a real-time message, ">TYPE:text"
+    const char *text = data + 1;
+    const int textSize = size - 1;
+    if (startsWithNoCase(text, textSize, "BYTECOUNT:", 10)) {
+        if (parseByteCount(text + 10, textSize - 10, message)) {
+            message.type = BYTECOUNT;
+        }
+    } else if (startsWithNoCase(text, textSize, "LOG:", 4)) {
+        message.type = matchRules(logRules(), line, toLower(line));
+    } else if (startsWithNoCase(text, textSize, "STATE:", 6)) {
+        message.type = matchRules(stateRules(), line, toLower(line));
+    } else if (startsWithNoCase(text, textSize, "PASSWORD:", 9)) {
+        message.type = matchRules(passwordRules(), line, toLower(line));
+    } else if (startsWithNoCase(text, textSize, "HOLD:", 5)) {
+        message.type = matchRules(holdRules(), line, toLower(line));
+    } else if (startsWithNoCase(text, textSize, "FATAL:", 6)) {
+        message.type = matchRules(fatalRules(), line, toLower(line));
+    }
+    return message;
+}
+
+const QByteArray &OpenVPNManagementParser::toLower(const QByteArray &line)
+{
+    // the capacity is kept by resize(), so there are no allocations after the first long lines
+    lowerLine_.resize(line.size());
+    const char *src = line.constData();
+    char *dst = lowerLine_.data();
+    for (int i = 0; i < line.size(); ++i) {
+        const char c = src[i];
+        dst[i] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    }
+    return lowerLine_;
+}
+
+bool OpenVPNManagementParser::parseByteCount(const char *data, int size, Message &outMessage)
+{
+    // "<bytes received>,<bytes sent>"
+    quint64 values[2] = { 0, 0 };
+    int ind = 0;
+    int digits = 0;
+    for (int i = 0; i < size; ++i) {
+        const char c = data[i];
+        if (c >= '0' && c <= '9') {
+            // 19 digits always fit in quint64
+            if (++digits > 19) {
+                return false;
+            }
+            values[ind] = values[ind] * 10 + (c - '0');
+        } else if (c == ',' && ind == 0 && digits > 0) {
+            ind = 1;
+            digits = 0;
+        } else {
+            return false;
+        }
+    }
+    if (ind != 1 || digits == 0) {
+        return false;
+    }
+    outMessage.bytesReceived = values[0];
+    outMessage.bytesSent = values[1];
+    return true;
+}
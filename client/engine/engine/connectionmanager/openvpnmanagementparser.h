@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QByteArray>
+
+// Classifies the lines received from the OpenVPN management interface (see management-notes.txt in the openvpn sources).
+// The real-time messages are dispatched by their ">TYPE:" prefix, so a line is searched only for the patterns of its type.
+// The patterns are matched case-insensitively. The caller is expected to trim the line.
+class OpenVPNManagementParser
+{
+public:
+    enum MessageType {
+        UNKNOWN,
+
+        // command replies
+        END,
+        STATE_NOTIFICATION_ON,
+        LOG_NOTIFICATION_ON,
+        BYTECOUNT_INTERVAL_CHANGED,
+        AUTH_USERNAME_ENTERED,
+        PROXY_USERNAME_ENTERED,
+
+        // >HOLD: and >PASSWORD:
+        HOLD_WAITING_RELEASE,
+        NEED_AUTH_USERNAME,
+        NEED_PROXY_USERNAME,
+        AUTH_VERIFICATION_FAILED,
+
+        // >BYTECOUNT:, bytesReceived and bytesSent are set
+        BYTECOUNT,
+
+        // >STATE:
+        STATE_CONNECTED_SUCCESS,
+        STATE_CONNECTED_ERROR,
+        STATE_RECONNECTING,
+
+        // >LOG: and >FATAL:
+        NO_TAP_ADAPTERS,
+        LOG_UDP_CANT_ASSIGN,
+        LOG_UDP_NO_BUFFER_SPACE,
+        LOG_UDP_NETWORK_DOWN,
+        LOG_WINTUN_OVER_CAPACITY,
+        LOG_TCP_ERROR,
+        LOG_INITIALIZATION_COMPLETED_WITH_ERRORS,
+        LOG_DEVICE_OPENED,      // macOS and Linux only
+        LOG_PUSH_REPLY,
+        LOG_WRITE_UDP_ERROR,
+        FATAL_ALL_TAP_IN_USE,
+        FATAL_ALL_WINTUN_IN_USE
+    };
+
+    struct Message
+    {
+        MessageType type = UNKNOWN;
+        quint64 bytesReceived = 0;
+        quint64 bytesSent = 0;
+    };
+
+    Message parse(const QByteArray &line);
+
+private:
+    QByteArray lowerLine_;      // reused between the lines to avoid the allocations
+
+    const QByteArray &toLower(const QByteArray &line);
+    static bool parseByteCount(const char *data, int size, Message &outMessage);
+};
@@ -0,0 +1,120 @@
+#include "connectpreflight.test.h"
+
+#include <QSignalSpy>
+#include <QTimer>
+#include <QtTest>
+
+void ConnectPreflight_test::testNoSteps()
+{
+    ConnectPreflight preflight(nullptr);
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    preflight.start();
+    QCOMPARE(spyFinished.count(), 1);
+    QVERIFY(!preflight.isRunning());
+}
+
+void ConnectPreflight_test::testSynchronousSteps()
+{
+    ConnectPreflight preflight(nullptr);
+    QStringList order;
+    preflight.addStep("a", QStringList(), [&]() { order << "a"; preflight.finishStep("a"); });
+    preflight.addStep("b", QStringList() << "a", [&]() { order << "b"; preflight.finishStep("b"); });
+    preflight.addStep("c", QStringList() << "a" << "b", [&]() { order << "c"; preflight.finishStep("c"); });
+
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    preflight.start();
+    QCOMPARE(spyFinished.count(), 1);
+    QCOMPARE(order, QStringList() << "a" << "b" << "c");
+}
+
+void ConnectPreflight_test::testIndependentStepsOverlap()
+{
+    ConnectPreflight preflight(nullptr);
+    // both steps take 200 ms, together they must not take 400 ms
+    preflight.addStep("a", QStringList(), [&]() { QTimer::singleShot(200, [&]() { preflight.finishStep("a"); }); });
+    preflight.addStep("b", QStringList(), [&]() { QTimer::singleShot(200, [&]() { preflight.finishStep("b"); }); });
+
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    QElapsedTimer timer;
+    timer.start();
+    preflight.start();
+    QVERIFY(preflight.isStepRunning("a"));
+    QVERIFY(preflight.isStepRunning("b"));
+    QVERIFY(spyFinished.wait(5000));
+    QVERIFY(timer.elapsed() < 380);
+}
+
+void ConnectPreflight_test::testDependentStepWaits()
+{
+    ConnectPreflight preflight(nullptr);
+    bool isBStarted = false;
+    preflight.addStep("a", QStringList(), [&]() { QTimer::singleShot(50, [&]() { preflight.finishStep("a"); }); });
+    preflight.addStep("b", QStringList() << "a", [&]() { isBStarted = true; preflight.finishStep("b"); });
+
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    preflight.start();
+    QVERIFY(!isBStarted);
+    QVERIFY(spyFinished.wait(5000));
+    QVERIFY(isBStarted);
+    QVERIFY(preflight.timingsLogString().contains("b "));
+}
+
+void ConnectPreflight_test::testResetFromStep()
+{
+    // a failed step resets the preflight, the steps after it are not started
+    ConnectPreflight preflight(nullptr);
+    bool isBStarted = false;
+    preflight.addStep("a", QStringList(), [&]() { preflight.reset(); });
+    preflight.addStep("b", QStringList(), [&]() { isBStarted = true; });
+
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    preflight.start();
+    QVERIFY(!isBStarted);
+    QVERIFY(!preflight.isRunning());
+    QCOMPARE(spyFinished.count(), 0);
+
+    // and it can be used for the next run
+    preflight.addStep("c", QStringList(), [&]() { preflight.finishStep("c"); });
+    preflight.start();
+    QCOMPARE(spyFinished.count(), 1);
+}
+
+void ConnectPreflight_test::testLateFinishIgnored()
+{
+    ConnectPreflight preflight(nullptr);
+    preflight.addStep("a", QStringList(), []() {});
+    preflight.start();
+    preflight.reset();
+
+    preflight.addStep("b", QStringList(), []() {});
+    preflight.addStep("a", QStringList() << "b", [&]() { preflight.finishStep("a"); });
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    preflight.start();
+    // the answer of the previous run for "a" must not finish the new one, "a" has not started yet
+    preflight.finishStep("a");
+    QCOMPARE(spyFinished.count(), 0);
+    QVERIFY(preflight.isStepRunning("b"));
+    preflight.finishStep("b");
+    QCOMPARE(spyFinished.count(), 1);
+}
+
+void ConnectPreflight_test::testLateFinishOfRunningStepIgnored()
+{
+    ConnectPreflight preflight(nullptr);
+    preflight.addStep("a", QStringList(), []() {});
+    preflight.start();
+    const int previousGeneration = preflight.generation();
+    preflight.reset();
+
+    preflight.addStep("a", QStringList(), []() {});
+    QSignalSpy spyFinished(&preflight, &ConnectPreflight::finished);
+    preflight.start();
+    // "a" of the new run is running, the answer of the previous run must not finish it
+    preflight.finishStep("a", previousGeneration);
+    QCOMPARE(spyFinished.count(), 0);
+    QVERIFY(preflight.isStepRunning("a"));
+    preflight.finishStep("a", preflight.generation());
+    QCOMPARE(spyFinished.count(), 1);
+}
+
+QTEST_MAIN(ConnectPreflight_test)
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QObject>
+#include "engine/connectionmanager/connectpreflight.h"
+
+// Checks the order in which ConnectPreflight starts the steps, with the steps finishing right away and from the event loop.
+class ConnectPreflight_test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testNoSteps();
+    void testSynchronousSteps();
+    void testIndependentStepsOverlap();
+    void testDependentStepWaits();
+    void testResetFromStep();
+    void testLateFinishIgnored();
+    void testLateFinishOfRunningStepIgnored();
+};
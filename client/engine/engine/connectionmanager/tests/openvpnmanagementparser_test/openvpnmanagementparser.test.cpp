@@ -0,0 +1,263 @@
+#include "openvpnmanagementparser.test.h"
+
+#include <QFile>
+#include <QtTest>
+
+Q_DECLARE_METATYPE(OpenVPNManagementParser::MessageType)
+
+void OpenVPNManagementParser_test::initTestCase()
+{
+    QFile file(":/openvpn_session.txt");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (!line.trimmed().isEmpty())
+            lines_ << line.trimmed();
+    }
+    QVERIFY(!lines_.isEmpty());
+}
+
+void OpenVPNManagementParser_test::testParse_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<OpenVPNManagementParser::MessageType>("type");
+
+    QTest::newRow("hold") << QByteArray(">HOLD:Waiting for hold release:0") << OpenVPNManagementParser::HOLD_WAITING_RELEASE;
+    QTest::newRow("end") << QByteArray("END") << OpenVPNManagementParser::END;
+    QTest::newRow("state on") << QByteArray("SUCCESS: real-time state notification set to ON") << OpenVPNManagementParser::STATE_NOTIFICATION_ON;
+    QTest::newRow("log on") << QByteArray("SUCCESS: real-time log notification set to ON") << OpenVPNManagementParser::LOG_NOTIFICATION_ON;
+    QTest::newRow("bytecount interval") << QByteArray("SUCCESS: bytecount interval changed") << OpenVPNManagementParser::BYTECOUNT_INTERVAL_CHANGED;
+    QTest::newRow("hold release") << QByteArray("SUCCESS: hold release succeeded") << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("need auth") << QByteArray(">PASSWORD:Need 'Auth' username/password") << OpenVPNManagementParser::NEED_AUTH_USERNAME;
+    QTest::newRow("need proxy") << QByteArray(">PASSWORD:Need 'HTTP Proxy' username/password") << OpenVPNManagementParser::NEED_PROXY_USERNAME;
+    QTest::newRow("auth entered") << QByteArray("SUCCESS: 'Auth' username entered, but not yet verified") << OpenVPNManagementParser::AUTH_USERNAME_ENTERED;
+    QTest::newRow("proxy entered") << QByteArray("SUCCESS: 'HTTP Proxy' username entered, but not yet verified") << OpenVPNManagementParser::PROXY_USERNAME_ENTERED;
+    QTest::newRow("auth failed") << QByteArray(">PASSWORD:Verification Failed: 'Auth'") << OpenVPNManagementParser::AUTH_VERIFICATION_FAILED;
+    QTest::newRow("connected") << QByteArray(">STATE:1729340001,CONNECTED,SUCCESS,10.112.14.35,185.232.22.10,443,,") << OpenVPNManagementParser::STATE_CONNECTED_SUCCESS;
+    QTest::newRow("connected error") << QByteArray(">STATE:1729340001,CONNECTED,ERROR,10.112.14.35,185.232.22.10,443,,") << OpenVPNManagementParser::STATE_CONNECTED_ERROR;
+    QTest::newRow("reconnecting") << QByteArray(">STATE:1729340001,RECONNECTING,ping-restart,,,,,") << OpenVPNManagementParser::STATE_RECONNECTING;
+    QTest::newRow("other state") << QByteArray(">STATE:1729340001,GET_CONFIG,,,,,,") << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("no tap log") << QByteArray(">LOG:1729340001,N,There are no TAP-Windows, Wintun or ovpn-dco adapters on this system.  You should be able to create an adapter by using tapctl.exe utility.")
+                                << OpenVPNManagementParser::NO_TAP_ADAPTERS;
+    QTest::newRow("no tap fatal") << QByteArray(">FATAL:There are no TAP-Windows, Wintun or ovpn-dco adapters on this system.") << OpenVPNManagementParser::NO_TAP_ADAPTERS;
+    QTest::newRow("udp 10055") << QByteArray(">LOG:1729340001,N,write UDPv4: No buffer space available (WSAENOBUFS) (code=10055)") << OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN;
+    QTest::newRow("udp 10065") << QByteArray(">LOG:1729340001,N,write UDPv4: No Route to Host (WSAEHOSTUNREACH) (code=10065)") << OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN;
+    QTest::newRow("udp 49") << QByteArray(">LOG:1729340001,N,write UDP: Can't assign requested address (code=49)") << OpenVPNManagementParser::LOG_UDP_CANT_ASSIGN;
+    QTest::newRow("udp 55") << QByteArray(">LOG:1729340001,N,write UDP: No buffer space available (code=55)") << OpenVPNManagementParser::LOG_UDP_NO_BUFFER_SPACE;
+    QTest::newRow("udp 50") << QByteArray(">LOG:1729340001,N,write UDP: Network is down (code=50)") << OpenVPNManagementParser::LOG_UDP_NETWORK_DOWN;
+    QTest::newRow("tcp 49") << QByteArray(">LOG:1729340001,N,write TCP: Can't assign requested address (code=49)") << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("wintun") << QByteArray(">LOG:1729340001,N,write_wintun(): head/tail value is over capacity") << OpenVPNManagementParser::LOG_WINTUN_OVER_CAPACITY;
+    QTest::newRow("tcp failed") << QByteArray(">LOG:1729340001,N,TCP: connect to [AF_INET]185.232.22.10:443 failed: Connection refused") << OpenVPNManagementParser::LOG_TCP_ERROR;
+    QTest::newRow("init errors") << QByteArray(">LOG:1729340001,N,Initialization Sequence Completed With Errors ( see http://openvpn.net/faq.html#dhcpclientserv )")
+                                 << OpenVPNManagementParser::LOG_INITIALIZATION_COMPLETED_WITH_ERRORS;
+#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
+    QTest::newRow("device opened") << QByteArray(">LOG:1729340001,I,TUN/TAP device tun0 opened") << OpenVPNManagementParser::LOG_DEVICE_OPENED;
+#endif
+    QTest::newRow("push") << QByteArray(">LOG:1729340001,,PUSH: Received control message: 'PUSH_REPLY,ifconfig 10.112.14.35 255.255.254.0'") << OpenVPNManagementParser::LOG_PUSH_REPLY;
+    QTest::newRow("write udp 10054") << QByteArray(">LOG:1729340001,,write UDP: Unknown error (code=10054)") << OpenVPNManagementParser::LOG_WRITE_UDP_ERROR;
+    QTest::newRow("write udp lowercase") << QByteArray(">LOG:1729340001,,write udp: unknown error (code=10054)") << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("other log") << QByteArray(">LOG:1729340001,I,Initialization Sequence Completed") << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("tap in use") << QByteArray(">FATAL:All tap-windows6 adapters on this system are currently in use or disabled.") << OpenVPNManagementParser::FATAL_ALL_TAP_IN_USE;
+    QTest::newRow("wintun in use") << QByteArray(">FATAL:All wintun adapters on this system are currently in use or disabled.") << OpenVPNManagementParser::FATAL_ALL_WINTUN_IN_USE;
+    QTest::newRow("lowercase type") << QByteArray(">state:1729340001,reconnecting,ping-restart,,,,,") << OpenVPNManagementParser::STATE_RECONNECTING;
+    QTest::newRow("pattern of another type") << QByteArray(">INFO:PUSH: Received control message:") << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("empty") << QByteArray() << OpenVPNManagementParser::UNKNOWN;
+    QTest::newRow("no type") << QByteArray(">") << OpenVPNManagementParser::UNKNOWN;
+}
+
+void OpenVPNManagementParser_test::testParse()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(OpenVPNManagementParser::MessageType, type);
+
+    OpenVPNManagementParser parser;
+    QCOMPARE(parser.parse(line).type, type);
+}
+
+void OpenVPNManagementParser_test::testByteCount_data()
+{
+    QTest::addColumn<QByteArray>("line");
+    QTest::addColumn<bool>("isValid");
+    QTest::addColumn<quint64>("bytesReceived");
+    QTest::addColumn<quint64>("bytesSent");
+
+    QTest::newRow("zeros") << QByteArray(">BYTECOUNT:0,0") << true << quint64(0) << quint64(0);
+    QTest::newRow("values") << QByteArray(">BYTECOUNT:123456789,987654") << true << quint64(123456789) << quint64(987654);
+    QTest::newRow("more than 4 GB") << QByteArray(">BYTECOUNT:10737418240,5368709120") << true << quint64(10737418240ULL) << quint64(5368709120ULL);
+    QTest::newRow("lowercase") << QByteArray(">bytecount:1,2") << true << quint64(1) << quint64(2);
+    QTest::newRow("one value") << QByteArray(">BYTECOUNT:12345") << false << quint64(0) << quint64(0);
+    QTest::newRow("three values") << QByteArray(">BYTECOUNT:1,2,3") << false << quint64(0) << quint64(0);
+    QTest::newRow("empty value") << QByteArray(">BYTECOUNT:,2") << false << quint64(0) << quint64(0);
+    QTest::newRow("not a number") << QByteArray(">BYTECOUNT:1x,2") << false << quint64(0) << quint64(0);
+    QTest::newRow("too long") << QByteArray(">BYTECOUNT:123456789012345678901,2") << false << quint64(0) << quint64(0);
+}
+
+void OpenVPNManagementParser_test::testByteCount()
+{
+    QFETCH(QByteArray, line);
+    QFETCH(bool, isValid);
+    QFETCH(quint64, bytesReceived);
+    QFETCH(quint64, bytesSent);
+
+    OpenVPNManagementParser parser;
+    const OpenVPNManagementParser::Message message = parser.parse(line);
+    QCOMPARE(message.type == OpenVPNManagementParser::BYTECOUNT, isValid);
+    if (isValid) {
+        QCOMPARE(message.bytesReceived, bytesReceived);
+        QCOMPARE(message.bytesSent, bytesSent);
+    }
+}
+
+void OpenVPNManagementParser_test::testReplay()
+{
+    OpenVPNManagementParser parser;
+    QMap<OpenVPNManagementParser::MessageType, int> counts;
+    quint64 lastBytesReceived = 0;
+    for (const QByteArray &line : qAsConst(lines_)) {
+        const OpenVPNManagementParser::Message message = parser.parse(line);
+        counts[message.type]++;
+        if (message.type == OpenVPNManagementParser::BYTECOUNT) {
+            // the counters of the session only grow
+            QVERIFY(message.bytesReceived > lastBytesReceived);
+            lastBytesReceived = message.bytesReceived;
+        }
+    }
+
+    QCOMPARE(counts.value(OpenVPNManagementParser::BYTECOUNT), 900);
+    QCOMPARE(counts.value(OpenVPNManagementParser::HOLD_WAITING_RELEASE), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::END), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::STATE_NOTIFICATION_ON), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::LOG_NOTIFICATION_ON), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::BYTECOUNT_INTERVAL_CHANGED), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::NEED_AUTH_USERNAME), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::AUTH_USERNAME_ENTERED), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::LOG_PUSH_REPLY), 1);
+    QCOMPARE(counts.value(OpenVPNManagementParser::STATE_CONNECTED_SUCCESS), 2);
+    QCOMPARE(counts.value(OpenVPNManagementParser::STATE_RECONNECTING), 1);
+#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
+    QCOMPARE(counts.value(OpenVPNManagementParser::LOG_DEVICE_OPENED), 1);
+#endif
+}
+
+void OpenVPNManagementParser_test::testSameAsContains()
+{
+    OpenVPNManagementParser parser;
+    for (const QByteArray &line : qAsConst(lines_)) {
+        quint64 bytesReceived = 0, bytesSent = 0;
+        const OpenVPNManagementParser::Message message = parser.parse(line);
+        QCOMPARE(message.type, parseWithContains(QString::fromUtf8(line), bytesReceived, bytesSent));
+        QCOMPARE(message.bytesReceived, bytesReceived);
+        QCOMPARE(message.bytesSent, bytesSent);
+    }
+}
+
+void OpenVPNManagementParser_test::benchmarkContains()
+{
+    QBENCHMARK {
+        quint64 total = 0;
+        for (const QByteArray &line : qAsConst(lines_)) {
+            quint64 bytesReceived = 0, bytesSent = 0;
+            parseWithContains(QString::fromUtf8(line), bytesReceived, bytesSent);
+            total += bytesReceived;
+        }
+        Q_UNUSED(total)
+    }
+}
+
+void OpenVPNManagementParser_test::benchmarkParser()
+{
+    OpenVPNManagementParser parser;
+    QBENCHMARK {
+        quint64 total = 0;
+        for (const QByteArray &line : qAsConst(lines_)) {
+            total += parser.parse(line).bytesReceived;
+        }
+        Q_UNUSED(total)
+    }
+}
+
+OpenVPNManagementParser::MessageType OpenVPNManagementParser_test::parseWithContains(const QString &serverReply, quint64 &outBytesReceived, quint64 &outBytesSent)
+{
+    typedef OpenVPNManagementParser P;
+
+    if (serverReply.contains("HOLD:Waiting for hold release", Qt::CaseInsensitive))
+        return P::HOLD_WAITING_RELEASE;
+    if (serverReply.startsWith("END"))
+        return P::END;
+    if (serverReply.contains("SUCCESS: real-time state notification set to ON", Qt::CaseInsensitive))
+        return P::STATE_NOTIFICATION_ON;
+    if (serverReply.contains("SUCCESS: real-time log notification set to ON", Qt::CaseInsensitive))
+        return P::LOG_NOTIFICATION_ON;
+    if (serverReply.contains("SUCCESS: bytecount interval changed", Qt::CaseInsensitive))
+        return P::BYTECOUNT_INTERVAL_CHANGED;
+    if (serverReply.contains("PASSWORD:Need 'Auth' username/password", Qt::CaseInsensitive))
+        return P::NEED_AUTH_USERNAME;
+    if (serverReply.contains("PASSWORD:Need 'HTTP Proxy' username/password", Qt::CaseInsensitive))
+        return P::NEED_PROXY_USERNAME;
+    if (serverReply.contains("'HTTP Proxy' username entered, but not yet verified", Qt::CaseInsensitive))
+        return P::PROXY_USERNAME_ENTERED;
+    if (serverReply.contains("'Auth' username entered, but not yet verified", Qt::CaseInsensitive))
+        return P::AUTH_USERNAME_ENTERED;
+    if (serverReply.contains("PASSWORD:Verification Failed: 'Auth'", Qt::CaseInsensitive))
+        return P::AUTH_VERIFICATION_FAILED;
+    if (serverReply.contains("There are no TAP-Windows", Qt::CaseInsensitive) && serverReply.contains("Wintun", Qt::CaseInsensitive) &&
+        serverReply.contains("adapters on this system.", Qt::CaseInsensitive))
+        return P::NO_TAP_ADAPTERS;
+
+    if (serverReply.startsWith(">BYTECOUNT:", Qt::CaseInsensitive)) {
+        QStringList pars = serverReply.split(":");
+        if (pars.count() > 1) {
+            QStringList pars2 = pars[1].split(",");
+            if (pars2.count() == 2) {
+                outBytesReceived = pars2[0].toULongLong();
+                outBytesSent = pars2[1].toULongLong();
+                return P::BYTECOUNT;
+            }
+        }
+        return P::UNKNOWN;
+    }
+    if (serverReply.startsWith(">STATE:", Qt::CaseInsensitive)) {
+        if (serverReply.contains("CONNECTED,SUCCESS", Qt::CaseInsensitive))
+            return P::STATE_CONNECTED_SUCCESS;
+        if (serverReply.contains("CONNECTED,ERROR", Qt::CaseInsensitive))
+            return P::STATE_CONNECTED_ERROR;
+        if (serverReply.contains("RECONNECTING", Qt::CaseInsensitive))
+            return P::STATE_RECONNECTING;
+        return P::UNKNOWN;
+    }
+    if (serverReply.startsWith(">LOG:", Qt::CaseInsensitive)) {
+        bool bContainsUDPWord = serverReply.contains("UDP", Qt::CaseInsensitive);
+        if (bContainsUDPWord && serverReply.contains("No buffer space available (WSAENOBUFS) (code=10055)", Qt::CaseInsensitive))
+            return P::LOG_UDP_CANT_ASSIGN;
+        if (bContainsUDPWord && serverReply.contains("No Route to Host (WSAEHOSTUNREACH) (code=10065)", Qt::CaseInsensitive))
+            return P::LOG_UDP_CANT_ASSIGN;
+        if (bContainsUDPWord && serverReply.contains("Can't assign requested address (code=49)", Qt::CaseInsensitive))
+            return P::LOG_UDP_CANT_ASSIGN;
+        if (bContainsUDPWord && serverReply.contains("No buffer space available (code=55)", Qt::CaseInsensitive))
+            return P::LOG_UDP_NO_BUFFER_SPACE;
+        if (bContainsUDPWord && serverReply.contains("Network is down (code=50)", Qt::CaseInsensitive))
+            return P::LOG_UDP_NETWORK_DOWN;
+        if (serverReply.contains("write_wintun", Qt::CaseInsensitive) && serverReply.contains("head/tail value is over capacity", Qt::CaseInsensitive))
+            return P::LOG_WINTUN_OVER_CAPACITY;
+        if (serverReply.contains("TCP:", Qt::CaseInsensitive) && serverReply.contains("failed", Qt::CaseInsensitive))
+            return P::LOG_TCP_ERROR;
+        if (serverReply.contains("Initialization Sequence Completed With Errors", Qt::CaseInsensitive))
+            return P::LOG_INITIALIZATION_COMPLETED_WITH_ERRORS;
+#if defined (Q_OS_MAC) || defined (Q_OS_LINUX)
+        if (serverReply.contains("device", Qt::CaseInsensitive) && serverReply.contains("opened", Qt::CaseInsensitive))
+            return P::LOG_DEVICE_OPENED;
+#endif
+        if (serverReply.contains("PUSH: Received control message:", Qt::CaseInsensitive))
+            return P::LOG_PUSH_REPLY;
+        if (serverReply.contains("write UDP: Unknown error (code=10065)") || serverReply.contains("write UDP: Unknown error (code=10054)"))
+            return P::LOG_WRITE_UDP_ERROR;
+        return P::UNKNOWN;
+    }
+    if (serverReply.contains(">FATAL:All tap-windows6 adapters on this system are currently in use", Qt::CaseInsensitive))
+        return P::FATAL_ALL_TAP_IN_USE;
+    if (serverReply.contains(">FATAL:All wintun adapters on this system are currently in use", Qt::CaseInsensitive))
+        return P::FATAL_ALL_WINTUN_IN_USE;
+    return P::UNKNOWN;
+}
+
+QTEST_MAIN(OpenVPNManagementParser_test)
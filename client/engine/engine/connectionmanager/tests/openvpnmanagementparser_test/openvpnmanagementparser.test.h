@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QObject>
+#include "engine/connectionmanager/openvpnmanagementparser.h"
+
+// Checks OpenVPNManagementParser on single lines and on a saved management session,
+// the benchmarks replay the session through the parser and through the QString::contains() chain it replaced.
+class OpenVPNManagementParser_test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testParse_data();
+    void testParse();
+    void testByteCount_data();
+    void testByteCount();
+    void testReplay();
+    void testSameAsContains();
+
+    void benchmarkContains();
+    void benchmarkParser();
+
+private:
+    QVector<QByteArray> lines_;
+
+    // the way OpenVPNConnection::handleRead classified the lines before OpenVPNManagementParser
+    static OpenVPNManagementParser::MessageType parseWithContains(const QString &serverReply, quint64 &outBytesReceived, quint64 &outBytesSent);
+};
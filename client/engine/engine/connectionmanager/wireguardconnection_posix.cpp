@@ -22,6 +22,9 @@ public:
     void configure();
     void disconnect();
     bool getStatus(types::WireGuardStatus *status);
+    bool waitStatus(const types::WireGuardStatus &lastStatus, int timeoutMs, types::WireGuardStatus *status);
+    void cancelWaitStatus();
+    void resetWaitStatus();
     bool stopWireGuard();
 
     QString getAdapterName() const { return adapterName_; }
@@ -108,6 +111,26 @@ bool WireGuardConnectionImpl::getStatus(types::WireGuardStatus *status)
     return isStarted_ && host_->helper_->getWireGuardStatus(status);
 }
 
+bool WireGuardConnectionImpl::waitStatus(const types::WireGuardStatus &lastStatus, int timeoutMs, types::WireGuardStatus *status)
+{
+    Helper_posix *helper_posix = dynamic_cast<Helper_posix *>(host_->helper_);
+    return isStarted_ && helper_posix && helper_posix->waitWireGuardStatus(lastStatus, timeoutMs, WireGuardConnection::kStatisticsIntervalMs, status);
+}
+
+void WireGuardConnectionImpl::cancelWaitStatus()
+{
+    Helper_posix *helper_posix = dynamic_cast<Helper_posix *>(host_->helper_);
+    if (helper_posix)
+        helper_posix->cancelWaitWireGuardStatus();
+}
+
+void WireGuardConnectionImpl::resetWaitStatus()
+{
+    Helper_posix *helper_posix = dynamic_cast<Helper_posix *>(host_->helper_);
+    if (helper_posix)
+        helper_posix->resetWaitWireGuardStatus();
+}
+
 void WireGuardConnectionImpl::setUsingKernelModule(bool usingKernelModule)
 {
     usingKernelModule_ = usingKernelModule;
@@ -138,7 +161,7 @@ WireGuardConnection::WireGuardConnection(QObject *parent, IHelper *helper)
       current_state_(ConnectionState::DISCONNECTED),
       do_stop_thread_(false)
 {
-    connect(&kill_process_timer_, &QTimer::timeout, this, &WireGuardConnection::onProcessKillTimeout);
+    connect(&kill_process_timer_, &WheelTimer::timeout, this, &WireGuardConnection::onProcessKillTimeout);
 }
 
 WireGuardConnection::~WireGuardConnection()
@@ -165,8 +188,10 @@ void WireGuardConnection::startConnect(const QString &configPathOrUrl, const QSt
     qCDebug(LOG_CONNECTION) << "Connecting WireGuard:" << pimpl_->getAdapterName();
 
     do_stop_thread_ = true;
+    pimpl_->cancelWaitStatus();
     wait();
     do_stop_thread_ = false;
+    pimpl_->resetWaitStatus();
 
     isAutomaticConnectionMode_ = isAutomaticConnectionMode;
     pimpl_->setConfig(wireGuardConfig, overrideDnsIp);
@@ -201,6 +226,7 @@ void WireGuardConnection::startDisconnect()
 
     adapterGatewayInfo_.clear();
     do_stop_thread_ = true;
+    pimpl_->cancelWaitStatus();
 }
 
 bool WireGuardConnection::isDisconnected() const
@@ -228,6 +254,9 @@ QString WireGuardConnection::getWireGuardAdapterName()
 void WireGuardConnection::run()
 {
     types::WireGuardStatus status;
+    status.state = types::WireGuardState::NONE;
+    status.errorCode = 0;
+    status.bytesReceived = status.bytesTransmitted = 0;
     quint64 bytesReceived = 0;
     quint64 bytesTransmitted = 0;
     bool is_configured = false;
@@ -237,6 +266,15 @@ void WireGuardConnection::run()
 
     BIND_CRASH_HANDLER_FOR_THREAD();
 
+#if defined(Q_OS_LINUX)
+    // the helper answers when the status changes instead of the polling
+    bool isWaitStatusSupported = true;
+#else
+    bool isWaitStatusSupported = false;
+#endif
+    // a failed wait is polled instead, the waiting is given up after several failures in a row (e.g. an older helper)
+    int waitStatusFailures = 0;
+
     for (pimpl_->connect();;) {
         if (do_stop_thread_) {
             pimpl_->disconnect();
@@ -244,12 +282,30 @@ void WireGuardConnection::run()
         }
         const auto current_state = getCurrentState();
         unsigned int next_status_check_ms = 100u;
+        bool isStatusWaited = false;
         if (current_state != ConnectionState::DISCONNECTED) {
 
             if (current_state == ConnectionState::CONNECTED)
                 elapsedTimer.invalidate();
 
-            if (!pimpl_->getStatus(&status)) {
+            if (isWaitStatusSupported) {
+                // while connecting, wake up often enough to check the timeout of the automatic mode
+                const int timeoutMs = current_state == ConnectionState::CONNECTED ? kWaitStatusTimeoutMs : kWaitStatusConnectingTimeoutMs;
+                const types::WireGuardStatus lastStatus = status;
+                isStatusWaited = pimpl_->waitStatus(lastStatus, timeoutMs, &status);
+                if (isStatusWaited) {
+                    waitStatusFailures = 0;
+                } else {
+                    if (do_stop_thread_)
+                        continue;
+                    if (++waitStatusFailures >= kMaxWaitStatusFailures) {
+                        qCDebug(LOG_WIREGUARD) << "Waiting for the WireGuard status is not available, polling it";
+                        isWaitStatusSupported = false;
+                    }
+                }
+            }
+
+            if (!isStatusWaited && !pimpl_->getStatus(&status)) {
                 qCDebug(LOG_WIREGUARD) << "Failed to get WireGuard status";
                 pimpl_->disconnect();
                 break;
@@ -303,7 +359,8 @@ void WireGuardConnection::run()
             setError(STATE_TIMEOUT_FOR_AUTOMATIC);
         }
 
-        QThread::msleep(next_status_check_ms);
+        if (!isStatusWaited)
+            QThread::msleep(next_status_check_ms);
     }
 }
 
@@ -4,6 +4,7 @@
 #include <atomic>
 #include <QMutex>
 #include <QTimer>
+#include "engine/utils/timerwheel.h"
 
 class WireGuardConnectionImpl;
 
@@ -42,6 +43,11 @@ private:
     enum class ConnectionState { DISCONNECTED, CONNECTING, CONNECTED };
     static constexpr int PROCESS_KILL_TIMEOUT = 10000;
     static constexpr int kTimeoutForAutomatic = 20000;  // 20 secs timeout for the automatic connection mode
+    // waiting for the status pushed by the helper
+    static constexpr int kWaitStatusTimeoutMs = 10000;
+    static constexpr int kWaitStatusConnectingTimeoutMs = 1000;
+    static constexpr int kMaxWaitStatusFailures = 3;
+    static constexpr int kStatisticsIntervalMs = 1000;
 
     ConnectionState getCurrentState() const;
     void setCurrentState(ConnectionState state);
@@ -55,7 +61,7 @@ private:
     ConnectionState current_state_;
     mutable QMutex current_state_mutex_;
     std::atomic<bool> do_stop_thread_;
-    QTimer kill_process_timer_;
+    WheelTimer kill_process_timer_;
     AdapterGatewayInfo adapterGatewayInfo_;
     bool isAutomaticConnectionMode_;
 };
@@ -1,5 +1,9 @@
 #include "customconfigs.h"
+#include <QCryptographicHash>
 #include <QDir>
+#include <QHash>
+#include <atomic>
+#include <vector>
 #include "utils/logger.h"
 #include "parseovpnconfigline.h"
 #include "ovpncustomconfig.h"
@@ -7,8 +11,48 @@
 
 namespace customconfigs {
 
-CustomConfigs::CustomConfigs(QObject *parent) : QObject(parent), dirWatcher_(NULL)
+CustomConfigsDelta CustomConfigsDelta::make(const QVector<QSharedPointer<const ICustomConfig>> &oldConfigs,
+                                            const QVector<QSharedPointer<const ICustomConfig>> &newConfigs)
 {
+    QHash<QString, QSharedPointer<const ICustomConfig>> oldByFilename;
+    for (const auto &config : oldConfigs)
+    {
+        oldByFilename.insert(config->filename(), config);
+    }
+
+    CustomConfigsDelta delta;
+    for (const auto &config : newConfigs)
+    {
+        auto it = oldByFilename.find(config->filename());
+        if (it == oldByFilename.end())
+        {
+            delta.added << config;
+        }
+        else
+        {
+            if (it.value() != config)
+            {
+                delta.updated << config;
+            }
+            oldByFilename.erase(it);
+        }
+    }
+    for (auto it = oldByFilename.cbegin(); it != oldByFilename.cend(); ++it)
+    {
+        delta.removed << it.key();
+    }
+    return delta;
+}
+
+CustomConfigs::CustomConfigs(QObject *parent) : QObject(parent), dirWatcher_(NULL), generation_(0)
+{
+}
+
+CustomConfigs::~CustomConfigs()
+{
+    // the jobs refer to this object
+    threadPool_.clear();
+    threadPool_.waitForDone();
 }
 
 void CustomConfigs::changeDir(const QString &path)
@@ -33,38 +77,130 @@ void CustomConfigs::changeDir(const QString &path)
         connect(dirWatcher_, &CustomConfigsDirWatcher::dirChanged, this, &CustomConfigs::onDirectoryChanged);
     }
     parseDir();
-    emit changed();
 }
 
 QVector<QSharedPointer<const ICustomConfig> > CustomConfigs::getConfigs()
 {
-    return configs_;
+    QVector<QSharedPointer<const ICustomConfig>> configs;
+    configs.reserve(files_.size());
+    for (const ParsedFile &file : qAsConst(files_))
+    {
+        if (!file.config.isNull())
+        {
+            configs << file.config;
+        }
+    }
+    return configs;
 }
 
 void CustomConfigs::onDirectoryChanged()
 {
     qDebug(LOG_CUSTOM_OVPN) << "custom_configs directory is changed";
     parseDir();
-    emit changed();
 }
 
 void CustomConfigs::parseDir()
 {
-    configs_.clear();
+    const quint64 generation = ++generation_;
 
     if (!dirWatcher_)
+    {
+        onParseFinished(generation, QString(), QVector<ParsedFile>());
+        return;
+    }
+
+    const QString dir = dirWatcher_->curDir();
+    const QStringList fileList = dirWatcher_->curFiles();
+    if (fileList.isEmpty())
+    {
+        onParseFinished(generation, dir, QVector<ParsedFile>());
         return;
+    }
 
-    QStringList fileList = dirWatcher_->curFiles();
-    for (const QString &filename : fileList)
+    // the configs of another directory are not the same even if the filenames and the contents are
+    QHash<QString, ParsedFile> cache;
+    if (dir == filesDir_)
     {
-        QString filepath = dirWatcher_->curDir() + "/" + filename;
-        QSharedPointer<const ICustomConfig> config = makeCustomConfigFromFile(filepath);
-        if (!config.isNull())
+        for (const ParsedFile &file : qAsConst(files_))
         {
-            configs_ << config;
+            cache.insert(file.filename, file);
         }
     }
+
+    // each job writes its own element, the last finished one passes the results to this thread
+    struct Batch
+    {
+        std::vector<ParsedFile> results;
+        std::atomic<int> remaining;
+    };
+    QSharedPointer<Batch> batch(new Batch);
+    batch->results.resize(fileList.size());
+    batch->remaining = fileList.size();
+
+    for (int i = 0; i < fileList.size(); ++i)
+    {
+        const QString filename = fileList[i];
+        const ParsedFile cached = cache.value(filename);
+        threadPool_.start([this, batch, generation, dir, filename, cached, i]()
+        {
+            batch->results[i] = parseFile(dir, filename, cached);
+            if (--batch->remaining == 0)
+            {
+                QMetaObject::invokeMethod(this, [this, batch, generation, dir]()
+                {
+                    onParseFinished(generation, dir, QVector<ParsedFile>(batch->results.begin(), batch->results.end()));
+                }, Qt::QueuedConnection);
+            }
+        });
+    }
+}
+
+void CustomConfigs::onParseFinished(quint64 generation, const QString &dir, const QVector<ParsedFile> &parsedFiles)
+{
+    // the directory has changed again while it was parsed
+    if (generation != generation_)
+    {
+        return;
+    }
+
+    const QVector<QSharedPointer<const ICustomConfig>> oldConfigs = getConfigs();
+    filesDir_ = dir;
+    files_ = parsedFiles;
+    const CustomConfigsDelta delta = CustomConfigsDelta::make(oldConfigs, getConfigs());
+    if (!delta.isEmpty())
+    {
+        qDebug(LOG_CUSTOM_OVPN) << "custom configs added:" << delta.added.size() << ", updated:" << delta.updated.size()
+                                << ", removed:" << delta.removed.size();
+        emit changed(delta);
+    }
+}
+
+CustomConfigs::ParsedFile CustomConfigs::parseFile(const QString &dir, const QString &filename, const ParsedFile &cached)
+{
+    const QString filepath = dir + "/" + filename;
+
+    ParsedFile parsedFile;
+    parsedFile.filename = filename;
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        // makes the config with the "Failed to open file" error
+        parsedFile.config = makeCustomConfigFromFile(filepath);
+        return parsedFile;
+    }
+
+    // the hash and the config are made from the same bytes, so a change of the file between them can't be missed
+    const QByteArray data = file.readAll();
+    parsedFile.contentHash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+    if (parsedFile.contentHash == cached.contentHash && !cached.config.isNull())
+    {
+        parsedFile.config = cached.config;
+    }
+    else
+    {
+        parsedFile.config = makeCustomConfigFromData(filepath, data);
+    }
+    return parsedFile;
 }
 
 QSharedPointer<const ICustomConfig> CustomConfigs::makeCustomConfigFromFile(const QString &filepath)
@@ -83,4 +219,20 @@ QSharedPointer<const ICustomConfig> CustomConfigs::makeCustomConfigFromFile(cons
     return NULL;
 }
 
+QSharedPointer<const ICustomConfig> CustomConfigs::makeCustomConfigFromData(const QString &filepath, const QByteArray &data)
+{
+    QFileInfo fi(filepath);
+    QString fileSuffix = fi.suffix();
+    if (fileSuffix.compare("ovpn", Qt::CaseInsensitive) == 0)
+    {
+        return QSharedPointer<const ICustomConfig>(OvpnCustomConfig::makeFromData(filepath, data));
+    }
+    else if (fileSuffix.compare("conf", Qt::CaseInsensitive) == 0)
+    {
+        return QSharedPointer<const ICustomConfig>(WireguardCustomConfig::makeFromData(filepath, data));
+    }
+
+    return NULL;
+}
+
 } //namespace customconfigs
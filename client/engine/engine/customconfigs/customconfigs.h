@@ -2,35 +2,66 @@
 
 #include <QObject>
 #include <QSharedPointer>
+#include <QThreadPool>
 #include <QVector>
 #include "icustomconfig.h"
 #include "customconfigsdirwatcher.h"
 
 namespace customconfigs {
 
+// the changes of the configs since the previous parsing of the directory
+struct CustomConfigsDelta
+{
+    QVector<QSharedPointer<const ICustomConfig>> added;
+    QVector<QSharedPointer<const ICustomConfig>> updated;
+    QStringList removed;    // filenames
+
+    bool isEmpty() const { return added.isEmpty() && updated.isEmpty() && removed.isEmpty(); }
+
+    // the configs are matched by filename, a config object that is not the same is reported as updated
+    static CustomConfigsDelta make(const QVector<QSharedPointer<const ICustomConfig>> &oldConfigs,
+                                   const QVector<QSharedPointer<const ICustomConfig>> &newConfigs);
+};
+
 // parse custom configs directory, make ovpn configs location
+// The files are parsed in a thread pool. A file is parsed again only if its content has changed,
+// otherwise the previous config object is kept, so the unchanged configs are not reported in the delta.
 class CustomConfigs : public QObject
 {
     Q_OBJECT
 public:
     explicit CustomConfigs(QObject *parent);
+    ~CustomConfigs();
 
     void changeDir(const QString &path);
     QVector<QSharedPointer<const ICustomConfig>> getConfigs();
 
 signals:
-    void changed();
+    void changed(const customconfigs::CustomConfigsDelta &delta);
 
 private slots:
     void onDirectoryChanged();
 
 private:
+    struct ParsedFile
+    {
+        QString filename;
+        QByteArray contentHash;     // empty if the file could not be read
+        QSharedPointer<const ICustomConfig> config;
+    };
+
     void parseDir();
+    void onParseFinished(quint64 generation, const QString &dir, const QVector<ParsedFile> &parsedFiles);
 
-    QSharedPointer<const ICustomConfig> makeCustomConfigFromFile(const QString &filepath);
+    static ParsedFile parseFile(const QString &dir, const QString &filename, const ParsedFile &cached);
+    static QSharedPointer<const ICustomConfig> makeCustomConfigFromFile(const QString &filepath);
+    static QSharedPointer<const ICustomConfig> makeCustomConfigFromData(const QString &filepath, const QByteArray &data);
 
     CustomConfigsDirWatcher *dirWatcher_;
-    QVector<QSharedPointer<const ICustomConfig>> configs_;
+    QThreadPool threadPool_;
+    quint64 generation_;            // the results of an outdated parsing are dropped
+    QString filesDir_;
+    QVector<ParsedFile> files_;     // in the order of the directory listing, also the parse cache
 };
 
 } //namespace customconfigs
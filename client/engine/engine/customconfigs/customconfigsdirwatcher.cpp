@@ -13,7 +13,7 @@ CustomConfigsDirWatcher::CustomConfigsDirWatcher(QObject *parent, const QString
     connect(&dirWatcher_, &QFileSystemWatcher::directoryChanged, this, &CustomConfigsDirWatcher::onDirectoryChanged);
     connect(&dirWatcher_, &QFileSystemWatcher::fileChanged, this, &CustomConfigsDirWatcher::onFileChanged);
 
-    connect(&emitTimer_, &QTimer::timeout, this, &CustomConfigsDirWatcher::onEmitTimer);
+    connect(&emitTimer_, &WheelTimer::timeout, this, &CustomConfigsDirWatcher::onEmitTimer);
     emitTimer_.setSingleShot(true);
 
     checkFiles(false, false);
@@ -2,7 +2,8 @@
 
 #include <QFileSystemWatcher>
 #include <QObject>
-#include <QTimer>
+
+#include "engine/utils/timerwheel.h"
 
 class CustomConfigsDirWatcher : public QObject
 {
@@ -29,7 +30,7 @@ private:
     QStringList curFiles_;
 
     static constexpr int EMIT_TIMEOUT = 1000;
-    QTimer emitTimer_;
+    WheelTimer emitTimer_;
 
     void checkFiles(bool bWithEmitSignal, bool bFileChanged);
 };
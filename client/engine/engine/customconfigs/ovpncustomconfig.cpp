@@ -2,6 +2,8 @@
 #include "utils/logger.h"
 #include "parseovpnconfigline.h"
 
+#include <QBuffer>
+#include <QFile>
 #include <QFileInfo>
 
 namespace customconfigs {
@@ -69,6 +71,19 @@ QString OvpnCustomConfig::getErrorForIncorrect() const
 }
 
 ICustomConfig *OvpnCustomConfig::makeFromFile(const QString &filepath)
+{
+    QFile file(filepath);
+    return make(filepath, &file);
+}
+
+ICustomConfig *OvpnCustomConfig::makeFromData(const QString &filepath, const QByteArray &data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    return make(filepath, &buffer);
+}
+
+ICustomConfig *OvpnCustomConfig::make(const QString &filepath, QIODevice *device)
 {
     OvpnCustomConfig *config = new OvpnCustomConfig();
     QFileInfo fi(filepath);
@@ -77,7 +92,7 @@ ICustomConfig *OvpnCustomConfig::makeFromFile(const QString &filepath)
     config->filepath_ = filepath;
     config->globalPort_ = 0;
     config->isCorrect_ = true;      // by default correct config
-    config->process();              // here the config can change to incorrect
+    config->process(device);        // here the config can change to incorrect
     return config;
 }
 
@@ -104,15 +119,14 @@ QString OvpnCustomConfig::getOvpnData() const
 // retrieves all hostnames/IPs "remote ..." commands
 // also ovpn-config with removed "remote" commands saves in ovpnData_
 // removed "remote" commands are saved in remotes_ (to restore the config with changed hostnames/IPs before connect)
-void OvpnCustomConfig::process()
+void OvpnCustomConfig::process(QIODevice *device)
 {
 #ifdef Q_OS_LINUX
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-but-set-variable"
 #endif
 
-    QFile file(filepath_);
-    if (file.open(QIODevice::ReadOnly))
+    if (device->open(QIODevice::ReadOnly))
     {
         qDebug(LOG_CUSTOM_OVPN) << "Opened:" << Utils::cleanSensitiveInfo(filepath_);
 
@@ -122,7 +136,7 @@ void OvpnCustomConfig::process()
         bool isTapDevice = false;
         bool bHasValidCipher = false;
         QString currentProtocol{ "udp" };
-        QTextStream in(&file);
+        QTextStream in(device);
         while (!in.atEnd())
         {
             QString line = in.readLine();
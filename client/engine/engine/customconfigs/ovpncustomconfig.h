@@ -1,5 +1,6 @@
 #pragma once
 
+#include <QIODevice>
 #include <QVector>
 #include "icustomconfig.h"
 
@@ -28,6 +29,8 @@ public:
     QString getErrorForIncorrect() const override;
 
     static ICustomConfig *makeFromFile(const QString &filepath);
+    // same as makeFromFile, but parses the already read content of the file
+    static ICustomConfig *makeFromData(const QString &filepath, const QByteArray &data);
 
     QVector<RemoteCommandLine> remotes() const;
     uint globalPort() const;
@@ -51,7 +54,8 @@ private:
     bool isAllowFirewallAfterConnection_ = true;
 
 
-    void process();
+    static ICustomConfig *make(const QString &filepath, QIODevice *device);
+    void process(QIODevice *device);
 
 };
 
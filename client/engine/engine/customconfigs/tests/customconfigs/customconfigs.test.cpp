@@ -0,0 +1,107 @@
+#include <QtTest>
+#include "engine/customconfigs/customconfigs.h"
+#include "engine/customconfigs/ovpncustomconfig.h"
+#include "engine/customconfigs/wireguardcustomconfig.h"
+
+using namespace customconfigs;
+
+typedef QSharedPointer<const ICustomConfig> ConfigPtr;
+
+static ConfigPtr makeOvpn(const QString &filename, const QString &remote)
+{
+    const QByteArray data = QString("client\ndev tun\nproto udp\nremote %1 443\n").arg(remote).toUtf8();
+    return ConfigPtr(OvpnCustomConfig::makeFromData("/configs/" + filename, data));
+}
+
+class TestCustomConfigs : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testDeltaUnchanged();
+    void testDeltaAdded();
+    void testDeltaRemoved();
+    void testDeltaChanged();
+    void testWireguardFromData();
+};
+
+void TestCustomConfigs::testDeltaUnchanged()
+{
+    // the parsing keeps the config object of an unchanged file
+    const QVector<ConfigPtr> configs = { makeOvpn("a.ovpn", "1.1.1.1"), makeOvpn("b.ovpn", "2.2.2.2") };
+    QVERIFY(CustomConfigsDelta::make(configs, configs).isEmpty());
+    QVERIFY(CustomConfigsDelta::make({}, {}).isEmpty());
+}
+
+void TestCustomConfigs::testDeltaAdded()
+{
+    const ConfigPtr a = makeOvpn("a.ovpn", "1.1.1.1");
+    const ConfigPtr b = makeOvpn("b.ovpn", "2.2.2.2");
+
+    const CustomConfigsDelta delta = CustomConfigsDelta::make({ a }, { a, b });
+    QCOMPARE(delta.added.size(), 1);
+    QCOMPARE(delta.added[0], b);
+    QVERIFY(delta.updated.isEmpty());
+    QVERIFY(delta.removed.isEmpty());
+
+    QCOMPARE(CustomConfigsDelta::make({}, { a, b }).added.size(), 2);
+}
+
+void TestCustomConfigs::testDeltaRemoved()
+{
+    const ConfigPtr a = makeOvpn("a.ovpn", "1.1.1.1");
+    const ConfigPtr b = makeOvpn("b.ovpn", "2.2.2.2");
+
+    const CustomConfigsDelta delta = CustomConfigsDelta::make({ a, b }, { b });
+    QVERIFY(delta.added.isEmpty());
+    QVERIFY(delta.updated.isEmpty());
+    QCOMPARE(delta.removed, QStringList() << "a.ovpn");
+}
+
+void TestCustomConfigs::testDeltaChanged()
+{
+    const ConfigPtr a = makeOvpn("a.ovpn", "1.1.1.1");
+    const ConfigPtr b = makeOvpn("b.ovpn", "2.2.2.2");
+    const ConfigPtr newB = makeOvpn("b.ovpn", "3.3.3.3");
+    const ConfigPtr c = makeOvpn("c.ovpn", "4.4.4.4");
+
+    // the changed file is reported once as updated, not as removed and added
+    const CustomConfigsDelta delta = CustomConfigsDelta::make({ a, b }, { newB, c });
+    QCOMPARE(delta.added.size(), 1);
+    QCOMPARE(delta.added[0], c);
+    QCOMPARE(delta.updated.size(), 1);
+    QCOMPARE(delta.updated[0], newB);
+    QCOMPARE(delta.updated[0]->nick(), QString("3.3.3.3"));
+    QCOMPARE(delta.removed, QStringList() << "a.ovpn");
+}
+
+void TestCustomConfigs::testWireguardFromData()
+{
+    const QByteArray data =
+        "# comment\n"
+        "[Interface]\n"
+        "PrivateKey = cHJpdmF0ZWtleQ==\n"
+        "Address = 10.0.0.2/32, fd00::2/128\n"
+        "DNS = 10.0.0.1\n"
+        "\n"
+        "[Peer]\n"
+        "PublicKey = cHVibGlja2V5\n"
+        "AllowedIPs = 0.0.0.0/0\n"
+        "Endpoint = vpn.example.com:51820\n";
+    QScopedPointer<ICustomConfig> config(WireguardCustomConfig::makeFromData("/configs/wg.conf", data));
+    QVERIFY2(config->isCorrect(), qPrintable(config->getErrorForIncorrect()));
+    QCOMPARE(config->name(), QString("wg"));
+    QCOMPARE(config->filename(), QString("wg.conf"));
+    QCOMPARE(config->hostnames(), QStringList() << "vpn.example.com");
+    QVERIFY(config->isAllowFirewallAfterConnection());
+    QCOMPARE(static_cast<WireguardCustomConfig *>(config.data())->getEndpointPort(), 51820u);
+
+    QScopedPointer<ICustomConfig> noPeer(WireguardCustomConfig::makeFromData("/configs/wg.conf", "[Interface]\nPrivateKey = a\n"));
+    QVERIFY(!noPeer->isCorrect());
+
+    QScopedPointer<ICustomConfig> invalid(WireguardCustomConfig::makeFromData("/configs/wg.conf", "[Interface]\nPrivateKey\n"));
+    QCOMPARE(invalid->getErrorForIncorrect(), QString("Invalid config format"));
+}
+
+QTEST_MAIN(TestCustomConfigs)
+#include "customconfigs.test.moc"
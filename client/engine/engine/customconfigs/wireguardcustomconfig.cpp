@@ -1,11 +1,57 @@
 #include "wireguardcustomconfig.h"
 #include "utils/logger.h"
 
+#include <QFile>
 #include <QFileInfo>
-#include <QSettings>
+#include <QHash>
 
 namespace customconfigs {
 
+namespace {
+
+// section and key names are lower-cased, as wg-quick matches them case-insensitively
+typedef QHash<QString, QString> IniValues;
+typedef QHash<QString, IniValues> IniSections;
+
+// "[Section]" and "Key = Value" lines, "#" and ";" start a comment line
+bool parseIni(const QByteArray &data, IniSections &outSections)
+{
+    QString section;
+    const QList<QByteArray> lines = data.split('\n');
+    for (const QByteArray &rawLine : lines) {
+        const QString line = QString::fromUtf8(rawLine).trimmed();
+        if (line.isEmpty() || line.startsWith('#') || line.startsWith(';'))
+            continue;
+        if (line.startsWith('[')) {
+            if (!line.endsWith(']'))
+                return false;
+            section = line.mid(1, line.size() - 2).trimmed().toLower();
+            outSections[section];
+            continue;
+        }
+        const int ind = line.indexOf('=');
+        if (ind <= 0)
+            return false;
+        outSections[section][line.left(ind).trimmed().toLower()] = line.mid(ind + 1).trimmed();
+    }
+    return true;
+}
+
+// a comma-separated value, e.g. "Address = 10.0.0.2/32, fd00::2/128"
+QStringList toList(const QString &value)
+{
+    QStringList list;
+    const QStringList parts = value.split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        const QString trimmed = part.trimmed();
+        if (!trimmed.isEmpty())
+            list << trimmed;
+    }
+    return list;
+}
+
+} // namespace
+
 CUSTOM_CONFIG_TYPE WireguardCustomConfig::type() const
 {
     return CUSTOM_CONFIG_WIREGUARD;
@@ -58,57 +104,62 @@ QSharedPointer<WireGuardConfig> WireguardCustomConfig::getWireGuardConfig(const
 
 // static
 ICustomConfig *WireguardCustomConfig::makeFromFile(const QString &filepath)
+{
+    QFile file(filepath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        WireguardCustomConfig *config = new WireguardCustomConfig();
+        QFileInfo fi(filepath);
+        config->name_ = fi.completeBaseName();
+        config->filename_ = fi.fileName();
+        qDebug(LOG_CUSTOM_OVPN) << "Failed to open file" << Utils::cleanSensitiveInfo(filepath);
+        config->errMessage_ = QObject::tr("Failed to open file");
+        return config;
+    }
+    return makeFromData(filepath, file.readAll());
+}
+
+// static
+ICustomConfig *WireguardCustomConfig::makeFromData(const QString &filepath, const QByteArray &data)
 {
     WireguardCustomConfig *config = new WireguardCustomConfig();
     QFileInfo fi(filepath);
     config->name_ = fi.completeBaseName();
     config->filename_ = fi.fileName();
-    config->loadFromFile(filepath);  // here the config can change to incorrect
+    config->loadFromData(filepath, data);  // here the config can change to incorrect
     config->validate();
     return config;
 }
 
-void WireguardCustomConfig::loadFromFile(const QString &filepath)
+void WireguardCustomConfig::loadFromData(const QString &filepath, const QByteArray &data)
 {
-    QSettings file(filepath, QSettings::IniFormat);
-    switch (file.status()) {
-    default:
-    case QSettings::AccessError:
-        qDebug(LOG_CUSTOM_OVPN) << "Failed to open file" << Utils::cleanSensitiveInfo(filepath);
-        errMessage_ = QObject::tr("Failed to open file");
-        return;
-    case QSettings::FormatError:
+    IniSections sections;
+    if (!parseIni(data, sections)) {
         qDebug(LOG_CUSTOM_OVPN) << "Failed to parse file" << Utils::cleanSensitiveInfo(filepath);
         errMessage_ = QObject::tr("Invalid config format");
         return;
-    case QSettings::NoError:
-        // File exists and format is correct.
-        break;
     }
 
-    auto groups = file.childGroups();
-    if (groups.indexOf("Interface") < 0) {
+    if (!sections.contains("interface")) {
         errMessage_ = QObject::tr("Missing \"Interface\" section");
         return;
     }
-    file.beginGroup("Interface");
-    privateKey_ = file.value("PrivateKey").toString();
-    ipAddress_ = WireGuardConfig::stripIpv6Address(file.value("Address").toStringList());
-    dnsAddress_ = WireGuardConfig::stripIpv6Address(file.value("DNS").toStringList());
-    file.endGroup();
+    const IniValues &interfaceValues = sections["interface"];
+    privateKey_ = interfaceValues.value("privatekey");
+    ipAddress_ = WireGuardConfig::stripIpv6Address(toList(interfaceValues.value("address")));
+    dnsAddress_ = WireGuardConfig::stripIpv6Address(toList(interfaceValues.value("dns")));
 
-    if (groups.indexOf("Peer") < 0) {
+    if (!sections.contains("peer")) {
         errMessage_ = QObject::tr("Missing \"Peer\" section");
         return;
     }
-    file.beginGroup("Peer");
-    publicKey_ = file.value("PublicKey").toString();
-    presharedKey_ = file.value("PresharedKey").toString();
+    const IniValues &peerValues = sections["peer"];
+    publicKey_ = peerValues.value("publickey");
+    presharedKey_ = peerValues.value("presharedkey");
     allowedIps_ =
-        WireGuardConfig::stripIpv6Address(file.value("AllowedIPs", "0.0.0.0/0").toStringList());
+        WireGuardConfig::stripIpv6Address(toList(peerValues.value("allowedips", "0.0.0.0/0")));
     if (!allowedIps_.contains("/0"))
         isAllowFirewallAfterConnection_ = false;
-    QStringList endpointParts = file.value("Endpoint").toString().split(":");
+    QStringList endpointParts = peerValues.value("endpoint").split(":");
     endpointHostname_ = endpointParts[0];
     endpointPort_.clear();
     endpointPortNumber_ = 0;
@@ -117,7 +168,6 @@ void WireguardCustomConfig::loadFromFile(const QString &filepath)
         if (endpointPortNumber_ > 0)
             endpointPort_ = QString(":%1").arg(endpointPortNumber_);
     }
-    file.endGroup();
     nick_ = endpointHostname_;
 }
 
@@ -24,9 +24,11 @@ public:
     uint getEndpointPort() const { return endpointPortNumber_; }
 
     static ICustomConfig *makeFromFile(const QString &filepath);
+    // same as makeFromFile, but parses the already read content of the file
+    static ICustomConfig *makeFromData(const QString &filepath, const QByteArray &data);
 
 private:
-    void loadFromFile(const QString &filepath);
+    void loadFromData(const QString &filepath, const QByteArray &data);
     void validate();
 
     QString errMessage_;
@@ -1,8 +1,9 @@
 #include "engine.h"
 
 #include <QCoreApplication>
-#include <QCryptographicHash>
 #include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
 
 #include "connectionmanager/connectionmanager.h"
 #include "connectionmanager/finishactiveconnections.h"
@@ -23,6 +24,7 @@
 #include "utils/ipvalidation.h"
 #include "utils/logger.h"
 #include "utils/mergelog.h"
+#include "utils/tracing.h"
 #include "utils/utils.h"
 #include "utils/ws_assert.h"
 
@@ -62,6 +64,7 @@ Engine::Engine() : QObject(nullptr),
     macAddressController_(nullptr),
     keepAliveManager_(nullptr),
     packetSizeController_(nullptr),
+    metricsServer_(nullptr),
     checkUpdateManager_(nullptr),
     myIpManager_(nullptr),
 #ifdef Q_OS_WIN
@@ -515,6 +518,13 @@ void Engine::init()
     isCleanupFinished_ = false;
     connect(this, &Engine::initCleanup, this, &Engine::cleanupImpl);
 
+    bool isMetricsPortSet;
+    const int metricsPort = ExtraConfig::instance().getMetricsPort(isMetricsPortSet);
+    if (isMetricsPortSet) {
+        metricsServer_ = new metrics::MetricsServer(this);
+        metricsServer_->startServer(metricsPort);
+    }
+
     helper_ = CrossPlatformObjectFactory::createHelper(this);
     connect(helper_, &IHelper::lostConnectionToHelper, this, &Engine::onLostConnectionToHelper);
     helper_->startInstallHelper();
@@ -863,6 +873,7 @@ void Engine::cleanupImpl(bool isExitWithRestart, bool isFirewallChecked, bool is
     SAFE_DELETE(networkDetectionManager_);
     SAFE_DELETE(downloadHelper_);
     SAFE_DELETE(networkAccessManager_);
+    SAFE_DELETE(metricsServer_);
     isCleanupFinished_ = true;
     qCDebug(LOG_BASIC) << "Cleanup finished";
 
@@ -914,6 +925,7 @@ void Engine::sendConfirmEmailImpl()
 
 void Engine::connectClickImpl(const LocationID &locationId, const types::ConnectionSettings &connectionSettings)
 {
+    WS_TRACE_SCOPE("engine", "Engine::connectClickImpl");
     locationId_ = locationId;
     connectionSettingsOverride_ = connectionSettings;
 
@@ -946,6 +958,7 @@ void Engine::connectClickImpl(const LocationID &locationId, const types::Connect
     {
         bool bFirewallStateOn = firewallController_->firewallActualState();
         if (!bFirewallStateOn) {
+            WS_TRACE_SCOPE("engine", "firewallOn");
             qCDebug(LOG_BASIC) << "Automatic enable firewall before connection";
             firewallController_->firewallOn(
                 firewallExceptions_.connectingIp(),
@@ -976,6 +989,19 @@ void Engine::sendDebugLogImpl()
     log += "================================================================================================================================================================================================\n";
     log += MergeLog::mergeLogs(true);
 
+#ifdef WS_TRACING
+    // the trace of the recent connects, also kept next to the logs for Perfetto or chrome://tracing
+    const QByteArray trace = tracing::chromeTraceJson();
+    QSaveFile traceFile(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/trace_engine.json");
+    if (traceFile.open(QIODevice::WriteOnly)) {
+        traceFile.write(trace);
+        traceFile.commit();
+    }
+    log += "================================================================================================================================================================================================\n";
+    log += "Trace (Chrome trace event format):\n";
+    log += QString::fromUtf8(trace) + "\n";
+#endif
+
     server_api::BaseRequest *request = serverAPI_->debugLog(userName, log);
     connect(request, &server_api::BaseRequest::finished, this, &Engine::onDebugLogAnswer);
 }
@@ -1226,7 +1252,7 @@ void Engine::onCheckUpdateUpdated(const types::CheckUpdate &checkUpdate)
     emit checkUpdateUpdated(checkUpdate);
 }
 
-void Engine::onHostIPsChanged(const QSet<QString> &hostIps)
+void Engine::onHostIPsChanged(const IpAddressSet &hostIps)
 {
     //qCDebug(LOG_BASIC) << "on host ips changed event:" << hostIps;    // too much spam from this
     firewallExceptions_.setHostIPs(hostIps);
@@ -1695,7 +1721,10 @@ void Engine::detectAppropriatePacketSizeImpl()
         qCDebug(LOG_PACKET_SIZE) << "Detecting appropriate packet size";
         runningPacketDetection_ = true;
         emit packetSizeDetectionStateChanged(true, false);
-        packetSizeController_->detectAppropriatePacketSize(serverAPI_->getHostname());
+        types::NetworkInterface networkInterface;
+        networkDetectionManager_->getCurrentNetworkInterface(networkInterface);
+        // requested by the user, so the size cached for the network is not reused
+        packetSizeController_->detectAppropriatePacketSize(serverAPI_->getHostname(), networkInterface.networkOrSsid, false);
     }
     else
     {
@@ -1720,7 +1749,13 @@ void Engine::updateVersionImpl(qint64 windowHandle)
     {
         QMap<QString, QString> downloads;
         downloads.insert(installerUrl_, downloadHelper_->downloadInstallerPath());
-        downloadHelper_->get(downloads);
+        QMap<QString, QString> sha256Hashes;
+#ifdef Q_OS_LINUX
+        // the hash is verified while the installer is downloaded, as before only on Linux (the signature of the installer is checked on the other platforms)
+        if (!installerHash_.isEmpty())
+            sha256Hashes.insert(installerUrl_, installerHash_);
+#endif
+        downloadHelper_->get(downloads, sha256Hashes);
     }
 }
 
@@ -1755,10 +1790,15 @@ void Engine::onDownloadHelperFinished(const DownloadHelper::DownloadState &state
     lastDownloadProgress_ = 100;
     installerPath_ = downloadHelper_->downloadInstallerPath();
 
+    if (state == DownloadHelper::DOWNLOAD_STATE_HASH_MISMATCH)
+    {
+        qCDebug(LOG_AUTO_UPDATER) << "Incorrect hash, the installer is removed";
+        emit updateVersionChanged(0, UPDATE_VERSION_STATE_DONE, UPDATE_VERSION_ERROR_COMPARE_HASH_FAIL);
+        return;
+    }
     if (state != DownloadHelper::DOWNLOAD_STATE_SUCCESS)
     {
-        qCDebug(LOG_DOWNLOADER) << "Removing incomplete installer";
-        QFile::remove(installerPath_);
+        // the incomplete installer is kept, the next attempt continues it
         emit updateVersionChanged(0, UPDATE_VERSION_STATE_DONE, UPDATE_VERSION_ERROR_DL_FAIL);
         return;
     }
@@ -1796,14 +1836,6 @@ void Engine::onDownloadHelperFinished(const DownloadHelper::DownloadState &state
         emit updateVersionChanged(0, UPDATE_VERSION_STATE_DONE, UPDATE_VERSION_ERROR_API_HASH_INVALID);
         return;
     }
-
-    if (!verifyContentsSha256(installerPath_, installerHash_)) // installerPath_
-    {
-        qCDebug(LOG_AUTO_UPDATER) << "Incorrect hash, removing installer";
-        if (QFile::exists(installerPath_)) QFile::remove(installerPath_);
-        emit updateVersionChanged(0, UPDATE_VERSION_STATE_DONE, UPDATE_VERSION_ERROR_COMPARE_HASH_FAIL);
-        return;
-    }
 #endif
 
     emit updateVersionChanged(0, UPDATE_VERSION_STATE_RUNNING, UPDATE_VERSION_ERROR_NO_ERROR);
@@ -1941,10 +1973,10 @@ void Engine::syncRobert()
     QMetaObject::invokeMethod(this, "syncRobertImpl");
 }
 
-void Engine::onCustomConfigsChanged()
+void Engine::onCustomConfigsChanged(const customconfigs::CustomConfigsDelta &delta)
 {
     qCDebug(LOG_BASIC) << "Custom configs changed";
-    updateServerLocations();
+    locationsModel_->updateCustomConfigLocations(delta);
 }
 
 void Engine::onLocationsModelWhitelistIpsChanged(const QStringList &ips)
@@ -2420,23 +2452,6 @@ void Engine::updateProxySettings()
     }
 }
 
-bool Engine::verifyContentsSha256(const QString &filename, const QString &compareHash)
-{
-    QFile file(filename);
-    if (!file.open(QIODevice::ReadOnly))
-    {
-        qCDebug(LOG_BASIC) << "Failed to open installer for reading";
-        return false;
-    }
-    QByteArray contentsBytes = file.readAll();
-    QString sha256Hash = QCryptographicHash::hash(contentsBytes, QCryptographicHash::Sha256).toHex();
-    if (sha256Hash == compareHash)
-    {
-        return true;
-    }
-    return false;
-}
-
 #ifdef Q_OS_WIN
 void Engine::enableDohSettings()
 {
@@ -21,6 +21,7 @@
 #include "helper/ihelper.h"
 #include "helper/initializehelper.h"
 #include "locationsmodel/enginelocationsmodel.h"
+#include "metrics/metricsserver.h"
 #include "networkaccessmanager/networkaccessmanager.h"
 #include "networkdetectionmanager/inetworkdetectionmanager.h"
 #include "packetsizecontroller.h"
@@ -235,7 +236,7 @@ private slots:
     void onFailOverTryingBackupEndpoint(int num, int cnt);
 
     void onCheckUpdateUpdated(const types::CheckUpdate &checkUpdate);
-    void onHostIPsChanged(const QSet<QString> &hostIps);
+    void onHostIPsChanged(const IpAddressSet &hostIps);
     void onMyIpManagerIpChanged(const QString &ip, bool isFromDisconnectedState);
     void onDebugLogAnswer();
     void onConfirmEmailAnswer();
@@ -281,7 +282,7 @@ private slots:
     void syncRobertImpl();
 
 
-    void onCustomConfigsChanged();
+    void onCustomConfigsChanged(const customconfigs::CustomConfigsDelta &delta);
 
     void onLocationsModelWhitelistIpsChanged(const QStringList &ips);
     void onLocationsModelWhitelistCustomConfigIpsChanged(const QStringList &ips);
@@ -308,7 +309,6 @@ private slots:
 private:
     void initPart2();
     void updateProxySettings();
-    bool verifyContentsSha256(const QString &filename, const QString &compareHash);
 
 #ifdef Q_OS_WIN
     void enableDohSettings();
@@ -330,6 +330,7 @@ private:
     IMacAddressController *macAddressController_;
     KeepAliveManager *keepAliveManager_;
     PacketSizeController *packetSizeController_;
+    metrics::MetricsServer *metricsServer_;     // null unless enabled in the advanced parameters
 
     QScopedPointer<api_resources::ApiResourcesManager> apiResourcesManager_;    // can be null for the custom config mode or when we in the logout state
     api_resources::CheckUpdateManager *checkUpdateManager_;
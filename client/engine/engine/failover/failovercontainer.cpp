@@ -9,6 +9,7 @@
 #include "failovers/cdndomainfailover.h"
 #include "utils/hardcodedsettings.h"
 #include "utils/dga_library.h"
+#include "engine/metrics/metrics.h"
 #include "utils/logger.h"
 #include "utils/utils.h"
 #include "utils/ws_assert.h"
@@ -107,6 +108,8 @@ QSharedPointer<BaseFailover> FailoverContainer::currentFailover(int *outInd /*=
 bool FailoverContainer::gotoNext()
 {
     if (curFailoverInd_ <  (failovers_.size() - 1)) {
+        static metrics::Counter &attempts = metrics::counter("ws_failover_attempts_total", "Switches to the next failover");
+        attempts.inc();
         curFailoverInd_++;
         currentFailover_ = failoverById(failovers_[curFailoverInd_]);
         return !currentFailover_.isNull();
@@ -115,6 +118,19 @@ bool FailoverContainer::gotoNext()
     }
 }
 
+bool FailoverContainer::gotoFailover(const QString &failoverUniqueId)
+{
+    const int ind = failovers_.indexOf(failoverUniqueId);
+    if (ind == -1)
+        return false;
+    QSharedPointer<BaseFailover> failover = failoverById(failoverUniqueId);
+    if (!failover)
+        return false;
+    curFailoverInd_ = ind;
+    currentFailover_ = failover;
+    return true;
+}
+
 QSharedPointer<BaseFailover> FailoverContainer::failoverById(const QString &failoverUniqueId)
 {
     if (failoverUniqueId == FAILOVER_DEFAULT_HARDCODED) {
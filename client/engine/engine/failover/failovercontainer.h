@@ -22,6 +22,7 @@ public:
     QSharedPointer<BaseFailover> currentFailover(int *outInd = nullptr) override;
     bool gotoNext() override;
     QSharedPointer<BaseFailover> failoverById(const QString &failoverUniqueId) override;
+    bool gotoFailover(const QString &failoverUniqueId) override;
     int count() const override;
 
 private:
@@ -23,6 +23,8 @@ public:
     virtual bool gotoNext() = 0;
     // return failover by unique identifier or null if not found
     virtual QSharedPointer<BaseFailover> failoverById(const QString &failoverUniqueId) = 0;
+    // switch the current position to the failover with the unique identifier or return false if it's not in the container
+    virtual bool gotoFailover(const QString &failoverUniqueId) = 0;
     virtual int count() const = 0;
 };
 
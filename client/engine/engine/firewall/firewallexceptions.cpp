@@ -6,7 +6,7 @@
 #include "utils/logger.h"
 #include "engine/dnsresolver/dnsutils.h"
 
-void FirewallExceptions::setHostIPs(const QSet<QString> &hostIPs)
+void FirewallExceptions::setHostIPs(const IpAddressSet &hostIPs)
 {
     hostIPs_ = hostIPs;
 }
@@ -104,10 +104,8 @@ QSet<QString> FirewallExceptions::getIPAddressesForFirewall() const
         ipList.add(s);
     }
 
-    for (const QString &s : hostIPs_) {
-        if (!s.isEmpty()) {
-            ipList.add(s);
-        }
+    for (const IpAddress &ip : hostIPs_) {
+        ipList.add(ip);
     }
 
     if (!proxyIP_.isEmpty()) {
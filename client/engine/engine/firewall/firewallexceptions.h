@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QSharedPointer>
+#include "engine/utils/ipaddressmap.h"
 #include "types/proxysettings.h"
 
 class FirewallExceptions
@@ -8,7 +9,7 @@ class FirewallExceptions
 public:
     FirewallExceptions();
 
-    void setHostIPs(const QSet<QString> &hostIPs);
+    void setHostIPs(const IpAddressSet &hostIPs);
     void setProxyIP(const types::ProxySettings &proxySettings);
 
     void setCustomRemoteIp(const QString &remoteIP, bool &bChanged);
@@ -26,7 +27,7 @@ public:
     const QString& connectingIp() const;
 
 private:
-    QSet<QString> hostIPs_;
+    IpAddressSet hostIPs_;
     QString proxyIP_;
     QString remoteIP_;
     QStringList locationsPingIPs_;
@@ -1,15 +1,19 @@
 #include "uniqueiplist.h"
-#include "utils/ipvalidation.h"
 
 void UniqueIpList::add(const QString &ip)
 {
-    if (IpValidation::isIp(ip))
+    add(IpAddress::fromString(ip));
+}
+
+void UniqueIpList::add(const IpAddress &ip)
+{
+    if (ip.isIPv4())
     {
-        set_ << ip;
+        set_.insert(ip);
     }
 }
 
 QSet<QString> UniqueIpList::get() const
 {
-    return set_;
+    return set_.toStringSet();
 }
@@ -3,12 +3,16 @@
 #include <QString>
 #include <QSet>
 
+#include "engine/utils/ipaddressmap.h"
+
+// IPv4 addresses for the firewall, the duplicates and the other strings are dropped
 class UniqueIpList
 {
 public:
     void add(const QString &ip);
+    void add(const IpAddress &ip);
     QSet<QString> get() const;
 
 private:
-    QSet<QString> set_;
+    IpAddressSet set_;
 };
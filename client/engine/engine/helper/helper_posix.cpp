@@ -1,6 +1,7 @@
 #include "helper_posix.h"
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
+#include "utils/tracing.h"
 #include <QElapsedTimer>
 #include <QDir>
 #include <QFile>
@@ -14,11 +15,14 @@
 #include "engine/wireguardconfig/wireguardconfig.h"
 #include "types/wireguardtypes.h"
 #include "engine/connectionmanager/adaptergatewayinfo.h"
+#include "engine/metrics/metrics.h"
 #include "utils/ws_assert.h"
 #include "utils/macutils.h"
 #include "utils/executable_signature/executable_signature.h"
 #include "../../../../backend/posix_common/helper_commands_serialize.h"
 
+#include <sys/socket.h>
+
 #ifdef Q_OS_LINUX
     #include "utils/dnsscripts_linux.h"
 #endif
@@ -31,7 +35,7 @@ Helper_posix *g_this_ = NULL;
 
 Helper_posix::Helper_posix(QObject *parent) : IHelper(parent), bIPV6State_(true), cmdId_(0), lastOpenVPNCmdId_(0)
   , ep_(SOCK_PATH), bHelperConnectedEmitted_(false)
-  , curState_(STATE_INIT), bNeedFinish_(false), firstConnectToHelperErrorReported_(false)
+  , waitSocketFd_(-1), isWaitCancelled_(false), curState_(STATE_INIT), bNeedFinish_(false), firstConnectToHelperErrorReported_(false)
 {
     WS_ASSERT(g_this_ == NULL);
     g_this_ = this;
@@ -373,6 +377,92 @@ bool Helper_posix::getWireGuardStatus(types::WireGuardStatus *status)
         return false;
     }
 
+    wireGuardStatusFromAnswer(answer, status);
+    return true;
+}
+
+bool Helper_posix::waitWireGuardStatus(const types::WireGuardStatus &lastStatus, int timeoutMs, int statisticsIntervalMs, types::WireGuardStatus *status)
+{
+    QMutexLocker locker(&mutexWaitSocket_);
+
+    if (curState_ != STATE_CONNECTED) {
+        return false;
+    }
+
+    if (!waitSocket_) {
+        boost::system::error_code ec;
+        waitSocket_.reset(new boost::asio::local::stream_protocol::socket(io_service_));
+        waitSocket_->connect(ep_, ec);
+        if (ec) {
+            qCDebug(LOG_WIREGUARD) << "Can't connect to the helper for the WireGuard status:" << ec.value();
+            waitSocket_.reset();
+            return false;
+        }
+        QMutexLocker fdLocker(&mutexWaitSocketFd_);
+        waitSocketFd_ = waitSocket_->native_handle();
+    }
+    // checked after the descriptor is set, so that a cancel from now on shuts it down
+    if (isWaitCancelled_) {
+        return false;
+    }
+
+    CMD_WAIT_WIREGUARD_STATUS cmd;
+    switch (lastStatus.state) {
+    case types::WireGuardState::NONE:       cmd.lastState = kWgStateNone; break;
+    case types::WireGuardState::FAILURE:    cmd.lastState = kWgStateError; break;
+    case types::WireGuardState::STARTING:   cmd.lastState = kWgStateStarting; break;
+    case types::WireGuardState::LISTENING:  cmd.lastState = kWgStateListening; break;
+    case types::WireGuardState::CONNECTING: cmd.lastState = kWgStateConnecting; break;
+    case types::WireGuardState::ACTIVE:     cmd.lastState = kWgStateActive; break;
+    }
+    cmd.lastBytesReceived = lastStatus.bytesReceived;
+    cmd.lastBytesTransmitted = lastStatus.bytesTransmitted;
+    cmd.timeoutMs = timeoutMs;
+    cmd.statisticsIntervalMs = statisticsIntervalMs;
+
+    std::stringstream stream;
+    boost::archive::text_oarchive oa(stream, boost::archive::no_header);
+    oa << cmd;
+
+    CMD_ANSWER answer;
+    if (!sendCmdToHelper(*waitSocket_, HELPER_CMD_WAIT_WIREGUARD_STATUS, stream.str()) || !readAnswer(*waitSocket_, answer)) {
+        // the descriptor is closed under the lock, so a cancel never shuts down a descriptor reused by someone else
+        QMutexLocker fdLocker(&mutexWaitSocketFd_);
+        waitSocketFd_ = -1;
+        waitSocket_.reset();
+        return false;
+    }
+    // the helper doesn't support this command
+    if (!answer.executed) {
+        return false;
+    }
+
+    if (status) {
+        status->errorCode = 0;
+        status->bytesReceived = status->bytesTransmitted = 0;
+        wireGuardStatusFromAnswer(answer, status);
+    }
+    return true;
+}
+
+void Helper_posix::cancelWaitWireGuardStatus()
+{
+    isWaitCancelled_ = true;
+    // unblocks the read in waitWireGuardStatus(), the socket is closed there
+    QMutexLocker fdLocker(&mutexWaitSocketFd_);
+    if (waitSocketFd_ >= 0) {
+        ::shutdown(waitSocketFd_, SHUT_RDWR);
+    }
+}
+
+void Helper_posix::resetWaitWireGuardStatus()
+{
+    isWaitCancelled_ = false;
+}
+
+// static
+void Helper_posix::wireGuardStatusFromAnswer(const CMD_ANSWER &answer, types::WireGuardStatus *status)
+{
     switch (answer.cmdId) {
     default:
     case kWgStateNone:
@@ -397,7 +487,6 @@ bool Helper_posix::getWireGuardStatus(types::WireGuardStatus *status)
         status->bytesTransmitted = answer.customInfoValue[1];
         break;
     }
-    return true;
 }
 
 void Helper_posix::setDefaultWireGuardDeviceName(const QString &deviceName)
@@ -742,25 +831,35 @@ void Helper_posix::doDisconnectAndReconnect()
 
 bool Helper_posix::runCommand(int cmdId, const std::string &data, CMD_ANSWER &answer)
 {
+    static metrics::Histogram &duration = metrics::histogram("ws_helper_command_duration_seconds", "Round trip time of the commands to the helper");
+    WS_TRACE_SCOPE_VALUE("helper", "Helper_posix::runCommand", cmdId);
+    QElapsedTimer timer;
+    timer.start();
+
     bool ret = sendCmdToHelper(cmdId, data);
-    if (!ret) {
-        return ret;
+    if (ret) {
+        ret = readAnswer(answer);
     }
-
-    return readAnswer(answer);
+    duration.record(timer.nsecsElapsed() / 1000);
+    return ret;
 }
 
 bool Helper_posix::readAnswer(CMD_ANSWER &outAnswer)
+{
+    return readAnswer(*socket_, outAnswer);
+}
+
+bool Helper_posix::readAnswer(boost::asio::local::stream_protocol::socket &socket, CMD_ANSWER &outAnswer)
 {
     boost::system::error_code ec;
     int length;
-    boost::asio::read(*socket_, boost::asio::buffer(&length, sizeof(length)),
+    boost::asio::read(socket, boost::asio::buffer(&length, sizeof(length)),
                       boost::asio::transfer_exactly(sizeof(length)), ec);
     if (ec) {
         return false;
     } else {
         std::vector<char> buff(length);
-        boost::asio::read(*socket_, boost::asio::buffer(&buff[0], length),
+        boost::asio::read(socket, boost::asio::buffer(&buff[0], length),
                           boost::asio::transfer_exactly(length), ec);
         if (ec) {
             return false;
@@ -776,30 +875,38 @@ bool Helper_posix::readAnswer(CMD_ANSWER &outAnswer)
 }
 
 bool Helper_posix::sendCmdToHelper(int cmdId, const std::string &data)
+{
+    return sendCmdToHelper(*socket_, cmdId, data);
+}
+
+bool Helper_posix::sendCmdToHelper(boost::asio::local::stream_protocol::socket &socket, int cmdId, const std::string &data)
 {
     int length = data.size();
     boost::system::error_code ec;
 
     // first 4 bytes - cmdId
-    boost::asio::write(*socket_, boost::asio::buffer(&cmdId, sizeof(cmdId)), boost::asio::transfer_exactly(sizeof(cmdId)), ec);
+    boost::asio::write(socket, boost::asio::buffer(&cmdId, sizeof(cmdId)), boost::asio::transfer_exactly(sizeof(cmdId)), ec);
     if (ec) {
         return false;
     }
     // second 4 bytes - pid
     const auto pid = getpid();
-    boost::asio::write(*socket_, boost::asio::buffer(&pid, sizeof(pid)), boost::asio::transfer_exactly(sizeof(pid)), ec);
+    boost::asio::write(socket, boost::asio::buffer(&pid, sizeof(pid)), boost::asio::transfer_exactly(sizeof(pid)), ec);
     if (ec) {
         return false;
     }
     // third 4 bytes - size of buffer
-    boost::asio::write(*socket_, boost::asio::buffer(&length, sizeof(length)), boost::asio::transfer_exactly(sizeof(length)), ec);
+    boost::asio::write(socket, boost::asio::buffer(&length, sizeof(length)), boost::asio::transfer_exactly(sizeof(length)), ec);
     if (ec) {
         return false;
     }
     // body of message
-    boost::asio::write(*socket_, boost::asio::buffer(data.data(), length), boost::asio::transfer_exactly(length), ec);
+    boost::asio::write(socket, boost::asio::buffer(data.data(), length), boost::asio::transfer_exactly(length), ec);
     if (ec) {
-        doDisconnectAndReconnect();
+        // only the main connection is restored
+        if (&socket == socket_.get()) {
+            doDisconnectAndReconnect();
+        }
         return false;
     }
 
@@ -39,6 +39,13 @@ public:
     bool configureWireGuard(const WireGuardConfig &config) override;
     bool getWireGuardStatus(types::WireGuardStatus *status) override;
     void setDefaultWireGuardDeviceName(const QString &deviceName) override;
+    // Blocks until the WireGuard state differs from lastStatus, the statistics change (not more often than statisticsIntervalMs)
+    // or timeoutMs passes. Uses its own connection to the helper, so the other commands are not blocked meanwhile.
+    // Returns false if the helper doesn't support it, the connection failed or the wait was cancelled.
+    bool waitWireGuardStatus(const types::WireGuardStatus &lastStatus, int timeoutMs, int statisticsIntervalMs, types::WireGuardStatus *status);
+    // Can be called from any thread, the next waits fail until resetWaitWireGuardStatus() is called.
+    void cancelWaitWireGuardStatus();
+    void resetWaitWireGuardStatus();
 
     // ctrld functions
     ExecuteError startCtrld(const QString &exeName, const QString &parameters) override;
@@ -99,6 +106,13 @@ protected:
     boost::scoped_ptr<boost::asio::local::stream_protocol::socket> socket_;
     QMutex mutexSocket_;
 
+    // the connection for waitWireGuardStatus()
+    boost::scoped_ptr<boost::asio::local::stream_protocol::socket> waitSocket_;
+    QMutex mutexWaitSocket_;        // held by waitWireGuardStatus() for the whole wait
+    QMutex mutexWaitSocketFd_;      // held shortly while the socket is opened or closed, and by the cancel, never during the blocking read
+    int waitSocketFd_;
+    std::atomic<bool> isWaitCancelled_;
+
     QElapsedTimer reconnectElapsedTimer_;
     bool bHelperConnectedEmitted_;
 
@@ -116,9 +130,13 @@ protected:
     void doDisconnectAndReconnect();
 
     bool readAnswer(CMD_ANSWER &outAnswer);
+    bool readAnswer(boost::asio::local::stream_protocol::socket &socket, CMD_ANSWER &outAnswer);
     bool sendCmdToHelper(int cmdId, const std::string &data);
+    bool sendCmdToHelper(boost::asio::local::stream_protocol::socket &socket, int cmdId, const std::string &data);
     bool runCommand(int cmdId, const std::string &data, CMD_ANSWER &answer);
 
 private:
     bool firstConnectToHelperErrorReported_;
+
+    static void wireGuardStatusFromAnswer(const CMD_ANSWER &answer, types::WireGuardStatus *status);
 };
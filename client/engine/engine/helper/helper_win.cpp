@@ -2,6 +2,7 @@
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QElapsedTimer>
 
 #include <sstream>
 
@@ -9,12 +10,14 @@
 
 #include "../../../../backend/windows/windscribe_service/ipc/serialize_structs.h"
 #include "engine/connectionmanager/adaptergatewayinfo.h"
+#include "engine/metrics/metrics.h"
 #include "engine/openvpnversioncontroller.h"
 #include "engine/wireguardconfig/wireguardconfig.h"
 #include "installhelper_win.h"
 #include "types/wireguardtypes.h"
 #include "utils/executable_signature/executable_signature.h"
 #include "utils/logger.h"
+#include "utils/tracing.h"
 #include "utils/win32handle.h"
 #include "utils/ws_assert.h"
 #include "utils/winutils.h"
@@ -756,6 +759,17 @@ void Helper_win::run()
 }
 
 MessagePacketResult Helper_win::sendCmdToHelper(int cmdId, const std::string &data)
+{
+    static metrics::Histogram &duration = metrics::histogram("ws_helper_command_duration_seconds", "Round trip time of the commands to the helper");
+    WS_TRACE_SCOPE_VALUE("helper", "Helper_win::sendCmdToHelper", cmdId);
+    QElapsedTimer timer;
+    timer.start();
+    MessagePacketResult mpr = sendCmdToHelperImpl(cmdId, data);
+    duration.record(timer.nsecsElapsed() / 1000);
+    return mpr;
+}
+
+MessagePacketResult Helper_win::sendCmdToHelperImpl(int cmdId, const std::string &data)
 {
     HANDLE hPipe = ::CreateFileW(SERVICE_PIPE_NAME, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_EXISTING, 0, 0);
     if (hPipe == INVALID_HANDLE_VALUE) {
@@ -115,6 +115,7 @@ private:
     wsl::ServiceControlManager scm_;
 
     MessagePacketResult sendCmdToHelper(int cmdId, const std::string &data);
+    MessagePacketResult sendCmdToHelperImpl(int cmdId, const std::string &data);
     bool disableIPv6();
     bool enableIPv6();
 
@@ -10,7 +10,8 @@
 namespace locationsmodel {
 
 ApiLocationsModel::ApiLocationsModel(QObject *parent, IConnectStateController *stateController, INetworkDetectionManager *networkDetectionManager, PingMultipleHosts *pingHosts) : QObject(parent),
-    pingManager_(this, stateController, networkDetectionManager, pingHosts, "pingStorage", "ping_log.txt")
+    pingManager_(this, stateController, networkDetectionManager, pingHosts, "pingStorage", "ping_log.txt"),
+    isLocationsSent_(false)
 {
     if (bestLocation_.isValid())
     {
@@ -55,6 +56,7 @@ void ApiLocationsModel::setLocations(const QVector<apiinfo::Location> &locations
     }
 
     pingManager_.updateIps(ips);
+    updatePingIndex();
     sendLocationsUpdated();
 }
 
@@ -63,7 +65,11 @@ void ApiLocationsModel::clear()
     locations_.clear();
     staticIps_ = apiinfo::StaticIps();
     pingManager_.clearIps();
-    QSharedPointer<QVector<types::Location> > empty(new QVector<types::Location>());
+    bestLocationTracker_.clear();
+    locationsByPingIp_.clear();
+    sentLocations_.clear();
+    isLocationsSent_ = true;
+    QSharedPointer<types::LocationsDelta> empty(new types::LocationsDelta(types::LocationsDelta::makeReset(QVector<types::Location>())));
     emit locationsUpdated(LocationID(), QString(),  empty);
 }
 
@@ -145,79 +151,31 @@ QSharedPointer<BaseLocationInfo> ApiLocationsModel::getMutableLocationInfoById(c
 
 void ApiLocationsModel::onPingInfoChanged(const QString &ip, int timems)
 {
-    if (pingManager_.isAllNodesHaveCurIteration()) {
-        detectBestLocation(true);
-    }
+    // the best location is chosen by the score, which also penalizes the jitter and the losses
+    bestLocationTracker_.setPing(ip, pingManager_.getScore(ip));
 
-    for (const apiinfo::Location &l : locations_) {
-        for (int i = 0; i < l.groupsCount(); ++i) {
-            const apiinfo::Group group = l.getGroup(i);
-            if (group.getPingIp() == ip) {
-                emit locationPingTimeChanged(LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick()), timems);
-            }
-        }
+    if (pingManager_.isBestNodeKnown()) {
+        detectBestLocation(true);
     }
 
-    if (staticIps_.getIpsCount() > 0) {
-        for (int i = 0; i < staticIps_.getIpsCount(); ++i) {
-            const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
-            if (sid.getPingIp() == ip) {
-                emit locationPingTimeChanged(LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp), timems);
-                break;
-            }
+    const auto it = locationsByPingIp_.constFind(ip);
+    if (it != locationsByPingIp_.constEnd()) {
+        for (const LocationID &lid : it.value()) {
+            emit locationPingTimeChanged(lid, timems);
         }
     }
 }
 
 void ApiLocationsModel::detectBestLocation(bool isAllNodesInDisconnectedState)
 {
-    int minLatency = INT_MAX;
-    LocationID locationIdWithMinLatency;
-
     // Commented debug entry out as this method is potentially called every minute and we don't
     // need to flood the log with this info.
     // qCDebug(LOG_BEST_LOCATION) << "LocationsModel::detectBestLocation, isAllNodesInDisconnectedState=" << isAllNodesInDisconnectedState;
 
-    int prevBestLocationLatency = INT_MAX;
-
-    int ind = 0;
-    for (const apiinfo::Location &l : locations_)
-    {
-        for (int i = 0; i < l.groupsCount(); ++i)
-        {
-            const apiinfo::Group group = l.getGroup(i);
-
-            if (group.isDisabled())
-            {
-                continue;
-            }
-
-            LocationID lid = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick());
-            int latency = pingManager_.getPing(group.getPingIp()).toInt();
-
-            // we assume a maximum ping time for three bars when no ping info
-            if (latency == PingTime::NO_PING_INFO)
-            {
-                latency = PingTime::LATENCY_STEP1;
-            }
-            else if (latency == PingTime::PING_FAILED)
-            {
-                latency = PingTime::MAX_LATENCY_FOR_PING_FAILED;
-            }
-
-            if (bestLocation_.isValid() && lid == bestLocation_.getId())
-            {
-                prevBestLocationLatency = latency;
-            }
-            if (latency != PingTime::PING_FAILED && latency < minLatency)
-            {
-                minLatency = latency;
-                locationIdWithMinLatency = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick()) ;
-            }
-        }
-
-        ind++;
-    }
+    // the tracker is kept up to date by the ping results, the latencies are already the effective ones
+    const int minLatency = bestLocationTracker_.bestLatency();
+    const LocationID locationIdWithMinLatency = bestLocationTracker_.best();
+    const int prevBestLocationLatency = bestLocation_.isValid() ? bestLocationTracker_.latency(bestLocation_.getId()) : INT_MAX;
 
     LocationID prevBestLocationId;
     if (bestLocation_.isValid())
@@ -285,9 +243,8 @@ void ApiLocationsModel::detectBestLocation(bool isAllNodesInDisconnectedState)
 
 BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
 {
-    QSharedPointer <QVector<types::Location> > items(new QVector<types::Location>());
-
     BestAndAllLocations ball;
+    QVector<types::Location> &items = ball.locations;
     bool isBestLocationValid = false;
 
     for (const apiinfo::Location &l : locations_)
@@ -319,7 +276,7 @@ BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
             }
         }
 
-        *items << item;
+        items << item;
     }
 
     LocationID bestLocation;
@@ -330,14 +287,14 @@ BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
     // use first city of first location as best location (if at least on node in the city exists)
     else
     {
-        for (int l = 0; l < items->count(); ++l)
+        for (int l = 0; l < items.count(); ++l)
         {
-            for (int c = 0; c < items->at(l).cities.count(); ++c)
+            for (int c = 0; c < items.at(l).cities.count(); ++c)
             {
-                if (!items->at(l).cities[c].isDisabled)
+                if (!items.at(l).cities[c].isDisabled)
                 {
-                    bestLocation = items->at(l).cities[c].id.apiLocationToBestLocation();
-                    qCDebug(LOG_BEST_LOCATION) << "Best location chosen as the first city of the first location:" << items->at(l).cities[c].city << items->at(l).cities[c].nick;
+                    bestLocation = items.at(l).cities[c].id.apiLocationToBestLocation();
+                    qCDebug(LOG_BEST_LOCATION) << "Best location chosen as the first city of the first location:" << items.at(l).cities[c].city << items.at(l).cities[c].nick;
                     break;
                 }
             }
@@ -376,18 +333,26 @@ BestAndAllLocations ApiLocationsModel::generateLocationsUpdated()
             item.cities << city;
         }
 
-        *items << item;
+        items << item;
     }
 
     ball.bestLocation = bestLocation;
-    ball.locations = items;
     return ball;
 }
 
 void ApiLocationsModel::sendLocationsUpdated()
 {
     BestAndAllLocations ball = generateLocationsUpdated();
-    emit locationsUpdated(ball.bestLocation, ball.staticIpDeviceName, ball.locations);
+
+    QSharedPointer<types::LocationsDelta> delta(new types::LocationsDelta());
+    if (isLocationsSent_)
+        *delta = types::LocationsDelta::make(sentLocations_, ball.locations);
+    else
+        *delta = types::LocationsDelta::makeReset(ball.locations);
+
+    sentLocations_ = ball.locations;
+    isLocationsSent_ = true;
+    emit locationsUpdated(ball.bestLocation, ball.staticIpDeviceName, delta);
 }
 
 void ApiLocationsModel::whitelistIps()
@@ -404,6 +369,45 @@ void ApiLocationsModel::whitelistIps()
     emit whitelistIpsChanged(ips);
 }
 
+void ApiLocationsModel::updatePingIndex()
+{
+    bestLocationTracker_.clear();
+    locationsByPingIp_.clear();
+    for (const apiinfo::Location &l : locations_)
+    {
+        for (int i = 0; i < l.groupsCount(); ++i)
+        {
+            const apiinfo::Group group = l.getGroup(i);
+            const LocationID lid = LocationID::createApiLocationId(l.getId(), group.getCity(), group.getNick());
+            locationsByPingIp_[group.getPingIp()] << lid;
+            if (!group.isDisabled())
+            {
+                bestLocationTracker_.add(lid, group.getPingIp(), pingManager_.getScore(group.getPingIp()));
+            }
+        }
+    }
+
+    for (int i = 0; i < staticIps_.getIpsCount(); ++i)
+    {
+        const apiinfo::StaticIpDescr &sid = staticIps_.getIp(i);
+        QVector<LocationID> &lids = locationsByPingIp_[sid.getPingIp()];
+        // only the first static ip with this ping ip gets the ping time, as before
+        bool isFound = false;
+        for (const LocationID &lid : lids)
+        {
+            if (lid.isStaticIpsLocation())
+            {
+                isFound = true;
+                break;
+            }
+        }
+        if (!isFound)
+        {
+            lids << LocationID::createStaticIpsLocationId(sid.cityName, sid.staticIp);
+        }
+    }
+}
+
 bool ApiLocationsModel::isChanged(const QVector<apiinfo::Location> &locations, const apiinfo::StaticIps &staticIps)
 {
     return locations_ != locations || staticIps_ != staticIps;
@@ -5,6 +5,7 @@
 
 #include "baselocationinfo.h"
 #include "bestlocation.h"
+#include "bestlocationtracker.h"
 #include "engine/apiinfo/location.h"
 #include "engine/apiinfo/staticips.h"
 #include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
@@ -12,13 +13,14 @@
 #include "engine/ping/pingmanager.h"
 #include "types/location.h"
 #include "types/locationid.h"
+#include "types/locationsdelta.h"
 
 namespace locationsmodel {
 
 struct BestAndAllLocations {
     LocationID bestLocation;
     QString staticIpDeviceName;
-    QSharedPointer<QVector<types::Location> > locations;
+    QVector<types::Location> locations;
 };
 
 // Managing locations (generic API-locations and static IPs locations). Converts the apiinfo::Location vector to LocationItem vector.
@@ -35,8 +37,8 @@ public:
     QSharedPointer<BaseLocationInfo> getMutableLocationInfoById(const LocationID &locationId);
 
 signals:
-    void locationsUpdated( const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<QVector<types::Location> > locations);
-    void locationsUpdatedCliOnly(const LocationID &bestLocation, QSharedPointer<QVector<types::Location> > locations);
+    // only the changes against the previously sent list of locations are sent (the first one is the reset delta)
+    void locationsUpdated( const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<types::LocationsDelta> delta);
     void locationPingTimeChanged(const LocationID &id, PingTime timeMs);
     void bestLocationUpdated( const LocationID &bestLocation);
     void whitelistIpsChanged(const QStringList &ips);
@@ -51,13 +53,19 @@ private:
     QVector<apiinfo::Location> locations_;
     apiinfo::StaticIps staticIps_;
     BestLocation bestLocation_;
+    BestLocationTracker bestLocationTracker_;
+    QHash<QString, QVector<LocationID>> locationsByPingIp_;    // the API and static IP locations pinged by each ip
     PingManager pingManager_;
 
+    QVector<types::Location> sentLocations_;    // the last list of locations sent to the GUI, to calculate the delta
+    bool isLocationsSent_;
+
 private:
     void detectBestLocation(bool isAllNodesInDisconnectedState);
     BestAndAllLocations generateLocationsUpdated();
     void sendLocationsUpdated();
     void whitelistIps();
+    void updatePingIndex();
 
     bool isChanged(const QVector<apiinfo::Location> &locations, const apiinfo::StaticIps &staticIps);
 };
@@ -1,13 +1,17 @@
 #include "bestlocation.h"
 
 #include <QIODevice>
-#include <QSettings>
+#include "utils/settingsstore.h"
 #include "utils/ws_assert.h"
 #include "utils/simplecrypt.h"
 #include "types/global_consts.h"
 
 namespace locationsmodel {
 
+namespace {
+const SettingsKey<QString> kBestLocationKey { "bestLocation" };
+}
+
 BestLocation::BestLocation() : isValid_(false), isDetectedFromThisAppStart_(false), isDetectedWithDisconnectedIps_(0)
 {
     loadFromSettings();
@@ -61,19 +65,18 @@ void BestLocation::saveToSettings()
             ds << id_;
         }
 
-        QSettings settings;
         SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-        settings.setValue("bestLocation", simpleCrypt.encryptToString(arr));
+        SettingsStore::instance().setValue(kBestLocationKey, simpleCrypt.encryptToString(arr));
     }
 }
 
 void BestLocation::loadFromSettings()
 {
-    QSettings settings;
-    if (settings.contains("bestLocation"))
+    SettingsStore &settings = SettingsStore::instance();
+    if (settings.contains(kBestLocationKey))
     {
         SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-        QString str = settings.value("bestLocation", "").toString();
+        QString str = settings.value(kBestLocationKey);
         QByteArray arr = simpleCrypt.decryptToByteArray(str);
 
         QDataStream ds(&arr, QIODevice::ReadOnly);
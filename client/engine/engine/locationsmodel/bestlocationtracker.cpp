@@ -0,0 +1,74 @@
+#include "bestlocationtracker.h"
+
+#include <climits>
+
+namespace locationsmodel {
+
+void BestLocationTracker::clear()
+{
+    entries_.clear();
+    index_.clear();
+    entriesByPingIp_.clear();
+    entriesById_.clear();
+}
+
+void BestLocationTracker::add(const LocationID &id, const QString &pingIp, PingTime ping)
+{
+    const int ind = entries_.size();
+    const int latency = effectiveLatency(ping);
+    entries_ << Entry { id, latency };
+    index_.emplace(latency, ind);
+    entriesByPingIp_[pingIp] << ind;
+    entriesById_.insert(id, ind);
+}
+
+void BestLocationTracker::setPing(const QString &pingIp, PingTime ping)
+{
+    auto it = entriesByPingIp_.constFind(pingIp);
+    if (it == entriesByPingIp_.constEnd())
+        return;
+
+    const int latency = effectiveLatency(ping);
+    for (int ind : it.value())
+    {
+        Entry &entry = entries_[ind];
+        if (entry.latency == latency)
+            continue;
+        index_.erase(std::make_pair(entry.latency, ind));
+        entry.latency = latency;
+        index_.emplace(latency, ind);
+    }
+}
+
+LocationID BestLocationTracker::best() const
+{
+    if (index_.empty())
+        return LocationID();
+    return entries_[index_.begin()->second].id;
+}
+
+int BestLocationTracker::bestLatency() const
+{
+    if (index_.empty())
+        return INT_MAX;
+    return index_.begin()->first;
+}
+
+int BestLocationTracker::latency(const LocationID &id) const
+{
+    auto it = entriesById_.constFind(id);
+    if (it == entriesById_.constEnd())
+        return INT_MAX;
+    return entries_[it.value()].latency;
+}
+
+int BestLocationTracker::effectiveLatency(PingTime ping)
+{
+    if (ping.toInt() == PingTime::NO_PING_INFO)
+        return PingTime::LATENCY_STEP1;
+    else if (ping.toInt() == PingTime::PING_FAILED)
+        return PingTime::MAX_LATENCY_FOR_PING_FAILED;
+    return ping.toInt();
+}
+
+} //namespace locationsmodel
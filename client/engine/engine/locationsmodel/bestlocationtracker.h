@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <set>
+#include <utility>
+
+#include "types/locationid.h"
+#include "types/pingtime.h"
+
+namespace locationsmodel {
+
+// Keeps the enabled API locations ordered by the effective latency, so the best one is known at any time
+// and a ping result updates it in O(log n) instead of walking all the locations.
+// The ties go to the location added first, the same as the order of the locations list.
+class BestLocationTracker
+{
+public:
+    void clear();
+    void add(const LocationID &id, const QString &pingIp, PingTime ping);
+    void setPing(const QString &pingIp, PingTime ping);
+
+    bool isEmpty() const { return index_.empty(); }
+    LocationID best() const;                    // invalid if empty
+    int bestLatency() const;                    // INT_MAX if empty
+    int latency(const LocationID &id) const;    // INT_MAX if the location is not tracked
+
+    // the latency used for comparison, when there is no ping info a maximum ping time for three bars is assumed
+    static int effectiveLatency(PingTime ping);
+
+private:
+    struct Entry
+    {
+        LocationID id;
+        int latency;
+    };
+    QVector<Entry> entries_;
+    std::set<std::pair<int, int>> index_;       // latency and the index in entries_
+    QHash<QString, QVector<int>> entriesByPingIp_;
+    QHash<LocationID, int> entriesById_;
+};
+
+} //namespace locationsmodel
@@ -2,6 +2,7 @@
 
 #include <QFile>
 #include <QTextStream>
+#include <algorithm>
 
 #include "utils/ws_assert.h"
 #include "utils/logger.h"
@@ -21,51 +22,71 @@ CustomConfigLocationsModel::CustomConfigLocationsModel(QObject *parent, IConnect
 }
 
 void CustomConfigLocationsModel::setCustomConfigs(const QVector<QSharedPointer<const customconfigs::ICustomConfig> > &customConfigs)
+{
+    // the unchanged configs are the same objects (see CustomConfigs), so only the difference is applied
+    QVector<QSharedPointer<const customconfigs::ICustomConfig>> oldConfigs;
+    for (const CustomConfigWithPingInfo &pingInfo : qAsConst(pingInfos_))
+    {
+        oldConfigs << pingInfo.customConfig;
+    }
+
+    const customconfigs::CustomConfigsDelta delta = customconfigs::CustomConfigsDelta::make(oldConfigs, customConfigs);
+    if (delta.isEmpty())
+    {
+        generateLocationsUpdated();
+        return;
+    }
+    updateCustomConfigs(delta);
+}
+
+void CustomConfigLocationsModel::updateCustomConfigs(const customconfigs::CustomConfigsDelta &delta)
 {
     // todo synchronize ping time for two instances of PingIpsController
-    // todo: check if configs actually changed
     // todo: dns-resolver cache
 
-    QStringList hostnamesForResolve;
-    // fill pingInfos_ array
-    pingInfos_.clear();
-    for (const auto &config : customConfigs)
+    if (delta.isEmpty())
     {
-        CustomConfigWithPingInfo cc;
-        cc.customConfig = config;
-
-        // fill remotes
-        const QStringList hostnames = config->hostnames();
-        for (const auto &hostname : hostnames)
-        {
-            RemoteItem ri;
-            ri.ipOrHostname.ip = hostname;
-            ri.isHostname = !IpValidation::isIp(hostname);
+        return;
+    }
 
-            if (!ri.isHostname)
-            {
-                ri.ipOrHostname.pingTime = pingManager_.getPing(hostname);
-            }
-            else
-            {
-                hostnamesForResolve << hostname;
-            }
+    for (const QString &filename : delta.removed)
+    {
+        pingInfos_.erase(std::remove_if(pingInfos_.begin(), pingInfos_.end(), [&filename](const CustomConfigWithPingInfo &pingInfo) {
+            return pingInfo.customConfig->filename() == filename;
+        }), pingInfos_.end());
+    }
 
-            cc.remotes << ri;
+    QStringList hostnamesForResolve;
+    for (const auto &config : delta.updated)
+    {
+        auto it = std::find_if(pingInfos_.begin(), pingInfos_.end(), [&config](const CustomConfigWithPingInfo &pingInfo) {
+            return pingInfo.customConfig->filename() == config->filename();
+        });
+        if (it != pingInfos_.end())
+        {
+            *it = makePingInfo(config, hostnamesForResolve);
         }
-
-        pingInfos_ << cc;
+        else
+        {
+            // the model was cleared after the previous changes
+            insertPingInfo(makePingInfo(config, hostnamesForResolve));
+        }
+    }
+    for (const auto &config : delta.added)
+    {
+        insertPingInfo(makePingInfo(config, hostnamesForResolve));
     }
 
     generateLocationsUpdated();
 
+    hostnamesForResolve.removeDuplicates();
     if (hostnamesForResolve.isEmpty())
     {
         startPingAndWhitelistIps();
     }
     else
     {
-        for (const QString &hostname : hostnamesForResolve)
+        for (const QString &hostname : qAsConst(hostnamesForResolve))
         {
             DnsRequest *dnsRequest = new DnsRequest(this, hostname, DnsServersConfiguration::instance().getCurrentDnsServers());
             connect(dnsRequest, &DnsRequest::finished, this, &CustomConfigLocationsModel::onDnsRequestFinished);
@@ -217,6 +238,43 @@ void CustomConfigLocationsModel::generateLocationsUpdated()
     emit locationsUpdated(item);
 }
 
+CustomConfigLocationsModel::CustomConfigWithPingInfo CustomConfigLocationsModel::makePingInfo(const QSharedPointer<const customconfigs::ICustomConfig> &config,
+                                                                                             QStringList &outHostnamesForResolve)
+{
+    CustomConfigWithPingInfo cc;
+    cc.customConfig = config;
+
+    // fill remotes
+    const QStringList hostnames = config->hostnames();
+    for (const auto &hostname : hostnames)
+    {
+        RemoteItem ri;
+        ri.ipOrHostname.ip = hostname;
+        ri.isHostname = !IpValidation::isIp(hostname);
+
+        if (!ri.isHostname)
+        {
+            ri.ipOrHostname.pingTime = pingManager_.getPing(hostname);
+        }
+        else
+        {
+            outHostnamesForResolve << hostname;
+        }
+
+        cc.remotes << ri;
+    }
+    return cc;
+}
+
+void CustomConfigLocationsModel::insertPingInfo(const CustomConfigWithPingInfo &pingInfo)
+{
+    // the same order as the directory listing of CustomConfigsDirWatcher
+    auto it = std::upper_bound(pingInfos_.begin(), pingInfos_.end(), pingInfo, [](const CustomConfigWithPingInfo &a, const CustomConfigWithPingInfo &b) {
+        return a.customConfig->filename().compare(b.customConfig->filename(), Qt::CaseInsensitive) < 0;
+    });
+    pingInfos_.insert(it, pingInfo);
+}
+
 PingTime CustomConfigLocationsModel::CustomConfigWithPingInfo::getPing() const
 {
     // return first not failed ping
@@ -4,6 +4,7 @@
 #include <QObject>
 
 #include "baselocationinfo.h"
+#include "engine/customconfigs/customconfigs.h"
 #include "engine/customconfigs/icustomconfig.h"
 #include "engine/ping/pingmanager.h"
 #include "types/location.h"
@@ -22,6 +23,8 @@ public:
     explicit CustomConfigLocationsModel(QObject *parent, IConnectStateController *stateController, INetworkDetectionManager *networkDetectionManager, PingMultipleHosts *pingHosts);
 
     void setCustomConfigs(const QVector<QSharedPointer<const customconfigs::ICustomConfig>> &customConfigs);
+    // only the added and updated configs are resolved again
+    void updateCustomConfigs(const customconfigs::CustomConfigsDelta &delta);
     void clear();
 
     QSharedPointer<BaseLocationInfo> getMutableLocationInfoById(const LocationID &locationId);
@@ -70,8 +73,10 @@ private:
         bool setPingTime(const QString &ip, PingTime pingTime);
     };
 
-    QVector<CustomConfigWithPingInfo> pingInfos_;
+    QVector<CustomConfigWithPingInfo> pingInfos_;     // sorted by filename
 
+    CustomConfigWithPingInfo makePingInfo(const QSharedPointer<const customconfigs::ICustomConfig> &config, QStringList &outHostnamesForResolve);
+    void insertPingInfo(const CustomConfigWithPingInfo &pingInfo);
 
     bool isAllResolved() const;
     void startPingAndWhitelistIps();
@@ -38,6 +38,11 @@ void LocationsModel::setCustomConfigLocations(const QVector<QSharedPointer<const
     customConfigLocationsModel_->setCustomConfigs(customConfigs);
 }
 
+void LocationsModel::updateCustomConfigLocations(const customconfigs::CustomConfigsDelta &delta)
+{
+    customConfigLocationsModel_->updateCustomConfigs(delta);
+}
+
 void LocationsModel::clear()
 {
     apiLocationsModel_->clear();
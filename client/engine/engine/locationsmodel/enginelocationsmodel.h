@@ -21,6 +21,7 @@ public:
 
     void setApiLocations(const QVector<apiinfo::Location> &locations, const apiinfo::StaticIps &staticIps);
     void setCustomConfigLocations(const QVector<QSharedPointer<const customconfigs::ICustomConfig>> &customConfigs);
+    void updateCustomConfigLocations(const customconfigs::CustomConfigsDelta &delta);
     void clear();
 
     void setProxySettings(const types::ProxySettings &proxySettings);
@@ -30,7 +31,7 @@ public:
     QSharedPointer<BaseLocationInfo> getMutableLocationInfoById(const LocationID &locationId);
 
 signals:
-    void locationsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<QVector<types::Location> > locations);
+    void locationsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<types::LocationsDelta> delta);
     void customConfigsLocationsUpdated(QSharedPointer<types::Location > location);
     void bestLocationUpdated(const LocationID &bestLocation);
     void locationPingTimeChanged(const LocationID &id, PingTime timeMs);
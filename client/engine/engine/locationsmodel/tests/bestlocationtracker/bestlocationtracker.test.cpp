@@ -0,0 +1,135 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <climits>
+#include "engine/locationsmodel/bestlocationtracker.h"
+
+using locationsmodel::BestLocationTracker;
+
+class TestBestLocationTracker : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEmpty();
+    void testEffectiveLatency();
+    void testUpdates();
+    void testTies();
+    void testSharedPingIp();
+    void testMatchesFullScan();
+};
+
+void TestBestLocationTracker::testEmpty()
+{
+    BestLocationTracker tracker;
+    QVERIFY(tracker.isEmpty());
+    QVERIFY(!tracker.best().isValid());
+    QCOMPARE(tracker.bestLatency(), INT_MAX);
+    QCOMPARE(tracker.latency(LocationID::createApiLocationId(1, "city", "nick")), INT_MAX);
+    tracker.setPing("10.0.0.1", 50);
+    QVERIFY(tracker.isEmpty());
+}
+
+void TestBestLocationTracker::testEffectiveLatency()
+{
+    QCOMPARE(BestLocationTracker::effectiveLatency(PingTime::NO_PING_INFO), PingTime::LATENCY_STEP1);
+    QCOMPARE(BestLocationTracker::effectiveLatency(PingTime::PING_FAILED), PingTime::MAX_LATENCY_FOR_PING_FAILED);
+    QCOMPARE(BestLocationTracker::effectiveLatency(42), 42);
+}
+
+void TestBestLocationTracker::testUpdates()
+{
+    const LocationID a = LocationID::createApiLocationId(1, "a", "a");
+    const LocationID b = LocationID::createApiLocationId(2, "b", "b");
+    BestLocationTracker tracker;
+    tracker.add(a, "10.0.0.1", 100);
+    tracker.add(b, "10.0.0.2", PingTime::NO_PING_INFO);
+    QCOMPARE(tracker.best(), a);
+    QCOMPARE(tracker.bestLatency(), 100);
+    QCOMPARE(tracker.latency(b), PingTime::LATENCY_STEP1);
+
+    tracker.setPing("10.0.0.2", 30);
+    QCOMPARE(tracker.best(), b);
+    QCOMPARE(tracker.bestLatency(), 30);
+
+    tracker.setPing("10.0.0.2", PingTime::PING_FAILED);
+    QCOMPARE(tracker.best(), a);
+    QCOMPARE(tracker.latency(b), PingTime::MAX_LATENCY_FOR_PING_FAILED);
+
+    tracker.clear();
+    QVERIFY(tracker.isEmpty());
+    QCOMPARE(tracker.latency(a), INT_MAX);
+}
+
+void TestBestLocationTracker::testTies()
+{
+    // the first added location wins, like the first one in the list
+    const LocationID a = LocationID::createApiLocationId(1, "a", "a");
+    const LocationID b = LocationID::createApiLocationId(2, "b", "b");
+    BestLocationTracker tracker;
+    tracker.add(a, "10.0.0.1", 80);
+    tracker.add(b, "10.0.0.2", 50);
+    QCOMPARE(tracker.best(), b);
+    tracker.setPing("10.0.0.1", 50);
+    QCOMPARE(tracker.best(), a);
+}
+
+void TestBestLocationTracker::testSharedPingIp()
+{
+    const LocationID a = LocationID::createApiLocationId(1, "a", "a");
+    const LocationID b = LocationID::createApiLocationId(1, "b", "b");
+    const LocationID c = LocationID::createApiLocationId(2, "c", "c");
+    BestLocationTracker tracker;
+    tracker.add(a, "10.0.0.1", 100);
+    tracker.add(b, "10.0.0.1", 100);
+    tracker.add(c, "10.0.0.2", 60);
+    tracker.setPing("10.0.0.1", 20);
+    QCOMPARE(tracker.latency(a), 20);
+    QCOMPARE(tracker.latency(b), 20);
+    QCOMPARE(tracker.best(), a);
+}
+
+void TestBestLocationTracker::testMatchesFullScan()
+{
+    // random ping results against the scan of all the locations the model did before
+    constexpr int kLocations = 200;
+    constexpr int kIps = 150;
+    QRandomGenerator rnd(1234);
+    QVector<LocationID> ids;
+    QVector<QString> ips;
+    QHash<QString, int> pings;
+    BestLocationTracker tracker;
+    for (int i = 0; i < kLocations; ++i)
+    {
+        ids << LocationID::createApiLocationId(i, "city", "nick");
+        ips << QString("10.0.0.%1").arg(rnd.bounded(kIps));
+        if (!pings.contains(ips.last()))
+            pings[ips.last()] = PingTime::NO_PING_INFO;
+        tracker.add(ids.last(), ips.last(), pings[ips.last()]);
+    }
+
+    for (int step = 0; step < 5000; ++step)
+    {
+        const QString ip = QString("10.0.0.%1").arg(rnd.bounded(kIps));
+        const int r = rnd.bounded(10);
+        const int ping = r == 0 ? PingTime::PING_FAILED : (r == 1 ? PingTime::NO_PING_INFO : rnd.bounded(1, 400));
+        pings[ip] = ping;
+        tracker.setPing(ip, ping);
+
+        int minLatency = INT_MAX;
+        LocationID best;
+        for (int i = 0; i < kLocations; ++i)
+        {
+            const int latency = BestLocationTracker::effectiveLatency(pings[ips[i]]);
+            if (latency < minLatency)
+            {
+                minLatency = latency;
+                best = ids[i];
+            }
+        }
+        QCOMPARE(tracker.bestLatency(), minLatency);
+        QCOMPARE(tracker.best(), best);
+    }
+}
+
+QTEST_MAIN(TestBestLocationTracker)
+#include "bestlocationtracker.test.moc"
@@ -0,0 +1,209 @@
+#include "metrics.h"
+
+#include <QtAlgorithms>
+
+#include "utils/ws_assert.h"
+
+namespace metrics {
+
+namespace {
+
+// the threads take the shards in turn as they first touch a metric
+int currentShard()
+{
+    static std::atomic<int> nextShard { 0 };
+    thread_local const int shard = nextShard.fetch_add(1, std::memory_order_relaxed) % kShards;
+    return shard;
+}
+
+// the bounds of the exported buckets, in seconds
+const double kExportBoundsSecs[] = { 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60 };
+
+} // namespace
+
+void Metric::writeHeader(QByteArray &out, const char *type) const
+{
+    out += "# HELP " + name_.toUtf8() + " " + help_.toUtf8() + "\n";
+    out += "# TYPE " + name_.toUtf8() + " " + type + "\n";
+}
+
+void Counter::inc(quint64 n)
+{
+    shards_[currentShard()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+quint64 Counter::value() const
+{
+    quint64 value = 0;
+    for (const auto &shard : shards_)
+        value += shard.value.load(std::memory_order_relaxed);
+    return value;
+}
+
+void Counter::writePrometheus(QByteArray &out) const
+{
+    writeHeader(out, "counter");
+    out += name_.toUtf8() + " " + QByteArray::number(value()) + "\n";
+}
+
+Histogram::Histogram(const QString &name, const QString &help) : Metric(name, help), shards_(new Shard[kShards])
+{
+    for (int i = 0; i < kShards; ++i)
+    {
+        for (auto &bucket : shards_[i].buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        shards_[i].count.store(0, std::memory_order_relaxed);
+        shards_[i].sum.store(0, std::memory_order_relaxed);
+    }
+}
+
+Histogram::~Histogram()
+{
+}
+
+void Histogram::record(qint64 microseconds)
+{
+    const quint64 value = qBound<qint64>(0, microseconds, (Q_INT64_C(1) << kMaxValueBits) - 1);
+    Shard &shard = shards_[currentShard()];
+    shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const
+{
+    Snapshot snapshot;
+    snapshot.buckets.resize(kBuckets, 0);
+    for (int i = 0; i < kShards; ++i)
+    {
+        for (int b = 0; b < kBuckets; ++b)
+            snapshot.buckets[b] += shards_[i].buckets[b].load(std::memory_order_relaxed);
+        snapshot.sum += shards_[i].sum.load(std::memory_order_relaxed);
+    }
+    // counted from the buckets, so it matches them even if a value is recorded during the snapshot
+    for (quint64 bucket : snapshot.buckets)
+        snapshot.count += bucket;
+    return snapshot;
+}
+
+// The values below 2 * kSubBuckets have a bucket each. Above that, the value is shifted right until it has
+// kSubBucketBits + 1 significant bits, and the shift selects the group of kSubBuckets buckets.
+int Histogram::bucketIndex(quint64 value)
+{
+    if (value < 2 * kSubBuckets)
+        return static_cast<int>(value);
+    const int msb = 63 - qCountLeadingZeroBits(value);
+    const int shift = msb - kSubBucketBits;
+    const int index = shift * kSubBuckets + static_cast<int>(value >> shift);
+    WS_ASSERT(index < kBuckets);
+    return index;
+}
+
+quint64 Histogram::bucketLowerBound(int index)
+{
+    if (index < 2 * kSubBuckets)
+        return index;
+    const int shift = index / kSubBuckets - 1;
+    return static_cast<quint64>(index - shift * kSubBuckets) << shift;
+}
+
+quint64 Histogram::bucketUpperBound(int index)
+{
+    if (index < 2 * kSubBuckets)
+        return index;
+    const int shift = index / kSubBuckets - 1;
+    return (static_cast<quint64>(index - shift * kSubBuckets + 1) << shift) - 1;
+}
+
+quint64 Histogram::Snapshot::valueAtPercentile(double percentile) const
+{
+    if (count == 0)
+        return 0;
+    const quint64 target = qMax<quint64>(1, static_cast<quint64>(count * qBound(0.0, percentile, 100.0) / 100.0 + 0.5));
+    quint64 cumulative = 0;
+    for (int i = 0; i < static_cast<int>(buckets.size()); ++i)
+    {
+        cumulative += buckets[i];
+        if (cumulative >= target)
+            return bucketUpperBound(i);
+    }
+    return bucketUpperBound(kBuckets - 1);
+}
+
+quint64 Histogram::Snapshot::countAtOrBelow(quint64 value) const
+{
+    quint64 cumulative = 0;
+    for (int i = 0; i < static_cast<int>(buckets.size()) && bucketUpperBound(i) <= value; ++i)
+        cumulative += buckets[i];
+    return cumulative;
+}
+
+void Histogram::writePrometheus(QByteArray &out) const
+{
+    const Snapshot s = snapshot();
+    const QByteArray name = name_.toUtf8();
+    writeHeader(out, "histogram");
+    for (double bound : kExportBoundsSecs)
+    {
+        out += name + "_bucket{le=\"" + QByteArray::number(bound) + "\"} " +
+               QByteArray::number(s.countAtOrBelow(qRound64(bound * 1000000))) + "\n";
+    }
+    out += name + "_bucket{le=\"+Inf\"} " + QByteArray::number(s.count) + "\n";
+    out += name + "_sum " + QByteArray::number(s.sum / 1000000.0, 'g', 12) + "\n";
+    out += name + "_count " + QByteArray::number(s.count) + "\n";
+}
+
+Registry &Registry::instance()
+{
+    static Registry registry;
+    return registry;
+}
+
+Counter &Registry::counter(const QString &name, const QString &help)
+{
+    QMutexLocker locker(&mutex_);
+    if (Metric *metric = find(name))
+    {
+        Counter *counter = dynamic_cast<Counter *>(metric);
+        WS_ASSERT(counter != nullptr);
+        return *counter;
+    }
+    Counter *counter = new Counter(name, help);
+    metrics_.emplace_back(counter);
+    return *counter;
+}
+
+Histogram &Registry::histogram(const QString &name, const QString &help)
+{
+    QMutexLocker locker(&mutex_);
+    if (Metric *metric = find(name))
+    {
+        Histogram *histogram = dynamic_cast<Histogram *>(metric);
+        WS_ASSERT(histogram != nullptr);
+        return *histogram;
+    }
+    Histogram *histogram = new Histogram(name, help);
+    metrics_.emplace_back(histogram);
+    return *histogram;
+}
+
+QByteArray Registry::prometheusText() const
+{
+    QMutexLocker locker(&mutex_);
+    QByteArray out;
+    for (const auto &metric : metrics_)
+        metric->writePrometheus(out);
+    return out;
+}
+
+Metric *Registry::find(const QString &name) const
+{
+    for (const auto &metric : metrics_)
+    {
+        if (metric->name() == name)
+            return metric.get();
+    }
+    return nullptr;
+}
+
+} // namespace metrics
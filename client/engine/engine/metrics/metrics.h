@@ -0,0 +1,123 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMutex>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Engine-wide metrics: counters and latency histograms, exported as Prometheus text.
+// The values are updated lock-free from any thread. Every metric is split into shards and a thread always
+// updates the same shard, so the threads don't contend on one cache line. The shards are summed on export.
+// A metric is registered once by name and lives until the process exits, so the call sites keep a reference:
+//   static metrics::Counter &requests = metrics::counter("ws_http_requests_total", "HTTP requests finished");
+//   requests.inc();
+namespace metrics {
+
+constexpr int kShards = 8;
+
+class Metric
+{
+public:
+    Metric(const QString &name, const QString &help) : name_(name), help_(help) {}
+    virtual ~Metric() {}
+
+    const QString &name() const { return name_; }
+    virtual void writePrometheus(QByteArray &out) const = 0;
+
+protected:
+    const QString name_;
+    const QString help_;
+
+    void writeHeader(QByteArray &out, const char *type) const;
+};
+
+class Counter : public Metric
+{
+public:
+    Counter(const QString &name, const QString &help) : Metric(name, help) {}
+
+    void inc(quint64 n = 1);
+    quint64 value() const;
+
+    void writePrometheus(QByteArray &out) const override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<quint64> value { 0 };
+    };
+    std::array<Shard, kShards> shards_;
+};
+
+// HDR histogram of durations in microseconds. The buckets are linear within each power of two
+// (kSubBuckets per power), so any value is recorded with a relative error below 1/kSubBuckets
+// in constant time and memory. Values above 2^kMaxValueBits are recorded as the maximum.
+class Histogram : public Metric
+{
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxValueBits = 40;        // about 12 days
+    static constexpr int kBuckets = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+    Histogram(const QString &name, const QString &help);
+    ~Histogram();
+
+    void record(qint64 microseconds);
+
+    struct Snapshot
+    {
+        std::vector<quint64> buckets;
+        quint64 count = 0;
+        quint64 sum = 0;
+
+        // the upper bound of the bucket of the value at the percentile (0..100), 0 if empty
+        quint64 valueAtPercentile(double percentile) const;
+        // the number of the values not greater than the value, exact on the bucket bounds
+        quint64 countAtOrBelow(quint64 value) const;
+    };
+    Snapshot snapshot() const;
+
+    static int bucketIndex(quint64 value);
+    static quint64 bucketLowerBound(int index);
+    static quint64 bucketUpperBound(int index);     // inclusive
+
+    void writePrometheus(QByteArray &out) const override;
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<quint64> buckets[kBuckets];
+        std::atomic<quint64> count;
+        std::atomic<quint64> sum;
+    };
+    std::unique_ptr<Shard[]> shards_;
+};
+
+class Registry
+{
+public:
+    static Registry &instance();
+
+    // returns the existing metric if the name is already registered
+    Counter &counter(const QString &name, const QString &help);
+    Histogram &histogram(const QString &name, const QString &help);
+
+    QByteArray prometheusText() const;
+
+private:
+    Registry() {}
+
+    mutable QMutex mutex_;
+    std::vector<std::unique_ptr<Metric>> metrics_;     // in the order of the registration
+
+    Metric *find(const QString &name) const;
+};
+
+inline Counter &counter(const QString &name, const QString &help) { return Registry::instance().counter(name, help); }
+inline Histogram &histogram(const QString &name, const QString &help) { return Registry::instance().histogram(name, help); }
+
+} // namespace metrics
@@ -0,0 +1,72 @@
+#include "metricsserver.h"
+
+#include <QTcpSocket>
+
+#include "metrics.h"
+#include "utils/logger.h"
+
+namespace metrics {
+
+MetricsServer::MetricsServer(QObject *parent) : QTcpServer(parent)
+{
+    connect(this, &QTcpServer::newConnection, this, &MetricsServer::onNewConnection);
+}
+
+bool MetricsServer::startServer(quint16 port)
+{
+    // only local clients, the metrics are not meant to leave the machine
+    if (!listen(QHostAddress::LocalHost, port))
+    {
+        qCDebug(LOG_BASIC) << "Can't start the metrics server on port" << port << ":" << errorString();
+        return false;
+    }
+    qCDebug(LOG_BASIC) << "Metrics server started on port" << port;
+    return true;
+}
+
+void MetricsServer::onNewConnection()
+{
+    while (QTcpSocket *socket = nextPendingConnection())
+    {
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]()
+        {
+            requests_.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MetricsServer::onReadyRead(QTcpSocket *socket)
+{
+    QByteArray &request = requests_[socket];
+    request += socket->readAll();
+    if (!request.contains("\r\n\r\n"))
+    {
+        if (request.size() > kMaxRequestSize)
+            socket->abort();
+        return;
+    }
+
+    const QList<QByteArray> requestLine = request.left(request.indexOf("\r\n")).split(' ');
+    QByteArray status;
+    QByteArray body;
+    if (requestLine.size() >= 2 && requestLine[0] == "GET" && (requestLine[1] == "/metrics" || requestLine[1] == "/"))
+    {
+        status = "200 OK";
+        body = Registry::instance().prometheusText();
+    }
+    else
+    {
+        status = "404 Not Found";
+    }
+    requests_.remove(socket);
+
+    socket->write("HTTP/1.1 " + status + "\r\n"
+                  "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                  "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                  "Connection: close\r\n\r\n" + body);
+    socket->disconnectFromHost();
+}
+
+} // namespace metrics
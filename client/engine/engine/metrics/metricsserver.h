@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QHash>
+#include <QTcpServer>
+
+class QTcpSocket;
+
+namespace metrics {
+
+// Serves the metrics of the Registry as Prometheus text on http://127.0.0.1:<port>/metrics.
+// Opt-in with the "ws-metrics-port=<port>" line of the advanced parameters.
+class MetricsServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit MetricsServer(QObject *parent);
+
+    bool startServer(quint16 port);
+
+private slots:
+    void onNewConnection();
+
+private:
+    static constexpr int kMaxRequestSize = 8192;
+
+    QHash<QTcpSocket *, QByteArray> requests_;
+
+    void onReadyRead(QTcpSocket *socket);
+};
+
+} // namespace metrics
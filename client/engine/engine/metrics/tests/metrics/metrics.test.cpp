@@ -0,0 +1,202 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QThread>
+#ifdef Q_OS_WIN
+#include <WinSock2.h>
+#endif
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "engine/metrics/metrics.h"
+#include "engine/metrics/metricsserver.h"
+
+class TestMetrics : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMetrics();
+
+private slots:
+    void testCounterThreads();
+    void testHistogramThreads();
+    void testBucketBounds();
+    void testPercentiles();
+    void testRegistry();
+    void testPrometheusText();
+    void testServer();
+};
+
+TestMetrics::TestMetrics()
+{
+#ifdef Q_OS_WIN
+    // Initialize Winsock
+    WSADATA wsaData;
+    WSAStartup(MAKEWORD(2,2), &wsaData);
+#endif
+}
+
+void TestMetrics::testCounterThreads()
+{
+    metrics::Counter counter("test_counter", "help");
+    constexpr int kThreads = 16;
+    constexpr int kIncrements = 100000;
+
+    std::vector<QThread *> threads;
+    for (int i = 0; i < kThreads; ++i)
+        threads.push_back(QThread::create([&counter]() { for (int n = 0; n < kIncrements; ++n) counter.inc(); }));
+    for (QThread *thread : threads)
+        thread->start();
+    for (QThread *thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+    QCOMPARE(counter.value(), static_cast<quint64>(kThreads) * kIncrements);
+
+    counter.inc(5);
+    QCOMPARE(counter.value(), static_cast<quint64>(kThreads) * kIncrements + 5);
+}
+
+void TestMetrics::testHistogramThreads()
+{
+    metrics::Histogram histogram("test_histogram", "help");
+    constexpr int kThreads = 8;
+    constexpr int kValues = 50000;
+
+    std::vector<QThread *> threads;
+    for (int i = 0; i < kThreads; ++i)
+        threads.push_back(QThread::create([&histogram]() { for (int n = 0; n < kValues; ++n) histogram.record(n); }));
+    for (QThread *thread : threads)
+        thread->start();
+    for (QThread *thread : threads)
+    {
+        thread->wait();
+        delete thread;
+    }
+
+    const metrics::Histogram::Snapshot snapshot = histogram.snapshot();
+    QCOMPARE(snapshot.count, static_cast<quint64>(kThreads) * kValues);
+    QCOMPARE(snapshot.sum, static_cast<quint64>(kThreads) * (static_cast<quint64>(kValues) * (kValues - 1) / 2));
+}
+
+void TestMetrics::testBucketBounds()
+{
+    using metrics::Histogram;
+    QCOMPARE(Histogram::bucketLowerBound(0), 0ULL);
+    for (int i = 0; i < Histogram::kBuckets; ++i)
+    {
+        const quint64 lower = Histogram::bucketLowerBound(i);
+        const quint64 upper = Histogram::bucketUpperBound(i);
+        QVERIFY(lower <= upper);
+        QCOMPARE(Histogram::bucketIndex(lower), i);
+        QCOMPARE(Histogram::bucketIndex(upper), i);
+        // the buckets cover the values without gaps
+        if (i > 0)
+            QCOMPARE(lower, Histogram::bucketUpperBound(i - 1) + 1);
+        // the width of a bucket is within the relative error
+        QVERIFY(upper - lower <= lower / Histogram::kSubBuckets);
+    }
+    QCOMPARE(Histogram::bucketUpperBound(Histogram::kBuckets - 1), (1ULL << Histogram::kMaxValueBits) - 1);
+}
+
+void TestMetrics::testPercentiles()
+{
+    metrics::Histogram histogram("test_percentiles", "help");
+    QCOMPARE(histogram.snapshot().valueAtPercentile(50), 0ULL);
+
+    QRandomGenerator generator(12345);
+    std::vector<quint64> values;
+    for (int i = 0; i < 100000; ++i)
+    {
+        // log-uniform from 1us to about 100s
+        const quint64 value = static_cast<quint64>(std::exp(generator.generateDouble() * std::log(1e8)));
+        values.push_back(value);
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    const metrics::Histogram::Snapshot snapshot = histogram.snapshot();
+    for (double percentile : { 1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 100.0 })
+    {
+        const quint64 exact = values[qMax<size_t>(1, static_cast<size_t>(values.size() * percentile / 100.0 + 0.5)) - 1];
+        const quint64 estimate = snapshot.valueAtPercentile(percentile);
+        QVERIFY2(estimate >= exact, qPrintable(QString("p%1: %2 < %3").arg(percentile).arg(estimate).arg(exact)));
+        QVERIFY2(estimate - exact <= exact / metrics::Histogram::kSubBuckets,
+                 qPrintable(QString("p%1: %2 vs %3").arg(percentile).arg(estimate).arg(exact)));
+    }
+
+    // the values beyond the range are recorded as the maximum, the negative ones as 0
+    histogram.record(-5);
+    histogram.record(Q_INT64_C(1) << 50);
+    const metrics::Histogram::Snapshot clamped = histogram.snapshot();
+    QCOMPARE(clamped.buckets.front(), snapshot.buckets.front() + 1);
+    QCOMPARE(clamped.buckets.back(), snapshot.buckets.back() + 1);
+}
+
+void TestMetrics::testRegistry()
+{
+    metrics::Counter &counter = metrics::counter("ws_test_registry_total", "help");
+    QCOMPARE(&metrics::counter("ws_test_registry_total", "other help"), &counter);
+    metrics::Histogram &histogram = metrics::histogram("ws_test_registry_seconds", "help");
+    QCOMPARE(&metrics::histogram("ws_test_registry_seconds", "help"), &histogram);
+}
+
+void TestMetrics::testPrometheusText()
+{
+    metrics::Counter &counter = metrics::counter("ws_test_text_total", "Test counter");
+    counter.inc(3);
+    metrics::Histogram &histogram = metrics::histogram("ws_test_text_seconds", "Test histogram");
+    histogram.record(500);          // 0.5ms
+    histogram.record(20000);        // 20ms
+    histogram.record(120000000);    // 2 min
+
+    const QString text = QString::fromUtf8(metrics::Registry::instance().prometheusText());
+    QVERIFY(text.contains("# HELP ws_test_text_total Test counter\n# TYPE ws_test_text_total counter\nws_test_text_total 3\n"));
+    QVERIFY(text.contains("# HELP ws_test_text_seconds Test histogram\n# TYPE ws_test_text_seconds histogram\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_bucket{le=\"0.001\"} 1\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_bucket{le=\"0.01\"} 1\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_bucket{le=\"0.025\"} 2\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_bucket{le=\"60\"} 2\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_bucket{le=\"+Inf\"} 3\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_sum 120.0205\n"));
+    QVERIFY(text.contains("ws_test_text_seconds_count 3\n"));
+}
+
+void TestMetrics::testServer()
+{
+    metrics::counter("ws_test_server_total", "help").inc();
+
+    metrics::MetricsServer server(this);
+    QVERIFY(server.startServer(0));
+
+    auto get = [&server](const QByteArray &path)
+    {
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, server.serverPort());
+        socket.write("GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+        // the server runs in this thread, so wait with the event loop running
+        QByteArray response;
+        QElapsedTimer timer;
+        timer.start();
+        while (socket.state() != QAbstractSocket::UnconnectedState && timer.elapsed() < 5000)
+        {
+            QTest::qWait(10);
+            response += socket.readAll();
+        }
+        response += socket.readAll();
+        return response;
+    };
+
+    const QByteArray response = get("/metrics");
+    QVERIFY(response.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(response.contains("ws_test_server_total 1\n"));
+
+    QVERIFY(get("/other").startsWith("HTTP/1.1 404"));
+}
+
+QTEST_MAIN(TestMetrics)
+#include "metrics.test.moc"
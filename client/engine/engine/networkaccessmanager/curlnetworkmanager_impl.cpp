@@ -5,6 +5,7 @@
 #include <QMap>
 #include <QStandardPaths>
 
+#include "engine/metrics/metrics.h"
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
 #include "utils/ws_assert.h"
@@ -48,12 +49,28 @@ CurlNetworkManagerImpl::~CurlNetworkManagerImpl()
 size_t CurlNetworkManagerImpl::writeDataCallback(void *ptr, size_t size, size_t count, void *ri)
 {
     RequestInfo *requestInfo = static_cast<RequestInfo *>(ri);
+    if (requestInfo->writeCallback) {
+        long httpCode = 0;
+        curl_easy_getinfo(requestInfo->curlEasyHandle, CURLINFO_RESPONSE_CODE, &httpCode);
+        // returning less than the passed size makes curl abort the request with CURLE_WRITE_ERROR
+        return requestInfo->writeCallback(httpCode, static_cast<const char *>(ptr), size*count) ? size*count : 0;
+    }
+
     QByteArray arr;
     arr.append((char*)ptr, size*count);
     emit g_this->requestNewData(requestInfo->id, arr);
     return size*count;
 }
 
+size_t CurlNetworkManagerImpl::headerCallback(char *buffer, size_t size, size_t count, void *ri)
+{
+    RequestInfo *requestInfo = static_cast<RequestInfo *>(ri);
+    long httpCode = 0;
+    curl_easy_getinfo(requestInfo->curlEasyHandle, CURLINFO_RESPONSE_CODE, &httpCode);
+    requestInfo->headerCallback(httpCode, QByteArray(buffer, static_cast<int>(size*count)));
+    return size*count;
+}
+
 int CurlNetworkManagerImpl::progressCallback(void *ri,   curl_off_t dltotal,   curl_off_t dlnow,   curl_off_t ultotal,   curl_off_t ulnow)
 {
     RequestInfo *requestInfo = static_cast<RequestInfo *>(ri);
@@ -66,7 +83,17 @@ bool CurlNetworkManagerImpl::setupBasicOptions(RequestInfo *requestInfo, const N
 {
     if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_WRITEFUNCTION, writeDataCallback) != CURLE_OK) return false;
     if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_WRITEDATA, requestInfo) != CURLE_OK) return false;
-    if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) return false;
+    if (request.range().isEmpty()) {
+        if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_ACCEPT_ENCODING, "") != CURLE_OK) return false;
+    } else {
+        if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_RANGE, request.range().toStdString().c_str()) != CURLE_OK) return false;
+    }
+    requestInfo->writeCallback = request.writeCallback();
+    requestInfo->headerCallback = request.headerCallback();
+    if (requestInfo->headerCallback) {
+        if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_HEADERFUNCTION, headerCallback) != CURLE_OK) return false;
+        if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_HEADERDATA, requestInfo) != CURLE_OK) return false;
+    }
     if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_URL, request.url().toString().toStdString().c_str()) != CURLE_OK) return false;
 
     if (curl_easy_setopt(requestInfo->curlEasyHandle, CURLOPT_FRESH_CONNECT, 1) != CURLE_OK) return false;
@@ -299,6 +326,7 @@ void CurlNetworkManagerImpl::run()
 
                   curl_off_t totalTime;
                   curl_easy_getinfo(curlEasyHandle, CURLINFO_TOTAL_TIME_T, &totalTime);
+                  recordMetrics(curlEasyHandle, curlMsg->data.result, totalTime);
 
                   quint64 id = *pointerId;
                   auto it = activeRequests_.find(id);
@@ -390,3 +418,24 @@ bool CurlNetworkManagerImpl::setupProxy(RequestInfo *requestInfo, const types::P
     }
     return true;
 }
+
+void CurlNetworkManagerImpl::recordMetrics(CURL *curlEasyHandle, CURLcode result, curl_off_t totalTimeUs)
+{
+    static metrics::Counter &requests = metrics::counter("ws_http_requests_total", "HTTP requests finished by curl");
+    static metrics::Counter &errors = metrics::counter("ws_http_request_errors_total", "HTTP requests finished with a curl error");
+    static metrics::Histogram &totalTime = metrics::histogram("ws_http_request_duration_seconds", "Total time of the HTTP requests");
+    static metrics::Histogram &connectTime = metrics::histogram("ws_http_connect_duration_seconds", "Time until the TCP connection of the HTTP requests is established");
+    static metrics::Histogram &tlsTime = metrics::histogram("ws_http_tls_handshake_duration_seconds", "Time until the TLS handshake of the HTTPS requests is completed");
+
+    requests.inc();
+    if (result != CURLE_OK)
+        errors.inc();
+    totalTime.record(totalTimeUs);
+
+    curl_off_t connectTimeUs = 0;
+    if (curl_easy_getinfo(curlEasyHandle, CURLINFO_CONNECT_TIME_T, &connectTimeUs) == CURLE_OK && connectTimeUs > 0)
+        connectTime.record(connectTimeUs);
+    curl_off_t appConnectTimeUs = 0;
+    if (curl_easy_getinfo(curlEasyHandle, CURLINFO_APPCONNECT_TIME_T, &appConnectTimeUs) == CURLE_OK && appConnectTimeUs > 0)
+        tlsTime.record(appConnectTimeUs);
+}
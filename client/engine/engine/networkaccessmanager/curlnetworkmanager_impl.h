@@ -61,6 +61,8 @@ private:
         quint64 id;
         CURL *curlEasyHandle = nullptr;
         QVector<struct curl_slist *> curlLists;
+        NetworkRequest::WriteCallback writeCallback;
+        NetworkRequest::HeaderCallback headerCallback;
         bool isAddedToMultiHandle = false;
         bool isNeedRemoveFromMultiHandle = false;
 
@@ -86,8 +88,11 @@ private:
     bool setupSslVerification(RequestInfo *requestInfo, const NetworkRequest &request);
     bool setupProxy(RequestInfo *requestInfo, const types::ProxySettings &proxySettings);
 
+    void recordMetrics(CURL *curlEasyHandle, CURLcode result, curl_off_t totalTimeUs);
+
     static CURLcode sslctx_function(CURL *curl, void *sslctx, void *parm);
     static size_t writeDataCallback(void *ptr, size_t size, size_t count, void *ri);
+    static size_t headerCallback(char *buffer, size_t size, size_t count, void *ri);
     static int progressCallback(void *ri,   curl_off_t dltotal,   curl_off_t dlnow,   curl_off_t ultotal,   curl_off_t ulnow);
 };
 
@@ -1,15 +1,20 @@
 #include "dnscache.h"
 #include <QDateTime>
-#include <QTimer>
+#include <climits>
+#include "utils/tracing.h"
 #include "utils/ws_assert.h"
 #include "engine/dnsresolver/dnsrequest.h"
+#include "engine/metrics/metrics.h"
+#include "engine/utils/timerwheel.h"
 
 DnsCache::DnsCache(QObject *parent, int cacheTimeoutMs /*= 60000*/, int reviewCacheIntervalMs /*= 1000*/) : QObject(parent),
     cacheTimeoutMs_(cacheTimeoutMs)
 {
-    QTimer *timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, this, &DnsCache::onTimer);
-    timer->start(reviewCacheIntervalMs);
+    // the expired entries may stay a bit longer, so the review can share a wakeup with the other timers
+    reviewTimer_ = new WheelTimer(this);
+    reviewTimer_->setSingleShot(true);
+    reviewTimer_->setSlack(reviewCacheIntervalMs);
+    connect(reviewTimer_, &WheelTimer::timeout, this, &DnsCache::onTimer);
 }
 
 DnsCache::~DnsCache()
@@ -21,6 +26,8 @@ void DnsCache::resolve(const QString &hostname, quint64 id, bool bypassCache /*=
     if (!bypassCache) {
         auto it = cache_.find(hostname);
         if (it != cache_.end()) {
+            static metrics::Counter &cacheHits = metrics::counter("ws_dns_cache_hits_total", "DNS resolutions answered from the cache");
+            cacheHits.inc();
             emit resolved(true, it.value().ips, id, true, 0);
             return;
         }
@@ -29,6 +36,7 @@ void DnsCache::resolve(const QString &hostname, quint64 id, bool bypassCache /*=
     DnsRequest *dnsRequest = new DnsRequest(this, hostname, dnsServers, timeoutMs);
     dnsRequest->setProperty("requestId", id);
     connect(dnsRequest, &DnsRequest::finished, this, &DnsCache::onDnsRequestFinished);
+    WS_TRACE_ASYNC_BEGIN("dns", tracing::internName(hostname), dnsRequest);
     dnsRequest->lookup();
 }
 
@@ -40,12 +48,22 @@ void DnsCache::onDnsRequestFinished()
     bool bOk;
     quint64 requestId = dnsRequest->property("requestId").toULongLong(&bOk);
     WS_ASSERT(bOk);
+    WS_TRACE_ASYNC_END("dns", tracing::internName(dnsRequest->hostname()), dnsRequest);
+
+    static metrics::Histogram &duration = metrics::histogram("ws_dns_resolve_duration_seconds", "Duration of the DNS resolutions not answered from the cache");
+    static metrics::Counter &failures = metrics::counter("ws_dns_resolve_failures_total", "Failed DNS resolutions");
+    duration.record(dnsRequest->elapsedMs() * 1000);
 
     bool bSuccess = false;
     if (!dnsRequest->isError()) {
         cache_[dnsRequest->hostname()].ips = dnsRequest->ips();
         cache_[dnsRequest->hostname()].time = QDateTime::currentMSecsSinceEpoch();
         bSuccess = true;
+        // otherwise an older entry expires first and the timer is already set for it
+        if (!reviewTimer_->isActive())
+            reviewTimer_->start(cacheTimeoutMs_ + 1);
+    } else {
+        failures.inc();
     }
 
     emit resolved(bSuccess, dnsRequest->ips(), requestId, false, dnsRequest->elapsedMs());
@@ -57,10 +75,16 @@ void DnsCache::onTimer()
     // delete outdated IPs from cache
     auto it = cache_.begin();
     qint64 curTime = QDateTime::currentMSecsSinceEpoch();
+    qint64 oldestTime = LLONG_MAX;
     while (it != cache_.end())
-        if ((curTime - it.value().time) > cacheTimeoutMs_)
+        if ((curTime - it.value().time) > cacheTimeoutMs_) {
             it = cache_.erase(it);
-        else
+        } else {
+            oldestTime = qMin(oldestTime, it.value().time);
             ++it;
+        }
+
+    if (!cache_.isEmpty())
+        reviewTimer_->start(static_cast<int>(qMax<qint64>(1, oldestTime + cacheTimeoutMs_ + 1 - curTime)));
 }
 
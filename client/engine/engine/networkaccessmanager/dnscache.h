@@ -3,6 +3,8 @@
 #include <QMap>
 #include <QObject>
 
+class WheelTimer;
+
 class DnsCache : public QObject
 {
     Q_OBJECT
@@ -38,6 +40,8 @@ private:
 
     QMap<QString, CacheItem> cache_;
     int cacheTimeoutMs_;
+    // single shot at the expiry of the oldest entry, not running while the cache is empty
+    WheelTimer *reviewTimer_;
 
 };
 
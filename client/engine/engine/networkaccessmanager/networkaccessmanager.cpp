@@ -25,7 +25,7 @@ NetworkAccessManager::NetworkAccessManager(QObject *parent) : QObject(parent)
     connect(dnsCache_, &DnsCache::resolved,  this, &NetworkAccessManager::onResolved);
 
     whitelistIpsManager_ = new WhitelistIpsManager(this);
-    connect(whitelistIpsManager_, &WhitelistIpsManager::whitelistIpsChanged, [this](const QSet<QString> &ips) {
+    connect(whitelistIpsManager_, &WhitelistIpsManager::whitelistIpsChanged, [this](const IpAddressSet &ips) {
         emit whitelistIpsChanged(ips);
     });
 }
@@ -33,7 +33,7 @@ public:
 signals:
     // need for add exception rules to firewall
     // use only direct connection type, because the IPs must be resolved before the HTTP/HTTPS request is actually executed
-    void whitelistIpsChanged(const QSet<QString> &ips);
+    void whitelistIpsChanged(const IpAddressSet &ips);
 
 private slots:
     void handleRequest(quint64 id);
@@ -136,3 +136,33 @@ bool NetworkRequest::isWhiteListIps() const
 {
     return isWhiteListIps_;
 }
+
+void NetworkRequest::setRange(qint64 from, qint64 to)
+{
+    range_ = QString::number(from) + "-" + (to >= 0 ? QString::number(to) : QString());
+}
+
+QString NetworkRequest::range() const
+{
+    return range_;
+}
+
+void NetworkRequest::setWriteCallback(const WriteCallback &callback)
+{
+    writeCallback_ = callback;
+}
+
+NetworkRequest::WriteCallback NetworkRequest::writeCallback() const
+{
+    return writeCallback_;
+}
+
+void NetworkRequest::setHeaderCallback(const HeaderCallback &callback)
+{
+    headerCallback_ = callback;
+}
+
+NetworkRequest::HeaderCallback NetworkRequest::headerCallback() const
+{
+    return headerCallback_;
+}
@@ -1,10 +1,17 @@
 #pragma once
 
 #include <QUrl>
+#include <functional>
 
 class NetworkRequest
 {
 public:
+    // Called on the curl thread with the chunks of the response body, instead of queuing them to the reply.
+    // httpCode is the status of the response. Returning false aborts the request with a curl error.
+    typedef std::function<bool(long httpCode, const char *data, size_t size)> WriteCallback;
+    // Called on the curl thread with each header line of the responses, including the status lines and the redirects.
+    typedef std::function<void(long httpCode, const QByteArray &header)> HeaderCallback;
+
     NetworkRequest() {}
     explicit NetworkRequest(const QUrl &url, int timeout, bool bUseDnsCache);
     explicit NetworkRequest(const QUrl &url, int timeout, bool bUseDnsCache, const QStringList &dnsServers, bool isIgnoreSslErrors);
@@ -45,6 +52,17 @@ public:
     void setIsWhiteListIps(bool isWhiteListIps);
     bool isWhiteListIps() const;
 
+    // Requests the bytes from..to (inclusive) of the resource, to = -1 means up to the end.
+    // The content is requested without encoding, since the range refers to the encoded bytes.
+    void setRange(qint64 from, qint64 to = -1);
+    QString range() const;
+
+    void setWriteCallback(const WriteCallback &callback);
+    WriteCallback writeCallback() const;
+
+    void setHeaderCallback(const HeaderCallback &callback);
+    HeaderCallback headerCallback() const;
+
 private:
     QUrl url_;
     int timeout_;
@@ -66,5 +84,9 @@ private:
     bool isWhiteListIps_;
 
     bool bExtraTLSPadding_;
+
+    QString range_;     // empty if the whole resource is requested
+    WriteCallback writeCallback_;
+    HeaderCallback headerCallback_;
 };
 
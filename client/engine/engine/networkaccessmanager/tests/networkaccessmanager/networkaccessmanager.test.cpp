@@ -167,7 +167,7 @@ void TestNetworkAccessManager::test_whitelist()
 
         QCOMPARE(signalWhitelist.count(), 1);
         QList<QVariant> arguments = signalWhitelist.takeFirst();
-        QSet<QString> set = qvariant_cast<QSet<QString> >(arguments.at(0));
+        IpAddressSet set = qvariant_cast<IpAddressSet>(arguments.at(0));
         QVERIFY(set.size() > 0);
     }
 
@@ -187,11 +187,11 @@ void TestNetworkAccessManager::test_whitelist()
 
         QCOMPARE(signalWhitelist.count(), 2);
         QList<QVariant> arguments = signalWhitelist.at(0);
-        QSet<QString> set = qvariant_cast<QSet<QString> >(arguments.at(0));
+        IpAddressSet set = qvariant_cast<IpAddressSet>(arguments.at(0));
         QVERIFY(set.size() > 0);
 
         arguments = signalWhitelist.at(1);
-        set = qvariant_cast<QSet<QString> >(arguments.at(0));
+        set = qvariant_cast<IpAddressSet>(arguments.at(0));
         QVERIFY(set.size() == 0);
     }
 }
@@ -1,5 +1,7 @@
 #include "whitelistipsmanager.h"
 
+const int typeIdIpAddressSet = qRegisterMetaType<IpAddressSet>("IpAddressSet");
+
 WhitelistIpsManager::WhitelistIpsManager(QObject *parent) : QObject(parent)
 {
 }
@@ -8,22 +10,34 @@ void WhitelistIpsManager::add(const QStringList &ips)
 {
     bool bChanged = false;
     for (const auto &it : qAsConst(ips)) {
-        if (!ips_.contains(it)) {
-            ips_.insert(it);
+        const IpAddress ip = IpAddress::fromString(it);
+        if (ip.isValid() && ++ips_[ip] == 1)
             bChanged = true;
-        }
     }
     if (bChanged)
-        emit whitelistIpsChanged(ips_);
+        emit whitelistIpsChanged(ipsSet());
 }
 
 void WhitelistIpsManager::remove(const QStringList &ips)
 {
     bool bChanged = false;
     for (const auto &it : qAsConst(ips)) {
-        if (ips_.remove(it))
+        const IpAddress ip = IpAddress::fromString(it);
+        int *count = ips_.find(ip);
+        if (count && --*count <= 0) {
+            ips_.remove(ip);
             bChanged = true;
+        }
     }
     if (bChanged)
-        emit whitelistIpsChanged(ips_);
+        emit whitelistIpsChanged(ipsSet());
+}
+
+IpAddressSet WhitelistIpsManager::ipsSet() const
+{
+    IpAddressSet ips;
+    ips.reserve(ips_.size());
+    for (const auto &it : ips_)
+        ips.insert(it.key());
+    return ips;
 }
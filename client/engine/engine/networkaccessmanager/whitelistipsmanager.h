@@ -1,7 +1,8 @@
 #pragma once
-#include <QHash>
 #include <QObject>
-#include <QSet>
+#include <QStringList>
+
+#include "engine/utils/ipaddressmap.h"
 
 class WhitelistIpsManager : public QObject
 {
@@ -10,13 +11,17 @@ class WhitelistIpsManager : public QObject
 public:
     WhitelistIpsManager(QObject *parent);
 
+    // the strings which are not ip addresses are ignored
     void add(const QStringList &ips);
     void remove(const QStringList &ips);
 
 signals:
-    void whitelistIpsChanged(const QSet<QString> &ips);
+    void whitelistIpsChanged(const IpAddressSet &ips);
 
 private:
-    QSet<QString> ips_;
+    // the number of the requests which have added an ip, several requests to the same host can run at the same time
+    IpAddressMap<int> ips_;
+
+    IpAddressSet ipsSet() const;
 };
 
@@ -17,12 +17,14 @@ NetworkDetectionManager_linux::NetworkDetectionManager_linux(QObject *parent, IH
 {
     Q_UNUSED(helper);
 
+    routeMonitorThread_ = new QThread;
+    routeMonitor_ = new RouteMonitor_linux;
+    routeMonitor_->loadTables();
+
     networkInterface_ = types::NetworkInterface::noNetworkInterface();
-    getDefaultRouteInterface(isOnline_);
+    routeMonitor_->defaultRouteInterface(isOnline_);
     updateNetworkInfo(false);
 
-    routeMonitorThread_ = new QThread;
-    routeMonitor_ = new RouteMonitor_linux;
     connect(routeMonitor_, &RouteMonitor_linux::routesChanged, this, &NetworkDetectionManager_linux::onRoutesChanged);
     connect(routeMonitorThread_, &QThread::started, routeMonitor_, &RouteMonitor_linux::init);
     connect(routeMonitorThread_, &QThread::finished, routeMonitor_, &RouteMonitor_linux::finish);
@@ -58,7 +60,7 @@ void NetworkDetectionManager_linux::onRoutesChanged()
 void NetworkDetectionManager_linux::updateNetworkInfo(bool bWithEmitSignal)
 {
     bool newIsOnline;
-    QString ifname = getDefaultRouteInterface(newIsOnline);
+    QString ifname = routeMonitor_->defaultRouteInterface(newIsOnline);
 
     if (isOnline_ != newIsOnline)
     {
@@ -83,43 +85,6 @@ void NetworkDetectionManager_linux::updateNetworkInfo(bool bWithEmitSignal)
     }
 }
 
-QString NetworkDetectionManager_linux::getDefaultRouteInterface(bool &isOnline)
-{
-    QString strReply;
-    FILE *file = popen("/sbin/route -n | grep '^0\\.0\\.0\\.0'", "r");
-    if (file)
-    {
-        char szLine[4096];
-        while(fgets(szLine, sizeof(szLine), file) != 0)
-        {
-            strReply += szLine;
-        }
-        pclose(file);
-    }
-
-    const QStringList lines = strReply.split('\n', Qt::SkipEmptyParts);
-
-    isOnline = !lines.isEmpty();
-
-    for (auto &it : lines)
-    {
-        const QStringList pars = it.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-        if (pars.size() == 8)
-        {
-            if (!pars[7].startsWith("tun") && !pars[7].startsWith("utun"))
-            {
-                return pars[7];
-            }
-        }
-        else
-        {
-            qDebug(LOG_BASIC) << "NetworkDetectionManager_linux::getDefaultRouteInterface parse error";
-            return QString();
-        }
-    }
-    return QString();
-}
-
 void NetworkDetectionManager_linux::getInterfacePars(const QString &ifname, types::NetworkInterface &outNetworkInterface)
 {
     outNetworkInterface.interfaceName = ifname;
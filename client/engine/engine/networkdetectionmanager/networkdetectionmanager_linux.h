@@ -27,7 +27,6 @@ private:
     RouteMonitor_linux *routeMonitor_ = nullptr;
 
     void updateNetworkInfo(bool bWithEmitSignal);
-    QString getDefaultRouteInterface(bool &isOnline);
     void getInterfacePars(const QString &ifname, types::NetworkInterface &outNetworkInterface);
     QString getMacAddressByIfName(const QString &ifname);
     bool isActiveByIfName(const QString &ifname);
@@ -1,9 +1,13 @@
 #include "routemonitor_linux.h"
 
+#include <climits>
+#include <errno.h>
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
+#include <net/if.h>
 #include <stdio.h>
 #include <sys/socket.h>
+#include <sys/time.h>
 #include <unistd.h>
 
 #include "utils/logger.h"
@@ -20,19 +24,56 @@ RouteMonitor_linux::~RouteMonitor_linux()
     }
 }
 
+void RouteMonitor_linux::loadTables()
+{
+    if (!dumpTables()) {
+        qCDebug(LOG_BASIC) << "RouteMonitor_linux could not load the routing table";
+    }
+}
+
+QString RouteMonitor_linux::defaultRouteInterface(bool &isOnline) const
+{
+    QMutexLocker locker(&mutex_);
+
+    isOnline = false;
+    QString interfaceName;
+    int lowestMetric = INT_MAX;
+    for (const Route &route : tables_.routes) {
+        // the same as the 0.0.0.0 lines of "route -n", including the 0.0.0.0/1 routes of the VPN
+        if (route.destination != 0) {
+            continue;
+        }
+        isOnline = true;
+
+        const QString name = tables_.links.value(route.interfaceIndex).name;
+        if (name.isEmpty() || name.startsWith("tun") || name.startsWith("utun")) {
+            continue;
+        }
+        if (route.metric < lowestMetric) {
+            lowestMetric = route.metric;
+            interfaceName = name;
+        }
+    }
+    return interfaceName;
+}
+
 void RouteMonitor_linux::init()
 {
-    if ((fd_ = socket(AF_NETLINK, SOCK_DGRAM, NETLINK_ROUTE)) < 0) {
+    if ((fd_ = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_ROUTE)) < 0) {
         qCDebug(LOG_BASIC) << "RouteMonitor_linux could not open netlink socket";
         WS_ASSERT(false);
         return;
     }
 
+    // the routes are added in bursts while the VPN connects, a larger buffer makes an overrun less likely
+    int bufferSize = 1024 * 1024;
+    setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+
     struct sockaddr_nl addr;
     memset(&addr, 0, sizeof(addr));
     addr.nl_family = AF_NETLINK;
-    addr.nl_pid    = getpid();
-    addr.nl_groups = RTMGRP_IPV4_ROUTE;
+    addr.nl_pid    = 0;     // assigned by the kernel
+    addr.nl_groups = RTMGRP_IPV4_ROUTE | RTMGRP_LINK;
 
     if (bind(fd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
         qCDebug(LOG_BASIC) << "RouteMonitor_linux could not bind address";
@@ -40,9 +81,23 @@ void RouteMonitor_linux::init()
         return;
     }
 
+    debounceTimer_ = new QTimer(this);
+    debounceTimer_->setSingleShot(true);
+    connect(debounceTimer_, &QTimer::timeout, this, [this]() {
+        if (needReload_) {
+            needReload_ = false;
+            loadTables();
+        }
+        emit routesChanged();
+    });
+
     notifier_ = new QSocketNotifier(fd_, QSocketNotifier::Read, this);
     connect(notifier_, &QSocketNotifier::activated, this, &RouteMonitor_linux::netlinkSocketReady);
     notifier_->setEnabled(true);
+
+    // the tables could change after loadTables() and before the subscription
+    needReload_ = true;
+    debounceTimer_->start(kDebounceMs);
 }
 
 void RouteMonitor_linux::finish()
@@ -50,6 +105,9 @@ void RouteMonitor_linux::finish()
     if (notifier_) {
         notifier_->setEnabled(false);
     }
+    if (debounceTimer_) {
+        debounceTimer_->stop();
+    }
 }
 
 void RouteMonitor_linux::netlinkSocketReady(QSocketDescriptor socket, QSocketNotifier::Type activationEvent)
@@ -57,9 +115,229 @@ void RouteMonitor_linux::netlinkSocketReady(QSocketDescriptor socket, QSocketNot
     Q_UNUSED(socket)
     Q_UNUSED(activationEvent)
 
-    char buffer[4096];
-    ssize_t len = recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
-    if (len >= 0) {
-        emit routesChanged();
+    // read all the pending notifications, the routes usually come in bursts
+    char buffer[32768];
+    bool isChanged = false;
+    while (true) {
+        ssize_t len = recv(fd_, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (len < 0) {
+            if (errno == ENOBUFS) {
+                // the notifications were lost, so the tables are not up to date anymore
+                qCDebug(LOG_BASIC) << "RouteMonitor_linux netlink socket overrun, reloading the routing table";
+                needReload_ = true;
+                isChanged = true;
+                continue;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (len == 0) {
+            break;
+        }
+
+        QMutexLocker locker(&mutex_);
+        if (handleMessages(buffer, len, tables_)) {
+            isChanged = true;
+        }
+    }
+
+    // not restarted by the next changes, so that the notification is delayed by kDebounceMs at most
+    if (isChanged && !debounceTimer_->isActive()) {
+        debounceTimer_->start(kDebounceMs);
+    }
+}
+
+bool RouteMonitor_linux::dumpTables()
+{
+    int fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct timeval timeout = { 1, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // not under the mutex, defaultRouteInterface() is not blocked by the recv() timeout
+    Tables tables;
+    // the links first, the routes refer to them
+    const bool ret = dump(fd, RTM_GETLINK, 1, tables) && dump(fd, RTM_GETROUTE, 2, tables);
+    close(fd);
+    if (!ret) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex_);
+    std::swap(tables_, tables);
+    return true;
+}
+
+bool RouteMonitor_linux::dump(int fd, int type, int seq, Tables &tables)
+{
+    char request[NLMSG_SPACE(sizeof(struct ifinfomsg))];
+    memset(request, 0, sizeof(request));
+    struct nlmsghdr *header = reinterpret_cast<struct nlmsghdr *>(request);
+    if (type == RTM_GETROUTE) {
+        header->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtmsg));
+        static_cast<struct rtmsg *>(NLMSG_DATA(header))->rtm_family = AF_INET;
+    } else {
+        header->nlmsg_len = NLMSG_LENGTH(sizeof(struct ifinfomsg));
+        static_cast<struct ifinfomsg *>(NLMSG_DATA(header))->ifi_family = AF_UNSPEC;
+    }
+    header->nlmsg_type = type;
+    header->nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    header->nlmsg_seq = seq;
+
+    if (send(fd, request, header->nlmsg_len, 0) < 0) {
+        return false;
+    }
+
+    char buffer[32768];
+    bool isDone = false;
+    while (!isDone) {
+        ssize_t len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len < 0 && errno == EINTR) {
+            continue;
+        }
+        if (len <= 0) {
+            return false;
+        }
+        int error = 0;
+        handleMessages(buffer, len, tables, &isDone, &error);
+        if (error != 0) {
+            qCDebug(LOG_BASIC) << "RouteMonitor_linux netlink dump" << type << "failed:" << -error;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RouteMonitor_linux::handleMessages(const char *buffer, size_t len, Tables &tables, bool *outIsDone, int *outError)
+{
+    bool isChanged = false;
+    int remaining = static_cast<int>(len);
+    for (struct nlmsghdr *header = reinterpret_cast<struct nlmsghdr *>(const_cast<char *>(buffer));
+         NLMSG_OK(header, remaining); header = NLMSG_NEXT(header, remaining)) {
+        switch (header->nlmsg_type) {
+            case NLMSG_ERROR:
+                if (outError) {
+                    // a truncated error message is an error too
+                    const struct nlmsgerr *error = static_cast<const struct nlmsgerr *>(NLMSG_DATA(header));
+                    *outError = header->nlmsg_len >= NLMSG_LENGTH(sizeof(struct nlmsgerr)) ? error->error : -EBADMSG;
+                }
+                if (outIsDone) {
+                    *outIsDone = true;
+                }
+                return isChanged;
+            case NLMSG_DONE:
+                if (outIsDone) {
+                    *outIsDone = true;
+                }
+                return isChanged;
+            case RTM_NEWROUTE:
+            case RTM_DELROUTE:
+                if (handleRouteMessage(header, tables)) {
+                    isChanged = true;
+                }
+                break;
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+                if (handleLinkMessage(header, tables)) {
+                    isChanged = true;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return isChanged;
+}
+
+bool RouteMonitor_linux::handleRouteMessage(const struct nlmsghdr *header, Tables &tables)
+{
+    struct rtmsg *message = static_cast<struct rtmsg *>(NLMSG_DATA(const_cast<struct nlmsghdr *>(header)));
+    if (message->rtm_family != AF_INET) {
+        return false;
+    }
+
+    Route route;
+    route.table = message->rtm_table;
+    route.destinationLength = message->rtm_dst_len;
+
+    int len = RTM_PAYLOAD(header);
+    for (struct rtattr *attr = RTM_RTA(message); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+        switch (attr->rta_type) {
+            case RTA_TABLE:
+                route.table = *static_cast<quint32 *>(RTA_DATA(attr));
+                break;
+            case RTA_DST:
+                memcpy(&route.destination, RTA_DATA(attr), sizeof(route.destination));
+                break;
+            case RTA_GATEWAY:
+                memcpy(&route.gateway, RTA_DATA(attr), sizeof(route.gateway));
+                break;
+            case RTA_OIF:
+                route.interfaceIndex = *static_cast<int *>(RTA_DATA(attr));
+                break;
+            case RTA_PRIORITY:
+                route.metric = *static_cast<quint32 *>(RTA_DATA(attr));
+                break;
+            default:
+                break;
+        }
+    }
+
+    // only the main table, as "route -n" shows
+    if (route.table != RT_TABLE_MAIN) {
+        return false;
+    }
+
+    const RouteKey key(route.table, route.destination, route.destinationLength, route.metric, route.interfaceIndex);
+    if (header->nlmsg_type == RTM_DELROUTE) {
+        return tables.routes.remove(key) > 0;
+    }
+
+    auto it = tables.routes.find(key);
+    if (it != tables.routes.end() && it->gateway == route.gateway) {
+        return false;
+    }
+    tables.routes[key] = route;
+    return true;
+}
+
+bool RouteMonitor_linux::handleLinkMessage(const struct nlmsghdr *header, Tables &tables)
+{
+    struct ifinfomsg *message = static_cast<struct ifinfomsg *>(NLMSG_DATA(const_cast<struct nlmsghdr *>(header)));
+
+    const auto it = tables.links.constFind(message->ifi_index);
+    const unsigned int oldFlags = it != tables.links.constEnd() ? it->flags : 0;
+
+    if (header->nlmsg_type == RTM_DELLINK) {
+        if (tables.links.remove(message->ifi_index) == 0) {
+            return false;
+        }
+        // the kernel drops the routes of the removed interface without notifications
+        needReload_ = true;
+        return true;
+    }
+
+    Link link;
+    link.flags = message->ifi_flags;
+    int len = IFLA_PAYLOAD(header);
+    for (struct rtattr *attr = IFLA_RTA(message); RTA_OK(attr, len); attr = RTA_NEXT(attr, len)) {
+        if (attr->rta_type == IFLA_IFNAME) {
+            link.name = QString::fromUtf8(static_cast<const char *>(RTA_DATA(attr)));
+        }
+    }
+
+    if (it != tables.links.constEnd() && it->name == link.name && it->flags == link.flags) {
+        return false;
+    }
+    // the same for the routes of an interface going down
+    if ((oldFlags & IFF_UP) && !(link.flags & IFF_UP)) {
+        needReload_ = true;
     }
+    tables.links[message->ifi_index] = link;
+    return true;
 }
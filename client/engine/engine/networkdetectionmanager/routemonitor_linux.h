@@ -1,15 +1,45 @@
 #pragma once
 
+#include <QHash>
+#include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QSocketNotifier>
+#include <QTimer>
+#include <tuple>
 
+// Keeps the IPv4 routes and the links in memory, updated by the netlink notifications.
+// routesChanged() is emitted once after a burst of changes (for example, the routes added while the VPN connects).
 class RouteMonitor_linux : public QObject
 {
    Q_OBJECT
 public:
+    struct Route
+    {
+        int table = 0;
+        quint32 destination = 0;    // network byte order
+        int destinationLength = 0;
+        quint32 gateway = 0;        // network byte order
+        int interfaceIndex = 0;
+        int metric = 0;
+    };
+
+    struct Link
+    {
+        QString name;
+        unsigned int flags = 0;
+    };
+
     explicit RouteMonitor_linux(QObject *parent = nullptr);
     ~RouteMonitor_linux();
 
+    // Fills the tables synchronously, can be called before the thread is started.
+    void loadTables();
+
+    // Thread-safe. The interface of the lowest metric default route except the VPN ones, empty if none.
+    // isOnline is true if there is any default route.
+    QString defaultRouteInterface(bool &isOnline) const;
+
 signals:
     void routesChanged();
 
@@ -21,6 +51,31 @@ private slots:
     void netlinkSocketReady(QSocketDescriptor socket, QSocketNotifier::Type activationEvent);
 
 private:
+    // a route is identified by the table, the destination, the metric and the interface
+    typedef std::tuple<int, quint32, int, int, int> RouteKey;
+
+    struct Tables
+    {
+        QMap<RouteKey, Route> routes;
+        QHash<int, Link> links;
+    };
+
+    static constexpr int kDebounceMs = 250;
+
     int fd_ = -1;
     QSocketNotifier *notifier_ = nullptr;
+    QTimer *debounceTimer_ = nullptr;
+    // set when the kernel could change the routes without notifications, the tables are reloaded after the debounce
+    bool needReload_ = false;
+
+    mutable QMutex mutex_;
+    Tables tables_;
+
+    // the tables are read without the mutex and replace tables_ only if the whole dump succeeded
+    bool dumpTables();
+    bool dump(int fd, int type, int seq, Tables &tables);
+    // returns true if the tables were changed, outError is the error of an NLMSG_ERROR message (0 for an acknowledgement)
+    bool handleMessages(const char *buffer, size_t len, Tables &tables, bool *outIsDone = nullptr, int *outError = nullptr);
+    bool handleRouteMessage(const struct nlmsghdr *header, Tables &tables);
+    bool handleLinkMessage(const struct nlmsghdr *header, Tables &tables);
 };
@@ -30,10 +30,10 @@ void PacketSizeController::setPacketSize(const types::PacketSize &packetSize)
     setPacketSizeImpl(packetSize);
 }
 
-void PacketSizeController::detectAppropriatePacketSize(const QString &hostname)
+void PacketSizeController::detectAppropriatePacketSize(const QString &hostname, const QString &networkOrSsid, bool useCache)
 {
     QMutexLocker locker(&mutex_);
-    QMetaObject::invokeMethod(this, "detectAppropriatePacketSizeImpl", Q_ARG(QString, hostname));
+    QMetaObject::invokeMethod(this, "detectAppropriatePacketSizeImpl", Q_ARG(QString, hostname), Q_ARG(QString, networkOrSsid), Q_ARG(bool, useCache));
 }
 
 void PacketSizeController::earlyStop()
@@ -51,14 +51,28 @@ void PacketSizeController::setPacketSizeImpl(const types::PacketSize &packetSize
     }
 }
 
-void PacketSizeController::detectAppropriatePacketSizeImpl(const QString &hostname)
+void PacketSizeController::detectAppropriatePacketSizeImpl(const QString &hostname, const QString &networkOrSsid, bool useCache)
 {
     {
         QMutexLocker locker(&mutex_);
         earlyStop_ = false;
     }
 
-    const int mtu = getIdealPacketSize(hostname);
+    const QString cacheKey = networkOrSsid + "/" + hostname;
+    int mtu = -1;
+    auto it = cache_.constFind(cacheKey);
+    if (useCache && !networkOrSsid.isEmpty() && it != cache_.constEnd() && !it->elapsedTimer.hasExpired(kCacheTimeoutMs)) {
+        mtu = it->mtu;
+        qCDebug(LOG_PACKET_SIZE) << "Using the mtu detected" << it->elapsedTimer.elapsed() / 1000 << "seconds ago for the current network";
+    } else {
+        mtu = getIdealPacketSize(hostname);
+        if (mtu > 0 && !networkOrSsid.isEmpty()) {
+            CachedMtu cachedMtu;
+            cachedMtu.mtu = mtu;
+            cachedMtu.elapsedTimer.start();
+            cache_[cacheKey] = cachedMtu;
+        }
+    }
     const bool is_error = mtu < 0;
 
     QMutexLocker locker(&mutex_);
@@ -76,7 +90,6 @@ void PacketSizeController::detectAppropriatePacketSizeImpl(const QString &hostna
 
 int PacketSizeController::getIdealPacketSize(const QString &hostname)
 {
-    int mtu = 1470;
     QString modifiedHostname = hostname;
 
     // if this is IP, use without change
@@ -93,30 +106,59 @@ int PacketSizeController::getIdealPacketSize(const QString &hostname)
 
     qCDebug(LOG_PACKET_SIZE) << "Detecting packet size via:" << modifiedHostname;
 
-    bool success = false;
-    while (mtu >= 1300)
+    // Binary search over the sizes from kMinMtu to kMaxMtu, several sizes in parallel per round.
+    // good is the index of the largest size known to pass, bad is the index of the smallest size known to fail.
+    const int count = (kMaxMtu - kMinMtu) / kMtuStep + 1;
+    int good = -1;
+    int bad = count;
+    while (bad - good > 1)
     {
-        QMutexLocker locker(&mutex_);
-        if (earlyStop_)
         {
-            qCDebug(LOG_PACKET_SIZE) << "Exiting packet size detection loop early";
-            break;
+            QMutexLocker locker(&mutex_);
+            if (earlyStop_)
+            {
+                qCDebug(LOG_PACKET_SIZE) << "Exiting packet size detection loop early";
+                return -1;
+            }
         }
 
-        bool pingSuccess = NetworkUtils::pingWithMtu(modifiedHostname, mtu);
-        if (pingSuccess)
+        QVector<int> indexes;
+        for (int i = 1; i <= kProbesPerRound; ++i)
+        {
+            const int ind = good + i * (bad - good) / (kProbesPerRound + 1);
+            if (ind > good && ind < bad && (indexes.isEmpty() || indexes.last() != ind))
+                indexes << ind;
+        }
+        if (indexes.isEmpty())
+            indexes << good + 1;
+
+        QVector<int> mtus;
+        for (int ind : qAsConst(indexes))
+            mtus << kMinMtu + ind * kMtuStep;
+        const QVector<bool> results = NetworkUtils::pingWithMtus(modifiedHostname, mtus, kProbeTimeoutMs);
+        qCDebug(LOG_PACKET_SIZE) << "Probed sizes" << mtus << "results" << results;
+
+        // a lost probe below the largest passed size is ignored, the search continues above it
+        for (int i = 0; i < indexes.size(); ++i)
+        {
+            if (results[i])
+                good = qMax(good, indexes[i]);
+        }
+        for (int i = 0; i < indexes.size(); ++i)
         {
-            success = true;
-            break;
+            if (!results[i] && indexes[i] > good)
+            {
+                bad = qMin(bad, indexes[i]);
+                break;
+            }
         }
-        mtu -= 10;
     }
 
-    if (!success)
+    if (good < 0)
     {
         qCDebug(LOG_PACKET_SIZE) << "Couldn't find appropriate MTU -- check internet connection";
         return -1;
     }
 
-    return mtu;
+    return kMinMtu + good * kMtuStep;
 }
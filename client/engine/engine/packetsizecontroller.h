@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
 #include <QMutex>
 #include "types/packetsize.h"
@@ -15,7 +17,8 @@ public:
     explicit PacketSizeController(QObject *parent = nullptr);
 
     void setPacketSize(const types::PacketSize &packetSize);
-    void detectAppropriatePacketSize(const QString &hostname);
+    // useCache is false for a detection requested by the user, the size is probed again then
+    void detectAppropriatePacketSize(const QString &hostname, const QString &networkOrSsid, bool useCache);
     void earlyStop();
 
 signals:
@@ -27,12 +30,28 @@ public slots:
     void finish();
 
 private slots:
-    void detectAppropriatePacketSizeImpl(const QString &hostname);
+    void detectAppropriatePacketSizeImpl(const QString &hostname, const QString &networkOrSsid, bool useCache);
 
 private:
+    // The sizes are searched from kMinMtu to kMaxMtu with kMtuStep, probing several of them in parallel per round.
+    static constexpr int kMaxMtu = 1470;
+    static constexpr int kMinMtu = 1300;
+    static constexpr int kMtuStep = 10;
+    static constexpr int kProbesPerRound = 4;
+    static constexpr int kProbeTimeoutMs = 1000;
+    // the detected size is reused for the same network during this time
+    static constexpr int kCacheTimeoutMs = 10 * 60 * 1000;
+
+    struct CachedMtu
+    {
+        int mtu;
+        QElapsedTimer elapsedTimer;
+    };
+
     QMutex mutex_;
     bool earlyStop_;
     types::PacketSize packetSize_;
+    QHash<QString, CachedMtu> cache_;
 
 #ifdef Q_OS_WIN
     QScopedPointer<Debug::CrashHandlerForThread> crashHandler_;
@@ -12,7 +12,8 @@ KeepAliveManager::KeepAliveManager(QObject *parent, IConnectStateController *sta
     isEnabled_(false), curConnectState_(CONNECT_STATE_DISCONNECTED), pingHosts_(this, stateController, networkAccessManager)
 {
     connect(stateController, &IConnectStateController::stateChanged, this, &KeepAliveManager::onConnectStateChanged);
-    connect(&timer_, &QTimer::timeout, this, &KeepAliveManager::onTimer);
+    connect(&timer_, &WheelTimer::timeout, this, &KeepAliveManager::onTimer);
+    timer_.setSlack(1000);
     connect(&pingHosts_, &PingMultipleHosts::pingFinished, this, &KeepAliveManager::onPingFinished);
 }
 
@@ -1,10 +1,10 @@
 #pragma once
 
 #include <QObject>
-#include <QTimer>
 
 #include "types/locationid.h"
 #include "pingmultiplehosts.h"
+#include "engine/utils/timerwheel.h"
 
 // If enabled, when user is connected to the tunnel send an ICMP request to windscribe.com every 10s.
 class KeepAliveManager : public QObject
@@ -25,7 +25,7 @@ private:
     bool isEnabled_;
     CONNECT_STATE curConnectState_;
     static constexpr int KEEP_ALIVE_TIMEOUT = 10000;
-    QTimer timer_;
+    WheelTimer timer_;
 
     struct IP_DESCR
     {
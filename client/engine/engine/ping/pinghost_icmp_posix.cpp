@@ -13,7 +13,22 @@ void PingHost_ICMP_posix::ping()
     WS_ASSERT(process_ == nullptr);
     process_ = new QProcess(this);
     connect(process_, &QProcess::finished, this, &PingHost_ICMP_posix::onProcessFinished);
+    connect(process_, &QProcess::errorOccurred, this, &PingHost_ICMP_posix::onProcessErrorOccurred);
+#ifdef Q_OS_MACOS
     process_->start("ping", QStringList() << "-c" << "1" << "-W" << "2000" << ip_);
+#else
+    // the timeout of the Linux ping is in seconds
+    process_->start("ping", QStringList() << "-c" << "1" << "-W" << "2" << ip_);
+#endif
+}
+
+void PingHost_ICMP_posix::onProcessErrorOccurred(QProcess::ProcessError error)
+{
+    // the finished signal is not emitted when the process failed to start
+    if (error == QProcess::FailedToStart) {
+        qCDebug(LOG_PING) << "ping utility failed to start:" << process_->errorString();
+        emit pingFinished(false, 0, ip_);
+    }
 }
 
 void PingHost_ICMP_posix::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
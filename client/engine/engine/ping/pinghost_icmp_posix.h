@@ -14,6 +14,7 @@ public:
 
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onProcessErrorOccurred(QProcess::ProcessError error);
 
 private:
     QString ip_;
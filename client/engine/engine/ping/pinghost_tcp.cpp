@@ -1,6 +1,5 @@
 #include "pinghost_tcp.h"
 #include <QTcpSocket>
-#include <QTimer>
 
 PingHost_TCP::PingHost_TCP(QObject *parent, const QString &ip, const types::ProxySettings &proxySettings, bool isProxyEnabled) :
     IPingHost(parent), ip_(ip), proxySettings_(proxySettings), isProxyEnabled_(isProxyEnabled)
@@ -14,8 +13,8 @@ void PingHost_TCP::ping()
     {
         tcpSocket_->setProxy(proxySettings_.getNetworkProxy());
     }
-    timer_ = new QTimer(this);
-    connect(timer_, &QTimer::timeout, this, &PingHost_TCP::onSocketTimeout);
+    timer_ = new WheelTimer(this);
+    connect(timer_, &WheelTimer::timeout, this, &PingHost_TCP::onSocketTimeout);
     connect(tcpSocket_, &QTcpSocket::connected, this, &PingHost_TCP::onSocketConnected);
     connect(tcpSocket_, &QTcpSocket::bytesWritten, this, &PingHost_TCP::onSocketBytesWritten);
     connect(tcpSocket_, &QTcpSocket::errorOccurred, this, &PingHost_TCP::onSocketError);
@@ -3,10 +3,10 @@
 #include <QVector>
 #include <QAbstractSocket>
 #include <QTcpSocket>
-#include <QTimer>
 #include <QElapsedTimer>
 #include "ipinghost.h"
 #include "types/proxysettings.h"
+#include "engine/utils/timerwheel.h"
 
 class PingHost_TCP : public IPingHost
 {
@@ -29,7 +29,7 @@ private:
     types::ProxySettings proxySettings_;
     bool isProxyEnabled_ = false;
     QTcpSocket *tcpSocket_ = nullptr;
-    QTimer *timer_ = nullptr;
+    WheelTimer *timer_ = nullptr;
     QElapsedTimer elapsedTimer_;
 
     bool isProxyEnabled() const;
@@ -2,6 +2,9 @@
 
 #include "../connectstatecontroller/iconnectstatecontroller.h"
 #include "types/pingtime.h"
+#include "engine/metrics/metrics.h"
+
+#include <algorithm>
 
 PingManager::PingManager(QObject *parent, IConnectStateController *stateController,
                                      INetworkDetectionManager *networkDetectionManager, PingMultipleHosts *pingHosts, const QString &storageSettingName,
@@ -10,48 +13,68 @@ PingManager::PingManager(QObject *parent, IConnectStateController *stateControll
     pingLog_(log_filename), pingHosts_(pingHosts)
 {
     connect(pingHosts_, &PingMultipleHosts::pingFinished, this, &PingManager::onPingFinished);
-    connect(&pingTimer_, &QTimer::timeout, this, &PingManager::onPingTimer);
+    connect(&pingTimer_, &WheelTimer::timeout, this, &PingManager::onPingTimer);
+    // the tick only checks which nodes are due, half a second late is fine
+    pingTimer_.setSingleShot(true);
+    pingTimer_.setSlack(PING_TIMER_INTERVAL / 2);
+    // the pings wait for these while the timer is not running
+    connect(networkDetectionManager_, &INetworkDetectionManager::networkChanged, this, &PingManager::wakeUpSoon);
+    connect(networkDetectionManager_, &INetworkDetectionManager::onlineStateChanged, this, &PingManager::wakeUpSoon);
+    connect(connectStateController_, &IConnectStateController::stateChanged, this, &PingManager::wakeUpSoon);
 }
 
 void PingManager::updateIps(const QVector<PingIpInfo> &ips)
 {
     pingLog_.addLog("PingIpsController::updateIps", "update ips:" + QString::number(ips.count()));
 
-    for (auto it = ips_.begin(); it != ips_.end(); ++it) {
+    for (const auto &it : ips_) {
         it.value().existThisIp = false;
     }
 
     for (const PingIpInfo &ip_info : qAsConst(ips)) {
-        auto it = ips_.find(ip_info.ip);
-        if (it == ips_.end()) {
-            pingStorage_.initPingDataIfNotExists(ip_info.ip);
+        const IpAddress ip = IpAddress::fromString(ip_info.ip);
+        if (!ip.isValid()) {
+            pingLog_.addLog("PingIpsController::updateIps", "skipped invalid ip: " + ip_info.ip);
+            continue;
+        }
+        PingIpState *state = ips_.find(ip);
+        if (!state) {
+            pingStorage_.initPingDataIfNotExists(ip);
             PingTime pingTime;
             qint64 iterTime;
-            pingStorage_.getPingData(ip_info.ip, pingTime, iterTime);
-            ips_[ip_info.ip] = PingIpState(ip_info, iterTime, pingTime == PingTime::PING_FAILED);
+            pingStorage_.getPingData(ip, pingTime, iterTime);
+            ips_[ip] = PingIpState(ip_info, iterTime, pingTime == PingTime::PING_FAILED);
         }
         else {
-            it.value().existThisIp = true;
+            state->existThisIp = true;
         }
     }
 
     // remove unused ips
-    auto it = ips_.begin();
-    while (it != ips_.end()) {
-        if (!it.value().existThisIp) {
-            pingLog_.addLog("PingIpsController::updateIps", "removed unused ip: " + it.key());
-            pingStorage_.removePingNode(it.key());
-            it = ips_.erase(it);
-        }
-        else {
-            ++it;
-        }
+    QVector<IpAddress> unused;
+    for (const auto &it : ips_) {
+        if (!it.value().existThisIp)
+            unused << it.key();
+    }
+    for (const IpAddress &ip : qAsConst(unused)) {
+        pingLog_.addLog("PingIpsController::updateIps", "removed unused ip: " + ips_.find(ip)->ipInfo.ip);
+        pingStorage_.removePingNode(ip);
+        ips_.remove(ip);
     }
 
     failedPingLogController_.clear();
 
+    // the best node may have been removed, the score is taken from the remaining ones pinged in the iteration
+    bestScoreThisIteration_ = INT_MAX;
+    for (const auto &it : qAsConst(ips_)) {
+        if (it.value().pingsThisIteration > 0 || it.value().iterationTime == pingStorage_.currentIterationTime()) {
+            const PingTime score = pingStorage_.getScore(it.key());
+            if (score.toInt() != PingTime::NO_PING_INFO && score.toInt() != PingTime::PING_FAILED)
+                bestScoreThisIteration_ = qMin(bestScoreThisIteration_, score.toInt());
+        }
+    }
+
     onPingTimer();
-    pingTimer_.start(PING_TIMER_INTERVAL);
 }
 
 void PingManager::clearIps()
@@ -64,19 +87,53 @@ bool PingManager::isAllNodesHaveCurIteration() const
     return pingStorage_.isAllNodesHaveCurIteration();
 }
 
+bool PingManager::isBestNodeKnown() const
+{
+    if (pingStorage_.isAllNodesHaveCurIteration())
+        return true;
+    if (bestScoreThisIteration_ == INT_MAX)
+        return false;
+
+    for (const auto &it : ips_) {
+        if (it.value().iterationTime == pingStorage_.currentIterationTime())
+            continue;
+        // the previous statistics give an optimistic estimate of the node, they are cleared when the network changes,
+        // so only the samples of the current network are used
+        const PingStats stats = pingStorage_.getStats(it.key());
+        const int rtt = stats.smoothedRtt().toInt();
+        if (rtt == PingTime::NO_PING_INFO)
+            return false;
+        if (rtt != PingTime::PING_FAILED && rtt - 2 * stats.jitter() < bestScoreThisIteration_)
+            return false;
+    }
+    return true;
+}
+
 PingTime PingManager::getPing(const QString &ip) const
 {
-    return pingStorage_.getPing(ip);
+    return pingStorage_.getPing(IpAddress::fromString(ip));
+}
+
+PingTime PingManager::getScore(const QString &ip) const
+{
+    return pingStorage_.getScore(IpAddress::fromString(ip));
 }
 
 void PingManager::onPingTimer()
 {
+    pingBudget_ = qMin(pingBudget_ + PING_BUDGET_PER_TICK, PING_BUDGET_BURST);
+
     // We don't attempt to issue a ping request when state is CONNECT_STATE_CONNECTING, as the firewall will block it.
-    if (!networkDetectionManager_->isOnline() || connectStateController_->currentState() != CONNECT_STATE_DISCONNECTED)
+    // The timer is woken up again by the state changes.
+    if (!networkDetectionManager_->isOnline() || connectStateController_->currentState() != CONNECT_STATE_DISCONNECTED) {
+        pingTimer_.stop();
         return;
+    }
 
-    if (ips_.isEmpty())
+    if (ips_.isEmpty()) {
+        pingTimer_.stop();
         return;
+    }
 
     QDateTime curDateTime = QDateTime::currentDateTimeUtc();
     QDateTime nextDateTime = QDateTime::fromMSecsSinceEpoch(pingStorage_.currentIterationTime(), Qt::UTC).addSecs(NEXT_PERIOD_SECS);
@@ -85,40 +142,149 @@ void PingManager::onPingTimer()
     types::NetworkInterface curNetworkInterface;
     networkDetectionManager_->getCurrentNetworkInterface(curNetworkInterface);
     if (pingStorage_.currentIterationTime() == 0 || curDateTime > nextDateTime || curNetworkInterface.networkOrSsid != pingStorage_.currentIterationNetworkOrSsid()) {
-        pingStorage_.setCurrentIterationData(curDateTime.toMSecsSinceEpoch(), curNetworkInterface.networkOrSsid);
-        for (auto it = ips_.begin(); it != ips_.end(); ++it) {
+        // the iterations are told apart by their time, so it never repeats the previous one
+        pingStorage_.setCurrentIterationData(qMax(curDateTime.toMSecsSinceEpoch(), pingStorage_.currentIterationTime() + 1), curNetworkInterface.networkOrSsid);
+        for (const auto &it : ips_) {
             it.value().resetState();
         }
+        pingBudget_ = PING_BUDGET_BURST;
+        bestScoreThisIteration_ = INT_MAX;
+        sweepTimer_.start();
         if (curDateTime > nextDateTime)
             pingLog_.addLog("PingIpsController::onPingTimer", "Re-ping all nodes by time");
         else
             pingLog_.addLog("PingIpsController::onPingTimer", "Re-ping all nodes by network change");
     }
 
-    for (auto it = ips_.begin(); it != ips_.end(); ++it) {
+    const qint64 now = curDateTime.toMSecsSinceEpoch();
+    sweepExpiredPings(now);
+
+    QVector<QPair<int, IpAddress>> due;
+    for (const auto &it : ips_) {
         PingIpState &pni = it.value();
+        if (pingsInFlight_.contains(it.key()))
+            continue;
+
+        // the noisy nodes are refreshed more often than the whole iteration
+        if (pni.iterationTime == pingStorage_.currentIterationTime() && !pni.latestPingFailed && now - pni.lastPingTime > NOISY_NODE_PERIOD_SECS * 1000LL) {
+            const PingStats stats = pingStorage_.getStats(it.key());
+            if (stats.jitter() * 5 > stats.smoothedRtt().toInt() || stats.lossRate() > 0.1) {
+                pingLog_.addLog("PingNodesController::onPingTimer", "refresh noisy node: " + pni.ipInfo.ip);
+                pni.resetState();
+                pni.existThisIp = true;
+            }
+        }
+
         if (pni.iterationTime != pingStorage_.currentIterationTime()) {
-            pingLog_.addLog("PingNodesController::onPingTimer", QString::fromLatin1("ping new node: %1 (%2 - %3)").arg(pni.ipInfo.ip, pni.ipInfo.city, pni.ipInfo.nick));
-            pingHosts_->addHostForPing(pni.ipInfo.ip, pni.ipInfo.hostname, pni.ipInfo.pingType);
+            due << qMakePair(pingPriority(it.key(), pni, now), it.key());
         } else if (pni.latestPingFailed) {
-            if (pni.nextTimeForFailedPing == 0 || QDateTime::currentMSecsSinceEpoch() >= pni.nextTimeForFailedPing) {
-                pingLog_.addLog("PingNodesController::onPingTimer", "start ping because latest ping failed: " + it.key());
-                pingHosts_->addHostForPing(pni.ipInfo.ip, pni.ipInfo.hostname, pni.ipInfo.pingType);
+            if (pni.nextTimeForFailedPing == 0 || now >= pni.nextTimeForFailedPing) {
+                due << qMakePair(pingPriority(it.key(), pni, now), it.key());
             }
         }
     }
+
+    const int count = std::max(0, std::min({ pingBudget_, MAX_PINGS_IN_FLIGHT - static_cast<int>(pingsInFlight_.size()), static_cast<int>(due.size()) }));
+    if (count > 0)
+        std::partial_sort(due.begin(), due.begin() + count, due.end());
+    for (int i = 0; i < count; ++i) {
+        const PingIpState &pni = *ips_.find(due[i].second);
+        if (pni.iterationTime != pingStorage_.currentIterationTime())
+            pingLog_.addLog("PingNodesController::onPingTimer", QString::fromLatin1("ping node: %1 (%2 - %3)").arg(pni.ipInfo.ip, pni.ipInfo.city, pni.ipInfo.nick));
+        else
+            pingLog_.addLog("PingNodesController::onPingTimer", "start ping because latest ping failed: " + pni.ipInfo.ip);
+        pingsInFlight_.insert(due[i].second, PingInFlight{ pingStorage_.currentIterationTime(), now + PING_IN_FLIGHT_TIMEOUT });
+        pingBudget_--;
+        pingHosts_->addHostForPing(pni.ipInfo.ip, pni.ipInfo.hostname, pni.ipInfo.pingType);
+    }
+
+    // the rest of the due nodes wait for the budget or the in-flight slots
+    scheduleNextPing(now, count < static_cast<int>(due.size()));
 }
 
-void PingManager::onPingFinished(bool success, int timems, const QString &ip, bool isFromDisconnectedState)
+int PingManager::pingPriority(const IpAddress &ip, const PingIpState &pni, qint64 now) const
 {
-    auto itNode = ips_.find(ip);
-    if (itNode == ips_.end()) {
+    // lower goes first: the optimistic latency of the node, the unknown ones may be the best too
+    int priority = 0;
+    const PingStats stats = pingStorage_.getStats(ip);
+    const int rtt = stats.smoothedRtt().toInt();
+    if (rtt == PingTime::PING_FAILED)
+        priority = PingTime::MAX_LATENCY_FOR_PING_FAILED;
+    else if (rtt != PingTime::NO_PING_INFO)
+        priority = qMax(0, rtt - 2 * stats.jitter());
+
+    // every hour without pings is worth 10 ms, up to the period of the iterations
+    const qint64 staleHours = qBound<qint64>(0, (now - pni.lastPingTime) / (60 * 60 * 1000), NEXT_PERIOD_SECS / (60 * 60));
+    return priority - static_cast<int>(staleHours) * 10;
+}
+
+void PingManager::scheduleNextPing(qint64 now, bool hasWaitingNodes)
+{
+    if (hasWaitingNodes) {
+        pingTimer_.start(PING_TIMER_INTERVAL);
+        return;
+    }
+
+    // the earliest of: the next iteration, a ping timeout, a retry of a failed node, a refresh of a noisy node
+    qint64 next = pingStorage_.currentIterationTime() + NEXT_PERIOD_SECS * 1000LL + 1;
+    for (const auto &it : qAsConst(pingsInFlight_))
+        next = qMin(next, it.value().deadline);
+    for (const auto &it : qAsConst(ips_)) {
+        const PingIpState &pni = it.value();
+        if (pni.iterationTime != pingStorage_.currentIterationTime())
+            continue;   // in flight or due now, the answer wakes the timer up
+        if (pni.latestPingFailed) {
+            if (pni.nextTimeForFailedPing != 0)
+                next = qMin(next, pni.nextTimeForFailedPing);
+        } else if (pni.lastPingTime + NOISY_NODE_PERIOD_SECS * 1000LL < next) {
+            const PingStats stats = pingStorage_.getStats(it.key());
+            if (stats.jitter() * 5 > stats.smoothedRtt().toInt() || stats.lossRate() > 0.1)
+                next = pni.lastPingTime + NOISY_NODE_PERIOD_SECS * 1000LL + 1;
+        }
+    }
+    pingTimer_.start(static_cast<int>(qBound<qint64>(PING_TIMER_INTERVAL, next - now, NEXT_PERIOD_SECS * 1000LL)));
+}
+
+void PingManager::wakeUpSoon()
+{
+    if (!pingTimer_.isActive() || pingTimer_.remainingTime() > PING_TIMER_INTERVAL)
+        pingTimer_.start(PING_TIMER_INTERVAL);
+}
+
+void PingManager::sweepExpiredPings(qint64 now)
+{
+    // a ping host which never answers (e.g. the ping process failed to start) would hold its slot forever
+    QStringList expired;
+    for (const auto &it : qAsConst(pingsInFlight_)) {
+        if (now >= it.value().deadline)
+            expired << it.key().toString();
+    }
+    for (const QString &ip : qAsConst(expired)) {
+        pingLog_.addLog("PingIpsController::onPingTimer", "ping timed out: " + ip);
+        onPingFinished(false, 0, ip, true);
+    }
+}
+
+void PingManager::onPingFinished(bool success, int timems, const QString &ipStr, bool isFromDisconnectedState)
+{
+    const IpAddress ip = IpAddress::fromString(ipStr);
+    // an answer after the ping timed out has no entry, it is discarded as one of another iteration
+    const qint64 startIterationTime = pingsInFlight_.value(ip).iterationTime;
+    pingsInFlight_.remove(ip);
+    PingIpState *node = ips_.find(ip);
+    if (!node) {
+        return;
+    }
+    // a ping started before a new iteration (e.g. on the previous network) would mix into the new statistics,
+    // the node is pinged again in the current iteration
+    if (startIterationTime != pingStorage_.currentIterationTime()) {
+        pingLog_.addLog("PingIpsController::onPingFinished", "discarding ping of the previous iteration: " + ipStr);
         return;
     }
 
     // Note: we only issue ping requests in the disconnected state.  However, it is possible we transitioned to the
     // connecting/connected state between the time the ping request was issued to PingHost and when it was executed.
-    PingIpState &p = itNode.value();
+    PingIpState &p = *node;
     if (success) {
         p.nextTimeForFailedPing = 0;
         p.latestPingFailed = false;
@@ -127,16 +293,27 @@ void PingManager::onPingFinished(bool success, int timems, const QString &ip, bo
         // If the ping was executed in the connected state, we'll mark it as never happening and reissue it when
         // we're back in the disconnected state.
         if (isFromDisconnectedState) {
-            p.iterationTime = pingStorage_.currentIterationTime();
-            pingStorage_.setPing(ip, timems);
-            emit pingInfoChanged(ip, timems);
-            pingLog_.addLog("PingIpsController::onPingFinished", QString::fromLatin1("ping successful: %1 (%2 - %3) %4ms").arg(p.ipInfo.ip, p.ipInfo.city, p.ipInfo.nick).arg(timems));
+            pingStorage_.addPing(ip, timems);
+            p.pingsThisIteration++;
+            p.lastPingTime = QDateTime::currentMSecsSinceEpoch();
+            const PingStats stats = pingStorage_.getStats(ip);
+            bestScoreThisIteration_ = qMin(bestScoreThisIteration_, stats.score().toInt());
+            // the extra pings only matter for the nodes which compete for the best location
+            if (p.pingsThisIteration >= PINGS_PER_ITERATION || stats.score().toInt() > bestScoreThisIteration_ * NOT_COMPETING_SCORE_RATIO) {
+                p.iterationTime = pingStorage_.currentIterationTime();
+                pingStorage_.setIterationDone(ip);
+            }
+            emit pingInfoChanged(p.ipInfo.ip, stats.smoothedRtt().toInt());
+            pingLog_.addLog("PingIpsController::onPingFinished", QString::fromLatin1("ping successful: %1 (%2 - %3) %4ms, smoothed %5ms, min %6ms, jitter %7ms, loss %8%")
+                .arg(p.ipInfo.ip, p.ipInfo.city, p.ipInfo.nick).arg(timems).arg(stats.smoothedRtt().toInt()).arg(stats.minRtt()).arg(stats.jitter()).arg(qRound(stats.lossRate() * 100)));
         }
         else {
             pingLog_.addLog("PingIpsController::onPingFinished", QString::fromLatin1("discarding ping while connected: %1 (%2 - %3) %4ms").arg(p.ipInfo.ip, p.ipInfo.city, p.ipInfo.nick).arg(timems));
         }
     }
     else {
+        static metrics::Counter &failures = metrics::counter("ws_ping_failures_total", "Failed pings of the server nodes");
+        failures.inc();
         p.latestPingFailed = true;
         p.failedPingsInRow++;
 
@@ -146,11 +323,13 @@ void PingManager::onPingFinished(bool success, int timems, const QString &ip, bo
 
             if (isFromDisconnectedState) {
                 p.iterationTime = pingStorage_.currentIterationTime();
-                pingStorage_.setPing(ip, PingTime::PING_FAILED);
-                emit pingInfoChanged(ip, PingTime::PING_FAILED);
+                p.lastPingTime = QDateTime::currentMSecsSinceEpoch();
+                pingStorage_.addPing(ip, PingTime::PING_FAILED);
+                pingStorage_.setIterationDone(ip);
+                emit pingInfoChanged(p.ipInfo.ip, PingTime::PING_FAILED);
             }
 
-            if (failedPingLogController_.logFailedIPs(ip)) {
+            if (failedPingLogController_.logFailedIPs(ipStr)) {
                 pingLog_.addLog("PingIpsController::onPingFinished", QString::fromLatin1("ping failed: %1 (%2 - %3)").arg(p.ipInfo.ip, p.ipInfo.city, p.ipInfo.nick));
             }
         }
@@ -158,7 +337,15 @@ void PingManager::onPingFinished(bool success, int timems, const QString &ip, bo
             p.nextTimeForFailedPing = 0;
         }
     }
+    // the node may need another ping now
+    wakeUpSoon();
+
     if (pingStorage_.isAllNodesHaveCurIteration()) {
         pingLog_.addLog("PingIpsController::onPingFinished", "All nodes have the same iteration time");
+        if (sweepTimer_.isValid()) {
+            static metrics::Histogram &sweepDuration = metrics::histogram("ws_ping_sweep_duration_seconds", "Time to ping all the server nodes");
+            sweepDuration.record(sweepTimer_.nsecsElapsed() / 1000);
+            sweepTimer_.invalidate();
+        }
     }
 }
@@ -1,15 +1,17 @@
 #pragma once
 
 #include <QObject>
-#include <QTimer>
 #include <QDateTime>
-#include <QHash>
+#include <QElapsedTimer>
+#include <climits>
 
 #include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
+#include "engine/utils/ipaddressmap.h"
 #include "pingmultiplehosts.h"
 #include "pingstorage.h"
 #include "failedpinglogcontroller.h"
 #include "pinglog.h"
+#include "engine/utils/timerwheel.h"
 
 struct PingIpInfo
 {
@@ -21,7 +23,9 @@ struct PingIpInfo
 };
 
 // logic of ping all nodes (taken into account connected/disconnected state, latest ping time, repeat failed pings)
-// starts ping on updateIps(...) and repeat ping every 24 hours
+// starts ping on updateIps(...) and repeat ping every 48 hours, or sooner for the noisy nodes
+// The due nodes are pinged in the order of priority under a rate budget: the ones which may be the best location and the stalest ones go first,
+// so after a network change the best location is known within seconds and the rest of the nodes are spread over the next minutes.
 class PingManager : public QObject
 {
     Q_OBJECT
@@ -33,7 +37,10 @@ public:
     void clearIps();
 
     bool isAllNodesHaveCurIteration() const;
-    PingTime getPing(const QString &ip) const;
+    // the nodes without the pings of the current iteration can't beat the best one pinged in it
+    bool isBestNodeKnown() const;
+    PingTime getPing(const QString &ip) const;      // the smoothed RTT
+    PingTime getScore(const QString &ip) const;     // the smoothed RTT with the jitter and loss penalties, to compare the nodes
 
 signals:
     void pingInfoChanged(const QString &ip, int timems);
@@ -41,11 +48,19 @@ signals:
 private slots:
     void onPingTimer();
     void onPingFinished(bool success, int timems, const QString &ip, bool isFromDisconnectedState);
+    void wakeUpSoon();
 
 private:
-    static constexpr int PING_TIMER_INTERVAL = 1000;
+    static constexpr int PING_TIMER_INTERVAL = 1000;    // the shortest wait of the timer, it sleeps until the next due ping otherwise
     static constexpr int MAX_FAILED_PING_IN_ROW = 3;
+    static constexpr int PINGS_PER_ITERATION = 3;         // successful pings of a node per iteration, the timer pings it until they are done
     static constexpr int NEXT_PERIOD_SECS = 2*60*60*24;   //  How many secs to wait until the next ping (48 hours)
+    static constexpr int NOISY_NODE_PERIOD_SECS = 12*60*60;   // the same for the nodes with a high jitter or losses
+    static constexpr int PING_BUDGET_BURST = 20;          // pings which may be started at once, right after a new iteration starts
+    static constexpr int PING_BUDGET_PER_TICK = 4;        // pings added to the budget every PING_TIMER_INTERVAL
+    static constexpr int MAX_PINGS_IN_FLIGHT = 16;
+    static constexpr int NOT_COMPETING_SCORE_RATIO = 2;   // a node this many times slower than the best one needs no more pings in the iteration
+    static constexpr int PING_IN_FLIGHT_TIMEOUT = 6000;   // the pings time out in 2 s, a queued one may wait for another one first; a ping without an answer by then failed
 
     PingMultipleHosts* const pingHosts_;
     IConnectStateController* const connectStateController_;
@@ -54,6 +69,16 @@ private:
     PingStorage pingStorage_;
     FailedPingLogController failedPingLogController_;
     PingLog pingLog_;
+    QElapsedTimer sweepTimer_;      // started when all the nodes are re-pinged, for the sweep duration metric
+    int pingBudget_ = PING_BUDGET_BURST;
+
+    struct PingInFlight
+    {
+        qint64 iterationTime = 0;   // the iteration in which the ping was started
+        qint64 deadline = 0;        // ms since epoch
+    };
+    IpAddressMap<PingInFlight> pingsInFlight_;
+    int bestScoreThisIteration_ = INT_MAX;
 
     struct PingIpState
     {
@@ -61,7 +86,9 @@ private:
         qint64 iterationTime;
         bool latestPingFailed;
         int failedPingsInRow;
+        int pingsThisIteration;
         qint64 nextTimeForFailedPing;
+        qint64 lastPingTime = 0;    // ms since epoch, kept over the iterations
         bool existThisIp;
 
         PingIpState()
@@ -74,6 +101,7 @@ private:
             resetState();
             existThisIp = true;
             iterationTime = iterTime;
+            lastPingTime = iterTime;
             latestPingFailed = isLatestPingFailed;
         }
 
@@ -82,12 +110,18 @@ private:
             iterationTime = 0;
             latestPingFailed = false;
             failedPingsInRow = 0;
+            pingsThisIteration = 0;
             nextTimeForFailedPing = 0;
             existThisIp = false;
         }
     };
 
-    QHash<QString, PingIpState> ips_;
-    QTimer pingTimer_;
+    // the ips are parsed once in updateIps(), the strings are kept in ipInfo for the ping hosts and the logs
+    IpAddressMap<PingIpState> ips_;
+    WheelTimer pingTimer_;
+
+    int pingPriority(const IpAddress &ip, const PingIpState &pni, qint64 now) const;
+    void scheduleNextPing(qint64 now, bool hasWaitingNodes);
+    void sweepExpiredPings(qint64 now);
 };
 
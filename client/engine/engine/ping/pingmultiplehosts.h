@@ -17,8 +17,8 @@ public:
     // connectStateController can be NULL, in this case not used
     explicit PingMultipleHosts(QObject *parent, IConnectStateController *connectStateController, NetworkAccessManager *networkAccessManager);
 
-    // hostname used only for Curl-ping
-    void addHostForPing(const QString &ip, const QString &hostname, PingType pingType);
+    // hostname used only for Curl-ping; virtual, so the tests of the ping scheduling can answer the pings themselves
+    virtual void addHostForPing(const QString &ip, const QString &hostname, PingType pingType);
 
     void setProxySettings(const types::ProxySettings &proxySettings);
     void disableProxy();
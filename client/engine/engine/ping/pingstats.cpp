@@ -0,0 +1,94 @@
+#include "pingstats.h"
+
+#include <limits>
+
+namespace {
+void incSaturated(quint16 &counter)
+{
+    if (counter < std::numeric_limits<quint16>::max())
+        counter++;
+}
+}
+
+void PingStats::addSample(int rttMs)
+{
+    rttMs = qBound(0, rttMs, static_cast<int>(std::numeric_limits<quint16>::max()));
+    if (successCount_ == 0) {
+        rtt_ = rttMs;
+        jitter_ = 0;
+    } else {
+        jitter_ += kJitterGain * (qAbs(rttMs - rtt_) - jitter_);
+        rtt_ += kRttGain * (rttMs - rtt_);
+    }
+    lossRate_ += kLossGain * (0 - lossRate_);
+
+    window_[windowPos_] = static_cast<quint16>(rttMs);
+    windowPos_ = (windowPos_ + 1) % kMinRttWindow;
+    incSaturated(sampleCount_);
+    incSaturated(successCount_);
+    isLatestFailed_ = false;
+}
+
+void PingStats::addLoss()
+{
+    lossRate_ += kLossGain * (1 - lossRate_);
+    incSaturated(sampleCount_);
+    isLatestFailed_ = true;
+}
+
+PingTime PingStats::smoothedRtt() const
+{
+    if (sampleCount_ == 0)
+        return PingTime::NO_PING_INFO;
+    if (isLatestFailed_ || successCount_ == 0)
+        return PingTime::PING_FAILED;
+    return qRound(rtt_);
+}
+
+int PingStats::minRtt() const
+{
+    const int count = qMin<int>(successCount_, kMinRttWindow);
+    if (count == 0)
+        return -1;
+    int minRtt = window_[0];
+    for (int i = 1; i < count; ++i)
+        minRtt = qMin<int>(minRtt, window_[i]);
+    return minRtt;
+}
+
+PingTime PingStats::score() const
+{
+    const PingTime rtt = smoothedRtt();
+    if (rtt.toInt() < 0)
+        return rtt;
+    const double latency = rtt_ + jitter_;
+    const double score = latency + lossRate_ * qMax(0.0, PingTime::MAX_LATENCY_FOR_PING_FAILED - latency);
+    return qMax(1, static_cast<int>(qRound(score)));
+}
+
+QDataStream &operator<<(QDataStream &stream, const PingStats &s)
+{
+    // the averages as fixed point with 8 fractional bits, independent of the floating point precision of the stream
+    stream << static_cast<quint32>(qRound(s.rtt_ * 256)) << static_cast<quint32>(qRound(s.jitter_ * 256))
+           << static_cast<quint16>(qRound(s.lossRate_ * 65535)) << s.sampleCount_ << s.successCount_
+           << static_cast<quint8>(s.isLatestFailed_) << s.windowPos_;
+    for (quint16 rtt : s.window_)
+        stream << rtt;
+    return stream;
+}
+
+QDataStream &operator>>(QDataStream &stream, PingStats &s)
+{
+    quint32 rtt, jitter;
+    quint16 lossRate;
+    quint8 isLatestFailed;
+    stream >> rtt >> jitter >> lossRate >> s.sampleCount_ >> s.successCount_ >> isLatestFailed >> s.windowPos_;
+    for (quint16 &r : s.window_)
+        stream >> r;
+    s.rtt_ = rtt / 256.0f;
+    s.jitter_ = jitter / 256.0f;
+    s.lossRate_ = lossRate / 65535.0f;
+    s.isLatestFailed_ = isLatestFailed != 0;
+    s.windowPos_ %= PingStats::kMinRttWindow;
+    return stream;
+}
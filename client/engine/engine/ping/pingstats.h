@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QDataStream>
+
+#include "types/pingtime.h"
+
+// Latency statistics of a node over several pings, so a single lucky or unlucky probe doesn't decide its place.
+// The RTT and the jitter are exponentially weighted moving averages like the TCP SRTT/RTTVAR (RFC 6298),
+// the loss rate is the same kind of average of 0 (success) and 1 (failure) samples.
+class PingStats
+{
+public:
+    void addSample(int rttMs);
+    void addLoss();
+
+    int sampleCount() const { return sampleCount_; }
+    bool isLatestFailed() const { return isLatestFailed_; }
+
+    // NO_PING_INFO without samples, PING_FAILED if the latest result is a failure or there were no successes
+    PingTime smoothedRtt() const;
+    int minRtt() const;         // over the last kMinRttWindow successful samples, -1 if none
+    int jitter() const { return qRound(jitter_); }
+    double lossRate() const { return lossRate_; }
+
+    // the latency used to compare the nodes: the smoothed RTT with the jitter added and moved towards
+    // the latency of a failed node by the loss rate, or the same special values as smoothedRtt()
+    PingTime score() const;
+
+    static constexpr int kMinRttWindow = 8;
+
+    // a fixed layout of 32 bytes
+    friend QDataStream &operator<<(QDataStream &stream, const PingStats &s);
+    friend QDataStream &operator>>(QDataStream &stream, PingStats &s);
+
+private:
+    static constexpr double kRttGain = 0.25;
+    static constexpr double kJitterGain = 0.25;
+    static constexpr double kLossGain = 0.25;
+
+    float rtt_ = 0;
+    float jitter_ = 0;
+    float lossRate_ = 0;
+    quint16 sampleCount_ = 0;       // saturates
+    quint16 successCount_ = 0;      // saturates
+    bool isLatestFailed_ = false;
+    quint8 windowPos_ = 0;
+    quint16 window_[kMinRttWindow] = {};
+};
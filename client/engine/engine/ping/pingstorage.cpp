@@ -2,8 +2,8 @@
 
 #include <QDataStream>
 #include <QIODevice>
-#include <QSettings>
 
+#include "utils/settingsstore.h"
 #include "utils/simplecrypt.h"
 #include "types/global_consts.h"
 
@@ -19,31 +19,55 @@ PingStorage::~PingStorage()
 
 void PingStorage::setCurrentIterationData(qint64 msecsSinceEpoch, const QString &networkOrSsid)
 {
+    // the latencies measured on another network say nothing about this one, the averages start over
+    if (networkOrSsid != curIterationNetworkOrSsid_) {
+        for (const auto &it : pingDataDB_)
+            it.value().stats_ = PingStats();
+    }
     curIterationTime_ = msecsSinceEpoch;
     curIterationNetworkOrSsid_ = networkOrSsid;
 }
 
-void PingStorage::setPing(const QString &ip, PingTime timeMs)
+void PingStorage::addPing(const IpAddress &ip, PingTime timeMs)
+{
+    PingStats &stats = pingDataDB_[ip].stats_;
+    if (timeMs == PingTime::PING_FAILED)
+        stats.addLoss();
+    else if (timeMs != PingTime::NO_PING_INFO)
+        stats.addSample(timeMs.toInt());
+}
+
+void PingStorage::setIterationDone(const IpAddress &ip)
+{
+    pingDataDB_[ip].iterationTime_ = curIterationTime_;
+}
+
+PingTime PingStorage::getPing(const IpAddress &ip) const
+{
+    return getStats(ip).smoothedRtt();
+}
+
+PingTime PingStorage::getScore(const IpAddress &ip) const
 {
-    pingDataDB_[ip] = PingData{timeMs, curIterationTime_};
+    return getStats(ip).score();
 }
 
-PingTime PingStorage::getPing(const QString &ip) const
+PingStats PingStorage::getStats(const IpAddress &ip) const
 {
-    auto it = pingDataDB_.constFind(ip);
-    if (it != pingDataDB_.constEnd()) {
-        return it.value().timeMs_;
+    const PingData *pingData = pingDataDB_.find(ip);
+    if (pingData) {
+        return pingData->stats_;
     }
 
-    return PingTime::NO_PING_INFO;
+    return PingStats();
 }
 
-void PingStorage::getPingData(const QString &ip, PingTime &outPingTime, qint64 &outIterationTime) const
+void PingStorage::getPingData(const IpAddress &ip, PingTime &outPingTime, qint64 &outIterationTime) const
 {
-    auto it = pingDataDB_.constFind(ip);
-    if (it != pingDataDB_.constEnd()) {
-        outPingTime = it.value().timeMs_;
-        outIterationTime = it.value().iterationTime_;
+    const PingData *pingData = pingDataDB_.find(ip);
+    if (pingData) {
+        outPingTime = pingData->stats_.smoothedRtt();
+        outIterationTime = pingData->iterationTime_;
         return;
     }
 
@@ -51,21 +75,21 @@ void PingStorage::getPingData(const QString &ip, PingTime &outPingTime, qint64 &
     outIterationTime = 0;
 }
 
-void PingStorage::initPingDataIfNotExists(const QString &ip)
+void PingStorage::initPingDataIfNotExists(const IpAddress &ip)
 {
     if (!pingDataDB_.contains(ip))
         pingDataDB_[ip] = PingData();
 }
 
-void PingStorage::removePingNode(const QString &ip)
+void PingStorage::removePingNode(const IpAddress &ip)
 {
     pingDataDB_.remove(ip);
 }
 
 bool PingStorage::isAllNodesHaveCurIteration() const
 {
-    for (const auto &it : pingDataDB_.values())
-        if (it.iterationTime_ != curIterationTime_)
+    for (const auto &it : pingDataDB_)
+        if (it.value().iterationTime_ != curIterationTime_)
             return false;
 
     return true;
@@ -80,15 +104,15 @@ void PingStorage::saveToSettings()
         ds << versionForSerialization_;
         ds << curIterationTime_;
         ds << curIterationNetworkOrSsid_;
-        ds << pingDataDB_.size();
-        for (auto it = pingDataDB_.begin(); it != pingDataDB_.end(); ++it) {
-            ds << it.key() << it.value().timeMs_.toInt() << it.value().iterationTime_;
+        // the ips are kept as strings, so the format doesn't depend on IpAddress
+        ds << static_cast<qsizetype>(pingDataDB_.size());
+        for (const auto &it : pingDataDB_) {
+            ds << it.key().toString() << it.value().stats_ << it.value().iterationTime_;
         }
     }
 
-    QSettings settings;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    settings.setValue(settingsKey_, simpleCrypt.encryptToString(arr));
+    SettingsStore::instance().setValue(settingsKey_, simpleCrypt.encryptToString(arr));
 }
 
 void PingStorage::loadFromSettings()
@@ -96,7 +120,7 @@ void PingStorage::loadFromSettings()
     curIterationNetworkOrSsid_.clear();
     pingDataDB_.clear();
 
-    QSettings settings;
+    SettingsStore &settings = SettingsStore::instance();
     if (!settings.contains(settingsKey_)) {
         return;
     }
@@ -113,7 +137,8 @@ void PingStorage::loadFromSettings()
         quint32 version;
         ds >> version;
 
-        if (version != versionForSerialization_)
+        // version 3 kept a single ping time, it becomes the first sample
+        if (version != versionForSerialization_ && version != 3)
             return;
 
         ds >> curIterationTime_;
@@ -123,15 +148,23 @@ void PingStorage::loadFromSettings()
         ds >> numDBElements;
         for (qsizetype i = 0; i < numDBElements; ++i) {
             QString ip;
-            int timeMs;
-            qint64 iterationTime;
-            ds >> ip >> timeMs >> iterationTime;
-
             PingData pingData;
-            pingData.timeMs_ = timeMs;
-            pingData.iterationTime_ = iterationTime;
-
-            pingDataDB_[ip] = pingData;
+            ds >> ip;
+            if (version == 3) {
+                int timeMs;
+                ds >> timeMs;
+                if (timeMs == PingTime::PING_FAILED)
+                    pingData.stats_.addLoss();
+                else if (timeMs >= 0)
+                    pingData.stats_.addSample(timeMs);
+            } else {
+                ds >> pingData.stats_;
+            }
+            ds >> pingData.iterationTime_;
+
+            const IpAddress address = IpAddress::fromString(ip);
+            if (address.isValid())
+                pingDataDB_[address] = pingData;
         }
 
         if (ds.status() != QDataStream::Ok) {
@@ -1,7 +1,7 @@
 #pragma once
 
-#include <QHash>
-
+#include "engine/utils/ipaddressmap.h"
+#include "pingstats.h"
 #include "types/pingtime.h"
 
 // IP ping storage that saves state between program launches
@@ -14,21 +14,27 @@ public:
     qint64 currentIterationTime() const { return curIterationTime_; }
     QString currentIterationNetworkOrSsid() const { return curIterationNetworkOrSsid_; }
 
+    // starts a new iteration, the statistics are cleared if the network has changed
     void setCurrentIterationData(qint64 msecsSinceEpoch, const QString &networkOrSsid);
 
-    void setPing(const QString &ip, PingTime timeMs);
-    PingTime getPing(const QString &ip) const;
-    void getPingData(const QString &ip, PingTime &outPingTime, qint64 &outIterationTime) const;
-    void initPingDataIfNotExists(const QString &ip);
+    // adds a sample to the statistics of the ip, PING_FAILED is a loss
+    void addPing(const IpAddress &ip, PingTime timeMs);
+    // the ip has all the pings of the current iteration
+    void setIterationDone(const IpAddress &ip);
+    PingTime getPing(const IpAddress &ip) const;      // the smoothed RTT
+    PingTime getScore(const IpAddress &ip) const;     // see PingStats::score()
+    PingStats getStats(const IpAddress &ip) const;
+    void getPingData(const IpAddress &ip, PingTime &outPingTime, qint64 &outIterationTime) const;
+    void initPingDataIfNotExists(const IpAddress &ip);
 
 
-    void removePingNode(const QString &ip);
+    void removePingNode(const IpAddress &ip);
     bool isAllNodesHaveCurIteration() const;
 
 private:
     struct PingData
     {
-        PingTime timeMs_;
+        PingStats stats_;
         qint64 iterationTime_ = 0;
     };
 
@@ -37,10 +43,10 @@ private:
     QString curIterationNetworkOrSsid_;     // the name of the network to which the pings were made
 
     // Maps the ip to its ping data.
-    QHash<QString, PingData> pingDataDB_;
+    IpAddressMap<PingData> pingDataDB_;
 
     static constexpr quint32 magic_ = 0x734AB2AE;
-    static constexpr int versionForSerialization_ = 3;  // should increment the version if the data format is changed
+    static constexpr int versionForSerialization_ = 4;  // should increment the version if the data format is changed
 
     void saveToSettings();
     void loadFromSettings();
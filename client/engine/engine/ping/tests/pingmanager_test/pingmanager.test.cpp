@@ -0,0 +1,316 @@
+#include <QtTest>
+#include <QDateTime>
+#include "engine/connectstatecontroller/iconnectstatecontroller.h"
+#include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
+#include "engine/ping/pingmanager.h"
+#include "engine/ping/pingmultiplehosts.h"
+#include "engine/utils/timerwheel.h"
+#include "utils/settingsstore.h"
+
+static IpAddress ipAddress(const char *str)
+{
+    return IpAddress::fromString(QString::fromLatin1(str));
+}
+
+class ConnectStateController_moc : public IConnectStateController
+{
+    Q_OBJECT
+public:
+    explicit ConnectStateController_moc(QObject *parent) : IConnectStateController(parent) {}
+
+    CONNECT_STATE currentState() override { return CONNECT_STATE_DISCONNECTED; }
+    CONNECT_STATE prevState() override { return CONNECT_STATE_DISCONNECTED; }
+    DISCONNECT_REASON disconnectReason() override { return DISCONNECTED_ITSELF; }
+    CONNECT_ERROR connectionError() override { return NO_CONNECT_ERROR; }
+    const LocationID &locationId() override { return locationId_; }
+
+private:
+    LocationID locationId_;
+};
+
+class NetworkDetectionManager_moc : public INetworkDetectionManager
+{
+    Q_OBJECT
+public:
+    explicit NetworkDetectionManager_moc(QObject *parent) : INetworkDetectionManager(parent) {}
+
+    void getCurrentNetworkInterface(types::NetworkInterface &networkInterface) override { networkInterface.networkOrSsid = networkOrSsid_; }
+    bool isOnline() override { return true; }
+
+    void setNetworkOrSsid(const QString &networkOrSsid) { networkOrSsid_ = networkOrSsid; }
+
+private:
+    QString networkOrSsid_ = "network1";
+};
+
+// Records the started pings, the test answers them with the pingFinished signal
+class PingMultipleHosts_moc : public PingMultipleHosts
+{
+    Q_OBJECT
+public:
+    explicit PingMultipleHosts_moc(QObject *parent) : PingMultipleHosts(parent, nullptr, nullptr) {}
+
+    void addHostForPing(const QString &ip, const QString &hostname, PingType pingType) override
+    {
+        Q_UNUSED(hostname);
+        Q_UNUSED(pingType);
+        started_ << ip;
+    }
+
+    QStringList takeStarted()
+    {
+        QStringList started = started_;
+        started_.clear();
+        return started;
+    }
+
+    void answer(const QString &ip, int timeMs)
+    {
+        emit pingFinished(true, timeMs, ip, true);
+    }
+
+private:
+    QStringList started_;
+};
+
+// The scheduling of PingManager, the numbers follow its private constants:
+// a burst of 20 pings, 4 more every tick, 16 pings in flight at most, 3 pings of a node per iteration,
+// a ping without an answer in 6 s failed, the timer sleeps until the next due ping.
+class TestPingManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void cleanupTestCase();
+
+    void testBudgetAndInFlightCap();
+    void testNonCompetingNodeSkipped();
+    void testNoisyNodeRefreshed();
+    void testNetworkChangeUsesCurrentSamples();
+    void testLateAnswerAfterNetworkChange();
+    void testUnansweredPingExpires();
+    void testTimerSleepsUntilNextDuePing();
+
+private:
+    static constexpr const char *kSettingsKey = "pingManagerTest";
+
+    ConnectStateController_moc *connectStateController_;
+    NetworkDetectionManager_moc *networkDetectionManager_;
+    PingMultipleHosts_moc *pingHosts_;
+
+    static QVector<PingIpInfo> makeIps(const QStringList &ips);
+    static void tick(PingManager *pingManager);
+};
+
+void TestPingManager::initTestCase()
+{
+    // the settings of the test are not mixed with the ones of the app
+    QCoreApplication::setOrganizationName("WindscribeTest");
+    QCoreApplication::setApplicationName("pingmanager.test");
+}
+
+void TestPingManager::init()
+{
+    connectStateController_ = new ConnectStateController_moc(this);
+    networkDetectionManager_ = new NetworkDetectionManager_moc(this);
+    pingHosts_ = new PingMultipleHosts_moc(this);
+}
+
+void TestPingManager::cleanup()
+{
+    delete pingHosts_;
+    delete networkDetectionManager_;
+    delete connectStateController_;
+    SettingsStore::instance().remove(kSettingsKey);
+}
+
+void TestPingManager::cleanupTestCase()
+{
+    SettingsStore::instance().flush();
+}
+
+QVector<PingIpInfo> TestPingManager::makeIps(const QStringList &ips)
+{
+    QVector<PingIpInfo> result;
+    for (const QString &ip : ips) {
+        PingIpInfo info;
+        info.ip = ip;
+        info.pingType = PingType::kTcp;
+        result << info;
+    }
+    return result;
+}
+
+void TestPingManager::tick(PingManager *pingManager)
+{
+    QVERIFY(QMetaObject::invokeMethod(pingManager, "onPingTimer"));
+}
+
+void TestPingManager::testBudgetAndInFlightCap()
+{
+    QStringList ips;
+    for (int i = 0; i < 40; ++i)
+        ips << QString("10.0.0.%1").arg(i + 1);
+
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(ips));
+
+    // the burst is cut by the in-flight cap
+    const QStringList first = pingHosts_->takeStarted();
+    QCOMPARE(first.size(), 16);
+
+    // nothing is started while all of them are in flight
+    tick(&pingManager);
+    QVERIFY(pingHosts_->takeStarted().isEmpty());
+
+    for (const QString &ip : first)
+        pingHosts_->answer(ip, 50);
+
+    // the rest of the burst and two ticks of the budget, the nodes without pings go first
+    tick(&pingManager);
+    const QStringList second = pingHosts_->takeStarted();
+    QCOMPARE(second.size(), 12);
+    for (const QString &ip : second)
+        QVERIFY(!first.contains(ip));
+}
+
+void TestPingManager::testNonCompetingNodeSkipped()
+{
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(QStringList() << "10.0.0.1" << "10.0.0.2" << "10.0.0.3"));
+    QCOMPARE(pingHosts_->takeStarted().size(), 3);
+
+    pingHosts_->answer("10.0.0.1", 20);
+    pingHosts_->answer("10.0.0.2", 100);    // more than twice as slow as the best one
+    pingHosts_->answer("10.0.0.3", 30);
+
+    tick(&pingManager);
+    QStringList started = pingHosts_->takeStarted();
+    started.sort();
+    QCOMPARE(started, QStringList() << "10.0.0.1" << "10.0.0.3");
+}
+
+void TestPingManager::testNoisyNodeRefreshed()
+{
+    // both nodes were pinged in the current iteration a day ago, on the same network
+    const qint64 dayAgo = QDateTime::currentMSecsSinceEpoch() - 24 * 60 * 60 * 1000LL;
+    {
+        PingStorage storage(kSettingsKey);
+        storage.setCurrentIterationData(dayAgo, "network1");
+        storage.addPing(ipAddress("10.0.0.1"), 50);
+        storage.addPing(ipAddress("10.0.0.1"), 50);
+        storage.addPing(ipAddress("10.0.0.2"), 20);
+        storage.addPing(ipAddress("10.0.0.2"), 200);
+        storage.setIterationDone(ipAddress("10.0.0.1"));
+        storage.setIterationDone(ipAddress("10.0.0.2"));
+    }
+
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(QStringList() << "10.0.0.1" << "10.0.0.2"));
+
+    // only the node with the high jitter is pinged before the next iteration
+    QCOMPARE(pingHosts_->takeStarted(), QStringList() << "10.0.0.2");
+}
+
+void TestPingManager::testNetworkChangeUsesCurrentSamples()
+{
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(QStringList() << "10.0.0.1" << "10.0.0.2"));
+    QCOMPARE(pingHosts_->takeStarted().size(), 2);
+
+    // the first node is fast and gets all its pings, the second one is slow on this network
+    pingHosts_->answer("10.0.0.1", 20);
+    pingHosts_->answer("10.0.0.2", 500);
+    for (int i = 1; i < 3; ++i) {
+        tick(&pingManager);
+        QCOMPARE(pingHosts_->takeStarted(), QStringList() << "10.0.0.1");
+        pingHosts_->answer("10.0.0.1", 20);
+    }
+    QVERIFY(pingManager.isAllNodesHaveCurIteration());
+    QVERIFY(pingManager.isBestNodeKnown());
+
+    // on another network the first node is slow, the second one may be fast now
+    networkDetectionManager_->setNetworkOrSsid("network2");
+    tick(&pingManager);
+    QCOMPARE(pingHosts_->takeStarted().size(), 2);
+    QCOMPARE(pingManager.getPing("10.0.0.2"), PingTime(PingTime::NO_PING_INFO));
+    pingHosts_->answer("10.0.0.1", 200);
+    QCOMPARE(pingManager.getPing("10.0.0.1").toInt(), 200);
+
+    // the 500 ms of the previous network doesn't rule the second node out
+    QVERIFY(!pingManager.isBestNodeKnown());
+    pingHosts_->answer("10.0.0.2", 30);
+    QCOMPARE(pingManager.getPing("10.0.0.2").toInt(), 30);
+}
+
+void TestPingManager::testLateAnswerAfterNetworkChange()
+{
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(QStringList() << "10.0.0.1"));
+    QCOMPARE(pingHosts_->takeStarted().size(), 1);
+
+    // the network changes while the ping is in flight, it is not started twice
+    networkDetectionManager_->setNetworkOrSsid("network2");
+    tick(&pingManager);
+    QVERIFY(pingHosts_->takeStarted().isEmpty());
+
+    // the answer measured on the previous network is discarded and the node is pinged again
+    pingHosts_->answer("10.0.0.1", 30);
+    QCOMPARE(pingManager.getPing("10.0.0.1"), PingTime(PingTime::NO_PING_INFO));
+    tick(&pingManager);
+    QCOMPARE(pingHosts_->takeStarted(), QStringList() << "10.0.0.1");
+}
+
+void TestPingManager::testUnansweredPingExpires()
+{
+    QStringList ips;
+    for (int i = 0; i < 20; ++i)
+        ips << QString("10.0.0.%1").arg(i + 1);
+
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(ips));
+    const QStringList first = pingHosts_->takeStarted();
+    QCOMPARE(first.size(), 16);
+
+    // none of the hosts answers, the in-flight slots are freed after the timeout
+    tick(&pingManager);
+    QVERIFY(pingHosts_->takeStarted().isEmpty());
+    QTest::qWait(6500);
+    tick(&pingManager);
+    const QStringList second = pingHosts_->takeStarted();
+    QCOMPARE(second.size(), 12);
+
+    // the late answer of an expired ping which is not started again is discarded
+    for (const QString &ip : first) {
+        if (!second.contains(ip)) {
+            pingHosts_->answer(ip, 30);
+            QCOMPARE(pingManager.getPing(ip), PingTime(PingTime::NO_PING_INFO));
+            break;
+        }
+    }
+}
+
+void TestPingManager::testTimerSleepsUntilNextDuePing()
+{
+    PingManager pingManager(this, connectStateController_, networkDetectionManager_, pingHosts_, kSettingsKey, "ping_log_test.txt");
+    pingManager.updateIps(makeIps(QStringList() << "10.0.0.1"));
+    for (int i = 0; i < 3; ++i) {
+        QCOMPARE(pingHosts_->takeStarted(), QStringList() << "10.0.0.1");
+        // the ping in flight wakes the timer up at its timeout at the latest
+        const qint64 wakeup = TimerWheel::instance()->nextWakeup() - TimerWheel::instance()->now();
+        QVERIFY(wakeup >= 0 && wakeup <= 6500);
+        pingHosts_->answer("10.0.0.1", 20);
+        tick(&pingManager);
+    }
+    QVERIFY(pingManager.isAllNodesHaveCurIteration());
+    QVERIFY(pingHosts_->takeStarted().isEmpty());
+
+    // nothing is due until the next iteration, the timer doesn't tick every second
+    QVERIFY(TimerWheel::instance()->nextWakeup() - TimerWheel::instance()->now() > 60 * 60 * 1000);
+}
+
+QTEST_MAIN(TestPingManager)
+#include "pingmanager.test.moc"
@@ -0,0 +1,127 @@
+#include <QtTest>
+#include <QDataStream>
+#include "engine/ping/pingstats.h"
+
+class TestPingStats : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testEmpty();
+    void testSmoothing();
+    void testMinRttWindow();
+    void testLoss();
+    void testScore();
+    void testSerialization();
+};
+
+void TestPingStats::testEmpty()
+{
+    PingStats stats;
+    QCOMPARE(stats.sampleCount(), 0);
+    QCOMPARE(stats.smoothedRtt(), PingTime(PingTime::NO_PING_INFO));
+    QCOMPARE(stats.score(), PingTime(PingTime::NO_PING_INFO));
+    QCOMPARE(stats.minRtt(), -1);
+}
+
+void TestPingStats::testSmoothing()
+{
+    PingStats stats;
+    stats.addSample(100);
+    QCOMPARE(stats.smoothedRtt().toInt(), 100);
+    QCOMPARE(stats.jitter(), 0);
+
+    // one outlier moves the average by a quarter of the difference only
+    stats.addSample(500);
+    QCOMPARE(stats.smoothedRtt().toInt(), 200);
+    QCOMPARE(stats.jitter(), 100);
+
+    for (int i = 0; i < 50; ++i)
+        stats.addSample(100);
+    QCOMPARE(stats.smoothedRtt().toInt(), 100);
+    QCOMPARE(stats.jitter(), 0);
+    QCOMPARE(stats.sampleCount(), 52);
+}
+
+void TestPingStats::testMinRttWindow()
+{
+    PingStats stats;
+    stats.addSample(50);
+    stats.addSample(80);
+    QCOMPARE(stats.minRtt(), 50);
+    for (int i = 0; i < PingStats::kMinRttWindow - 1; ++i)
+        stats.addSample(90 + i);
+    // 50 is out of the window
+    QCOMPARE(stats.minRtt(), 80);
+}
+
+void TestPingStats::testLoss()
+{
+    PingStats stats;
+    stats.addLoss();
+    QCOMPARE(stats.smoothedRtt(), PingTime(PingTime::PING_FAILED));
+    QVERIFY(stats.isLatestFailed());
+
+    stats.addSample(100);
+    QCOMPARE(stats.smoothedRtt().toInt(), 100);
+    QVERIFY(!stats.isLatestFailed());
+    QVERIFY(stats.lossRate() > 0 && stats.lossRate() < 1);
+
+    stats.addLoss();
+    QCOMPARE(stats.smoothedRtt(), PingTime(PingTime::PING_FAILED));
+    QCOMPARE(stats.score(), PingTime(PingTime::PING_FAILED));
+}
+
+void TestPingStats::testScore()
+{
+    // a stable node beats a node with the same average but jitter, and a node with losses
+    PingStats stable, jittery, lossy;
+    for (int i = 0; i < 10; ++i)
+    {
+        stable.addSample(100);
+        jittery.addSample(i % 2 ? 50 : 150);
+        lossy.addSample(100);
+    }
+    lossy.addLoss();
+    lossy.addSample(100);
+
+    QCOMPARE(stable.score().toInt(), 100);
+    QVERIFY(jittery.score().toInt() > stable.score().toInt());
+    QVERIFY(lossy.score().toInt() > stable.score().toInt());
+    QVERIFY(lossy.score().toInt() < PingTime::MAX_LATENCY_FOR_PING_FAILED);
+}
+
+void TestPingStats::testSerialization()
+{
+    PingStats stats;
+    for (int i = 0; i < 12; ++i)
+        stats.addSample(40 + i * 7);
+    stats.addLoss();
+    stats.addSample(61);
+
+    QByteArray arr;
+    {
+        QDataStream ds(&arr, QIODevice::WriteOnly);
+        ds << stats;
+    }
+    QCOMPARE(arr.size(), 32);
+
+    PingStats loaded;
+    QDataStream ds(&arr, QIODevice::ReadOnly);
+    ds >> loaded;
+    QCOMPARE(ds.status(), QDataStream::Ok);
+    QCOMPARE(loaded.sampleCount(), stats.sampleCount());
+    QCOMPARE(loaded.smoothedRtt(), stats.smoothedRtt());
+    QCOMPARE(loaded.score(), stats.score());
+    QCOMPARE(loaded.minRtt(), stats.minRtt());
+    QCOMPARE(loaded.jitter(), stats.jitter());
+    QVERIFY(qAbs(loaded.lossRate() - stats.lossRate()) < 0.001);
+
+    // the window continues where it was
+    loaded.addSample(10);
+    stats.addSample(10);
+    QCOMPARE(loaded.minRtt(), stats.minRtt());
+}
+
+QTEST_MAIN(TestPingStats)
+#include "pingstats.test.moc"
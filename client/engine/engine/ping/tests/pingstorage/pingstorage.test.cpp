@@ -0,0 +1,110 @@
+#include <QtTest>
+#include <QDataStream>
+#include "engine/ping/pingstorage.h"
+#include "types/global_consts.h"
+#include "utils/settingsstore.h"
+#include "utils/simplecrypt.h"
+
+static IpAddress ipAddress(const char *str)
+{
+    return IpAddress::fromString(QString::fromLatin1(str));
+}
+
+class TestPingStorage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanup();
+    void cleanupTestCase();
+
+    void testMigrationFromVersion3();
+    void testNetworkChangeClearsStats();
+
+private:
+    static constexpr const char *kSettingsKey = "pingStorageTest";
+};
+
+void TestPingStorage::initTestCase()
+{
+    // the settings of the test are not mixed with the ones of the app
+    QCoreApplication::setOrganizationName("WindscribeTest");
+    QCoreApplication::setApplicationName("pingstorage.test");
+}
+
+void TestPingStorage::cleanup()
+{
+    SettingsStore::instance().remove(kSettingsKey);
+}
+
+void TestPingStorage::cleanupTestCase()
+{
+    SettingsStore::instance().flush();
+}
+
+void TestPingStorage::testMigrationFromVersion3()
+{
+    const qint64 iterationTime = 1700000000000;
+
+    // the format of version 3: a single ping time per ip
+    QByteArray arr;
+    {
+        QDataStream ds(&arr, QIODevice::WriteOnly);
+        ds << (quint32)0x734AB2AE << (quint32)3 << iterationTime << QString("network");
+        ds << (qsizetype)3;
+        ds << QString("1.1.1.1") << 50 << iterationTime;
+        ds << QString("2.2.2.2") << (int)PingTime::PING_FAILED << iterationTime;
+        ds << QString("3.3.3.3") << (int)PingTime::NO_PING_INFO << (qint64)0;
+    }
+    SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
+    SettingsStore::instance().setValue(kSettingsKey, simpleCrypt.encryptToString(arr));
+
+    {
+        PingStorage storage(kSettingsKey);
+        QCOMPARE(storage.currentIterationTime(), iterationTime);
+        QCOMPARE(storage.currentIterationNetworkOrSsid(), QString("network"));
+        QCOMPARE(storage.getPing(ipAddress("1.1.1.1")).toInt(), 50);
+        QCOMPARE(storage.getStats(ipAddress("1.1.1.1")).sampleCount(), 1);
+        QCOMPARE(storage.getPing(ipAddress("2.2.2.2")), PingTime(PingTime::PING_FAILED));
+        QCOMPARE(storage.getPing(ipAddress("3.3.3.3")), PingTime(PingTime::NO_PING_INFO));
+        QVERIFY(!storage.isAllNodesHaveCurIteration());
+        // saved in the current version on destruction
+    }
+
+    PingStorage storage(kSettingsKey);
+    QCOMPARE(storage.currentIterationTime(), iterationTime);
+    QCOMPARE(storage.getPing(ipAddress("1.1.1.1")).toInt(), 50);
+    QCOMPARE(storage.getPing(ipAddress("2.2.2.2")), PingTime(PingTime::PING_FAILED));
+    QCOMPARE(storage.getPing(ipAddress("3.3.3.3")), PingTime(PingTime::NO_PING_INFO));
+
+    PingTime pingTime;
+    qint64 outIterationTime;
+    storage.getPingData(ipAddress("3.3.3.3"), pingTime, outIterationTime);
+    QCOMPARE(outIterationTime, (qint64)0);
+}
+
+void TestPingStorage::testNetworkChangeClearsStats()
+{
+    PingStorage storage(kSettingsKey);
+    storage.setCurrentIterationData(1000, "network1");
+    storage.addPing(ipAddress("1.1.1.1"), 100);
+    storage.addPing(ipAddress("1.1.1.1"), 100);
+    storage.setIterationDone(ipAddress("1.1.1.1"));
+
+    // a new iteration on the same network keeps averaging
+    storage.setCurrentIterationData(2000, "network1");
+    storage.addPing(ipAddress("1.1.1.1"), 500);
+    QCOMPARE(storage.getPing(ipAddress("1.1.1.1")).toInt(), 200);
+
+    // on another network the samples start over
+    storage.setCurrentIterationData(3000, "network2");
+    QCOMPARE(storage.getPing(ipAddress("1.1.1.1")), PingTime(PingTime::NO_PING_INFO));
+    QCOMPARE(storage.getStats(ipAddress("1.1.1.1")).sampleCount(), 0);
+    storage.addPing(ipAddress("1.1.1.1"), 30);
+    QCOMPARE(storage.getPing(ipAddress("1.1.1.1")).toInt(), 30);
+    QCOMPARE(storage.getStats(ipAddress("1.1.1.1")).sampleCount(), 1);
+}
+
+QTEST_MAIN(TestPingStorage)
+#include "pingstorage.test.moc"
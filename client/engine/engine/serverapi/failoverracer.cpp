@@ -0,0 +1,163 @@
+#include "failoverracer.h"
+
+#include <algorithm>
+
+#include "utils/logger.h"
+#include "utils/ws_assert.h"
+
+namespace server_api {
+
+FailoverRacer::FailoverRacer(QObject *parent, IConnectStateController *connectStateController, NetworkAccessManager *networkAccessManager,
+                             failover::IFailoverContainer *failoverContainer, int staggerMs) : QObject(parent),
+    connectStateController_(connectStateController), networkAccessManager_(networkAccessManager), failoverContainer_(failoverContainer),
+    staggerMs_(staggerMs), bIgnoreSslErrors_(false), isPreferredTaken_(false), isContainerStarted_(false), isExhausted_(false), isFinished_(false)
+{
+    staggerTimer_.setSingleShot(true);
+    connect(&staggerTimer_, &QTimer::timeout, this, &FailoverRacer::onStaggerTimer);
+}
+
+FailoverRacer::~FailoverRacer()
+{
+    cancelAll();
+}
+
+void FailoverRacer::execute(QPointer<BaseRequest> request, const QString &preferredFailoverId, bool bIgnoreSslErrors)
+{
+    WS_ASSERT(request_ == nullptr);
+    request_ = request;
+    preferredFailoverId_ = preferredFailoverId;
+    bIgnoreSslErrors_ = bIgnoreSslErrors;
+    staggerTimer_.start(0);
+}
+
+failover::FailoverData FailoverRacer::failoverData() const
+{
+    WS_ASSERT(!winnerFailoverData_.isNull());
+    return *winnerFailoverData_;
+}
+
+void FailoverRacer::onStaggerTimer()
+{
+    if (candidates_.size() < kMaxParallel && startNextCandidate()) {
+        // the candidate could fail or finish immediately, then the timer is already restarted or the race is over
+        if (!isFinished_ && !isExhausted_ && !staggerTimer_.isActive())
+            staggerTimer_.start(staggerMs_);
+        return;
+    }
+
+    if (candidates_.isEmpty()) {
+        // all the candidates have failed
+        finish(RequestExecuterRetCode::kFailoverFailed);
+    } else if (!isExhausted_) {
+        // the maximum number of candidates are running, try again on the next failure or after the stagger
+        staggerTimer_.start(staggerMs_);
+    }
+}
+
+void FailoverRacer::onExecuterFinished(RequestExecuterRetCode retCode)
+{
+    RequestExecuterViaFailover *executer = static_cast<RequestExecuterViaFailover *>(sender());
+    auto it = std::find_if(candidates_.begin(), candidates_.end(), [executer](const Candidate &c) { return c.executer == executer; });
+    if (it == candidates_.end())
+        return;
+
+    // the replies are handled one at a time and only until one of them is correct, the rest are never handled
+    if (retCode == RequestExecuterRetCode::kSuccess && !executer->handleResponse()) {
+        // an incorrect response, the candidate goes on with the next domain of its failover or finishes with a failure
+        return;
+    }
+
+    // the executer is in the call stack, so it can't be deleted right now
+    const Candidate candidate = *it;
+    candidates_.erase(it);
+    candidate.executer->disconnect(this);
+    candidate.executer->deleteLater();
+
+    if (retCode == RequestExecuterRetCode::kFailoverFailed) {
+        qCDebug(LOG_FAILOVER) << "Failed:" << candidate.failover->name();
+        // start the next candidate without waiting for the stagger
+        staggerTimer_.start(0);
+        return;
+    }
+
+    if (retCode == RequestExecuterRetCode::kSuccess) {
+        qCDebug(LOG_FAILOVER) << "Won:" << candidate.failover->name();
+        winnerFailoverData_.reset(new failover::FailoverData(candidate.executer->failoverData()));
+        winnerFailoverId_ = candidate.failover->uniqueId();
+        // the next failover run goes on from the winner, not from the last candidate started
+        failoverContainer_->gotoFailover(winnerFailoverId_);
+    }
+    // the losers still running are cancelled before their replies are handled
+    finish(retCode);
+}
+
+bool FailoverRacer::startNextCandidate()
+{
+    if (isExhausted_)
+        return false;
+
+    int ind = -1;
+    QSharedPointer<failover::BaseFailover> failover = nextFailover(ind);
+    if (!failover) {
+        isExhausted_ = true;
+        return false;
+    }
+
+    qCDebug(LOG_FAILOVER) << "Trying:" << failover->name();
+    // Do not emit this signal for the first failover and for the remembered failover
+    if (ind > 0)
+        emit tryingBackupEndpoint(ind, failoverContainer_->count() - 1);
+
+    RequestExecuterViaFailover *executer = new RequestExecuterViaFailover(this, connectStateController_, networkAccessManager_);
+    executer->setDeferredHandling(true);
+    connect(executer, &RequestExecuterViaFailover::finished, this, &FailoverRacer::onExecuterFinished);
+    candidates_ << Candidate { executer, failover };
+    executer->execute(request_, failover, bIgnoreSslErrors_);
+    return true;
+}
+
+QSharedPointer<failover::BaseFailover> FailoverRacer::nextFailover(int &outInd)
+{
+    if (!isPreferredTaken_) {
+        isPreferredTaken_ = true;
+        if (!preferredFailoverId_.isEmpty()) {
+            QSharedPointer<failover::BaseFailover> failover = failoverContainer_->failoverById(preferredFailoverId_);
+            if (failover) {
+                outInd = -1;
+                return failover;
+            }
+        }
+    }
+
+    while (true) {
+        if (!isContainerStarted_) {
+            isContainerStarted_ = true;
+        } else if (!failoverContainer_->gotoNext()) {
+            return nullptr;
+        }
+        QSharedPointer<failover::BaseFailover> failover = failoverContainer_->currentFailover(&outInd);
+        // the remembered failover has already been tried
+        if (failover && failover->uniqueId() != preferredFailoverId_)
+            return failover;
+    }
+}
+
+void FailoverRacer::finish(RequestExecuterRetCode retCode)
+{
+    isFinished_ = true;
+    cancelAll();
+    emit finished(retCode);
+}
+
+void FailoverRacer::cancelAll()
+{
+    staggerTimer_.stop();
+    // deleting an executer aborts its network request
+    for (const Candidate &candidate : qAsConst(candidates_)) {
+        candidate.executer->disconnect(this);
+        delete candidate.executer;
+    }
+    candidates_.clear();
+}
+
+} // namespace server_api
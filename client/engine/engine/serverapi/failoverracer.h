@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+
+#include "engine/failover/ifailovercontainer.h"
+#include "requestexecuterviafailover.h"
+
+namespace server_api {
+
+// Helper class used by ServerAPI.
+// Executes a request through several failovers in parallel ("happy eyeballs") instead of waiting for the timeout of each of them.
+// The next candidate is started after a short stagger, or immediately if a running one has failed. The first successful candidate wins,
+// the others are cancelled without handling their replies. The candidates are the failover that won last time on the current network (if any),
+// then the failovers of the container starting from its current position.
+class FailoverRacer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FailoverRacer(QObject *parent, IConnectStateController *connectStateController, NetworkAccessManager *networkAccessManager,
+                           failover::IFailoverContainer *failoverContainer, int staggerMs = kDefaultStaggerMs);
+    ~FailoverRacer();
+
+    void execute(QPointer<BaseRequest> request, const QString &preferredFailoverId, bool bIgnoreSslErrors);
+    QPointer<BaseRequest> request() { return request_; }
+
+    // valid after the successful finish
+    failover::FailoverData failoverData() const;
+    QString failoverUniqueId() const { return winnerFailoverId_; }
+
+    static constexpr int kDefaultStaggerMs = 2000;
+    static constexpr int kMaxParallel = 3;
+
+signals:
+    void finished(server_api::RequestExecuterRetCode retCode);
+    void tryingBackupEndpoint(int num, int cnt);
+
+private slots:
+    void onStaggerTimer();
+    void onExecuterFinished(server_api::RequestExecuterRetCode retCode);
+
+private:
+    struct Candidate
+    {
+        RequestExecuterViaFailover *executer;
+        QSharedPointer<failover::BaseFailover> failover;
+    };
+
+    IConnectStateController *connectStateController_;
+    NetworkAccessManager *networkAccessManager_;
+    failover::IFailoverContainer *failoverContainer_;
+    int staggerMs_;
+
+    QPointer<BaseRequest> request_;
+    QString preferredFailoverId_;
+    bool bIgnoreSslErrors_;
+
+    QTimer staggerTimer_;
+    QVector<Candidate> candidates_;     // running candidates
+    bool isPreferredTaken_;
+    bool isContainerStarted_;
+    bool isExhausted_;
+    bool isFinished_;
+
+    QScopedPointer<failover::FailoverData> winnerFailoverData_;
+    QString winnerFailoverId_;
+
+    bool startNextCandidate();
+    QSharedPointer<failover::BaseFailover> nextFailover(int &outInd);
+    void finish(RequestExecuterRetCode retCode);
+    void cancelAll();
+};
+
+} // namespace server_api
@@ -17,6 +17,13 @@ RequestExecuterViaFailover::RequestExecuterViaFailover(QObject *parent, IConnect
 {
 }
 
+RequestExecuterViaFailover::~RequestExecuterViaFailover()
+{
+    // abort the request in progress if the executer is cancelled
+    if (reply_)
+        reply_->deleteLater();
+}
+
 void RequestExecuterViaFailover::execute(QPointer<BaseRequest> request, QSharedPointer<failover::BaseFailover> failover, bool bIgnoreSslErrors)
 {
     WS_ASSERT(request_ == nullptr);
@@ -77,34 +84,48 @@ void RequestExecuterViaFailover::onNetworkRequestFinished()
     }
 
     if (!reply->isSuccess()) {
-        // failover can contain several domains, let's try another one if there is one
-        curIndFailoverData_++;
-        if (curIndFailoverData_ >= failoverData_.count())
-            emit finished(RequestExecuterRetCode::kFailoverFailed);
-        else
-            executeBaseRequest(failoverData_[curIndFailoverData_]);
+        executeNextDomain();
         return;
     }
 
-    QByteArray serverResponse = reply->readAll();
+    response_ = reply->readAll();
     if (ExtraConfig::instance().getLogAPIResponse()) {
         qCDebug(LOG_SERVER_API) << request_->name();
-        qCDebugMultiline(LOG_SERVER_API) << serverResponse;
+        qCDebugMultiline(LOG_SERVER_API) << response_;
     }
 
-    request_->handle(serverResponse);
+    if (isDeferredHandling_) {
+        emit finished(RequestExecuterRetCode::kSuccess);
+        return;
+    }
+    if (handleResponse())
+        emit finished(RequestExecuterRetCode::kSuccess);
+}
+
+bool RequestExecuterViaFailover::handleResponse()
+{
+    // the response is not streamed into the request, it's handled as a whole
+    if (request_->isStreaming())
+        request_->resetStreaming();
+    request_->setNetworkRetCode(SERVER_RETURN_SUCCESS);
+    request_->handle(response_);
+    response_.clear();
 
     if (request_->networkRetCode() == SERVER_RETURN_INCORRECT_JSON) {
-        // failover can contain several domains, let's try another one if there is one
-        curIndFailoverData_++;
-        if (curIndFailoverData_ >= failoverData_.count())
-            emit finished(RequestExecuterRetCode::kFailoverFailed);
-        else
-            executeBaseRequest(failoverData_[curIndFailoverData_]);
-        return;
+        executeNextDomain();
+        return false;
     }
+    return true;
+}
 
-    emit finished(RequestExecuterRetCode::kSuccess);
+void RequestExecuterViaFailover::executeNextDomain()
+{
+    // failover can contain several domains, let's try another one if there is one
+    curIndFailoverData_++;
+    if (curIndFailoverData_ >= failoverData_.count())
+        emit finished(RequestExecuterRetCode::kFailoverFailed);
+    else
+        executeBaseRequest(failoverData_[curIndFailoverData_]);
 }
 
 void RequestExecuterViaFailover::executeBaseRequest(const failover::FailoverData &failoverData)
@@ -140,6 +161,7 @@ void RequestExecuterViaFailover::executeBaseRequest(const failover::FailoverData
         default:
             WS_ASSERT(false);
     }
+    reply_ = reply;
     connect(reply, &NetworkReply::finished, this, &RequestExecuterViaFailover::onNetworkRequestFinished);
 }
 
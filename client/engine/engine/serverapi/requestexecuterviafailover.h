@@ -26,11 +26,18 @@ class RequestExecuterViaFailover : public QObject
     Q_OBJECT
 public:
     explicit RequestExecuterViaFailover(QObject *parent, IConnectStateController *connectStateController, NetworkAccessManager *networkAccessManager);
+    ~RequestExecuterViaFailover();
 
     void execute(QPointer<BaseRequest> request, QSharedPointer<failover::BaseFailover> failover, bool bIgnoreSslErrors);
     QPointer<BaseRequest> request() { return request_; }
     failover::FailoverData failoverData() const;
 
+    // Several executers may run the same request in parallel (see FailoverRacer), then a successful reply is kept and finished(kSuccess)
+    // is emitted without handling it. The owner calls handleResponse() for one executer at a time, so only the winning reply is handled.
+    void setDeferredHandling(bool isDeferred) { isDeferredHandling_ = isDeferred; }
+    // returns false for an incorrect response, then the executer goes on with the next domain of the failover
+    bool handleResponse();
+
 signals:
     void finished(server_api::RequestExecuterRetCode retCode);
 
@@ -50,8 +57,12 @@ private:
 
     QVector<failover::FailoverData> failoverData_;
     int curIndFailoverData_;
+    QPointer<NetworkReply> reply_;
+    bool isDeferredHandling_ = false;
+    QByteArray response_;
 
     void executeBaseRequest(const failover::FailoverData &failoverData);
+    void executeNextDomain();
 };
 
 } // namespace server_api
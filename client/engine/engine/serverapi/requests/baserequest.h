@@ -22,6 +22,13 @@ public:
     virtual QString name() const = 0;
     virtual void handle(const QByteArray &arr) = 0;
 
+    // A request with a large response can parse it while it is being received instead of buffering it.
+    // Then the executor calls resetStreaming() before every attempt, handleChunk() for every received portion of the data
+    // and handle() with the rest of the data when the reply is finished.
+    virtual bool isStreaming() const { return false; }
+    virtual void resetStreaming() {}
+    virtual void handleChunk(const QByteArray &chunk) { Q_UNUSED(chunk); }
+
     RequestType requestType() const { return requestType_; }
     int timeout() const { return timeout_; }
 
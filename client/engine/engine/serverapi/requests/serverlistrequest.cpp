@@ -1,7 +1,5 @@
 #include "serverlistrequest.h"
 
-#include <QJsonArray>
-#include <QJsonDocument>
 #include <QSettings>
 
 #include "engine/utils/urlquery_utils.h"
@@ -75,44 +73,72 @@ QString ServerListRequest::name() const
     return "ServerList";
 }
 
+void ServerListRequest::resetStreaming()
+{
+    parser_.reset(new apiinfo::ServerListParser());
+}
+
+void ServerListRequest::handleChunk(const QByteArray &chunk)
+{
+    if (!parser_)
+        resetStreaming();
+    parser_->addData(chunk);
+}
+
 void ServerListRequest::handle(const QByteArray &arr)
 {
-    QJsonParseError errCode;
-    QJsonDocument doc = QJsonDocument::fromJson(arr, &errCode);
-    if (errCode.error != QJsonParseError::NoError || !doc.isObject()) {
-        qCDebugMultiline(LOG_SERVER_API) << arr;
-        qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json";
+    handleChunk(arr);
+    QScopedPointer<apiinfo::ServerListParser> parser(parser_.take());
+    // the result of a previous answer to this request must not be kept
+    locations_.clear();
+    forceDisconnectNodes_.clear();
+
+    if (!parser->finish() || !parser->isObject()) {
+        qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json" << parser->errorString();
         setNetworkRetCode(SERVER_RETURN_INCORRECT_JSON);
         return;
     }
-    QJsonObject jsonObject = doc.object();
 
-    if (!jsonObject.contains("info")) {
-        qCDebugMultiline(LOG_SERVER_API) << arr;
+    if (!parser->hasInfo()) {
         qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json (info field not found)";
         setNetworkRetCode(SERVER_RETURN_INCORRECT_JSON);
         return;
     }
 
-    if (!jsonObject.contains("data")) {
-        qCDebugMultiline(LOG_SERVER_API) << arr;
+    if (!parser->hasData()) {
         qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json (data field not found)";
         setNetworkRetCode(SERVER_RETURN_INCORRECT_JSON);
         return;
     }
-    // parse revision number
-    QJsonObject jsonInfo = jsonObject["info"].toObject();
-    bool isChanged = jsonInfo["changed"].toInt() != 0;
-    int newRevision = jsonInfo["revision"].toInt();
-    QString revisionHash = jsonInfo["revision_hash"].toString();
+
+    if (parser->isChanged())  {
+        qCDebug(LOG_SERVER_API) << "API request ServerLocations successfully executed, revision changed =" << parser->revision()
+                                << ", revision_hash =" << parser->revisionHash();
+
+        locations_ = parser->locations();
+        forceDisconnectNodes_ = parser->forceDisconnectNodes();
+
+        if (locations_.empty())  {
+            qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json, no valid 'data' elements were found";
+            setNetworkRetCode(SERVER_RETURN_INCORRECT_JSON);
+        }
+    }
+    else
+    {
+        qCDebug(LOG_SERVER_API) << "API request ServerLocations successfully executed, revision not changed";
+    }
+
+    // several failovers can answer the same request (see FailoverRacer), only a valid answer may change the settings
+    if (networkRetCode() != SERVER_RETURN_SUCCESS)
+        return;
 
     // manage the country override flag according to the documentation
     // https://gitlab.int.windscribe.com/ws/client/desktop/client-desktop-public/-/issues/354
-    if (jsonInfo.contains("country_override")) {
+    if (parser->hasCountryOverride()) {
         if (isFromDisconnectedVPNState_ && connectStateController_->currentState() == CONNECT_STATE::CONNECT_STATE_DISCONNECTED) {
             QSettings settings;
-            settings.setValue("countryOverride", jsonInfo["country_override"].toString());
-            qCDebug(LOG_SERVER_API) << "API request ServerLocations saved countryOverride =" << jsonInfo["country_override"].toString();
+            settings.setValue("countryOverride", parser->countryOverride());
+            qCDebug(LOG_SERVER_API) << "API request ServerLocations saved countryOverride =" << parser->countryOverride();
         }
     } else {
         if (isFromDisconnectedVPNState_ && connectStateController_->currentState() == CONNECT_STATE::CONNECT_STATE_DISCONNECTED) {
@@ -123,40 +149,6 @@ void ServerListRequest::handle(const QByteArray &arr)
             }
         }
     }
-
-    if (isChanged)  {
-        qCDebug(LOG_SERVER_API) << "API request ServerLocations successfully executed, revision changed =" << newRevision
-                                << ", revision_hash =" << revisionHash;
-
-        // parse locations array
-        const QJsonArray jsonData = jsonObject["data"].toArray();
-
-        for (int i = 0; i < jsonData.size(); ++i) {
-            if (jsonData.at(i).isObject()) {
-                apiinfo::Location sl;
-                QJsonObject dataElement = jsonData.at(i).toObject();
-                if (sl.initFromJson(dataElement, forceDisconnectNodes_)) {
-                    locations_ << sl;
-                } else {
-                    QJsonDocument invalidData(dataElement);
-                    qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping invalid/incomplete 'data' element at index" << i
-                                            << "(" << invalidData.toJson(QJsonDocument::Compact) << ")";
-                }
-            } else {
-                qCDebug(LOG_SERVER_API) << "API request ServerLocations skipping non-object 'data' element at index" << i;
-            }
-        }
-
-        if (locations_.empty())  {
-            qCDebugMultiline(LOG_SERVER_API) << arr;
-            qCDebug(LOG_SERVER_API) << "API request ServerLocations incorrect json, no valid 'data' elements were found";
-            setNetworkRetCode(SERVER_RETURN_INCORRECT_JSON);
-        }
-    }
-    else
-    {
-        qCDebug(LOG_SERVER_API) << "API request ServerLocations successfully executed, revision not changed";
-    }
 }
 
 QVector<apiinfo::Location> ServerListRequest::locations() const
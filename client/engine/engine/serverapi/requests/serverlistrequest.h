@@ -1,7 +1,9 @@
 #pragma once
 
+#include <QScopedPointer>
 #include "baserequest.h"
 #include "engine/apiinfo/location.h"
+#include "engine/apiinfo/serverlistparser.h"
 #include "engine/connectstatecontroller/iconnectstatecontroller.h"
 
 namespace server_api {
@@ -17,6 +19,11 @@ public:
     QString name() const override;
     void handle(const QByteArray &arr) override;
 
+    // the serverlist is large, so it is parsed while being received
+    bool isStreaming() const override { return true; }
+    void resetStreaming() override;
+    void handleChunk(const QByteArray &chunk) override;
+
     // output values
     QVector<apiinfo::Location> locations() const;
     QStringList forceDisconnectNodes() const;
@@ -28,6 +35,7 @@ private:
     QStringList alcList_;
     IConnectStateController *connectStateController_;
     bool isFromDisconnectedVPNState_;
+    QScopedPointer<apiinfo::ServerListParser> parser_;
 
     // output values
     QVector<apiinfo::Location> locations_;
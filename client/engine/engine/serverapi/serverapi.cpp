@@ -1,5 +1,6 @@
 #include "serverapi.h"
 
+#include <QCryptographicHash>
 #include <QUrl>
 #include <QUrlQuery>
 
@@ -8,6 +9,7 @@
 #include "utils/utils.h"
 #include "utils/extraconfig.h"
 #include "utils/simplecrypt.h"
+#include "utils/tracing.h"
 #include "utils/hardcodedsettings.h"
 #include "engine/dnsresolver/dnsserversconfiguration.h"
 #include "engine/connectstatecontroller/iconnectstatecontroller.h"
@@ -54,14 +56,14 @@ ServerAPI::ServerAPI(QObject *parent, IConnectStateController *connectStateContr
 
     failoverContainer_->setParent(this);
 
-    failoverFromSettingsId_ = readFailoverIdFromSettings();
+    failoverFromSettingsId_ = readFailoverIdFromSettings(currentNetworkOrSsid());
     if (failoverContainer_->failoverById(failoverFromSettingsId_))
         failoverState_ = FailoverState::kFromSettingsUnknown;
 }
 
 ServerAPI::~ServerAPI()
 {
-    requestExecutorViaFailover_.reset();
+    failoverRacer_.reset();
 }
 
 QString ServerAPI::getHostname() const
@@ -255,6 +257,7 @@ void ServerAPI::onNetworkRequestFinished()
     NetworkReply *reply = static_cast<NetworkReply *>(sender());
     QSharedPointer<NetworkReply> obj = QSharedPointer<NetworkReply>(reply, &QObject::deleteLater);
     QPointer<BaseRequest> pointerToRequest = reply->property("pointerToRequest").value<QPointer<BaseRequest> >();
+    WS_TRACE_ASYNC_END("api", tracing::internName(reply->property("requestName").toString()), reply);
 
     // if the request has already been deleted before completion, skip processing
     if (!pointerToRequest) {
@@ -275,6 +278,19 @@ void ServerAPI::onNetworkRequestFinished()
     }
 }
 
+void ServerAPI::onNetworkRequestReadyRead()
+{
+    NetworkReply *reply = static_cast<NetworkReply *>(sender());
+    QPointer<BaseRequest> pointerToRequest = reply->property("pointerToRequest").value<QPointer<BaseRequest> >();
+    if (!pointerToRequest)
+        return;
+
+    QByteArray chunk = reply->readAll();
+    if (ExtraConfig::instance().getLogAPIResponse())
+        qCDebugMultiline(LOG_SERVER_API) << chunk;
+    pointerToRequest->handleChunk(chunk);
+}
+
 void ServerAPI::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, CONNECT_ERROR err, const LocationID &location)
 {
     // If we use the hostname from the settings then reset it after the first disconnect signal after starting the program
@@ -287,44 +303,34 @@ void ServerAPI::onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON rea
     }
 }
 
-void ServerAPI::onRequestExecuterViaFailoverFinished(RequestExecuterRetCode retCode)
+void ServerAPI::onFailoverRacerFinished(RequestExecuterRetCode retCode)
 {
     WS_ASSERT(failoverState_ == FailoverState::kUnknown || failoverState_ == FailoverState::kFromSettingsUnknown);
-    QPointer<BaseRequest> request = requestExecutorViaFailover_->request();
+    QPointer<BaseRequest> request = failoverRacer_->request();
 
     if (retCode == RequestExecuterRetCode::kSuccess) {
-        if (failoverState_ == FailoverState::kFromSettingsUnknown) {
+        if (!failoverFromSettingsId_.isEmpty() && failoverRacer_->failoverUniqueId() == failoverFromSettingsId_)
             failoverState_ = FailoverState::kFromSettingsReady;
-        } else {
+        else
             failoverState_ = FailoverState::kReady;
-            writeFailoverIdToSettings(failoverContainer_->currentFailover()->uniqueId());
-        }
-        failoverData_.reset(new failover::FailoverData(requestExecutorViaFailover_->failoverData()));
-        requestExecutorViaFailover_.reset();
+        writeFailoverIdToSettings(currentNetworkOrSsid(), failoverRacer_->failoverUniqueId());
+        failoverData_.reset(new failover::FailoverData(failoverRacer_->failoverData()));
+        failoverRacer_.reset();
         emit request->finished();
         executeWaitingInQueueRequests();
     } else if (retCode == RequestExecuterRetCode::kRequestDeleted) {
         WS_ASSERT(request.isNull());
-        requestExecutorViaFailover_.reset();
+        failoverRacer_.reset();
         executeWaitingInQueueRequests();
     } else if (retCode == RequestExecuterRetCode::kFailoverFailed) {
-        requestExecutorViaFailover_.reset();
-        if (failoverState_ == FailoverState::kFromSettingsUnknown) {
-            failoverState_ = FailoverState::kUnknown;
-            executeRequest(request);
-        } else {
-            WS_ASSERT(failoverState_ == FailoverState::kUnknown);
-            if (failoverContainer_->gotoNext()) {
-                executeRequest(request);
-            } else {
-                failoverState_ = FailoverState::kFailed;
-                setErrorCodeAndEmitRequestFinished(request, SERVER_RETURN_FAILOVER_FAILED, "Failover API not ready");
-                finishWaitingInQueueRequests(SERVER_RETURN_FAILOVER_FAILED, "Failover API not ready");
-            }
-        }
+        // the racer has already tried the remembered failover and all the rest of the container
+        failoverRacer_.reset();
+        failoverState_ = FailoverState::kFailed;
+        setErrorCodeAndEmitRequestFinished(request, SERVER_RETURN_FAILOVER_FAILED, "Failover API not ready");
+        finishWaitingInQueueRequests(SERVER_RETURN_FAILOVER_FAILED, "Failover API not ready");
     } else if (retCode == RequestExecuterRetCode::kConnectStateChanged) {
         // Repeat the execution of the request via failover
-        requestExecutorViaFailover_.reset();
+        failoverRacer_.reset();
         executeRequest(request);
     } else {
         WS_ASSERT(false);
@@ -370,7 +376,7 @@ void ServerAPI::executeRequest(QPointer<BaseRequest> request)
     }
 
     // if failover already in progress then move the request to queue
-    if (requestExecutorViaFailover_ != nullptr) {
+    if (failoverRacer_ != nullptr) {
         // wgConfigsInit, wgConfigsConnect and pingTest should have a higher priority in the queue to avoid potential connection delays
         if (dynamic_cast<PingTestRequest *>(request.get()) != nullptr ||
             dynamic_cast<WgConfigsInitRequest *>(request.get()) != nullptr ||
@@ -387,7 +393,7 @@ void ServerAPI::executeRequest(QPointer<BaseRequest> request)
         executeRequestImpl(request, failover::FailoverData(hostnameForConnectedState()));
         executeWaitingInQueueRequests();
     } else {
-        WS_ASSERT(requestExecutorViaFailover_ == nullptr);
+        WS_ASSERT(failoverRacer_ == nullptr);
 
         bool bUseFailover = false;
         if (failoverState_ == FailoverState::kFromSettingsUnknown || failoverState_ == FailoverState::kUnknown) {
@@ -402,16 +408,12 @@ void ServerAPI::executeRequest(QPointer<BaseRequest> request)
         }
 
         if (bUseFailover) {
-            int failoverInd = -1;
-            QSharedPointer<failover::BaseFailover> curFailover = (failoverState_ == FailoverState::kFromSettingsUnknown) ? failoverContainer_->failoverById(failoverFromSettingsId_) : failoverContainer_->currentFailover(&failoverInd);
-            WS_ASSERT(curFailover);
-            qCDebug(LOG_FAILOVER) << "Trying:" << curFailover->name();
-            requestExecutorViaFailover_.reset(new RequestExecuterViaFailover(this, connectStateController_, networkAccessManager_));
-            connect(requestExecutorViaFailover_.get(), &RequestExecuterViaFailover::finished, this, &ServerAPI::onRequestExecuterViaFailoverFinished, Qt::QueuedConnection);
-            requestExecutorViaFailover_->execute(request, curFailover, bIgnoreSslErrors_);
-            // Do not emit this signal for the first failover and for from the settings failover
-            if (failoverInd > 0)
-                emit tryingBackupEndpoint(failoverInd, failoverContainer_->count() - 1);
+            // the failover that won last time on this network is tried first, the others are raced after it
+            failoverFromSettingsId_ = readFailoverIdFromSettings(currentNetworkOrSsid());
+            failoverRacer_.reset(new FailoverRacer(this, connectStateController_, networkAccessManager_, failoverContainer_));
+            connect(failoverRacer_.get(), &FailoverRacer::finished, this, &ServerAPI::onFailoverRacerFinished, Qt::QueuedConnection);
+            connect(failoverRacer_.get(), &FailoverRacer::tryingBackupEndpoint, this, &ServerAPI::tryingBackupEndpoint);
+            failoverRacer_->execute(request, failoverFromSettingsId_, bIgnoreSslErrors_);
         } else {
             if (failoverState_ == FailoverState::kReady || failoverState_ == FailoverState::kFromSettingsReady) {
                 WS_ASSERT(!failoverData_.isNull());
@@ -467,7 +469,16 @@ void ServerAPI::executeRequestImpl(QPointer<BaseRequest> request, const failover
     }
     QPointer<BaseRequest> pointerToRequest(request);
     reply->setProperty("pointerToRequest",  QVariant::fromValue(pointerToRequest));
+#ifdef WS_TRACING
+    // the request may be deleted before the reply finishes
+    reply->setProperty("requestName", request->name());
+#endif
+    WS_TRACE_ASYNC_BEGIN("api", tracing::internName(request->name()), reply);
     connect(reply, &NetworkReply::finished, this, &ServerAPI::onNetworkRequestFinished);
+    if (request->isStreaming()) {
+        request->resetStreaming();
+        connect(reply, &NetworkReply::readyRead, this, &ServerAPI::onNetworkRequestReadyRead);
+    }
 }
 
 void ServerAPI::executeWaitingInQueueRequests()
@@ -510,22 +521,50 @@ QString ServerAPI::hostnameForConnectedState() const
     return HardcodedSettings::instance().primaryServerDomain();
 }
 
-void ServerAPI::writeFailoverIdToSettings(const QString &failoverId)
+QString ServerAPI::currentNetworkOrSsid() const
+{
+    types::NetworkInterface networkInterface;
+    networkDetectionManager_->getCurrentNetworkInterface(networkInterface);
+    return networkInterface.networkOrSsid;
+}
+
+void ServerAPI::writeFailoverIdToSettings(const QString &networkOrSsid, const QString &failoverId)
 {
     QSettings settings;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    settings.setValue("flvId", simpleCrypt.encryptToString(failoverId));
+    const QString encryptedId = simpleCrypt.encryptToString(failoverId);
+    settings.setValue("flvId", encryptedId);
+
+    if (!networkOrSsid.isEmpty()) {
+        QVariantMap ids = settings.value("flvIdByNetwork").toMap();
+        // don't let the map grow endlessly, the failovers for the forgotten networks will be raced again
+        if (ids.size() >= kMaxRememberedNetworks && !ids.contains(networkKey(networkOrSsid)))
+            ids.clear();
+        ids[networkKey(networkOrSsid)] = encryptedId;
+        settings.setValue("flvIdByNetwork", ids);
+    }
 }
 
-QString ServerAPI::readFailoverIdFromSettings() const
+QString ServerAPI::readFailoverIdFromSettings(const QString &networkOrSsid) const
 {
     QSettings settings;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    QString str = settings.value("flvId", "").toString();
+    // the failover that won on this network, otherwise the latest one that won on any network
+    QString str;
+    if (!networkOrSsid.isEmpty())
+        str = settings.value("flvIdByNetwork").toMap().value(networkKey(networkOrSsid)).toString();
+    if (str.isEmpty())
+        str = settings.value("flvId", "").toString();
     if (!str.isEmpty())
         return simpleCrypt.decryptToString(str);
     else
         return QString();
 }
 
+QString ServerAPI::networkKey(const QString &networkOrSsid)
+{
+    // the network names are not stored in the settings as is
+    return QCryptographicHash::hash(networkOrSsid.toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+}
+
 } // namespace server_api
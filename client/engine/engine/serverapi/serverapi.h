@@ -13,7 +13,7 @@
 #include "types/apiresolutionsettings.h"
 #include "types/protocol.h"
 #include "types/robertfilter.h"
-#include "requestexecuterviafailover.h"
+#include "failoverracer.h"
 
 namespace server_api {
 
@@ -83,9 +83,10 @@ signals:
 
 private slots:
     void onNetworkRequestFinished();
+    void onNetworkRequestReadyRead();
     //void onFailoverNextHostnameAnswer(failover::FailoverRetCode retCode, const QString &hostname);
     void onConnectStateChanged(CONNECT_STATE state, DISCONNECT_REASON reason, CONNECT_ERROR err, const LocationID &location);
-    void onRequestExecuterViaFailoverFinished(server_api::RequestExecuterRetCode retCode);
+    void onFailoverRacerFinished(server_api::RequestExecuterRetCode retCode);
 
 private:
     NetworkAccessManager *networkAccessManager_;
@@ -100,9 +101,9 @@ private:
     enum class FailoverState { kUnknown, kFromSettingsUnknown, kFromSettingsReady, kReady, kFailed } failoverState_;
     QScopedPointer<failover::FailoverData> failoverData_;   // valid only in kReady/kFromSettingsReady states
 
-    QString failoverFromSettingsId_;   // empty if not exists
+    QString failoverFromSettingsId_;   // the failover that won last time on the current network, empty if not exists
 
-    QScopedPointer<RequestExecuterViaFailover> requestExecutorViaFailover_;
+    QScopedPointer<FailoverRacer> failoverRacer_;
 
     failover::IFailoverContainer *failoverContainer_;
     bool isGettingFailoverHostnameInProgress_ = false;
@@ -121,10 +122,14 @@ private:
 
     QString hostnameForConnectedState() const;
 
-    // Save and read the hostname from the settings where it is stored encrypted
+    QString currentNetworkOrSsid() const;
+
+    // Save and read the winning failover id per network from the settings where it is stored encrypted
     static constexpr quint64 SIMPLE_CRYPT_KEY = 0x2572241DF31F32EE;
-    void writeFailoverIdToSettings(const QString &failoverId);
-    QString readFailoverIdFromSettings() const;
+    static constexpr int kMaxRememberedNetworks = 32;
+    void writeFailoverIdToSettings(const QString &networkOrSsid, const QString &failoverId);
+    QString readFailoverIdFromSettings(const QString &networkOrSsid) const;
+    static QString networkKey(const QString &networkOrSsid);
 };
 
 } // namespace server_api
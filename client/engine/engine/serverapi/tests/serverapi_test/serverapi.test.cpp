@@ -1,4 +1,5 @@
 #include "serverapi.test.h"
+#include "engine/serverapi/failoverracer.h"
 #include "engine/serverapi/requests/loginrequest.h"
 #include <QtTest>
 #include <QtConcurrent/QtConcurrent>
@@ -325,4 +326,130 @@ void ServerApi_test::testDeleteRequestsBeforeFinished()
     QTest::qWait(10000);
 }
 
+void ServerApi_test::testFailoverRacing_data()
+{
+    QTest::addColumn<QVector<bool> >("results");
+    QTest::addColumn<QVector<int> >("delaysMs");
+    QTest::addColumn<bool>("isSuccess");
+
+    QTest::newRow("first works") << (QVector<bool>() << true) << (QVector<int>() << 0) << true;
+    QTest::newRow("fast failures") << (QVector<bool>() << false << false << true) << (QVector<int>() << 0 << 0 << 0) << true;
+    QTest::newRow("slow failure") << (QVector<bool>() << false << true) << (QVector<int>() << 10000 << 0) << true;
+    QTest::newRow("slow failures more than parallel") << (QVector<bool>() << false << false << false << true) << (QVector<int>() << 10000 << 10000 << 10000 << 0) << true;
+    QTest::newRow("working one is slow") << (QVector<bool>() << false << true) << (QVector<int>() << 10000 << 3000) << true;
+    QTest::newRow("all fail slowly") << (QVector<bool>() << false << false) << (QVector<int>() << 3000 << 3000) << false;
+}
+
+void ServerApi_test::testFailoverRacing()
+{
+    QFETCH(QVector<bool>, results);
+    QFETCH(QVector<int>, delaysMs);
+    QFETCH(bool, isSuccess);
+
+    // forget the failover that won in the previous tests
+    QSettings settings;
+    settings.remove("flvId");
+    settings.remove("flvIdByNetwork");
+
+    QVector<QPair<QString, bool> > failovers;
+    int sumDelaysMs = 0;
+    for (int i = 0; i < results.size(); ++i) {
+        failovers << qMakePair(results[i] ? QString("windscribe.com") : QString("failover%1.invalid").arg(i), results[i]);
+        sumDelaysMs += delaysMs[i];
+    }
+    QScopedPointer<server_api::ServerAPI> serverAPI(new server_api::ServerAPI(this, connectStateController_, accessManager_, networkDetectionManager_,
+                                                                             new FailoverContainer_moc(this, failovers, delaysMs)));
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    QScopedPointer<server_api::BaseRequest> request(serverAPI->myIP(5000));
+    QSignalSpy spy(request.get(), &server_api::BaseRequest::finished);
+    QVERIFY(spy.wait(60000));
+
+    if (isSuccess)
+        QCOMPARE(request->networkRetCode(), SERVER_RETURN_SUCCESS);
+    else
+        QCOMPARE(request->networkRetCode(), SERVER_RETURN_FAILOVER_FAILED);
+
+    // the slow failures are waited in parallel, not one after another
+    qDebug() << "finished in" << elapsedTimer.elapsed() << "ms, sequential failovers would take at least" << sumDelaysMs << "ms";
+    if (sumDelaysMs > 0)
+        QVERIFY(elapsedTimer.elapsed() < sumDelaysMs);
+}
+
+void ServerApi_test::testRememberedFailover()
+{
+    QSettings settings;
+    settings.remove("flvId");
+    settings.remove("flvIdByNetwork");
+
+    QVector<QPair<QString, bool> > failovers;
+    failovers << qMakePair("failover0.invalid", false);
+    failovers << qMakePair("windscribe.com", true);
+    QVector<int> delaysMs;
+    delaysMs << 10000 << 0;
+
+    // the first time the backup failover wins the race
+    {
+        QScopedPointer<server_api::ServerAPI> serverAPI(new server_api::ServerAPI(this, connectStateController_, accessManager_, networkDetectionManager_,
+                                                                                 new FailoverContainer_moc(this, failovers, delaysMs)));
+        QSignalSpy backupSpy(serverAPI.get(), &server_api::ServerAPI::tryingBackupEndpoint);
+        QScopedPointer<server_api::BaseRequest> request(serverAPI->myIP(5000));
+        QSignalSpy spy(request.get(), &server_api::BaseRequest::finished);
+        QVERIFY(spy.wait(60000));
+        QCOMPARE(request->networkRetCode(), SERVER_RETURN_SUCCESS);
+        QVERIFY(backupSpy.count() > 0);
+    }
+
+    // the next time it is started first, without waiting for the slow one
+    {
+        QScopedPointer<server_api::ServerAPI> serverAPI(new server_api::ServerAPI(this, connectStateController_, accessManager_, networkDetectionManager_,
+                                                                                 new FailoverContainer_moc(this, failovers, delaysMs)));
+        QSignalSpy backupSpy(serverAPI.get(), &server_api::ServerAPI::tryingBackupEndpoint);
+        QScopedPointer<server_api::BaseRequest> request(serverAPI->myIP(5000));
+        QSignalSpy spy(request.get(), &server_api::BaseRequest::finished);
+        QVERIFY(spy.wait(60000));
+        QCOMPARE(request->networkRetCode(), SERVER_RETURN_SUCCESS);
+        QCOMPARE(backupSpy.count(), 0);
+    }
+}
+
+void ServerApi_test::testFailoverRacingIncorrectJson()
+{
+    // the first candidate answers with JSON after a while, the second one (started 100 ms later) answers with an HTML page
+    // in the meantime and the third one with JSON after the first one: only the replies until the first correct one are handled
+    HttpServer_moc server(this);
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    server.addResponse("/slow", "{\"answer\": \"slow\"}", 1500);
+    server.addResponse("/html", "<html></html>", 0);
+    server.addResponse("/late", "{\"answer\": \"late\"}", 2500);
+
+    QVector<QPair<QString, bool> > failovers;
+    failovers << qMakePair(server.domain("/slow"), true);
+    failovers << qMakePair(server.domain("/html"), true);
+    failovers << qMakePair(server.domain("/late"), true);
+    FailoverContainer_moc *failoverContainer = new FailoverContainer_moc(this, failovers);
+
+    server_api::FailoverRacer racer(this, connectStateController_, accessManager_, failoverContainer, 100);
+    QScopedPointer<JsonRequest_moc> request(new JsonRequest_moc(this));
+    QSignalSpy spy(&racer, &server_api::FailoverRacer::finished);
+    racer.execute(request.get(), QString(), false);
+    QVERIFY(spy.wait(10000));
+
+    QCOMPARE(spy.first().at(0).value<server_api::RequestExecuterRetCode>(), server_api::RequestExecuterRetCode::kSuccess);
+    QCOMPARE(racer.failoverUniqueId(), server.domain("/slow"));
+    QCOMPARE(request->networkRetCode(), SERVER_RETURN_SUCCESS);
+    QCOMPARE(request->json()["answer"].toString(), QString("slow"));
+    QCOMPARE(request->handledCount(), 2);
+
+    // the container is left at the winner
+    int ind = -1;
+    QCOMPARE(failoverContainer->currentFailover(&ind)->uniqueId(), server.domain("/slow"));
+    QCOMPARE(ind, 0);
+
+    // the late reply of the cancelled candidate is never handled
+    QTest::qWait(1500);
+    QCOMPARE(request->handledCount(), 2);
+    QCOMPARE(request->json()["answer"].toString(), QString("slow"));
+}
+
 QTEST_MAIN(ServerApi_test)
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QList>
 #include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
 #include "engine/connectstatecontroller/iconnectstatecontroller.h"
 #include "engine/networkdetectionmanager/inetworkdetectionmanager.h"
 #include "engine/serverapi/serverapi.h"
@@ -60,18 +65,19 @@ private:
     bool bOnline_ = true;
 };
 
+// The failover answers after delayMs, so that a slow failure (a timeout on a censored network) can be simulated
 class Failover_moc : public failover::BaseFailover
 {
     Q_OBJECT
 public:
-    explicit Failover_moc(QObject *parent, QString domain, bool bSuccess) : BaseFailover(parent, "id"),  domain_(domain), bSuccess_(bSuccess) {}
+    explicit Failover_moc(QObject *parent, QString domain, bool bSuccess, int delayMs = 0) : BaseFailover(parent, domain),
+        domain_(domain), bSuccess_(bSuccess), delayMs_(delayMs) {}
 
     void getData(bool bIgnoreSslErrors) {
-        if (bSuccess_) {
-            emit finished(QVector<failover::FailoverData>() << failover::FailoverData(domain_));
-        } else {
-            emit finished(QVector<failover::FailoverData>());
-        }
+        if (delayMs_ > 0)
+            QTimer::singleShot(delayMs_, this, [this]() { answer(); });
+        else
+            answer();
     }
 
     QString name() const override {
@@ -81,6 +87,16 @@ public:
 private:
     QString domain_;
     bool bSuccess_;
+    int delayMs_;
+
+    void answer()
+    {
+        if (bSuccess_) {
+            emit finished(QVector<failover::FailoverData>() << failover::FailoverData(domain_));
+        } else {
+            emit finished(QVector<failover::FailoverData>());
+        }
+    }
 };
 
 class FailoverContainer_moc : public failover::IFailoverContainer
@@ -88,8 +104,8 @@ class FailoverContainer_moc : public failover::IFailoverContainer
     Q_OBJECT
 
 public:
-    explicit FailoverContainer_moc(QObject *parent, QVector<QPair<QString, bool> > failovers) : IFailoverContainer(parent),
-        failovers_(failovers), curFailoverInd_(0)
+    explicit FailoverContainer_moc(QObject *parent, QVector<QPair<QString, bool> > failovers, QVector<int> delaysMs = QVector<int>()) : IFailoverContainer(parent),
+        failovers_(failovers), delaysMs_(delaysMs), curFailoverInd_(0)
     {
         resetImpl();
     }
@@ -111,7 +127,7 @@ public:
     {
         if (curFailoverInd_ <  (failovers_.size() - 1)) {
             curFailoverInd_++;
-            currentFailover_ = QSharedPointer<failover::BaseFailover>(new Failover_moc(this, failovers_[curFailoverInd_].first, failovers_[curFailoverInd_].second));
+            currentFailover_ = createFailover(curFailoverInd_);
             return !currentFailover_.isNull();
         } else {
             return false;
@@ -120,9 +136,25 @@ public:
 
     QSharedPointer<failover::BaseFailover> failoverById(const QString &failoverUniqueId) override
     {
+        for (int i = 0; i < failovers_.size(); ++i) {
+            if (failovers_[i].first == failoverUniqueId)
+                return createFailover(i);
+        }
         return nullptr;
     }
 
+    bool gotoFailover(const QString &failoverUniqueId) override
+    {
+        for (int i = 0; i < failovers_.size(); ++i) {
+            if (failovers_[i].first == failoverUniqueId) {
+                curFailoverInd_ = i;
+                currentFailover_ = createFailover(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
     int count() const override
     {
         return failovers_.count();
@@ -130,14 +162,97 @@ public:
 
 private:
     QVector<QPair<QString, bool> > failovers_;
+    QVector<int> delaysMs_;
     int curFailoverInd_;
     QSharedPointer<failover::BaseFailover> currentFailover_;
 
     void resetImpl()
     {
         curFailoverInd_ = 0;
-        currentFailover_ = QSharedPointer<failover::BaseFailover>(new Failover_moc(this, failovers_[curFailoverInd_].first, failovers_[curFailoverInd_].second));
+        currentFailover_ = createFailover(curFailoverInd_);
+    }
+
+    QSharedPointer<failover::BaseFailover> createFailover(int ind)
+    {
+        return QSharedPointer<failover::BaseFailover>(new Failover_moc(this, failovers_[ind].first, failovers_[ind].second,
+                                                                       ind < delaysMs_.size() ? delaysMs_[ind] : 0));
+    }
+};
+
+// Requests the URL given as the failover domain over HTTP, a response which is not a JSON object is an incorrect JSON
+class JsonRequest_moc : public server_api::BaseRequest
+{
+    Q_OBJECT
+public:
+    explicit JsonRequest_moc(QObject *parent) : BaseRequest(parent, server_api::RequestType::kGet, true, 20000) {}
+
+    QUrl url(const QString &domain) const override { return QUrl("http://" + domain); }
+    QString name() const override { return "JsonRequest_moc"; }
+
+    void handle(const QByteArray &arr) override
+    {
+        handledCount_++;
+        QJsonDocument doc = QJsonDocument::fromJson(arr);
+        if (!doc.isObject()) {
+            setNetworkRetCode(SERVER_RETURN_INCORRECT_JSON);
+            return;
+        }
+        json_ = doc.object();
+    }
+
+    QJsonObject json() const { return json_; }
+    int handledCount() const { return handledCount_; }
+
+private:
+    QJsonObject json_;
+    int handledCount_ = 0;
+};
+
+// A local HTTP server, it answers the requests of each path with a fixed body after a fixed delay
+class HttpServer_moc : public QTcpServer
+{
+    Q_OBJECT
+public:
+    explicit HttpServer_moc(QObject *parent) : QTcpServer(parent)
+    {
+        connect(this, &QTcpServer::newConnection, this, &HttpServer_moc::onNewConnection);
     }
+
+    void addResponse(const QByteArray &path, const QByteArray &body, int delayMs)
+    {
+        responses_[path] = qMakePair(body, delayMs);
+    }
+
+    // the failover domain of the path
+    QString domain(const QByteArray &path) const
+    {
+        return QString("127.0.0.1:%1%2").arg(serverPort()).arg(QString::fromLatin1(path));
+    }
+
+private slots:
+    void onNewConnection()
+    {
+        while (QTcpSocket *socket = nextPendingConnection()) {
+            connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+                request_[socket] += socket->readAll();
+                if (!request_[socket].contains("\r\n\r\n"))
+                    return;
+                // the request line is "GET /path HTTP/1.1"
+                const QByteArray path = request_.take(socket).split(' ').value(1);
+                const QPair<QByteArray, int> response = responses_.value(path, qMakePair(QByteArray(), 0));
+                QTimer::singleShot(response.second, socket, [socket, body = response.first]() {
+                    socket->write("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\nContent-Length: "
+                                  + QByteArray::number(body.size()) + "\r\n\r\n" + body);
+                    socket->disconnectFromHost();
+                });
+            });
+        }
+    }
+
+private:
+    QHash<QByteArray, QPair<QByteArray, int>> responses_;
+    QHash<QTcpSocket *, QByteArray> request_;
 };
 
 // Semi-automatic unit test of ServerAPI,
@@ -157,6 +272,10 @@ private slots:
     void testFailoverFailed();
     void testDeleteServerAPIWhileRequestsRunning();
     void testDeleteRequestsBeforeFinished();
+    void testFailoverRacing_data();
+    void testFailoverRacing();
+    void testRememberedFailover();
+    void testFailoverRacingIncorrectJson();
 
 private:
     ConnectStateController_moc *connectStateController_;
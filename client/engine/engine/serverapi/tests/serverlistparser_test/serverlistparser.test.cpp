@@ -0,0 +1,123 @@
+#include "serverlistparser.test.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtTest>
+#include "engine/apiinfo/serverlistparser.h"
+
+void ServerListParser_test::initTestCase()
+{
+    QFile file(":/serverlist.json");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    serverList_ = file.readAll();
+    QVERIFY(!serverList_.isEmpty());
+}
+
+void ServerListParser_test::testSameAsJsonDocument()
+{
+    QVector<apiinfo::Location> expectedLocations;
+    QStringList expectedForceDisconnectNodes;
+    parseWithJsonDocument(serverList_, expectedLocations, expectedForceDisconnectNodes);
+
+    apiinfo::ServerListParser parser;
+    QVERIFY(parser.addData(serverList_));
+    QVERIFY(parser.finish());
+    QVERIFY(parser.isObject());
+    QVERIFY(parser.hasInfo());
+    QVERIFY(parser.hasData());
+    QVERIFY(parser.isChanged());
+    QCOMPARE(parser.revision(), 2513);
+    QCOMPARE(parser.revisionHash(), QString("d0c1fbd58e7d6d2f5a0f2a83e3a3a0dbd0a4e1c5"));
+    QVERIFY(parser.hasCountryOverride());
+    QCOMPARE(parser.countryOverride(), QString("CA"));
+
+    // the incomplete and non-object elements at the end are skipped
+    QVERIFY(!expectedLocations.isEmpty());
+    QVERIFY(!expectedForceDisconnectNodes.isEmpty());
+    QCOMPARE(parser.locations().size(), expectedLocations.size());
+    QVERIFY(parser.locations() == expectedLocations);
+    QCOMPARE(parser.forceDisconnectNodes(), expectedForceDisconnectNodes);
+}
+
+void ServerListParser_test::testChunks_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::newRow("1 byte") << 1;
+    QTest::newRow("7 bytes") << 7;
+    QTest::newRow("4 KB") << 4096;
+}
+
+void ServerListParser_test::testChunks()
+{
+    QFETCH(int, chunkSize);
+
+    apiinfo::ServerListParser wholeParser;
+    QVERIFY(wholeParser.addData(serverList_));
+    QVERIFY(wholeParser.finish());
+
+    // a token split between the chunks must give the same result
+    apiinfo::ServerListParser parser;
+    for (int i = 0; i < serverList_.size(); i += chunkSize)
+        QVERIFY(parser.addData(serverList_.mid(i, chunkSize)));
+    QVERIFY(parser.finish());
+    QVERIFY(parser.locations() == wholeParser.locations());
+    QCOMPARE(parser.forceDisconnectNodes(), wholeParser.forceDisconnectNodes());
+    QCOMPARE(parser.revision(), wholeParser.revision());
+}
+
+void ServerListParser_test::testIncorrectJson_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("truncated") << serverList_.left(serverList_.size() / 2);
+    QTest::newRow("unterminated string") << QByteArray("{\"info\":{\"revision_hash\":\"abc");
+    QTest::newRow("garbage after") << QByteArray("{\"info\":{},\"data\":[]} x");
+    QTest::newRow("invalid literal") << QByteArray("{\"info\":{\"changed\":tru},\"data\":[]}");
+    QTest::newRow("missing colon") << QByteArray("{\"info\" {}}");
+}
+
+void ServerListParser_test::testIncorrectJson()
+{
+    QFETCH(QByteArray, data);
+
+    apiinfo::ServerListParser parser;
+    parser.addData(data);
+    QVERIFY(!parser.finish());
+    QVERIFY(!parser.errorString().isEmpty());
+}
+
+void ServerListParser_test::benchmarkJsonDocument()
+{
+    QBENCHMARK {
+        QVector<apiinfo::Location> locations;
+        QStringList forceDisconnectNodes;
+        parseWithJsonDocument(serverList_, locations, forceDisconnectNodes);
+    }
+}
+
+void ServerListParser_test::benchmarkServerListParser()
+{
+    QBENCHMARK {
+        apiinfo::ServerListParser parser;
+        parser.addData(serverList_);
+        parser.finish();
+        QVector<apiinfo::Location> locations = parser.locations();
+    }
+}
+
+void ServerListParser_test::parseWithJsonDocument(const QByteArray &arr, QVector<apiinfo::Location> &outLocations, QStringList &outForceDisconnectNodes)
+{
+    // the way ServerListRequest parsed the response before ServerListParser
+    const QJsonDocument doc = QJsonDocument::fromJson(arr);
+    const QJsonArray jsonData = doc.object()["data"].toArray();
+    for (int i = 0; i < jsonData.size(); ++i) {
+        if (jsonData.at(i).isObject()) {
+            apiinfo::Location sl;
+            if (sl.initFromJson(jsonData.at(i).toObject(), outForceDisconnectNodes))
+                outLocations << sl;
+        }
+    }
+}
+
+QTEST_MAIN(ServerListParser_test)
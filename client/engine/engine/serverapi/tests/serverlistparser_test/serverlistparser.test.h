@@ -0,0 +1,28 @@
+#pragma once
+
+#include <QObject>
+#include "engine/apiinfo/location.h"
+
+// Compares ServerListParser with the QJsonDocument based parsing on a saved serverlist response,
+// the benchmarks show the difference in speed.
+class ServerListParser_test : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void testSameAsJsonDocument();
+    void testChunks_data();
+    void testChunks();
+    void testIncorrectJson_data();
+    void testIncorrectJson();
+
+    void benchmarkJsonDocument();
+    void benchmarkServerListParser();
+
+private:
+    QByteArray serverList_;
+
+    static void parseWithJsonDocument(const QByteArray &arr, QVector<apiinfo::Location> &outLocations, QStringList &outForceDisconnectNodes);
+};
@@ -0,0 +1,78 @@
+#!/bin/bash
+# Hermetic network for the engine tests and benchmarks (Linux, root).
+# Creates the network namespace "wsnetsim" connected to the host with a veth pair and runs netsim_server.py in it:
+# a stand-in for the Windscribe API on HTTPS (443, which is also the TCP ping responder), a DNS server (53) which resolves
+# every name to the namespace address, and the kernel answers ICMP. The latency, loss and bandwidth are set with tc/netem
+# on the namespace side of the pair, so they apply to the replies.
+#
+#   sudo ./netsim.sh up
+#   sudo ./netsim.sh shape --delay 80ms --jitter 10ms --loss 2% --rate 5mbit
+#   WS_NETSIM_IP=10.200.0.2 WS_NETSIM_DELAY_MS=80 ./netsim.test
+#   sudo ./netsim.sh down
+
+set -e
+
+NS=wsnetsim
+HOST_IF=wsnetsim0
+NS_IF=wsnetsim1
+HOST_IP=10.200.0.1
+NS_IP=10.200.0.2
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+RUN_DIR=/run/wsnetsim
+
+up() {
+    ip netns add $NS
+    ip link add $HOST_IF type veth peer name $NS_IF
+    ip link set $NS_IF netns $NS
+    ip addr add $HOST_IP/24 dev $HOST_IF
+    ip link set $HOST_IF up
+    ip netns exec $NS ip addr add $NS_IP/24 dev $NS_IF
+    ip netns exec $NS ip link set $NS_IF up
+    ip netns exec $NS ip link set lo up
+
+    mkdir -p $RUN_DIR
+    openssl req -x509 -newkey rsa:2048 -nodes -days 30 -subj "/CN=netsim" \
+        -keyout $RUN_DIR/key.pem -out $RUN_DIR/cert.pem 2>/dev/null
+    ip netns exec $NS python3 "$SCRIPT_DIR/netsim_server.py" \
+        --address $NS_IP --fixtures "$SCRIPT_DIR/fixtures" \
+        --serverlist "$SCRIPT_DIR/../../serverapi/tests/serverlistparser_test/serverlist.json" \
+        --cert $RUN_DIR/cert.pem --key $RUN_DIR/key.pem > $RUN_DIR/server.log 2>&1 &
+    echo $! > $RUN_DIR/server.pid
+    echo "netsim is up: $NS_IP"
+}
+
+down() {
+    if [ -f $RUN_DIR/server.pid ]; then
+        kill "$(cat $RUN_DIR/server.pid)" 2>/dev/null || true
+    fi
+    rm -rf $RUN_DIR
+    ip netns del $NS 2>/dev/null || true
+    ip link del $HOST_IF 2>/dev/null || true
+}
+
+shape() {
+    local delay=0ms jitter=0ms loss=0% rate=
+    while [ $# -gt 0 ]; do
+        case "$1" in
+            --delay) delay=$2; shift 2 ;;
+            --jitter) jitter=$2; shift 2 ;;
+            --loss) loss=$2; shift 2 ;;
+            --rate) rate=$2; shift 2 ;;
+            *) echo "unknown option $1"; exit 1 ;;
+        esac
+    done
+    local args="delay $delay $jitter loss $loss"
+    if [ -n "$rate" ]; then
+        args="$args rate $rate"
+    fi
+    # shellcheck disable=SC2086
+    ip netns exec $NS tc qdisc replace dev $NS_IF root netem $args
+    echo "netsim shaped: $args"
+}
+
+case "$1" in
+    up) up ;;
+    down) down ;;
+    shape) shift; shape "$@" ;;
+    *) echo "usage: $0 up | down | shape [--delay 50ms] [--jitter 5ms] [--loss 1%] [--rate 10mbit]"; exit 1 ;;
+esac
@@ -0,0 +1,170 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+#include "engine/dnsresolver/dnsrequest.h"
+#include "engine/networkaccessmanager/curlnetworkmanager.h"
+#include "engine/ping/pinghost_tcp.h"
+#include "engine/ping/pinghost_icmp_posix.h"
+
+// Runs against the hermetic network started by netsim.sh; skipped when WS_NETSIM_IP is not set.
+// WS_NETSIM_DELAY_MS is the delay configured with "netsim.sh shape", the round trips must not be faster than it.
+class TestNetsim : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void test_dns();
+    void test_dns_nxdomain();
+    void test_api_session();
+    void test_api_serverconfigs();
+    void test_api_serverlist();
+    void test_ping_tcp();
+    void test_ping_icmp();
+
+    void benchmark_dns();
+    void benchmark_api_session();
+
+private:
+    QString ip_;
+    int delayMs_ = 0;
+
+    CurlReply *get(CurlNetworkManager *manager, const QString &path);
+    bool waitForPing(IPingHost *pingHost, int &timeMs);
+};
+
+void TestNetsim::initTestCase()
+{
+    ip_ = qEnvironmentVariable("WS_NETSIM_IP");
+    if (ip_.isEmpty())
+        QSKIP("WS_NETSIM_IP is not set, start the network with netsim.sh");
+    delayMs_ = qEnvironmentVariableIntValue("WS_NETSIM_DELAY_MS");
+}
+
+void TestNetsim::test_dns()
+{
+    DnsRequest request(this, "api.windscribe.com", QStringList() << ip_, 5000 + delayMs_ * 2);
+    request.lookupBlocked();
+    QCOMPARE(request.isError(), false);
+    QCOMPARE(request.ips(), QStringList() << ip_);
+    QVERIFY(request.elapsedMs() >= delayMs_);
+}
+
+void TestNetsim::test_dns_nxdomain()
+{
+    // the names are listed in fixtures/nxdomain.txt
+    DnsRequest request(this, "nxdomain.netsim.test", QStringList() << ip_, 5000 + delayMs_ * 2);
+    request.lookupBlocked();
+    QCOMPARE(request.isError(), true);
+    QVERIFY(request.ips().isEmpty());
+}
+
+CurlReply *TestNetsim::get(CurlNetworkManager *manager, const QString &path)
+{
+    NetworkRequest request(QUrl("https://" + ip_ + path), 10000 + delayMs_ * 4, false);
+    // the server has a self-signed certificate
+    request.setIgnoreSslErrors(true);
+    return manager->get(request, QStringList() << ip_);
+}
+
+void TestNetsim::test_api_session()
+{
+    CurlNetworkManager manager(this);
+    QElapsedTimer timer;
+    timer.start();
+    CurlReply *reply = get(&manager, "/Session");
+    QSignalSpy signalFinished(reply, &CurlReply::finished);
+    QVERIFY(signalFinished.wait(20000));
+    QVERIFY(timer.elapsed() >= delayMs_);
+
+    QVERIFY(reply->isSuccess());
+    QJsonParseError errCode;
+    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &errCode);
+    QVERIFY(errCode.error == QJsonParseError::NoError && doc.isObject());
+    QJsonObject data = doc.object()["data"].toObject();
+    QCOMPARE(data["username"].toString(), QString("netsim"));
+    QCOMPARE(data["is_premium"].toInt(), 1);
+    delete reply;
+}
+
+void TestNetsim::test_api_serverconfigs()
+{
+    CurlNetworkManager manager(this);
+    CurlReply *reply = get(&manager, "/ServerConfigs");
+    QSignalSpy signalFinished(reply, &CurlReply::finished);
+    QVERIFY(signalFinished.wait(20000));
+
+    QVERIFY(reply->isSuccess());
+    QByteArray config = QByteArray::fromBase64(reply->readAll());
+    QVERIFY(config.startsWith("client"));
+    delete reply;
+}
+
+void TestNetsim::test_api_serverlist()
+{
+    CurlNetworkManager manager(this);
+    CurlReply *reply = get(&manager, "/serverlist/mob-v2/1/0");
+    QSignalSpy signalFinished(reply, &CurlReply::finished);
+    QVERIFY(signalFinished.wait(20000));
+
+    QVERIFY(reply->isSuccess());
+    QJsonParseError errCode;
+    QJsonDocument doc = QJsonDocument::fromJson(reply->readAll(), &errCode);
+    QVERIFY(errCode.error == QJsonParseError::NoError && doc.isObject());
+    QVERIFY(doc.object()["data"].isArray());
+    QVERIFY(!doc.object()["data"].toArray().isEmpty());
+    delete reply;
+}
+
+bool TestNetsim::waitForPing(IPingHost *pingHost, int &timeMs)
+{
+    QSignalSpy signalFinished(pingHost, &IPingHost::pingFinished);
+    pingHost->ping();
+    if (!signalFinished.wait(20000))
+        return false;
+    timeMs = signalFinished.first().at(1).toInt();
+    return signalFinished.first().at(0).toBool();
+}
+
+void TestNetsim::test_ping_tcp()
+{
+    PingHost_TCP pingHost(this, ip_, types::ProxySettings(), false);
+    int timeMs = 0;
+    QVERIFY(waitForPing(&pingHost, timeMs));
+    QVERIFY(timeMs >= delayMs_);
+}
+
+void TestNetsim::test_ping_icmp()
+{
+    PingHost_ICMP_posix pingHost(this, ip_);
+    int timeMs = 0;
+    QVERIFY(waitForPing(&pingHost, timeMs));
+    QVERIFY(timeMs >= delayMs_);
+}
+
+void TestNetsim::benchmark_dns()
+{
+    QBENCHMARK {
+        DnsRequest request(this, "api.windscribe.com", QStringList() << ip_, 5000 + delayMs_ * 2);
+        request.lookupBlocked();
+        QCOMPARE(request.isError(), false);
+    }
+}
+
+void TestNetsim::benchmark_api_session()
+{
+    // each iteration is a new connection, as the first API request after a connect
+    QBENCHMARK {
+        CurlNetworkManager manager(this);
+        CurlReply *reply = get(&manager, "/Session");
+        QSignalSpy signalFinished(reply, &CurlReply::finished);
+        QVERIFY(signalFinished.wait(20000));
+        QVERIFY(reply->isSuccess());
+        delete reply;
+    }
+}
+
+QTEST_MAIN(TestNetsim)
+#include "netsim.test.moc"
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# The servers of the hermetic test network, started by netsim.sh inside the namespace. Standard library only.
+#   - HTTPS on 443: a stand-in for the Windscribe API which answers from the recorded fixtures; it is also the TCP ping responder.
+#   - DNS on 53/udp: resolves every A query to --address (so api.windscribe.com and the failover domains land here),
+#     the names listed in fixtures/nxdomain.txt return NXDOMAIN.
+
+import argparse
+import base64
+import http.server
+import os
+import socket
+import ssl
+import struct
+import threading
+
+
+class ApiHandler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def do_GET(self):
+        self.respond()
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        self.rfile.read(length)
+        self.respond()
+
+    def respond(self):
+        path = self.path.split("?", 1)[0]
+        fixtures = self.server.fixtures
+        if path == "/Session":
+            body = fixtures["session"]
+        elif path == "/ServerConfigs":
+            # the client decodes the ovpn config from base64
+            body = base64.b64encode(fixtures["serverconfigs"])
+        elif "/serverlist/" in path:
+            body = fixtures["serverlist"]
+        else:
+            self.send_error(404)
+            return
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format, *args):
+        print("api: " + format % args, flush=True)
+
+
+def read_fixture(path):
+    with open(path, "rb") as f:
+        return f.read()
+
+
+def serve_api(args):
+    server = http.server.ThreadingHTTPServer((args.address, 443), ApiHandler)
+    server.fixtures = {
+        "session": read_fixture(os.path.join(args.fixtures, "session.json")),
+        "serverconfigs": read_fixture(os.path.join(args.fixtures, "serverconfigs.ovpn")),
+        "serverlist": read_fixture(args.serverlist),
+    }
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(args.cert, args.key)
+    # the handshake runs in the request thread, so a TCP ping which only connects does not hold up the accepting
+    server.socket = context.wrap_socket(server.socket, server_side=True, do_handshake_on_connect=False)
+    server.serve_forever()
+
+
+def dns_response(query, address, nxdomains):
+    (qid, flags, qdcount) = struct.unpack("!HHH", query[:6])
+    if qdcount != 1:
+        return None
+    # the question: labels, then the type and the class
+    pos = 12
+    labels = []
+    while query[pos] != 0:
+        length = query[pos]
+        labels.append(query[pos + 1:pos + 1 + length].decode("ascii", "replace").lower())
+        pos += 1 + length
+    question_end = pos + 5
+    qtype = struct.unpack("!H", query[pos + 1:pos + 3])[0]
+    question = query[12:question_end]
+    name = ".".join(labels)
+
+    rd = flags & 0x0100
+    if name in nxdomains:
+        return struct.pack("!HHHHHH", qid, 0x8183 | rd, 1, 0, 0, 0) + question
+    if qtype != 1:
+        # no AAAA and the other types, an empty answer
+        return struct.pack("!HHHHHH", qid, 0x8180 | rd, 1, 0, 0, 0) + question
+    answer = struct.pack("!HHHLH", 0xC00C, 1, 1, 60, 4) + socket.inet_aton(address)
+    return struct.pack("!HHHHHH", qid, 0x8180 | rd, 1, 1, 0, 0) + question + answer
+
+
+def serve_dns(args):
+    nxdomains = set()
+    nxdomain_path = os.path.join(args.fixtures, "nxdomain.txt")
+    if os.path.exists(nxdomain_path):
+        with open(nxdomain_path) as f:
+            nxdomains = {line.strip().lower() for line in f if line.strip()}
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.address, 53))
+    while True:
+        query, client = sock.recvfrom(512)
+        try:
+            response = dns_response(query, args.address, nxdomains)
+        except (IndexError, struct.error):
+            response = None
+        if response:
+            sock.sendto(response, client)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--address", required=True)
+    parser.add_argument("--fixtures", required=True)
+    parser.add_argument("--serverlist", required=True)
+    parser.add_argument("--cert", required=True)
+    parser.add_argument("--key", required=True)
+    args = parser.parse_args()
+
+    threading.Thread(target=serve_dns, args=(args,), daemon=True).start()
+    serve_api(args)
+
+
+if __name__ == "__main__":
+    main()
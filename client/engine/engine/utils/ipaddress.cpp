@@ -0,0 +1,249 @@
+#include "ipaddress.h"
+
+namespace {
+
+// dotted decimal, up to 3 digits per part like IpValidation::isIp()
+bool parseIPv4(QStringView str, quint8 *out)
+{
+    int part = 0;
+    int value = 0;
+    int digits = 0;
+    for (QChar c : str) {
+        const char16_t ch = c.unicode();
+        if (ch >= '0' && ch <= '9') {
+            if (digits == 3)
+                return false;
+            value = value * 10 + (ch - '0');
+            digits++;
+            if (value > 255)
+                return false;
+        } else if (ch == '.') {
+            if (digits == 0 || part == 3)
+                return false;
+            out[part++] = static_cast<quint8>(value);
+            value = 0;
+            digits = 0;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0 || part != 3)
+        return false;
+    out[3] = static_cast<quint8>(value);
+    return true;
+}
+
+int hexValue(char16_t ch)
+{
+    if (ch >= '0' && ch <= '9')
+        return ch - '0';
+    if (ch >= 'a' && ch <= 'f')
+        return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F')
+        return ch - 'A' + 10;
+    return -1;
+}
+
+// RFC 4291 text form, with an optional IPv4 address in the last 32 bits
+bool parseIPv6(QStringView str, quint8 *out)
+{
+    quint16 groups[8] = {};
+    int count = 0;
+    int compressAt = -1;
+    const qsizetype len = str.size();
+    qsizetype i = 0;
+
+    if (len >= 2 && str[0] == ':' && str[1] == ':') {
+        compressAt = 0;
+        i = 2;
+    } else if (len == 0 || str[0] == ':') {
+        return false;
+    }
+
+    while (i < len) {
+        const qsizetype start = i;
+        int value = 0;
+        int digits = 0;
+        while (i < len && hexValue(str[i].unicode()) >= 0) {
+            if (++digits > 4)
+                return false;
+            value = value * 16 + hexValue(str[i].unicode());
+            i++;
+        }
+        if (i < len && str[i] == '.') {
+            quint8 ipv4[4];
+            if (count > 6 || !parseIPv4(str.mid(start), ipv4))
+                return false;
+            groups[count++] = static_cast<quint16>(ipv4[0] << 8 | ipv4[1]);
+            groups[count++] = static_cast<quint16>(ipv4[2] << 8 | ipv4[3]);
+            break;
+        }
+        if (digits == 0 || count == 8)
+            return false;
+        groups[count++] = static_cast<quint16>(value);
+        if (i == len)
+            break;
+        if (str[i] != ':')
+            return false;
+        i++;
+        if (i < len && str[i] == ':') {
+            if (compressAt >= 0)
+                return false;
+            compressAt = count;
+            i++;
+        } else if (i == len) {
+            return false;
+        }
+    }
+
+    if (compressAt < 0) {
+        if (count != 8)
+            return false;
+    } else {
+        // "::" stands for one group at least
+        if (count > 7)
+            return false;
+        const int tail = count - compressAt;
+        for (int g = 0; g < tail; ++g) {
+            groups[7 - g] = groups[count - 1 - g];
+            groups[count - 1 - g] = 0;
+        }
+    }
+
+    for (int g = 0; g < 8; ++g) {
+        out[g * 2] = static_cast<quint8>(groups[g] >> 8);
+        out[g * 2 + 1] = static_cast<quint8>(groups[g]);
+    }
+    return true;
+}
+
+int formatIPv4(const quint8 *bytes, char *out)
+{
+    char *p = out;
+    for (int i = 0; i < 4; ++i) {
+        if (i > 0)
+            *p++ = '.';
+        const int v = bytes[i];
+        if (v >= 100)
+            *p++ = static_cast<char>('0' + v / 100);
+        if (v >= 10)
+            *p++ = static_cast<char>('0' + v / 10 % 10);
+        *p++ = static_cast<char>('0' + v % 10);
+    }
+    return static_cast<int>(p - out);
+}
+
+} // namespace
+
+IpAddress IpAddress::fromString(QStringView str)
+{
+    IpAddress addr;
+    if (parseIPv4(str, addr.bytes_)) {
+        addr.family_ = kIPv4;
+    } else if (str.contains(':') && parseIPv6(str, addr.bytes_)) {
+        addr.family_ = kIPv6;
+    } else {
+        addr = IpAddress();
+    }
+    return addr;
+}
+
+IpAddress IpAddress::fromIPv4(quint32 ip)
+{
+    IpAddress addr;
+    addr.bytes_[0] = static_cast<quint8>(ip >> 24);
+    addr.bytes_[1] = static_cast<quint8>(ip >> 16);
+    addr.bytes_[2] = static_cast<quint8>(ip >> 8);
+    addr.bytes_[3] = static_cast<quint8>(ip);
+    addr.family_ = kIPv4;
+    return addr;
+}
+
+quint32 IpAddress::toIPv4() const
+{
+    if (family_ != kIPv4)
+        return 0;
+    return static_cast<quint32>(bytes_[0]) << 24 | static_cast<quint32>(bytes_[1]) << 16 | static_cast<quint32>(bytes_[2]) << 8 | bytes_[3];
+}
+
+QString IpAddress::toString() const
+{
+    char buf[48];
+    int len = 0;
+    if (family_ == kIPv4) {
+        len = formatIPv4(bytes_, buf);
+    } else if (family_ == kIPv6) {
+        quint16 groups[8];
+        for (int g = 0; g < 8; ++g)
+            groups[g] = static_cast<quint16>(bytes_[g * 2] << 8 | bytes_[g * 2 + 1]);
+
+        // IPv4-mapped addresses keep the dotted form
+        static const quint8 kMappedPrefix[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+        if (std::memcmp(bytes_, kMappedPrefix, sizeof(kMappedPrefix)) == 0) {
+            std::memcpy(buf, "::ffff:", 7);
+            len = 7 + formatIPv4(bytes_ + 12, buf + 7);
+            return QString::fromLatin1(buf, len);
+        }
+
+        // the first longest run of two zero groups or more is compressed
+        int bestStart = -1, bestLen = 1;
+        for (int g = 0; g < 8;) {
+            if (groups[g] != 0) {
+                g++;
+                continue;
+            }
+            int end = g;
+            while (end < 8 && groups[end] == 0)
+                end++;
+            if (end - g > bestLen) {
+                bestStart = g;
+                bestLen = end - g;
+            }
+            g = end;
+        }
+
+        static const char kHex[] = "0123456789abcdef";
+        for (int g = 0; g < 8; ++g) {
+            if (g == bestStart) {
+                buf[len++] = ':';
+                if (g == 0)
+                    buf[len++] = ':';
+                g += bestLen - 1;
+                continue;
+            }
+            bool isStarted = false;
+            for (int shift = 12; shift >= 0; shift -= 4) {
+                const int digit = (groups[g] >> shift) & 0xf;
+                if (digit != 0 || isStarted || shift == 0) {
+                    buf[len++] = kHex[digit];
+                    isStarted = true;
+                }
+            }
+            if (g < 7)
+                buf[len++] = ':';
+        }
+    }
+    return QString::fromLatin1(buf, len);
+}
+
+bool IpAddress::operator<(const IpAddress &other) const
+{
+    if (family_ != other.family_)
+        return family_ < other.family_;
+    return std::memcmp(bytes_, other.bytes_, sizeof(bytes_)) < 0;
+}
+
+size_t IpAddress::hash(size_t seed) const
+{
+    quint64 a, b;
+    std::memcpy(&a, bytes_, sizeof(a));
+    std::memcpy(&b, bytes_ + 8, sizeof(b));
+    // the finalizer of MurmurHash3 over a mix of the two halves
+    quint64 h = a * Q_UINT64_C(0x9E3779B97F4A7C15) ^ (b + family_) * Q_UINT64_C(0xC2B2AE3D27D4EB4F) ^ seed;
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xff51afd7ed558ccd);
+    h ^= h >> 33;
+    h *= Q_UINT64_C(0xc4ceb9fe1a85ec53);
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QString>
+#include <QStringView>
+#include <cstring>
+
+// An IPv4 or IPv6 address as a trivially copyable value, so the sets of ips don't allocate or hash strings.
+// The strings are parsed and formatted only where the addresses come from and go to the text (API, DNS, firewall rules).
+// IPv4 addresses keep their 4 bytes at the start of the buffer, the rest is zero.
+class IpAddress
+{
+public:
+    enum Family : quint8 { kInvalid = 0, kIPv4 = 4, kIPv6 = 6 };
+
+    IpAddress() = default;
+    // a plain address only: no CIDR suffix, port or IPv6 scope, the invalid address otherwise
+    static IpAddress fromString(QStringView str);
+    static IpAddress fromIPv4(quint32 ip);     // host byte order
+
+    bool isValid() const { return family_ != kInvalid; }
+    Family family() const { return family_; }
+    bool isIPv4() const { return family_ == kIPv4; }
+    bool isIPv6() const { return family_ == kIPv6; }
+    quint32 toIPv4() const;                     // host byte order
+    const quint8 *bytes() const { return bytes_; }
+
+    // IPv6 in the RFC 5952 form, an empty string for the invalid address
+    QString toString() const;
+
+    bool operator==(const IpAddress &other) const { return family_ == other.family_ && std::memcmp(bytes_, other.bytes_, sizeof(bytes_)) == 0; }
+    bool operator!=(const IpAddress &other) const { return !(*this == other); }
+    bool operator<(const IpAddress &other) const;
+
+    size_t hash(size_t seed = 0) const;
+
+private:
+    alignas(8) quint8 bytes_[16] = {};
+    Family family_ = kInvalid;
+};
+
+Q_DECLARE_TYPEINFO(IpAddress, Q_PRIMITIVE_TYPE);
+
+inline size_t qHash(const IpAddress &key, size_t seed = 0)
+{
+    return key.hash(seed);
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <QMetaType>
+#include <QSet>
+#include <QString>
+#include <vector>
+
+#include "ipaddress.h"
+#include "utils/ws_assert.h"
+
+// An open addressing hash map keyed by IpAddress: the keys and the values are stored inline in one array with linear probing,
+// an empty slot has the invalid address as its key, so the keys must be valid addresses.
+// Inserting may rehash, which invalidates the iterators and the pointers to the values.
+template <typename T>
+class IpAddressMap
+{
+    struct Slot
+    {
+        IpAddress key;
+        T value {};
+    };
+
+public:
+    class const_iterator
+    {
+    public:
+        const IpAddress &key() const { return slot_->key; }
+        const T &value() const { return slot_->value; }
+        // the iterator itself, so a range-based for loop gives key() and value()
+        const const_iterator &operator*() const { return *this; }
+        const_iterator &operator++() { ++slot_; skipEmpty(); return *this; }
+        bool operator==(const const_iterator &other) const { return slot_ == other.slot_; }
+        bool operator!=(const const_iterator &other) const { return slot_ != other.slot_; }
+
+    private:
+        friend class IpAddressMap;
+        const_iterator(const Slot *slot, const Slot *end) : slot_(slot), end_(end) { skipEmpty(); }
+        void skipEmpty() { while (slot_ != end_ && !slot_->key.isValid()) ++slot_; }
+
+        const Slot *slot_;
+        const Slot *end_;
+    };
+
+    // the values can be changed in place, the keys can't
+    class iterator
+    {
+    public:
+        const IpAddress &key() const { return slot_->key; }
+        T &value() const { return slot_->value; }
+        const iterator &operator*() const { return *this; }
+        iterator &operator++() { ++slot_; skipEmpty(); return *this; }
+        bool operator==(const iterator &other) const { return slot_ == other.slot_; }
+        bool operator!=(const iterator &other) const { return slot_ != other.slot_; }
+
+    private:
+        friend class IpAddressMap;
+        iterator(Slot *slot, Slot *end) : slot_(slot), end_(end) { skipEmpty(); }
+        void skipEmpty() { while (slot_ != end_ && !slot_->key.isValid()) ++slot_; }
+
+        Slot *slot_;
+        Slot *end_;
+    };
+
+    int size() const { return size_; }
+    bool isEmpty() const { return size_ == 0; }
+
+    void clear()
+    {
+        slots_.clear();
+        size_ = 0;
+    }
+
+    void reserve(int count)
+    {
+        int capacity = kMinCapacity;
+        while (capacity < count * 2)
+            capacity *= 2;
+        if (capacity > static_cast<int>(slots_.size()))
+            rehash(capacity);
+    }
+
+    const T *find(const IpAddress &key) const
+    {
+        const int ind = indexOf(key);
+        return ind >= 0 ? &slots_[ind].value : nullptr;
+    }
+
+    T *find(const IpAddress &key)
+    {
+        const int ind = indexOf(key);
+        return ind >= 0 ? &slots_[ind].value : nullptr;
+    }
+
+    bool contains(const IpAddress &key) const { return indexOf(key) >= 0; }
+
+    T value(const IpAddress &key, const T &defaultValue = T()) const
+    {
+        const T *v = find(key);
+        return v ? *v : defaultValue;
+    }
+
+    // inserts a default value if there is no such key
+    T &operator[](const IpAddress &key)
+    {
+        WS_ASSERT(key.isValid());
+        if ((size_ + 1) * 2 > static_cast<int>(slots_.size()))
+            rehash(slots_.empty() ? kMinCapacity : static_cast<int>(slots_.size()) * 2);
+        const int mask = static_cast<int>(slots_.size()) - 1;
+        for (int i = static_cast<int>(key.hash()) & mask; ; i = (i + 1) & mask) {
+            if (slots_[i].key == key)
+                return slots_[i].value;
+            if (!slots_[i].key.isValid()) {
+                slots_[i].key = key;
+                size_++;
+                return slots_[i].value;
+            }
+        }
+    }
+
+    // returns true if the key is new
+    bool insert(const IpAddress &key, const T &value)
+    {
+        const int before = size_;
+        (*this)[key] = value;
+        return size_ != before;
+    }
+
+    bool remove(const IpAddress &key)
+    {
+        int ind = indexOf(key);
+        if (ind < 0)
+            return false;
+        // backward shift deletion, so the probe sequences stay without holes and no tombstones are needed
+        const int mask = static_cast<int>(slots_.size()) - 1;
+        for (int next = (ind + 1) & mask; slots_[next].key.isValid(); next = (next + 1) & mask) {
+            const int home = static_cast<int>(slots_[next].key.hash()) & mask;
+            // the entry can move to the hole if its home slot is not between the hole and its position
+            if (((next - home) & mask) >= ((next - ind) & mask)) {
+                slots_[ind] = std::move(slots_[next]);
+                ind = next;
+            }
+        }
+        slots_[ind] = Slot();
+        size_--;
+        return true;
+    }
+
+    const_iterator begin() const { return const_iterator(slots_.data(), slots_.data() + slots_.size()); }
+    const_iterator end() const { return const_iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size()); }
+    iterator begin() { return iterator(slots_.data(), slots_.data() + slots_.size()); }
+    iterator end() { return iterator(slots_.data() + slots_.size(), slots_.data() + slots_.size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+private:
+    static constexpr int kMinCapacity = 16;
+
+    std::vector<Slot> slots_;   // the size is a power of two, at most half full
+    int size_ = 0;
+
+    int indexOf(const IpAddress &key) const
+    {
+        if (slots_.empty() || !key.isValid())
+            return -1;
+        const int mask = static_cast<int>(slots_.size()) - 1;
+        for (int i = static_cast<int>(key.hash()) & mask; slots_[i].key.isValid(); i = (i + 1) & mask) {
+            if (slots_[i].key == key)
+                return i;
+        }
+        return -1;
+    }
+
+    void rehash(int capacity)
+    {
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        const int mask = capacity - 1;
+        for (Slot &slot : old) {
+            if (!slot.key.isValid())
+                continue;
+            int i = static_cast<int>(slot.key.hash()) & mask;
+            while (slots_[i].key.isValid())
+                i = (i + 1) & mask;
+            slots_[i] = std::move(slot);
+        }
+    }
+};
+
+// A set of the addresses on top of IpAddressMap.
+class IpAddressSet
+{
+public:
+    class const_iterator
+    {
+    public:
+        const IpAddress &operator*() const { return it_.key(); }
+        const_iterator &operator++() { ++it_; return *this; }
+        bool operator==(const const_iterator &other) const { return it_ == other.it_; }
+        bool operator!=(const const_iterator &other) const { return it_ != other.it_; }
+
+    private:
+        friend class IpAddressSet;
+        explicit const_iterator(IpAddressMap<bool>::const_iterator it) : it_(it) {}
+        IpAddressMap<bool>::const_iterator it_;
+    };
+
+    int size() const { return map_.size(); }
+    bool isEmpty() const { return map_.isEmpty(); }
+    void clear() { map_.clear(); }
+    void reserve(int count) { map_.reserve(count); }
+    bool contains(const IpAddress &ip) const { return map_.contains(ip); }
+    // returns true if the address is new
+    bool insert(const IpAddress &ip) { return map_.insert(ip, true); }
+    bool remove(const IpAddress &ip) { return map_.remove(ip); }
+
+    const_iterator begin() const { return const_iterator(map_.begin()); }
+    const_iterator end() const { return const_iterator(map_.end()); }
+
+    bool operator==(const IpAddressSet &other) const
+    {
+        if (size() != other.size())
+            return false;
+        for (const IpAddress &ip : *this) {
+            if (!other.contains(ip))
+                return false;
+        }
+        return true;
+    }
+    bool operator!=(const IpAddressSet &other) const { return !(*this == other); }
+
+    // the strings for the firewall and the logs
+    QSet<QString> toStringSet() const
+    {
+        QSet<QString> set;
+        set.reserve(size());
+        for (const IpAddress &ip : *this)
+            set.insert(ip.toString());
+        return set;
+    }
+
+private:
+    IpAddressMap<bool> map_;
+};
+
+Q_DECLARE_METATYPE(IpAddressSet)
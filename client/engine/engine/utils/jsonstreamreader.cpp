@@ -0,0 +1,374 @@
+#include "jsonstreamreader.h"
+
+#include <cstring>
+
+namespace {
+
+bool isWhitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNumberChar(char c)
+{
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool readHex4(const char *p, uint &outValue)
+{
+    outValue = 0;
+    for (int i = 0; i < 4; ++i) {
+        const int v = hexValue(p[i]);
+        if (v < 0)
+            return false;
+        outValue = (outValue << 4) | v;
+    }
+    return true;
+}
+
+} // namespace
+
+JsonStreamReader::JsonStreamReader(Handler *handler) : handler_(handler), pos_(0), consumedBytes_(0), isFinished_(false),
+    expect_(Expect::kValue)
+{
+}
+
+bool JsonStreamReader::addData(const QByteArray &data)
+{
+    if (hasError())
+        return false;
+
+    if (pos_ > 0) {
+        consumedBytes_ += pos_;
+        buffer_.remove(0, pos_);
+        pos_ = 0;
+    }
+    // in most cases the previous chunk is consumed completely and the new one is used without copying
+    if (buffer_.isEmpty())
+        buffer_ = data;
+    else
+        buffer_.append(data);
+
+    parse();
+    return !hasError();
+}
+
+bool JsonStreamReader::finish()
+{
+    if (hasError())
+        return false;
+
+    isFinished_ = true;
+    parse();
+    if (!hasError() && expect_ != Expect::kDone)
+        setError("unexpected end of data", buffer_.size());
+    return !hasError();
+}
+
+void JsonStreamReader::parse()
+{
+    while (!hasError()) {
+        const char *begin = buffer_.constData();
+        const char *end = begin + buffer_.size();
+        const char *p = begin + pos_;
+        while (p < end && isWhitespace(*p))
+            ++p;
+        pos_ = p - begin;
+        if (p == end)
+            return;
+
+        const char c = *p;
+        switch (expect_) {
+            case Expect::kDone:
+                setError("garbage after the JSON value", pos_);
+                return;
+
+            case Expect::kColon:
+                if (c != ':') {
+                    setError("colon expected", pos_);
+                    return;
+                }
+                pos_++;
+                expect_ = Expect::kValue;
+                break;
+
+            case Expect::kCommaOrEnd:
+                if (c == ',') {
+                    pos_++;
+                    expect_ = (stack_.last() == '{') ? Expect::kKey : Expect::kValue;
+                } else if (c == (stack_.last() == '{' ? '}' : ']')) {
+                    pos_++;
+                    const char container = stack_.takeLast();
+                    afterValue();
+                    if (container == '{')
+                        handler_->endObject();
+                    else
+                        handler_->endArray();
+                } else {
+                    setError("comma or end of the container expected", pos_);
+                    return;
+                }
+                break;
+
+            case Expect::kFirstKeyOrEnd:
+                if (c == '}') {
+                    pos_++;
+                    stack_.removeLast();
+                    afterValue();
+                    handler_->endObject();
+                    break;
+                }
+                Q_FALLTHROUGH();
+            case Expect::kKey:
+            {
+                if (c != '"') {
+                    setError("key expected", pos_);
+                    return;
+                }
+                const TokenResult res = readString(p, end);
+                if (res != TokenResult::kOk)
+                    return;
+                pos_ = p - begin;
+                expect_ = Expect::kColon;
+                handler_->key(scratch_);
+                break;
+            }
+
+            case Expect::kFirstValueOrEnd:
+                if (c == ']') {
+                    pos_++;
+                    stack_.removeLast();
+                    afterValue();
+                    handler_->endArray();
+                    break;
+                }
+                Q_FALLTHROUGH();
+            case Expect::kValue:
+                if (readValue() != TokenResult::kOk)
+                    return;
+                break;
+        }
+    }
+}
+
+JsonStreamReader::TokenResult JsonStreamReader::readValue()
+{
+    const char *begin = buffer_.constData();
+    const char *end = begin + buffer_.size();
+    const char *p = begin + pos_;
+
+    switch (*p) {
+        case '{':
+        case '[':
+            if (stack_.size() >= kMaxDepth) {
+                setError("too deep nesting", pos_);
+                return TokenResult::kError;
+            }
+            pos_++;
+            stack_ << *p;
+            if (*p == '{') {
+                expect_ = Expect::kFirstKeyOrEnd;
+                handler_->startObject();
+            } else {
+                expect_ = Expect::kFirstValueOrEnd;
+                handler_->startArray();
+            }
+            return TokenResult::kOk;
+
+        case '"':
+        {
+            const TokenResult res = readString(p, end);
+            if (res == TokenResult::kOk) {
+                pos_ = p - begin;
+                afterValue();
+                handler_->stringValue(scratch_);
+            }
+            return res;
+        }
+
+        case 't':
+        case 'f':
+        case 'n':
+        {
+            const char *literal = (*p == 't') ? "true" : (*p == 'f' ? "false" : "null");
+            const TokenResult res = readLiteral(p, end, literal);
+            if (res == TokenResult::kOk) {
+                pos_ = p - begin;
+                afterValue();
+                if (literal[0] == 'n')
+                    handler_->nullValue();
+                else
+                    handler_->boolValue(literal[0] == 't');
+            }
+            return res;
+        }
+
+        default:
+            if (*p == '-' || (*p >= '0' && *p <= '9')) {
+                double value;
+                const TokenResult res = readNumber(p, end, value);
+                if (res == TokenResult::kOk) {
+                    pos_ = p - begin;
+                    afterValue();
+                    handler_->numberValue(value);
+                }
+                return res;
+            }
+            setError("unexpected character", pos_);
+            return TokenResult::kError;
+    }
+}
+
+JsonStreamReader::TokenResult JsonStreamReader::readString(const char *&p, const char *end)
+{
+    const char *begin = buffer_.constData();
+
+    // find the closing quote first, the string is decoded only when it's complete
+    const char *q = p + 1;
+    bool hasEscapes = false;
+    while (q < end && *q != '"') {
+        if (*q == '\\') {
+            hasEscapes = true;
+            q += 2;
+        } else {
+            if ((uchar)*q < 0x20) {
+                setError("control character in a string", q - begin);
+                return TokenResult::kError;
+            }
+            ++q;
+        }
+    }
+    if (q >= end) {
+        if (isFinished_) {
+            setError("unterminated string", p - begin);
+            return TokenResult::kError;
+        }
+        return TokenResult::kNeedMoreData;
+    }
+
+    scratch_.truncate(0);
+    if (!hasEscapes) {
+        scratch_.append(p + 1, q - p - 1);
+        p = q + 1;
+        return TokenResult::kOk;
+    }
+
+    for (const char *s = p + 1; s < q; ++s) {
+        if (*s != '\\') {
+            scratch_.append(*s);
+            continue;
+        }
+        ++s;
+        switch (*s) {
+            case '"':  scratch_.append('"'); break;
+            case '\\': scratch_.append('\\'); break;
+            case '/':  scratch_.append('/'); break;
+            case 'b':  scratch_.append('\b'); break;
+            case 'f':  scratch_.append('\f'); break;
+            case 'n':  scratch_.append('\n'); break;
+            case 'r':  scratch_.append('\r'); break;
+            case 't':  scratch_.append('\t'); break;
+            case 'u':
+            {
+                uint codePoint;
+                if (q - s < 5 || !readHex4(s + 1, codePoint)) {
+                    setError("invalid unicode escape", s - begin);
+                    return TokenResult::kError;
+                }
+                s += 4;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    uint low;
+                    if (q - s >= 7 && s[1] == '\\' && s[2] == 'u' && readHex4(s + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        s += 6;
+                    } else {
+                        codePoint = 0xFFFD;
+                    }
+                } else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF) {
+                    codePoint = 0xFFFD;
+                }
+                appendUtf8(codePoint);
+                break;
+            }
+            default:
+                setError("invalid escape sequence", s - begin);
+                return TokenResult::kError;
+        }
+    }
+    p = q + 1;
+    return TokenResult::kOk;
+}
+
+JsonStreamReader::TokenResult JsonStreamReader::readNumber(const char *&p, const char *end, double &outValue)
+{
+    const char *q = p;
+    while (q < end && isNumberChar(*q))
+        ++q;
+    // the number may continue in the next chunk
+    if (q == end && !isFinished_)
+        return TokenResult::kNeedMoreData;
+
+    bool ok;
+    outValue = QByteArray::fromRawData(p, q - p).toDouble(&ok);
+    if (!ok) {
+        setError("invalid number", p - buffer_.constData());
+        return TokenResult::kError;
+    }
+    p = q;
+    return TokenResult::kOk;
+}
+
+JsonStreamReader::TokenResult JsonStreamReader::readLiteral(const char *&p, const char *end, const char *literal)
+{
+    const int len = strlen(literal);
+    const int available = end - p;
+    if (available < len) {
+        if (!isFinished_ && memcmp(p, literal, available) == 0)
+            return TokenResult::kNeedMoreData;
+        setError("invalid literal", p - buffer_.constData());
+        return TokenResult::kError;
+    }
+    if (memcmp(p, literal, len) != 0) {
+        setError("invalid literal", p - buffer_.constData());
+        return TokenResult::kError;
+    }
+    p += len;
+    return TokenResult::kOk;
+}
+
+void JsonStreamReader::afterValue()
+{
+    expect_ = stack_.isEmpty() ? Expect::kDone : Expect::kCommaOrEnd;
+}
+
+void JsonStreamReader::appendUtf8(uint codePoint)
+{
+    if (codePoint < 0x80) {
+        scratch_.append(char(codePoint));
+    } else if (codePoint < 0x800) {
+        scratch_.append(char(0xC0 | (codePoint >> 6)));
+        scratch_.append(char(0x80 | (codePoint & 0x3F)));
+    } else if (codePoint < 0x10000) {
+        scratch_.append(char(0xE0 | (codePoint >> 12)));
+        scratch_.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        scratch_.append(char(0x80 | (codePoint & 0x3F)));
+    } else {
+        scratch_.append(char(0xF0 | (codePoint >> 18)));
+        scratch_.append(char(0x80 | ((codePoint >> 12) & 0x3F)));
+        scratch_.append(char(0x80 | ((codePoint >> 6) & 0x3F)));
+        scratch_.append(char(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+void JsonStreamReader::setError(const QString &message, int pos)
+{
+    errorString_ = QString("%1 at offset %2").arg(message).arg(consumedBytes_ + pos);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Incremental (SAX style) JSON reader, no document tree is built.
+// The data can be fed in chunks of any size as it arrives from the network. Complete tokens are reported to the handler immediately,
+// an incomplete token at the end of a chunk is kept until the next chunk.
+// Keys and string values are passed as decoded UTF-8 in a reused buffer, so the handler decides which of them to convert to QString.
+class JsonStreamReader
+{
+public:
+    class Handler
+    {
+    public:
+        virtual ~Handler() {}
+        virtual void startObject() = 0;
+        virtual void endObject() = 0;
+        virtual void startArray() = 0;
+        virtual void endArray() = 0;
+        virtual void key(const QByteArray &utf8) = 0;
+        virtual void stringValue(const QByteArray &utf8) = 0;
+        virtual void numberValue(double value) = 0;
+        virtual void boolValue(bool value) = 0;
+        virtual void nullValue() = 0;
+    };
+
+    explicit JsonStreamReader(Handler *handler);
+
+    // returns false if the data is not a correct JSON, the rest of the data is ignored after an error
+    bool addData(const QByteArray &data);
+    // must be called after the last chunk, returns true if exactly one complete JSON value was read
+    bool finish();
+
+    bool hasError() const { return !errorString_.isEmpty(); }
+    QString errorString() const { return errorString_; }
+
+private:
+    enum class Expect { kValue, kFirstKeyOrEnd, kKey, kColon, kFirstValueOrEnd, kCommaOrEnd, kDone };
+    enum class TokenResult { kOk, kNeedMoreData, kError };
+
+    static constexpr int kMaxDepth = 1024;      // the same limit as QJsonDocument
+
+    Handler *handler_;
+    QByteArray buffer_;         // not consumed yet data
+    int pos_;
+    qint64 consumedBytes_;      // to report the offset of errors
+    bool isFinished_;
+    Expect expect_;
+    QVector<char> stack_;       // '{' or '['
+    QByteArray scratch_;        // decoded string
+    QString errorString_;
+
+    void parse();
+    TokenResult readValue();
+    TokenResult readString(const char *&p, const char *end);
+    TokenResult readNumber(const char *&p, const char *end, double &outValue);
+    TokenResult readLiteral(const char *&p, const char *end, const char *literal);
+    void afterValue();
+    void appendUtf8(uint codePoint);
+    void setError(const QString &message, int pos);
+};
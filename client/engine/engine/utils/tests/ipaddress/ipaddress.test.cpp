@@ -0,0 +1,134 @@
+#include <QtTest>
+#include <QRandomGenerator>
+#include <QHash>
+#include "engine/utils/ipaddressmap.h"
+
+class TestIpAddress : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testParse_data();
+    void testParse();
+    void testIPv4();
+    void testMap();
+    void testSet();
+};
+
+void TestIpAddress::testParse_data()
+{
+    QTest::addColumn<QString>("input");
+    QTest::addColumn<QString>("output");     // empty if invalid
+
+    QTest::newRow("v4") << "1.2.3.4" << "1.2.3.4";
+    QTest::newRow("v4 max") << "255.255.255.255" << "255.255.255.255";
+    QTest::newRow("v4 leading zeros") << "010.001.0.1" << "10.1.0.1";
+    QTest::newRow("v4 out of range") << "256.1.1.1" << "";
+    QTest::newRow("v4 short") << "1.2.3" << "";
+    QTest::newRow("v4 long") << "1.2.3.4.5" << "";
+    QTest::newRow("v4 empty part") << "1..2.3" << "";
+    QTest::newRow("v4 cidr") << "1.2.3.4/32" << "";
+    QTest::newRow("empty") << "" << "";
+    QTest::newRow("hostname") << "windscribe.com" << "";
+
+    QTest::newRow("v6 any") << "::" << "::";
+    QTest::newRow("v6 loopback") << "::1" << "::1";
+    QTest::newRow("v6 trailing") << "1::" << "1::";
+    QTest::newRow("v6 compressed") << "2001:DB8:0:0:0:0:2:1" << "2001:db8::2:1";
+    QTest::newRow("v6 single zero group") << "2001:db8:0:1:1:1:1:1" << "2001:db8:0:1:1:1:1:1";
+    QTest::newRow("v6 longest run") << "2001:0:0:1:0:0:0:1" << "2001:0:0:1::1";
+    QTest::newRow("v6 first run") << "2001:db8::1:0:0:1" << "2001:db8::1:0:0:1";
+    QTest::newRow("v6 mapped") << "::ffff:1.2.3.4" << "::ffff:1.2.3.4";
+    QTest::newRow("v6 embedded v4") << "1:2:3:4:5:6:1.2.3.4" << "1:2:3:4:5:6:102:304";
+    QTest::newRow("v6 too many groups") << "1:2:3:4:5:6:7:8:9" << "";
+    QTest::newRow("v6 triple colon") << "1:::2" << "";
+    QTest::newRow("v6 two compressions") << "1::2::3" << "";
+    QTest::newRow("v6 leading colon") << ":1::" << "";
+    QTest::newRow("v6 trailing colon") << "1:" << "";
+    QTest::newRow("v6 long group") << "12345::" << "";
+    QTest::newRow("v6 scope") << "fe80::1%eth0" << "";
+}
+
+void TestIpAddress::testParse()
+{
+    QFETCH(QString, input);
+    QFETCH(QString, output);
+    const IpAddress ip = IpAddress::fromString(input);
+    QCOMPARE(ip.isValid(), !output.isEmpty());
+    QCOMPARE(ip.toString(), output);
+    if (ip.isValid())
+        QCOMPARE(IpAddress::fromString(ip.toString()), ip);
+}
+
+void TestIpAddress::testIPv4()
+{
+    const IpAddress ip = IpAddress::fromString(QString("10.0.0.1"));
+    QVERIFY(ip.isIPv4());
+    QCOMPARE(ip.toIPv4(), 0x0A000001u);
+    QCOMPARE(IpAddress::fromIPv4(0x0A000001), ip);
+    QVERIFY(IpAddress::fromString(QString("::a00:1")) != ip);
+    QVERIFY(IpAddress::fromString(QString("10.0.0.1")) < IpAddress::fromString(QString("10.0.0.2")));
+}
+
+void TestIpAddress::testMap()
+{
+    // random inserts and removes against QHash
+    QRandomGenerator rnd(42);
+    IpAddressMap<int> map;
+    QHash<quint32, int> ref;
+    for (int step = 0; step < 100000; ++step)
+    {
+        const quint32 key = rnd.bounded(300);
+        const IpAddress ip = IpAddress::fromIPv4(key);
+        switch (rnd.bounded(3))
+        {
+        case 0:
+            map[ip] = step;
+            ref[key] = step;
+            break;
+        case 1:
+            QCOMPARE(map.remove(ip), ref.remove(key) > 0);
+            break;
+        default:
+            QCOMPARE(map.contains(ip), ref.contains(key));
+            QCOMPARE(map.value(ip, -1), ref.value(key, -1));
+        }
+        QCOMPARE(map.size(), ref.size());
+    }
+
+    int count = 0;
+    for (const auto &it : map)
+    {
+        QCOMPARE(it.value(), ref.value(it.key().toIPv4()));
+        count++;
+    }
+    QCOMPARE(count, ref.size());
+
+    // the values are changed in place
+    for (const auto &it : map)
+        it.value() = -it.value();
+    for (auto it = ref.cbegin(); it != ref.cend(); ++it)
+        QCOMPARE(map.value(IpAddress::fromIPv4(it.key())), -it.value());
+
+    map.clear();
+    QVERIFY(map.isEmpty());
+    QVERIFY(!map.contains(IpAddress::fromIPv4(1)));
+}
+
+void TestIpAddress::testSet()
+{
+    IpAddressSet a, b;
+    QVERIFY(a.insert(IpAddress::fromString(QString("1.2.3.4"))));
+    QVERIFY(!a.insert(IpAddress::fromString(QString("1.2.3.4"))));
+    a.insert(IpAddress::fromString(QString("2001:db8::1")));
+    b.insert(IpAddress::fromString(QString("2001:db8::1")));
+    QVERIFY(a != b);
+    b.insert(IpAddress::fromString(QString("1.2.3.4")));
+    QVERIFY(a == b);
+    QCOMPARE(a.toStringSet(), QSet<QString>({ "1.2.3.4", "2001:db8::1" }));
+    QVERIFY(a.remove(IpAddress::fromString(QString("1.2.3.4"))));
+    QCOMPARE(a.size(), 1);
+}
+
+QTEST_MAIN(TestIpAddress)
+#include "ipaddress.test.moc"
@@ -0,0 +1,178 @@
+#include <QtTest>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "engine/utils/timerwheel.h"
+
+class TestTimerWheel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSingleShot();
+    void testRepeating();
+    void testSlackWindow();
+    void testCoalescing();
+    void testStopFromTimeout();
+    void testDeleteFromTimeout();
+    void testRestart();
+    void testFarDeadline();
+};
+
+void TestTimerWheel::testSingleShot()
+{
+    WheelTimer timer;
+    timer.setSingleShot(true);
+    timer.setSlack(0);
+    QSignalSpy spy(&timer, &WheelTimer::timeout);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    timer.start(50);
+    QVERIFY(timer.isActive());
+    QVERIFY(spy.wait(2000));
+    QVERIFY(elapsed.elapsed() >= 50);
+    QVERIFY(!timer.isActive());
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestTimerWheel::testRepeating()
+{
+    WheelTimer timer;
+    timer.setSlack(0);
+    QSignalSpy spy(&timer, &WheelTimer::timeout);
+    timer.start(20);
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 5, 2000);
+    QVERIFY(timer.isActive());
+    timer.stop();
+    const int count = spy.count();
+    QTest::qWait(100);
+    QCOMPARE(spy.count(), count);
+}
+
+void TestTimerWheel::testSlackWindow()
+{
+    // intervals and slacks which land on different levels
+    const struct { int interval; int slack; } params[] = {
+        { 1, 0 }, { 30, 0 }, { 70, 5 }, { 100, 0 }, { 130, 64 }, { 250, 10 }, { 300, 300 }, { 520, 0 }, { 700, 100 },
+    };
+    constexpr int kTolerance = 50;      // the latency of the event loop
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    std::vector<std::unique_ptr<WheelTimer>> timers;
+    std::vector<qint64> fired(std::size(params), -1);
+    for (size_t i = 0; i < std::size(params); ++i)
+    {
+        timers.emplace_back(new WheelTimer());
+        WheelTimer *timer = timers.back().get();
+        timer->setSingleShot(true);
+        timer->setSlack(params[i].slack);
+        connect(timer, &WheelTimer::timeout, this, [&fired, &elapsed, i]() { fired[i] = elapsed.elapsed(); });
+        timer->start(params[i].interval);
+    }
+    QTRY_VERIFY_WITH_TIMEOUT(std::count(fired.begin(), fired.end(), -1) == 0, 5000);
+    for (size_t i = 0; i < std::size(params); ++i)
+    {
+        QVERIFY2(fired[i] >= params[i].interval, qPrintable(QString("%1: %2").arg(params[i].interval).arg(fired[i])));
+        QVERIFY2(fired[i] <= params[i].interval + params[i].slack + kTolerance, qPrintable(QString("%1: %2").arg(params[i].interval).arg(fired[i])));
+    }
+}
+
+void TestTimerWheel::testCoalescing()
+{
+    // the deadlines are spread over 400 ms, the slack lets them merge into one or two wakeups
+    std::vector<std::unique_ptr<WheelTimer>> timers;
+    int count = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        timers.emplace_back(new WheelTimer());
+        timers.back()->setSingleShot(true);
+        timers.back()->setSlack(600);
+        connect(timers.back().get(), &WheelTimer::timeout, this, [&count]() { count++; });
+    }
+    const int wakeupsBefore = TimerWheel::instance()->wakeups();
+    for (int i = 0; i < 10; ++i)
+        timers[i]->start(200 + i * 40);
+    QTRY_COMPARE_WITH_TIMEOUT(count, 10, 5000);
+    QVERIFY(TimerWheel::instance()->wakeups() - wakeupsBefore <= 3);
+}
+
+void TestTimerWheel::testStopFromTimeout()
+{
+    WheelTimer first;
+    WheelTimer second;
+    for (WheelTimer *timer : { &first, &second })
+    {
+        timer->setSingleShot(true);
+        timer->setSlack(100);
+    }
+    // whichever fires first stops the other one in the same wakeup
+    int count = 0;
+    connect(&first, &WheelTimer::timeout, this, [&]() { count++; second.stop(); });
+    connect(&second, &WheelTimer::timeout, this, [&]() { count++; first.stop(); });
+    first.start(50);
+    second.start(50);
+    QTRY_COMPARE_WITH_TIMEOUT(count, 1, 2000);
+    QTest::qWait(300);
+    QCOMPARE(count, 1);
+}
+
+void TestTimerWheel::testDeleteFromTimeout()
+{
+    // whichever fires first deletes the other one, which is due in the same wakeup
+    QPointer<WheelTimer> first = new WheelTimer();
+    QPointer<WheelTimer> second = new WheelTimer();
+    int count = 0;
+    connect(first, &WheelTimer::timeout, this, [&]() { count++; delete second; first->deleteLater(); });
+    connect(second, &WheelTimer::timeout, this, [&]() { count++; delete first; second->deleteLater(); });
+    for (WheelTimer *timer : { first.data(), second.data() })
+    {
+        timer->setSingleShot(true);
+        timer->setSlack(100);
+        timer->start(50);
+    }
+    QTest::qWait(300);
+    QCOMPARE(count, 1);
+    QVERIFY(first.isNull() && second.isNull());
+}
+
+void TestTimerWheel::testRestart()
+{
+    WheelTimer timer;
+    timer.setSingleShot(true);
+    timer.setSlack(0);
+    QSignalSpy spy(&timer, &WheelTimer::timeout);
+    QElapsedTimer elapsed;
+    elapsed.start();
+    timer.start(100);
+    QTest::qWait(60);
+    timer.start(100);
+    QVERIFY(spy.wait(2000));
+    QVERIFY(elapsed.elapsed() >= 160);
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestTimerWheel::testFarDeadline()
+{
+    TimerWheel *wheel = TimerWheel::instance();
+    WheelTimer timer;
+    timer.setSlack(0);
+    timer.start(10 * 60 * 60 * 1000);
+    QVERIFY(timer.isActive());
+    QVERIFY(timer.remainingTime() > 10 * 60 * 60 * 1000 - 1000);
+    // waits on a coarse level, so the first wakeup is before the deadline
+    const qint64 wakeup = wheel->nextWakeup();
+    QVERIFY(wakeup > wheel->now());
+    QVERIFY(wakeup <= wheel->now() + timer.remainingTime());
+    timer.stop();
+    QVERIFY(!timer.isActive());
+    QCOMPARE(timer.remainingTime(), -1);
+}
+
+QTEST_MAIN(TestTimerWheel)
+#include "timerwheel.test.moc"
@@ -0,0 +1,272 @@
+#include "timerwheel.h"
+
+#include <QPointer>
+#include <QVector>
+#include <memory>
+
+#include "engine/metrics/metrics.h"
+#include "utils/ws_assert.h"
+
+// The wheel keeps current_, the time up to which all the slots are processed. Every timer in the wheel fires after current_
+// and within kSlots - 1 slots of its level from it, and its fire time is a multiple of the level granularity.
+// So a slot never holds timers of different fire times, and the first occupied slot after current_ on a level is the earliest one.
+
+TimerWheel *TimerWheel::instance()
+{
+    thread_local std::unique_ptr<TimerWheel> wheel(new TimerWheel());
+    return wheel.get();
+}
+
+TimerWheel::TimerWheel() : QObject(nullptr)
+{
+    clock_.start();
+    timer_.setSingleShot(true);
+    // the slack is already applied by the wheel
+    timer_.setTimerType(Qt::PreciseTimer);
+    connect(&timer_, &QTimer::timeout, this, &TimerWheel::onTimer);
+}
+
+TimerWheel::~TimerWheel()
+{
+    // the timers may outlive the thread
+    for (Level &level : levels_)
+    {
+        for (WheelTimer *&head : level.buckets)
+        {
+            for (WheelTimer *t = head; t != nullptr; t = t->next_)
+            {
+                t->level_ = WheelTimer::kNotInWheel;
+                t->wheel_ = nullptr;
+            }
+            head = nullptr;
+        }
+        level.occupied = 0;
+    }
+}
+
+qint64 TimerWheel::now() const
+{
+    return clock_.elapsed();
+}
+
+qint64 TimerWheel::nextWakeup() const
+{
+    qint64 wakeup = -1;
+    for (int l = 0; l < kLevels; ++l)
+    {
+        const Level &level = levels_[l];
+        if (level.occupied == 0)
+            continue;
+        const int from = static_cast<int>(((current_ >> (kLevelBits * l)) + 1) & (kSlots - 1));
+        const quint64 rotated = (level.occupied >> from) | (from == 0 ? 0 : level.occupied << (kSlots - from));
+        const int slot = (from + qCountTrailingZeroBits(rotated)) & (kSlots - 1);
+        const qint64 fireTime = level.buckets[slot]->fireTime_;
+        if (wakeup < 0 || fireTime < wakeup)
+            wakeup = fireTime;
+    }
+    return wakeup;
+}
+
+void TimerWheel::onTimer()
+{
+    static metrics::Counter &wakeupsMetric = metrics::counter("ws_timer_wheel_wakeups_total", "Wakeups of the engine timer wheels");
+    wakeupsMetric.inc();
+    wakeups_++;
+    scheduledWakeup_ = -1;
+
+    // take out the slots which are due
+    const qint64 now = this->now();
+    WheelTimer *due = nullptr;
+    for (int l = 0; l < kLevels; ++l)
+    {
+        Level &level = levels_[l];
+        const qint64 first = (current_ >> (kLevelBits * l)) + 1;
+        const qint64 last = qMin(now >> (kLevelBits * l), first + kSlots - 2);
+        for (qint64 block = first; block <= last && level.occupied != 0; ++block)
+        {
+            const int slot = static_cast<int>(block & (kSlots - 1));
+            if (level.buckets[slot] == nullptr)
+                continue;
+            WheelTimer *tail = level.buckets[slot];
+            while (tail->next_ != nullptr)
+                tail = tail->next_;
+            tail->next_ = due;
+            due = level.buckets[slot];
+            level.buckets[slot] = nullptr;
+            level.occupied &= ~(Q_UINT64_C(1) << slot);
+        }
+    }
+    current_ = now;
+
+    // the timers waiting on a coarse level go down, the expired ones fire
+    QVector<QPointer<WheelTimer>> expired;
+    while (due != nullptr)
+    {
+        WheelTimer *t = due;
+        due = due->next_;
+        t->prev_ = t->next_ = nullptr;
+        if (t->deadline_ > now)
+        {
+            place(t);
+        }
+        else
+        {
+            t->level_ = WheelTimer::kExpired;
+            expired << t;
+        }
+    }
+
+    for (const QPointer<WheelTimer> &t : expired)
+    {
+        // deleted, stopped or restarted by a previous timeout
+        if (t.isNull() || t->level_ != WheelTimer::kExpired)
+            continue;
+        t->level_ = WheelTimer::kNotInWheel;
+        if (!t->isSingleShot_)
+        {
+            t->deadline_ = now + t->interval_;
+            place(t);
+        }
+        emit t->timeout();
+    }
+
+    reschedule();
+}
+
+void TimerWheel::add(WheelTimer *timer)
+{
+    // nothing is due, so the processed time can move to now and the new timer is placed precisely
+    const qint64 now = this->now();
+    const qint64 wakeup = nextWakeup();
+    if (wakeup < 0 || wakeup > now)
+        current_ = qMax(current_, now);
+
+    place(timer);
+    reschedule();
+}
+
+void TimerWheel::remove(WheelTimer *timer)
+{
+    WS_ASSERT(timer->level_ >= 0);
+    Level &level = levels_[timer->level_];
+    if (timer->prev_)
+        timer->prev_->next_ = timer->next_;
+    else
+        level.buckets[timer->slot_] = timer->next_;
+    if (timer->next_)
+        timer->next_->prev_ = timer->prev_;
+    if (level.buckets[timer->slot_] == nullptr)
+        level.occupied &= ~(Q_UINT64_C(1) << timer->slot_);
+    timer->prev_ = timer->next_ = nullptr;
+    timer->level_ = WheelTimer::kNotInWheel;
+    // the wakeup is not moved later, an early wakeup with nothing to fire is cheaper than the rescheduling on every stop
+}
+
+void TimerWheel::place(WheelTimer *timer)
+{
+    const qint64 deadline = timer->deadline_;
+    int level = 0;
+    qint64 fireTime = current_ + 1;
+    if (deadline > current_)
+    {
+        // the coarsest level where rounding the deadline up stays within the slack
+        const int slack = timer->slack();
+        int slackLevel = 0;
+        while (slackLevel + 1 < kLevels && granularity(slackLevel + 1) <= slack + 1)
+            slackLevel++;
+
+        level = slackLevel;
+        qint64 g = granularity(level);
+        fireTime = (deadline + g - 1) / g * g;
+        // too far for that level: wait on a coarser one, rounded down, and go down from there
+        while (fireTime - current_ >= (kSlots - 1) * g && level + 1 < kLevels)
+        {
+            level++;
+            g = granularity(level);
+            fireTime = deadline / g * g;
+        }
+        if (fireTime - current_ >= (kSlots - 1) * g)
+            fireTime = (current_ + (kSlots - 2) * g) / g * g;
+    }
+
+    timer->level_ = level;
+    timer->fireTime_ = fireTime;
+    timer->slot_ = static_cast<int>((fireTime >> (kLevelBits * level)) & (kSlots - 1));
+    Level &l = levels_[level];
+    timer->prev_ = nullptr;
+    timer->next_ = l.buckets[timer->slot_];
+    if (timer->next_)
+        timer->next_->prev_ = timer;
+    l.buckets[timer->slot_] = timer;
+    l.occupied |= Q_UINT64_C(1) << timer->slot_;
+}
+
+void TimerWheel::reschedule()
+{
+    const qint64 wakeup = nextWakeup();
+    if (wakeup < 0)
+    {
+        timer_.stop();
+        scheduledWakeup_ = -1;
+        return;
+    }
+    if (timer_.isActive() && scheduledWakeup_ >= 0 && scheduledWakeup_ <= wakeup)
+        return;
+    scheduledWakeup_ = wakeup;
+    timer_.start(static_cast<int>(qMax<qint64>(0, wakeup - now())));
+}
+
+WheelTimer::WheelTimer(QObject *parent) : QObject(parent), wheel_(nullptr)
+{
+}
+
+WheelTimer::~WheelTimer()
+{
+    stop();
+}
+
+void WheelTimer::setInterval(int msec)
+{
+    interval_ = msec;
+    if (isActive())
+        start();
+}
+
+int WheelTimer::slack() const
+{
+    return slack_ >= 0 ? slack_ : interval_ / 20;
+}
+
+int WheelTimer::remainingTime() const
+{
+    if (!isActive())
+        return -1;
+    return static_cast<int>(qMax<qint64>(0, deadline_ - wheel_->now()));
+}
+
+void WheelTimer::start()
+{
+    stop();
+    wheel_ = TimerWheel::instance();
+    deadline_ = wheel_->now() + interval_;
+    wheel_->add(this);
+}
+
+void WheelTimer::start(int msec)
+{
+    interval_ = msec;
+    start();
+}
+
+void WheelTimer::stop()
+{
+    if (isActive())
+    {
+        WS_ASSERT(wheel_ == TimerWheel::instance());
+        wheel_->remove(this);
+    }
+    else if (level_ == kExpired)
+    {
+        level_ = kNotInWheel;
+    }
+}
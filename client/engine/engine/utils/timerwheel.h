@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+class WheelTimer;
+
+// Hierarchical timer wheel of one thread, woken by a single QTimer at the next real deadline.
+// Level L has kSlots slots of 8^L ms each. A timer is placed on the coarsest level whose granularity fits into its slack,
+// so its deadline is rounded up to a multiple of the granularity there and the timers with close deadlines share one wakeup.
+// A timer too far in the future for that level waits on a coarser one and moves down when its slot is reached.
+// Inserting, removing and finding the next wakeup don't depend on the number of the timers.
+class TimerWheel : public QObject
+{
+    Q_OBJECT
+public:
+    // the wheel of the current thread, created on the first use and destroyed when the thread finishes
+    static TimerWheel *instance();
+    ~TimerWheel();
+
+    qint64 now() const;                 // ms, monotonic
+    qint64 nextWakeup() const;          // -1 if there are no timers
+    int wakeups() const { return wakeups_; }
+
+    static constexpr int kLevelBits = 3;
+    static constexpr int kLevels = 8;   // the coarsest granularity is 8^7 ms, about 35 minutes
+    static constexpr int kSlots = 64;
+
+private slots:
+    void onTimer();
+
+private:
+    friend class WheelTimer;
+
+    TimerWheel();
+
+    QElapsedTimer clock_;
+    qint64 current_ = 0;                // all the slots up to this time are processed
+    QTimer timer_;
+    qint64 scheduledWakeup_ = -1;
+    int wakeups_ = 0;
+
+    struct Level
+    {
+        WheelTimer *buckets[kSlots] = {};
+        quint64 occupied = 0;           // a bit per non-empty slot
+    };
+    Level levels_[kLevels];
+
+    void add(WheelTimer *timer);
+    void remove(WheelTimer *timer);
+    void place(WheelTimer *timer);
+    void reschedule();
+
+    static qint64 granularity(int level) { return Q_INT64_C(1) << (kLevelBits * level); }
+};
+
+// A drop-in replacement of QTimer for the timers which tolerate a delay: the timeout is emitted
+// between the interval and the interval + slack, together with the other timers of the thread due in that window.
+// The timer belongs to the wheel of the thread where it's started and must be stopped in that thread.
+class WheelTimer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit WheelTimer(QObject *parent = nullptr);
+    ~WheelTimer();
+
+    void setInterval(int msec);
+    int interval() const { return interval_; }
+    void setSingleShot(bool singleShot) { isSingleShot_ = singleShot; }
+    bool isSingleShot() const { return isSingleShot_; }
+    // the maximum delay of the timeout, 5% of the interval by default like Qt::CoarseTimer
+    void setSlack(int msec) { slack_ = msec; }
+    int slack() const;
+
+    bool isActive() const { return level_ >= 0; }
+    int remainingTime() const;
+
+public slots:
+    void start();
+    void start(int msec);
+    void stop();
+
+signals:
+    void timeout();
+
+private:
+    friend class TimerWheel;
+
+    TimerWheel *wheel_;
+    int interval_ = 0;
+    int slack_ = -1;
+    bool isSingleShot_ = false;
+
+    qint64 deadline_ = 0;               // the earliest time of the timeout
+    qint64 fireTime_ = 0;               // the time of the slot
+    static constexpr int kNotInWheel = -1;
+    static constexpr int kExpired = -2;   // taken out of the wheel to fire
+    int level_ = kNotInWheel;
+    int slot_ = 0;
+    WheelTimer *prev_ = nullptr;
+    WheelTimer *next_ = nullptr;
+};
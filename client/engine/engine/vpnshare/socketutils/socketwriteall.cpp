@@ -1,5 +1,7 @@
 #include "socketwriteall.h"
 
+#include "engine/metrics/metrics.h"
+
 SocketWriteAll::SocketWriteAll(QObject *parent, QTcpSocket *socket) : QObject(parent),
     socket_(socket), bEmitAllDataWritten_(false)
 {
@@ -30,6 +32,8 @@ void SocketWriteAll::setEmitAllDataWritten()
 
 void SocketWriteAll::onBytesWritten(qint64 bytes)
 {
+    static metrics::Counter &relayedBytes = metrics::counter("ws_proxy_relayed_bytes_total", "Bytes written to the sockets by the proxy sharing");
+    relayedBytes.inc(bytes);
     arr_.remove(0, bytes);
     if (!arr_.isEmpty())
     {
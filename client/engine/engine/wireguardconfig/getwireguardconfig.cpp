@@ -2,6 +2,7 @@
 #include "engine/serverapi/serverapi.h"
 #include "engine/apiinfo/apiinfo.h"
 #include "types/global_consts.h"
+#include "utils/logger.h"
 #include "utils/utils.h"
 #include "utils/ws_assert.h"
 #include "engine/serverapi/requests/wgconfigsinitrequest.h"
@@ -16,7 +17,8 @@ extern "C" {
 const QString GetWireGuardConfig::KEY_WIREGUARD_CONFIG = "wireguardConfig";
 
 GetWireGuardConfig::GetWireGuardConfig(QObject *parent, server_api::ServerAPI *serverAPI) : QObject(parent), serverAPI_(serverAPI),
-    request_(nullptr), simpleCrypt_(SIMPLE_CRYPT_KEY)
+    request_(nullptr), prefetchRequest_(nullptr), isWaitingForPrefetch_(false), isKeyLimitReached_(false),
+    simpleCrypt_(SIMPLE_CRYPT_KEY)
 {
 }
 
@@ -31,6 +33,59 @@ void GetWireGuardConfig::getWireGuardConfig(const QString &serverName, bool dele
     isRetryConnectRequest_ = false;
     isRetryInitRequest_ = false;
 
+    if (prefetchRequest_) {
+        // the key-pair is being registered, use it when it's done
+        isWaitingForPrefetch_ = true;
+        return;
+    }
+    startGetWireGuardConfig();
+}
+
+void GetWireGuardConfig::prefetchKeyPair()
+{
+    if (prefetchRequest_ || request_ || isWaitingForPrefetch_ || isKeyLimitReached_)
+        return;
+
+    QString publicKey, privateKey, presharedKey, allowedIPs;
+    if (getWireGuardKeyPair(publicKey, privateKey) && getWireGuardPeerInfo(presharedKey, allowedIPs))
+        return;
+
+    // the key-pair is saved with the peer parameters once it's registered, a failed registration leaves the settings as they are
+    prefetchConfig_.reset();
+    if (!prefetchConfig_.generateKeyPair())
+        return;
+
+    qCDebug(LOG_CONNECTION) << "Prefetching the WireGuard key-pair registration";
+    prefetchRequest_ = serverAPI_->wgConfigsInit(apiinfo::ApiInfo::getAuthHash(), prefetchConfig_.clientPublicKey(), false);
+    prefetchRequest_->setParent(this);
+    connect(prefetchRequest_, &server_api::BaseRequest::finished, this, &GetWireGuardConfig::onPrefetchInitAnswer);
+}
+
+void GetWireGuardConfig::onPrefetchInitAnswer()
+{
+    QSharedPointer<server_api::WgConfigsInitRequest> request(static_cast<server_api::WgConfigsInitRequest *>(sender()), &QObject::deleteLater);
+    prefetchRequest_ = nullptr;
+
+    // on errors nothing is saved, so getWireGuardConfig() goes through the whole flow with its error handling
+    if (request->networkRetCode() == SERVER_RETURN_SUCCESS && !request->isErrorCode()) {
+        WireGuardConfig wgConfig = readWireGuardConfigFromSettings();
+        wgConfig.setKeyPair(prefetchConfig_.clientPublicKey(), prefetchConfig_.clientPrivateKey());
+        wgConfig.setPeerPresharedKey(request->presharedKey());
+        wgConfig.setPeerAllowedIPs(WireGuardConfig::stripIpv6Address(request->allowedIps()));
+        writeWireGuardConfigToSettings(wgConfig);
+    } else if (request->networkRetCode() == SERVER_RETURN_SUCCESS && request->errorCode() == 1313) {
+        isKeyLimitReached_ = true;
+    }
+    prefetchConfig_.reset();
+
+    if (isWaitingForPrefetch_) {
+        isWaitingForPrefetch_ = false;
+        startGetWireGuardConfig();
+    }
+}
+
+void GetWireGuardConfig::startGetWireGuardConfig()
+{
     wireGuardConfig_.reset();
     // restore a key-pair and peer parameters stored on disk
     // if they are not found in settings, they will be generated and saved later by this class flow.
@@ -73,6 +128,7 @@ void GetWireGuardConfig::onWgConfigsInitAnswer()
            // This error indicates the user has used up all of their public key slots on the server.
            // Ask them if they want to delete their oldest registered key and try again.
            newRetCode = WireGuardConfigRetCode::kKeyLimit;
+           isKeyLimitReached_ = true;
         }
 
         request_ = nullptr;
@@ -80,6 +136,7 @@ void GetWireGuardConfig::onWgConfigsInitAnswer()
         return;
     }
 
+    isKeyLimitReached_ = false;
     wireGuardConfig_.setPeerPresharedKey(request->presharedKey());
     wireGuardConfig_.setPeerAllowedIPs(WireGuardConfig::stripIpv6Address(request->allowedIps()));
 
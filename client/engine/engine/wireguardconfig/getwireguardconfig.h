@@ -22,6 +22,10 @@ public:
     GetWireGuardConfig(QObject *parent, server_api::ServerAPI *serverAPI);
 
     void getWireGuardConfig(const QString &serverName, bool deleteOldestKey, const QString &deviceId);
+    // generates and registers the key-pair ahead of the connection if there is none yet, so getWireGuardConfig() only
+    // needs the wgConfigsConnect request; the key-pair is not tied to a location.
+    // Not done after the server has answered that the key limit is reached, until a key-pair is registered.
+    void prefetchKeyPair();
     static void removeWireGuardSettings();
 
 signals:
@@ -30,7 +34,7 @@ signals:
 private slots:
     void onWgConfigsInitAnswer();
     void onWgConfigsConnectAnswer();
-
+    void onPrefetchInitAnswer();
 
 private:
     static const QString KEY_WIREGUARD_CONFIG;
@@ -43,8 +47,15 @@ private:
     bool isRetryConnectRequest_;
     bool isRetryInitRequest_;
     server_api::BaseRequest *request_;
+    server_api::BaseRequest *prefetchRequest_;
+    WireGuardConfig prefetchConfig_;   // the key-pair being registered by the prefetch
+    // getWireGuardConfig() was called while the prefetch was in progress, it continues when the prefetch is done
+    bool isWaitingForPrefetch_;
+    // the server answered 1313 (all the key slots are used), a prefetch would be refused too
+    bool isKeyLimitReached_;
     SimpleCrypt simpleCrypt_;
 
+    void startGetWireGuardConfig();
     void submitWireGuardInitRequest(bool generateKeyPair);
 
     bool getWireGuardKeyPair(QString &publicKey, QString &privateKey);
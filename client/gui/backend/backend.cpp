@@ -7,6 +7,7 @@
 #include "persistentstate.h"
 #include "utils/logger.h"
 #include "utils/network_utils/network_utils.h"
+#include "utils/settingsstore.h"
 
 #ifdef Q_OS_LINUX
 #include "launchonstartup/launchonstartup.h"
@@ -44,6 +45,8 @@ Backend::~Backend()
 {
     preferences_.saveGuiSettings();
     delete engine_;
+    // the engine and the GUI don't write the settings after this point
+    SettingsStore::instance().flush();
 }
 
 void Backend::init()
@@ -621,9 +624,9 @@ void Backend::onEngineWebSessionToken(WEB_SESSION_PURPOSE purpose, const QString
         emit webSessionTokenForManageRobertRules(token);
 }
 
-void Backend::onEngineLocationsModelItemsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<QVector<types::Location> > items)
+void Backend::onEngineLocationsModelItemsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<types::LocationsDelta> delta)
 {
-    locationsModelManager_->updateLocations(bestLocation, *items);
+    locationsModelManager_->updateLocations(bestLocation, *delta);
     locationsModelManager_->updateDeviceName(staticIpDeviceName);
 }
 
@@ -164,7 +164,7 @@ private slots:
     void onEngineConfirmEmailFinished(bool bSuccess);
     void onEngineWebSessionToken(WEB_SESSION_PURPOSE purpose, const QString &token);
 
-    void onEngineLocationsModelItemsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer< QVector<types::Location> > items);
+    void onEngineLocationsModelItemsUpdated(const LocationID &bestLocation, const QString &staticIpDeviceName, QSharedPointer<types::LocationsDelta> delta);
     void onEngineLocationsModelBestLocationUpdated(const LocationID &bestLocation);
     void onEngineLocationsModelCustomConfigItemsUpdated(QSharedPointer<types::Location> item);
     void onEngineLocationsModelPingChangedChanged(const LocationID &id, PingTime timeMs);
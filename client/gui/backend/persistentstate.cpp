@@ -1,32 +1,37 @@
 #include "persistentstate.h"
 
 #include <QRect>
-#include <QSettings>
 
 #include "utils/logger.h"
+#include "utils/settingsstore.h"
 #include "utils/simplecrypt.h"
 #include "types/global_consts.h"
 #include "legacy_protobuf_support/legacy_protobuf.h"
 
+namespace {
+const SettingsKey<QByteArray> kLegacyStateKey { "persistentGuiSettings" };
+const SettingsKey<QString> kStateKey { "guiPersistentState" };
+}
+
 void PersistentState::load()
 {
-    QSettings settings;
+    SettingsStore &settings = SettingsStore::instance();
     bool bLoaded = false;
     // try load from legacy protobuf
     // todo remove this code at some point later
-    if (settings.contains("persistentGuiSettings"))
+    if (settings.contains(kLegacyStateKey))
     {
-        QByteArray arr = settings.value("persistentGuiSettings").toByteArray();
+        QByteArray arr = settings.value(kLegacyStateKey);
         bLoaded = LegacyProtobufSupport::loadGuiPersistentState(arr, state_);
         if (bLoaded)
         {
-            settings.remove("persistentGuiSettings");
+            settings.remove(kLegacyStateKey);
         }
     }
-    if (!bLoaded && settings.contains("guiPersistentState"))
+    if (!bLoaded && settings.contains(kStateKey))
     {
         SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-        QString str = settings.value("guiPersistentState", "").toString();
+        QString str = settings.value(kStateKey);
         QByteArray arr = simpleCrypt.decryptToByteArray(str);
 
         QDataStream ds(&arr, QIODevice::ReadOnly);
@@ -52,7 +57,7 @@ void PersistentState::load()
         state_ = types::GuiPersistentState(); // reset to defaults
     }
     // remove the legacy key of settings
-    settings.remove("persistentGuiSettings");
+    settings.remove(kLegacyStateKey);
 }
 
 void PersistentState::save()
@@ -66,9 +71,7 @@ void PersistentState::save()
     }
 
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    QSettings settings;
-    settings.setValue("guiPersistentState", simpleCrypt.encryptToString(arr));
-    settings.sync();
+    SettingsStore::instance().setValue(kStateKey, simpleCrypt.encryptToString(arr));
 }
 
 void PersistentState::setFirewallState(bool bFirewallOn)
@@ -1,6 +1,5 @@
 #include "preferences.h"
 
-#include <QSettings>
 #include <QSystemTrayIcon>
 
 #include "../persistentstate.h"
@@ -9,10 +8,16 @@
 #include "utils/logger.h"
 #include "utils/utils.h"
 #include "utils/ipvalidation.h"
+#include "utils/settingsstore.h"
 #include "utils/simplecrypt.h"
 #include "types/global_consts.h"
 #include "legacy_protobuf_support/legacy_protobuf.h"
 
+namespace {
+const SettingsKey<QByteArray> kLegacyGuiSettingsKey { "guiSettings" };
+const SettingsKey<QString> kGuiSettingsKey { "guiSettings2" };
+}
+
 Preferences::Preferences(QObject *parent) : QObject(parent)
   , isSettingEngineSettings_(false)
 {
@@ -802,10 +807,8 @@ void Preferences::saveGuiSettings() const
         ds << guiSettings_;
     }
 
-    QSettings settings;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    settings.setValue("guiSettings2", simpleCrypt.encryptToString(arr));
-    settings.sync();
+    SettingsStore::instance().setValue(kGuiSettingsKey, simpleCrypt.encryptToString(arr));
 }
 
 void Preferences::loadGuiSettings()
@@ -813,21 +816,21 @@ void Preferences::loadGuiSettings()
     bool bLoaded = false;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
 
-    QSettings settings;
-    if (settings.contains("guiSettings"))
+    SettingsStore &settings = SettingsStore::instance();
+    if (settings.contains(kLegacyGuiSettingsKey))
     {
         // try load from legacy protobuf
         // todo remove this code at some point later
-        QByteArray arr = settings.value("guiSettings").toByteArray();
+        QByteArray arr = settings.value(kLegacyGuiSettingsKey);
         bLoaded = LegacyProtobufSupport::loadGuiSettings(arr, guiSettings_);
         if (bLoaded)
         {
-            settings.remove("guiSettings");
+            settings.remove(kLegacyGuiSettingsKey);
         }
     }
-    if (!bLoaded && settings.contains("guiSettings2"))
+    if (!bLoaded && settings.contains(kGuiSettingsKey))
     {
-        QString str = settings.value("guiSettings2").toString();
+        QString str = settings.value(kGuiSettingsKey);
         QByteArray arr = simpleCrypt.decryptToByteArray(str);
 
         QDataStream ds(&arr, QIODevice::ReadOnly);
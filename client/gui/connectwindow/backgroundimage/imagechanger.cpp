@@ -18,6 +18,11 @@ ImageChanger::ImageChanger(QObject *parent, int animationDuration) : QObject(par
 
 ImageChanger::~ImageChanger()
 {
+    curImage_.clear(this);
+    prevImage_.clear(this);
+    // the decoders are deleted on their thread before it finishes
+    decodeThread_.quit();
+    decodeThread_.wait();
     SAFE_DELETE(pixmap_);
 }
 
@@ -65,18 +70,14 @@ void ImageChanger::setImage(QSharedPointer<IndependentPixmap> pixmap, bool bShow
 
 void ImageChanger::setMovie(QSharedPointer<QMovie> movie, bool bShowPrevChangeAnimation)
 {
-    generateCustomGradient(movie->scaledSize() / DpiScaleManager::instance().curDevicePixelRatio());
-
     if (!curImage_.isValid() || !bShowPrevChangeAnimation)
     {
         curImage_.clear(this);
         prevImage_.clear(this);
         curImage_.isMovie = true;
-        curImage_.movie = movie;
+        curImage_.movie = createMovieDecoder(movie);
         opacityPrevImage_ = 0.0;
         opacityCurImage_ = 1.0;
-        connect(curImage_.movie.get(), &QMovie::updated, this, &ImageChanger::updatePixmap);
-        curImage_.movie->start();
     }
     else
     {
@@ -84,7 +85,7 @@ void ImageChanger::setMovie(QSharedPointer<QMovie> movie, bool bShowPrevChangeAn
 
         curImage_.clear(nullptr);
         curImage_.isMovie = true;
-        curImage_.movie = movie;
+        curImage_.movie = createMovieDecoder(movie);
 
         opacityPrevImage_ = opacityCurImage_;
         opacityCurImage_ = 1.0 - opacityPrevImage_;
@@ -98,8 +99,6 @@ void ImageChanger::setMovie(QSharedPointer<QMovie> movie, bool bShowPrevChangeAn
         opacityAnimation_.setEndValue(1.0);
         opacityAnimation_.setDuration((1.0 - opacityCurImage_) * animationDuration_);
 
-        connect(curImage_.movie.get(), &QMovie::updated, this, &ImageChanger::updatePixmap);
-        curImage_.movie->start();
         opacityAnimation_.start();
     }
     onMainWindowIsActiveChanged(MainWindowState::instance().isActive());
@@ -126,10 +125,15 @@ void ImageChanger::onOpacityFinished()
 
 void ImageChanger::updatePixmap()
 {
-    SAFE_DELETE(pixmap_);
-
-    pixmap_ = new QPixmap(WIDTH * G_SCALE * DpiScaleManager::instance().curDevicePixelRatio(), 176 * G_SCALE * DpiScaleManager::instance().curDevicePixelRatio());
-    pixmap_->setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
+    // the pixmap is redrawn on every frame of a movie, so it is only reallocated when the scale changes
+    const qreal dpr = DpiScaleManager::instance().curDevicePixelRatio();
+    const QSize size(WIDTH * G_SCALE * dpr, 176 * G_SCALE * dpr);
+    if (!pixmap_ || pixmap_->size() != size || pixmap_->devicePixelRatio() != dpr)
+    {
+        SAFE_DELETE(pixmap_);
+        pixmap_ = new QPixmap(size);
+        pixmap_->setDevicePixelRatio(dpr);
+    }
     pixmap_->fill(QColor(2, 13, 28));
 
     // prev and current gradient info
@@ -171,15 +175,7 @@ void ImageChanger::updatePixmap()
             else
             {
                 p.setOpacity(opacityPrevImage_);
-                QPixmap framePixmap = prevImage_.movie->currentPixmap();
-                framePixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
-                p.drawPixmap(0, ceil(7.0 * G_SCALE), framePixmap);
-
-                if (curGradient != GRADIENT_CUSTOM_BACKGROUND)
-                {
-                    p.setOpacity(opacityPrevImage_);
-                    p.drawPixmap(0, ceil(7.0 * G_SCALE), customGradient_);
-                }
+                drawFrame(&p, prevImage_.frame, dpr);
             }
         }
         if (curImage_.isValid())
@@ -203,20 +199,9 @@ void ImageChanger::updatePixmap()
             }
             else
             {
+                // the gradient is in the frame already, so it fades in with the frame
                 p.setOpacity(opacityCurImage_);
-                QPixmap framePixmap = curImage_.movie->currentPixmap();
-                framePixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
-                p.drawPixmap(0, ceil(7.0 * G_SCALE), framePixmap);
-
-                if (prevGradient == GRADIENT_FLAG)
-                {
-                    p.setOpacity(opacityCurImage_);
-                }
-                else
-                {
-                    p.setOpacity(1.0);
-                }
-                p.drawPixmap(0, ceil(7.0 * G_SCALE), customGradient_);
+                drawFrame(&p, curImage_.frame, dpr);
             }
         }
     }
@@ -225,32 +210,64 @@ void ImageChanger::updatePixmap()
 
 void ImageChanger::onMainWindowIsActiveChanged(bool isActive)
 {
-    if (curImage_.isValid() && curImage_.isMovie && curImage_.movie)
+    for (const ImageInfo *info : { &curImage_, &prevImage_ })
     {
-        curImage_.movie->setPaused(!isActive);
-    }
-    if (prevImage_.isValid() && prevImage_.isMovie && prevImage_.movie)
-    {
-        prevImage_.movie->setPaused(!isActive);
+        if (info->isValid() && info->isMovie)
+        {
+            MovieFrameDecoder *movie = info->movie.get();
+            QMetaObject::invokeMethod(movie, [movie, isActive] { movie->setPaused(!isActive); }, Qt::QueuedConnection);
+        }
     }
 }
 
-void ImageChanger::generateCustomGradient(const QSize &size)
+void ImageChanger::onMovieFrameReady(quint64 decoderId, const QImage &frame)
 {
-    if (customGradient_.isNull() || customGradient_.size() != size)
-    {
-        customGradient_ = QPixmap(size * DpiScaleManager::instance().curDevicePixelRatio());
-        customGradient_.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
-        customGradient_.fill(Qt::transparent);
-        QPainter p(&customGradient_);
-
-        QLinearGradient gradient(0, 0, 0, size.height() * 0.2);
-        gradient.setColorAt(0, QColor(2, 13, 28, 255));
-        gradient.setColorAt(1, QColor(2, 13, 28, 0));
-        p.fillRect(QRect(0, 0, size.width(), size.height() * 0.2), gradient);
-    }
+    ImageInfo *info = nullptr;
+    if (curImage_.isMovie && curImage_.movie && curImage_.movie->id() == decoderId)
+        info = &curImage_;
+    else if (prevImage_.isMovie && prevImage_.movie && prevImage_.movie->id() == decoderId)
+        info = &prevImage_;
+    else
+        return;
+
+    // the frame shares the data of the decoder cache, it is not converted or copied here
+    info->frame = frame;
+    updatePixmap();
+}
+
+// the frame is in device pixels
+void ImageChanger::drawFrame(QPainter *painter, const QImage &frame, qreal dpr)
+{
+    painter->drawImage(QRectF(0, ceil(7.0 * G_SCALE), frame.width() / dpr, frame.height() / dpr), frame);
 }
 
+QSharedPointer<MovieFrameDecoder> ImageChanger::createMovieDecoder(const QSharedPointer<QMovie> &movie)
+{
+    if (!decodeThread_.isRunning())
+        decodeThread_.start(QThread::LowPriority);
+
+    // the QMovie is used for the file name and the size only, the decoder reads the file on its own
+    QSharedPointer<MovieFrameDecoder> decoder(
+        new MovieFrameDecoder(movie->fileName(), movie->scaledSize(), generateCustomGradient(movie->scaledSize())),
+        &QObject::deleteLater);
+    decoder->moveToThread(&decodeThread_);
+    connect(decoder.get(), &MovieFrameDecoder::frameReady, this, &ImageChanger::onMovieFrameReady);
+    QMetaObject::invokeMethod(decoder.get(), &MovieFrameDecoder::start, Qt::QueuedConnection);
+    return decoder;
+}
 
+// in device pixels, it is composited into the frames by MovieFrameDecoder
+QImage ImageChanger::generateCustomGradient(const QSize &size)
+{
+    QImage gradientImage(size, QImage::Format_ARGB32_Premultiplied);
+    gradientImage.fill(Qt::transparent);
+    QPainter p(&gradientImage);
+
+    QLinearGradient gradient(0, 0, 0, size.height() * 0.2);
+    gradient.setColorAt(0, QColor(2, 13, 28, 255));
+    gradient.setColorAt(1, QColor(2, 13, 28, 0));
+    p.fillRect(QRect(0, 0, size.width(), size.height() * 0.2), gradient);
+    return gradientImage;
+}
 
 } //namespace ConnectWindow
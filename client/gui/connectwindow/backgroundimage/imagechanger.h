@@ -1,13 +1,16 @@
 #pragma once
 
 #include <QObject>
+#include <QThread>
 #include <QVariantAnimation>
 #include <QMovie>
+#include "movieframedecoder.h"
 #include "../../graphicresources/independentpixmap.h"
 
 namespace ConnectWindow {
 
-// Provides smooth image change and gif animation
+// Provides smooth image change and gif animation.
+// The gif frames are decoded and composited with the gradient by MovieFrameDecoder on decodeThread_, this class only draws them.
 class ImageChanger : public QObject
 {
     Q_OBJECT
@@ -27,6 +30,7 @@ private slots:
     void onOpacityFinished();
     void updatePixmap();
     void onMainWindowIsActiveChanged(bool isActive);
+    void onMovieFrameReady(quint64 decoderId, const QImage &frame);
 
 private:
     static constexpr int WIDTH = 332;
@@ -36,12 +40,14 @@ private:
     qreal opacityPrevImage_;
     int animationDuration_;
     QVariantAnimation opacityAnimation_;
+    QThread decodeThread_;
 
     struct ImageInfo
     {
         bool isMovie;
         QSharedPointer<IndependentPixmap> pixmap;
-        QSharedPointer<QMovie> movie;
+        QSharedPointer<MovieFrameDecoder> movie;
+        QImage frame;       // the latest frame of the movie, premultiplied and with the gradient, so it is drawn as it is
 
         ImageInfo() : isMovie(false) {}
         bool isValid() const
@@ -61,11 +67,11 @@ private:
             if (isMovie && movie && parent)
             {
                 movie->disconnect(parent);
-                movie->stop();
             }
 
             pixmap.reset();
             movie.reset();
+            frame = QImage();
             isMovie = false;
         }
     };
@@ -73,9 +79,9 @@ private:
     ImageInfo curImage_;
     ImageInfo prevImage_;
 
-    QPixmap customGradient_;
-
-    void generateCustomGradient(const QSize &size);
+    QSharedPointer<MovieFrameDecoder> createMovieDecoder(const QSharedPointer<QMovie> &movie);
+    static QImage generateCustomGradient(const QSize &size);
+    static void drawFrame(QPainter *painter, const QImage &frame, qreal dpr);
 
 };
 
@@ -0,0 +1,126 @@
+#include "movieframedecoder.h"
+
+#include <QFileInfo>
+#include <QPainter>
+
+namespace ConnectWindow {
+
+std::atomic<quint64> MovieFrameDecoder::nextId_(1);
+QMutex MovieFrameDecoder::cacheMutex_;
+QCache<QString, MovieFrameDecoder::Frame> MovieFrameDecoder::cache_(MovieFrameDecoder::kCacheSizeMb * 1024);
+
+MovieFrameDecoder::MovieFrameDecoder(const QString &fileName, const QSize &size, const QImage &overlay) : QObject(nullptr),
+    id_(nextId_++), fileName_(fileName), size_(size), overlay_(overlay), timer_(this)
+{
+    timer_.setSingleShot(true);
+    connect(&timer_, &QTimer::timeout, this, &MovieFrameDecoder::showNextFrame);
+}
+
+void MovieFrameDecoder::start()
+{
+    isStarted_ = true;
+    isFinished_ = false;
+    loopsDone_ = 0;
+    fileModifiedMs_ = QFileInfo(fileName_).lastModified().toMSecsSinceEpoch();
+    rewind();
+    loopCount_ = reader_.loopCount();
+    showNextFrame();
+}
+
+void MovieFrameDecoder::setPaused(bool isPaused)
+{
+    isPaused_ = isPaused;
+    if (isPaused_)
+        timer_.stop();
+    else if (isStarted_ && !timer_.isActive())
+        showNextFrame();
+}
+
+void MovieFrameDecoder::showNextFrame()
+{
+    if (isPaused_ || !isStarted_ || isFinished_)
+        return;
+
+    if (frameIndex_ == frameCount_ && !startNextLoop())
+        return;
+
+    Frame frame;
+    bool isCached = false;
+    {
+        QMutexLocker locker(&cacheMutex_);
+        if (const Frame *cached = cache_.object(cacheKey(frameIndex_))) {
+            frame = *cached;
+            isCached = true;
+        }
+    }
+
+    if (!isCached) {
+        if (!decodeFrame(frame)) {
+            if (frameIndex_ == 0)
+                return;     // not an image
+            // the end of the animation, loop it
+            frameCount_ = frameIndex_;
+            if (!startNextLoop())
+                return;
+            showNextFrame();
+            return;
+        }
+        QMutexLocker locker(&cacheMutex_);
+        cache_.insert(cacheKey(frameIndex_), new Frame(frame), frame.image.sizeInBytes() / 1024 + 1);
+    }
+
+    emit frameReady(id_, frame.image);
+    frameIndex_++;
+    if (reader_.supportsAnimation())
+        timer_.start(frame.delayMs);
+}
+
+// the still images and the finished animations keep their last frame and stop the timer
+bool MovieFrameDecoder::startNextLoop()
+{
+    if (frameCount_ == 1 || (loopCount_ >= 0 && loopsDone_ >= loopCount_)) {
+        isFinished_ = true;
+        return false;
+    }
+    loopsDone_++;
+    frameIndex_ = 0;
+    return true;
+}
+
+bool MovieFrameDecoder::decodeFrame(Frame &frame)
+{
+    // the frames of an animation depend on the previous ones, so the reader goes through them in order
+    if (readerIndex_ > frameIndex_)
+        rewind();
+
+    QImage image;
+    while (readerIndex_ <= frameIndex_) {
+        if (!reader_.read(&image))
+            return false;
+        readerIndex_++;
+    }
+    frame.delayMs = reader_.nextImageDelay() > 0 ? reader_.nextImageDelay() : kDefaultFrameDelayMs;
+
+    if (image.size() != size_)
+        image = image.scaled(size_, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    frame.image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    QPainter p(&frame.image);
+    p.drawImage(0, 0, overlay_);
+    return true;
+}
+
+void MovieFrameDecoder::rewind()
+{
+    reader_.setFileName(fileName_);
+    readerIndex_ = 0;
+    // oversized sources are scaled down by the decoder (JPEG and WebP do it while decoding), so no full-size frames are kept
+    reader_.setScaledSize(size_);
+}
+
+QString MovieFrameDecoder::cacheKey(int frameIndex) const
+{
+    return fileName_ + "|" + QString::number(fileModifiedMs_) + "|" + QString::number(size_.width()) + "x" + QString::number(size_.height())
+           + "|" + QString::number(frameIndex);
+}
+
+} //namespace ConnectWindow
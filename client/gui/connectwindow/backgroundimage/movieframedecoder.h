@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QImageReader>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+
+namespace ConnectWindow {
+
+// Decodes the frames of an animated custom background on a worker thread and composites the overlay (the custom gradient) onto them,
+// so the GUI thread only draws the ready frames. The object must be moved to the worker thread and controlled with queued calls.
+// The frames are premultiplied and kept in an LRU cache bounded in megabytes, shared by all the decoders, so a looping animation
+// which fits is decoded once and the background that is not shown is evicted first.
+class MovieFrameDecoder : public QObject
+{
+    Q_OBJECT
+public:
+    // size in device pixels; the overlay is drawn over each frame
+    MovieFrameDecoder(const QString &fileName, const QSize &size, const QImage &overlay);
+
+    // unique over the lifetime of the app, so a frame queued by a deleted decoder is not taken for one of a new decoder
+    quint64 id() const { return id_; }
+
+public slots:
+    void start();
+    void setPaused(bool isPaused);
+
+signals:
+    void frameReady(quint64 decoderId, const QImage &frame);
+
+private slots:
+    void showNextFrame();
+
+private:
+    static constexpr int kCacheSizeMb = 64;
+    static constexpr int kDefaultFrameDelayMs = 100;
+
+    struct Frame
+    {
+        QImage image;
+        int delayMs;
+    };
+
+    const quint64 id_;
+    const QString fileName_;
+    const QSize size_;
+    const QImage overlay_;
+    QImageReader reader_;
+    QTimer timer_;
+    int frameIndex_ = 0;        // the frame to show next
+    int readerIndex_ = 0;       // the frame the reader returns next
+    int frameCount_ = -1;       // known after the first pass
+    int loopCount_ = -1;        // the repeats of the animation, -1 loops forever
+    int loopsDone_ = 0;
+    qint64 fileModifiedMs_ = 0; // a part of the cache key, so a file replaced under the same name is decoded again
+    bool isStarted_ = false;
+    bool isPaused_ = false;
+    bool isFinished_ = false;   // the last loop is shown, or the image has a single frame
+
+    bool decodeFrame(Frame &frame);
+    bool startNextLoop();
+    void rewind();
+    QString cacheKey(int frameIndex) const;
+
+    static std::atomic<quint64> nextId_;
+    static QMutex cacheMutex_;
+    static QCache<QString, Frame> cache_;     // the cost is in kilobytes
+};
+
+} //namespace ConnectWindow
@@ -0,0 +1,148 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <ctime>
+#include "movieframedecoder.h"
+
+using ConnectWindow::MovieFrameDecoder;
+
+// The fixtures are 16x16: an animation of red, green and blue frames of 20 ms, the same one repeated once,
+// and a white still image. The decoder runs on the test thread here.
+class TestMovieFrameDecoder : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testFrames();
+    void testLoopCount();
+    void testSingleFrame();
+    void testPause();
+    void testNotAnImage();
+    void benchmarkCpuUsage();
+
+private:
+    static constexpr int kFrameDelayMs = 20;
+    static const QSize kSize;
+
+    static QImage makeOverlay();
+    static QRgb centerPixel(const QVariant &frame);
+};
+
+const QSize TestMovieFrameDecoder::kSize(32, 32);
+
+// a half transparent black top half, like the custom gradient
+QImage TestMovieFrameDecoder::makeOverlay()
+{
+    QImage overlay(kSize, QImage::Format_ARGB32_Premultiplied);
+    overlay.fill(Qt::transparent);
+    QPainter p(&overlay);
+    p.fillRect(QRect(0, 0, kSize.width(), kSize.height() / 2), QColor(0, 0, 0, 128));
+    return overlay;
+}
+
+QRgb TestMovieFrameDecoder::centerPixel(const QVariant &frame)
+{
+    const QImage image = frame.value<QImage>();
+    return image.pixel(image.width() / 2, image.height() * 3 / 4);
+}
+
+void TestMovieFrameDecoder::testFrames()
+{
+    MovieFrameDecoder decoder(":/data/tests/movieframedecoder/animated.gif", kSize, makeOverlay());
+    QSignalSpy spy(&decoder, &MovieFrameDecoder::frameReady);
+    decoder.start();
+
+    // the animation loops forever, the second loop comes from the cache
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 7, 5000);
+    const QList<QRgb> colors = { qRgb(255, 0, 0), qRgb(0, 255, 0), qRgb(0, 0, 255) };
+    for (int i = 0; i < 7; ++i) {
+        QCOMPARE(spy.at(i).at(0).toULongLong(), decoder.id());
+        const QImage frame = spy.at(i).at(1).value<QImage>();
+        QCOMPARE(frame.size(), kSize);
+        QCOMPARE(frame.format(), QImage::Format_ARGB32_Premultiplied);
+        QCOMPARE(centerPixel(spy.at(i).at(1)), colors[i % 3]);
+        // the overlay is composited onto the frame
+        QVERIFY(qAbs(qRed(frame.pixel(kSize.width() / 2, 0)) - (i % 3 == 0 ? 127 : 0)) <= 1);
+    }
+}
+
+void TestMovieFrameDecoder::testLoopCount()
+{
+    MovieFrameDecoder decoder(":/data/tests/movieframedecoder/animated_loop_once.gif", kSize, QImage());
+    QSignalSpy spy(&decoder, &MovieFrameDecoder::frameReady);
+    decoder.start();
+
+    // played and repeated once, then it stays on the last frame
+    QTRY_COMPARE_WITH_TIMEOUT(spy.count(), 6, 5000);
+    QTest::qWait(kFrameDelayMs * 10);
+    QCOMPARE(spy.count(), 6);
+    QCOMPARE(centerPixel(spy.last().at(1)), qRgb(0, 0, 255));
+
+    // resuming a finished animation shows nothing new
+    decoder.setPaused(true);
+    decoder.setPaused(false);
+    QTest::qWait(kFrameDelayMs * 5);
+    QCOMPARE(spy.count(), 6);
+}
+
+void TestMovieFrameDecoder::testSingleFrame()
+{
+    MovieFrameDecoder decoder(":/data/tests/movieframedecoder/single_frame.gif", kSize, QImage());
+    QSignalSpy spy(&decoder, &MovieFrameDecoder::frameReady);
+    decoder.start();
+
+    // the still image is shown once, not every frame delay
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(centerPixel(spy.first().at(1)), qRgb(255, 255, 255));
+    QTest::qWait(500);
+    QCOMPARE(spy.count(), 1);
+}
+
+void TestMovieFrameDecoder::testPause()
+{
+    MovieFrameDecoder decoder(":/data/tests/movieframedecoder/animated.gif", kSize, QImage());
+    QSignalSpy spy(&decoder, &MovieFrameDecoder::frameReady);
+    decoder.start();
+    QCOMPARE(spy.count(), 1);
+
+    decoder.setPaused(true);
+    QTest::qWait(kFrameDelayMs * 5);
+    QCOMPARE(spy.count(), 1);
+
+    // it goes on from the next frame
+    decoder.setPaused(false);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(centerPixel(spy.last().at(1)), qRgb(0, 255, 0));
+}
+
+void TestMovieFrameDecoder::testNotAnImage()
+{
+    MovieFrameDecoder decoder(":/data/tests/movieframedecoder/missing.gif", kSize, QImage());
+    QSignalSpy spy(&decoder, &MovieFrameDecoder::frameReady);
+    decoder.start();
+    QTest::qWait(kFrameDelayMs * 5);
+    QCOMPARE(spy.count(), 0);
+}
+
+// The CPU time of the process while the animation plays from the frame cache, the decoder must not keep a core busy.
+// QTest has no CPU time metric, so the result is logged and checked against a generous bound.
+void TestMovieFrameDecoder::benchmarkCpuUsage()
+{
+    MovieFrameDecoder decoder(":/data/tests/movieframedecoder/animated.gif", kSize, makeOverlay());
+    QSignalSpy spy(&decoder, &MovieFrameDecoder::frameReady);
+    decoder.start();
+    // the first loop fills the cache
+    QTRY_VERIFY_WITH_TIMEOUT(spy.count() >= 3, 5000);
+
+    const std::clock_t cpuStart = std::clock();
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QTest::qWait(2000);
+    const double cpuMs = 1000.0 * (std::clock() - cpuStart) / CLOCKS_PER_SEC;
+    const qint64 wallMs = elapsed.elapsed();
+
+    qInfo() << "frames:" << spy.count() << "CPU time:" << cpuMs << "ms of" << wallMs << "ms";
+    QVERIFY(cpuMs < wallMs * 0.25);
+}
+
+QTEST_MAIN(TestMovieFrameDecoder)
+#include "movieframedecoder.test.moc"
@@ -1,6 +1,7 @@
 #include "imageresourcessvg.h"
 
 #include <QDirIterator>
+#include <QMutex>
 #include <QSvgRenderer>
 #include <QPainter>
 #include <QApplication>
@@ -9,10 +10,24 @@
 #include "utils/crashhandler.h"
 #include "utils/logger.h"
 #include "dpiscalemanager.h"
+#include "svgatlascache.h"
 #include "widgetutils/widgetutils.h"
 
-ImageResourcesSvg::ImageResourcesSvg() : QThread(nullptr), bNeedFinish_(false), bFininishedGracefully_(false)
+// the state shared by the tasks of one preloading
+struct ImageResourcesSvg::PreloadJob
 {
+    int generation;
+    double scale;
+    int devicePixelRatio;
+    QString cachePath;
+    std::atomic<int> remainingTasks { 0 };
+    QMutex mutex;
+    QHash<QString, QImage> images;      // for the atlas
+};
+
+ImageResourcesSvg::ImageResourcesSvg() : QObject(nullptr), generation_(0), bFininishedGracefully_(false)
+{
+    threadPool_.setThreadPriority(QThread::LowestPriority);
 }
 
 ImageResourcesSvg::~ImageResourcesSvg()
@@ -29,17 +44,20 @@ void ImageResourcesSvg::clearHash()
 
 void ImageResourcesSvg::clearHashAndStartPreloading()
 {
-    bNeedFinish_ = true;
-    wait();
+    // the running tasks see the new generation and stop, no need to wait for them
+    QSharedPointer<PreloadJob> job(new PreloadJob);
+    job->generation = ++generation_;
+    job->scale = G_SCALE;
+    job->devicePixelRatio = DpiScaleManager::instance().curDevicePixelRatio();
+    job->cachePath = SvgAtlasCache::filePath(job->scale, job->devicePixelRatio);
     clearHash();
-    bNeedFinish_ = false;
-    start(Priority::LowestPriority);
+    threadPool_.start([this, job] { preload(job); });
 }
 
 void ImageResourcesSvg::finishGracefully()
 {
-    bNeedFinish_ = true;
-    wait();
+    ++generation_;
+    threadPool_.waitForDone();
     clearHash();
     bFininishedGracefully_ = true;
 }
@@ -47,7 +65,6 @@ void ImageResourcesSvg::finishGracefully()
 // get pixmap with original size
 QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIndependentPixmap(const QString &name)
 {
-    QMutexLocker locker(&mutex_);
     auto it = hashIndependent_.find(name);
     if (it != hashIndependent_.end())
     {
@@ -69,7 +86,6 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIndependentPixmap(const
 
 QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIconIndependentPixmap(const QString &name)
 {
-    QMutexLocker locker(&mutex_);
     auto it = iconHashes_.find(name);
     if (it != iconHashes_.end())
     {
@@ -92,7 +108,6 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getIconIndependentPixmap(co
 
 QSharedPointer<IndependentPixmap> ImageResourcesSvg::getFlag(const QString &flagName)
 {
-    QMutexLocker locker(&mutex_);
     QSharedPointer<IndependentPixmap> ret = getIndependentPixmap("flags/" + flagName);
     if (ret)
     {
@@ -107,7 +122,6 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getFlag(const QString &flag
 QSharedPointer<IndependentPixmap> ImageResourcesSvg::getScaledFlag(const QString &flagName, int width, int height,
                                                     int flags)
 {
-    QMutexLocker locker(&mutex_);
     QSharedPointer<IndependentPixmap> ret = getIndependentPixmapScaled("flags/" + flagName, width, height, flags);
     if (ret)
     {
@@ -119,21 +133,88 @@ QSharedPointer<IndependentPixmap> ImageResourcesSvg::getScaledFlag(const QString
     }
 }
 
-void ImageResourcesSvg::run()
+void ImageResourcesSvg::preload(QSharedPointer<PreloadJob> job)
 {
     BIND_CRASH_HANDLER_FOR_THREAD();
+    QHash<QString, QImage> cached;
+    if (SvgAtlasCache::load(job->cachePath, cached)) {
+        qCDebug(LOG_BASIC) << "ImageResourcesSvg::preload() - loaded" << cached.size() << "SVGs from the cache";
+        QMetaObject::invokeMethod(this, [this, job, cached] { onImagesPreloaded(job->generation, cached); }, Qt::QueuedConnection);
+        return;
+    }
+
+    QStringList names;
     QDirIterator it(":/svg", QDirIterator::Subdirectories);
-    while (!bNeedFinish_ && it.hasNext())
-    {
+    while (it.hasNext()) {
         it.next();
         if (it.fileInfo().isFile())
-        {
-            QMutexLocker locker(&mutex_);
-            QString name = it.fileInfo().filePath().mid(6, it.fileInfo().filePath().length() - 10);
-            loadFromResource(name);
-        }
+            names << it.fileInfo().filePath().mid(6, it.fileInfo().filePath().length() - 10);
+    }
+
+    // one task per chunk, the last one to finish writes the atlas
+    job->remainingTasks = (names.size() + kSvgsPerTask - 1) / kSvgsPerTask;
+    for (int i = 0; i < names.size(); i += kSvgsPerTask) {
+        const QStringList chunk = names.mid(i, kSvgsPerTask);
+        threadPool_.start([this, job, chunk] { renderChunk(job, chunk); });
+    }
+}
+
+void ImageResourcesSvg::renderChunk(QSharedPointer<PreloadJob> job, const QStringList &names)
+{
+    BIND_CRASH_HANDLER_FOR_THREAD();
+    QHash<QString, QImage> images;
+    for (const QString &name : names) {
+        if (isCanceled(job))
+            return;
+        const QImage image = renderFromResource(name, job->scale, job->devicePixelRatio);
+        if (!image.isNull())
+            images[name] = image;
+    }
+    QMetaObject::invokeMethod(this, [this, job, images] { onImagesPreloaded(job->generation, images); }, Qt::QueuedConnection);
+
+    bool isLast;
+    {
+        QMutexLocker locker(&job->mutex);
+        job->images.insert(images);
+        isLast = --job->remainingTasks == 0;
+    }
+    if (isLast && !isCanceled(job)) {
+        SvgAtlasCache::save(job->cachePath, job->images);
+        qCDebug(LOG_BASIC) << "ImageResourcesSvg::renderChunk() - all SVGs loaded";
+    }
+}
+
+void ImageResourcesSvg::onImagesPreloaded(int generation, const QHash<QString, QImage> &images)
+{
+    if (generation != generation_)
+        return;
+    for (auto it = images.cbegin(); it != images.cend(); ++it) {
+        // the GUI thread could have rendered it already on a miss
+        if (hashIndependent_.contains(it.key()))
+            continue;
+        QPixmap pixmap = QPixmap::fromImage(it.value());
+        pixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
+        hashIndependent_[it.key()] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
     }
-    qCDebug(LOG_BASIC) << "ImageResourcesSvg::run() - all SVGs loaded";
+}
+
+bool ImageResourcesSvg::isCanceled(const QSharedPointer<PreloadJob> &job) const
+{
+    return job->generation != generation_;
+}
+
+QImage ImageResourcesSvg::renderFromResource(const QString &name, double scale, int devicePixelRatio)
+{
+    QSvgRenderer render(":/svg/" + name + ".svg");
+    if (!render.isValid())
+    {
+        return QImage();
+    }
+    QImage image(render.defaultSize() * scale * devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter painter(&image);
+    render.render(&painter);
+    return image;
 }
 
 bool ImageResourcesSvg::loadIconFromResource(const QString &name)
@@ -153,16 +234,12 @@ bool ImageResourcesSvg::loadIconFromResource(const QString &name)
 
 bool ImageResourcesSvg::loadFromResource(const QString &name)
 {
-    QSvgRenderer render(":/svg/" + name + ".svg");
-    if (!render.isValid())
+    const QImage image = renderFromResource(name, G_SCALE, DpiScaleManager::instance().curDevicePixelRatio());
+    if (image.isNull())
     {
         return false;
     }
-    QPixmap pixmap(render.defaultSize() * G_SCALE * DpiScaleManager::instance().curDevicePixelRatio());
-    pixmap.fill(Qt::transparent);
-    QPainter painter(&pixmap);
-    render.render(&painter);
-
+    QPixmap pixmap = QPixmap::fromImage(image);
     pixmap.setDevicePixelRatio(DpiScaleManager::instance().curDevicePixelRatio());
     hashIndependent_[name] = QSharedPointer<IndependentPixmap>(new IndependentPixmap(pixmap));
     return true;
@@ -1,12 +1,17 @@
 #pragma once
 
-#include <QThread>
+#include <QObject>
 #include <QPixmap>
-#include <QRecursiveMutex>
 #include <QHash>
+#include <QThreadPool>
+#include <atomic>
 #include "independentpixmap.h"
 
-class ImageResourcesSvg : public QThread
+// The SVGs are rasterized into QImages on a thread pool and handed over to the GUI thread in batches.
+// The hashes are touched by the GUI thread only, so the lookups don't lock; a miss renders the image synchronously.
+// The default-size images of each (scale, device pixel ratio) are kept in SvgAtlasCache, so later launches and
+// monitor switches load them from disk instead of rendering.
+class ImageResourcesSvg : public QObject
 {
     Q_OBJECT
 
@@ -32,20 +37,26 @@ public:
     QSharedPointer<IndependentPixmap> getFlag(const QString &flagName);
     QSharedPointer<IndependentPixmap> getScaledFlag(const QString &flagName, int width, int height, int flags = 0);
 
-protected:
-    void run() override;
-
 private:
+    struct PreloadJob;
+    static constexpr int kSvgsPerTask = 16;
+
     ImageResourcesSvg();
     virtual ~ImageResourcesSvg();
 
     QHash<QString, QSharedPointer<IndependentPixmap> > iconHashes_;
     QHash<QString, QSharedPointer<IndependentPixmap> > hashIndependent_;
-    std::atomic<bool> bNeedFinish_;
+    QThreadPool threadPool_;
+    // incremented on every preloading, the results of the previous ones are dropped
+    std::atomic<int> generation_;
     bool bFininishedGracefully_;
-    QRecursiveMutex mutex_;
 
+    void preload(QSharedPointer<PreloadJob> job);
+    void renderChunk(QSharedPointer<PreloadJob> job, const QStringList &names);
+    void onImagesPreloaded(int generation, const QHash<QString, QImage> &images);
+    bool isCanceled(const QSharedPointer<PreloadJob> &job) const;
 
+    static QImage renderFromResource(const QString &name, double scale, int devicePixelRatio);
     bool loadIconFromResource(const QString &name);
     bool loadFromResource(const QString &name);
     bool loadFromResourceWithCustomSize(const QString &name, int width, int height, int flags);
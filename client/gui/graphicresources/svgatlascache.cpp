@@ -0,0 +1,108 @@
+#include "svgatlascache.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+#include "utils/logger.h"
+#include "version/appversion.h"
+
+QString SvgAtlasCache::filePath(double scale, int devicePixelRatio)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/svg_cache/atlas_" +
+           QString::number(qRound(scale * 100)) + "_" + QString::number(devicePixelRatio) + ".bin";
+}
+
+bool SvgAtlasCache::load(const QString &path, QHash<QString, QImage> &images)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream ds(&file);
+    quint32 magic, version;
+    QString appVersion;
+    ds >> magic >> version;
+    if (magic != kMagic || version != kVersion)
+        return false;
+    ds >> appVersion;
+    if (appVersion != AppVersion::instance().fullVersionString())
+        return false;
+
+    QHash<QString, QRect> index;
+    qint32 width, height;
+    ds >> index >> width >> height;
+    if (ds.status() != QDataStream::Ok || width <= 0 || height <= 0 || width > kMaxAtlasSide || height > kMaxAtlasSide)
+        return false;
+    // a truncated or damaged file must not make us allocate the pixels it doesn't have
+    if (static_cast<qint64>(width) * height * 4 > file.bytesAvailable())
+        return false;
+
+    QImage atlas(width, height, QImage::Format_ARGB32_Premultiplied);
+    if (atlas.isNull() || ds.readRawData(reinterpret_cast<char *>(atlas.bits()), atlas.sizeInBytes()) != atlas.sizeInBytes())
+        return false;
+
+    for (auto it = index.cbegin(); it != index.cend(); ++it) {
+        if (!atlas.rect().contains(it.value()))
+            return false;
+        images[it.key()] = atlas.copy(it.value());
+    }
+    return true;
+}
+
+bool SvgAtlasCache::save(const QString &path, const QHash<QString, QImage> &images)
+{
+    // shelf packing: the tallest images first, each shelf is as tall as its first image
+    QList<QString> names = images.keys();
+    std::sort(names.begin(), names.end(), [&images](const QString &a, const QString &b) {
+        return images[a].height() > images[b].height();
+    });
+
+    int width = kAtlasWidth;
+    for (const QImage &image : images)
+        width = std::max(width, image.width());
+
+    QHash<QString, QRect> index;
+    int x = 0, y = 0, shelfHeight = 0;
+    for (const QString &name : names) {
+        const QSize size = images[name].size();
+        if (x + size.width() > width) {
+            x = 0;
+            y += shelfHeight;
+            shelfHeight = 0;
+        }
+        index[name] = QRect(QPoint(x, y), size);
+        x += size.width();
+        shelfHeight = std::max(shelfHeight, size.height());
+    }
+    const int height = std::max(1, y + shelfHeight);
+
+    QImage atlas(width, height, QImage::Format_ARGB32_Premultiplied);
+    if (atlas.isNull())
+        return false;
+    atlas.fill(Qt::transparent);
+    {
+        QPainter painter(&atlas);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        for (auto it = index.cbegin(); it != index.cend(); ++it)
+            painter.drawImage(it.value().topLeft(), images[it.key()]);
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream ds(&file);
+    ds << kMagic << kVersion << AppVersion::instance().fullVersionString() << index << qint32(width) << qint32(height);
+    ds.writeRawData(reinterpret_cast<const char *>(atlas.constBits()), atlas.sizeInBytes());
+    if (ds.status() != QDataStream::Ok || !file.commit()) {
+        qCDebug(LOG_BASIC) << "SvgAtlasCache: could not write" << path;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QHash>
+#include <QImage>
+#include <QString>
+
+// On-disk cache of the rasterized SVGs for one (scale, device pixel ratio).
+// The images are packed into a single ARGB32 premultiplied atlas and stored as raw pixels with an index of
+// (name, rect), so a launch or a monitor switch reads one file and copies the rects out instead of rendering every SVG.
+// The file is tied to the app version, since the SVGs are compiled into the resources. Thread-safe, all methods are static.
+class SvgAtlasCache
+{
+public:
+    static QString filePath(double scale, int devicePixelRatio);
+
+    // returns false if there is no file, it is from another version or it is damaged
+    static bool load(const QString &path, QHash<QString, QImage> &images);
+    // written with QSaveFile, so a crash never leaves a half-written atlas
+    static bool save(const QString &path, const QHash<QString, QImage> &images);
+
+private:
+    static constexpr quint32 kMagic = 0x53564741;   // "SVGA"
+    static constexpr quint32 kVersion = 1;
+    static constexpr int kAtlasWidth = 2048;
+    static constexpr int kMaxAtlasSide = kAtlasWidth * 4;    // a bigger atlas in a file is damaged
+};
@@ -0,0 +1,125 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include "svgatlascache.h"
+
+class TestSvgAtlasCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testNoFile();
+    void testTruncatedFile_data();
+    void testTruncatedFile();
+    void testHugeSize();
+
+private:
+    QTemporaryDir dir_;
+
+    static QHash<QString, QImage> makeImages();
+    static QImage makeImage(const QSize &size, const QColor &color);
+};
+
+QImage TestSvgAtlasCache::makeImage(const QSize &size, const QColor &color)
+{
+    QImage image(size, QImage::Format_ARGB32_Premultiplied);
+    image.fill(color);
+    // a corner pixel of another color, so a rect shifted in the atlas is noticed
+    image.setPixelColor(0, 0, Qt::white);
+    return image;
+}
+
+QHash<QString, QImage> TestSvgAtlasCache::makeImages()
+{
+    QHash<QString, QImage> images;
+    images["a"] = makeImage(QSize(16, 16), Qt::red);
+    images["b"] = makeImage(QSize(40, 10), QColor(0, 255, 0, 128));
+    images["c"] = makeImage(QSize(1, 1), Qt::blue);
+    images["wide"] = makeImage(QSize(2100, 3), Qt::black);    // wider than the default atlas
+    for (int i = 0; i < 100; ++i)
+        images[QString("icon%1").arg(i)] = makeImage(QSize(24 + i % 7, 24), QColor(i, 0, 255 - i));
+    return images;
+}
+
+void TestSvgAtlasCache::testRoundTrip()
+{
+    const QString path = dir_.filePath("roundtrip/atlas.bin");
+    const QHash<QString, QImage> images = makeImages();
+    QVERIFY(SvgAtlasCache::save(path, images));
+
+    QHash<QString, QImage> loaded;
+    QVERIFY(SvgAtlasCache::load(path, loaded));
+    QCOMPARE(loaded.size(), images.size());
+    for (auto it = images.cbegin(); it != images.cend(); ++it) {
+        QVERIFY(loaded.contains(it.key()));
+        QCOMPARE(loaded[it.key()], it.value());
+    }
+}
+
+void TestSvgAtlasCache::testNoFile()
+{
+    QHash<QString, QImage> loaded;
+    QVERIFY(!SvgAtlasCache::load(dir_.filePath("missing.bin"), loaded));
+    QVERIFY(loaded.isEmpty());
+}
+
+void TestSvgAtlasCache::testTruncatedFile_data()
+{
+    QTest::addColumn<double>("keptPart");
+
+    QTest::newRow("header only") << 0.01;
+    QTest::newRow("half") << 0.5;
+    QTest::newRow("one byte short") << -1.0;
+}
+
+void TestSvgAtlasCache::testTruncatedFile()
+{
+    QFETCH(double, keptPart);
+
+    const QString path = dir_.filePath("truncated.bin");
+    QVERIFY(SvgAtlasCache::save(path, makeImages()));
+    QFile file(path);
+    const qint64 size = file.size();
+    QVERIFY(file.resize(keptPart < 0 ? size - 1 : static_cast<qint64>(size * keptPart)));
+
+    QHash<QString, QImage> loaded;
+    QVERIFY(!SvgAtlasCache::load(path, loaded));
+    QVERIFY(loaded.isEmpty());
+}
+
+// the dimensions in a damaged file are not trusted for the allocation
+void TestSvgAtlasCache::testHugeSize()
+{
+    const QString path = dir_.filePath("huge.bin");
+    QHash<QString, QImage> images;
+    images["a"] = makeImage(QSize(4, 4), Qt::red);
+    QVERIFY(SvgAtlasCache::save(path, images));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QByteArray data = file.readAll();
+    // the width and the height are the two qint32 right before the pixels of the 2048 x 4 atlas
+    const qint64 sizePos = data.size() - 2048 * 4 * 4 - 8;
+    QVERIFY(sizePos > 0);
+    {
+        QDataStream ds(&data, QIODevice::ReadWrite);
+        ds.device()->seek(sizePos);
+        qint32 width, height;
+        ds >> width >> height;
+        QCOMPARE(width, 2048);
+        QCOMPARE(height, 4);
+        ds.device()->seek(sizePos);
+        // within the maximum size, but far more pixels than the file has
+        ds << qint32(2048) << qint32(8000);
+    }
+    QVERIFY(file.seek(0));
+    QCOMPARE(file.write(data), data.size());
+    file.close();
+
+    QHash<QString, QImage> loaded;
+    QVERIFY(!SvgAtlasCache::load(path, loaded));
+    QVERIFY(loaded.isEmpty());
+}
+
+QTEST_MAIN(TestSvgAtlasCache)
+#include "svgatlascache.test.moc"
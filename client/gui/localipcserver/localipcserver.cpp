@@ -5,6 +5,7 @@
 #include "ipc/server.h"
 #include "ipc/clicommands.h"
 #include "backend/persistentstate.h"
+#include "engine/metrics/metrics.h"
 
 LocalIPCServer::LocalIPCServer(Backend *backend, QObject *parent) : QObject(parent)
   , backend_(backend)
@@ -62,7 +63,7 @@ void LocalIPCServer::onServerCallbackAcceptFunction(IPC::Connection *connection)
     connect(connection, &IPC::Connection::stateChanged, this, &LocalIPCServer::onConnectionStateCallback);
 }
 
-void LocalIPCServer::onConnectionCommandCallback(IPC::Command *command, IPC::Connection * /*connection*/)
+void LocalIPCServer::onConnectionCommandCallback(IPC::Command *command, IPC::Connection *connection)
 {
     if (command->getStringId() ==IPC::CliCommands::ShowLocations::getCommandStringId())
     {
@@ -188,6 +189,13 @@ void LocalIPCServer::onConnectionCommandCallback(IPC::Command *command, IPC::Con
             notifyCliSignOutFinished();
         }
     }
+    else if (command->getStringId() == IPC::CliCommands::GetMetrics::getCommandStringId())
+    {
+        // the engine runs in this process, so the registry is read directly
+        IPC::CliCommands::Metrics cmd;
+        cmd.text_ = QString::fromUtf8(metrics::Registry::instance().prometheusText());
+        connection->sendCommand(cmd);
+    }
 }
 
 void LocalIPCServer::onConnectionStateCallback(int state, IPC::Connection *connection)
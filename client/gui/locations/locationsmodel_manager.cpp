@@ -38,9 +38,9 @@ LocationsModelManager::LocationsModelManager(QObject *parent) : QObject(parent)
     customConfigsProxyModel_->setSourceModel(sortedCitiesProxyModel_);
 }
 
-void LocationsModelManager::updateLocations(const LocationID &bestLocation, const QVector<types::Location> &locations)
+void LocationsModelManager::updateLocations(const LocationID &bestLocation, const types::LocationsDelta &delta)
 {
-    locationsModel_->updateLocations(bestLocation, locations);
+    locationsModel_->updateLocations(bestLocation, delta);
 }
 
 void LocationsModelManager::updateDeviceName(const QString &staticIpDeviceName)
@@ -15,7 +15,7 @@ class LocationsModelManager : public QObject
 public:
     explicit LocationsModelManager(QObject *parent = nullptr);
 
-    void updateLocations(const LocationID &bestLocation, const QVector<types::Location> &locations);
+    void updateLocations(const LocationID &bestLocation, const types::LocationsDelta &delta);
     void updateBestLocation(const LocationID &bestLocation);
     void updateCustomConfigLocation(const types::Location &location);
     void updateDeviceName(const QString &staticIpDeviceName);
@@ -1,16 +1,21 @@
 #include "favoritelocationsstorage.h"
 
-#include <QDataStream>
 #include <QDataStream>
 #include <QIODevice>
-#include <QSettings>
 
+#include "utils/settingsstore.h"
 #include "utils/simplecrypt.h"
 #include "types/global_consts.h"
 #include "legacy_protobuf_support/legacy_protobuf.h"
 
 namespace gui_locations {
 
+namespace {
+const SettingsKey<QString> kFavoriteLocationsKey { "favoriteLocations" };
+// the same key written in the legacy protobuf format
+const SettingsKey<QByteArray> kLegacyFavoriteLocationsKey { "favoriteLocations" };
+}
+
 void FavoriteLocationsStorage::addToFavorites(const LocationID &locationId)
 {
     if (!favoriteLocations_.contains(locationId))
@@ -39,12 +44,12 @@ bool FavoriteLocationsStorage::isFavorite(const LocationID &locationId) const
 void FavoriteLocationsStorage::readFromSettings()
 {
     favoriteLocations_.clear();
-    QSettings settings;
+    SettingsStore &settings = SettingsStore::instance();
     bool bLoaded = false;
-    if (settings.contains("favoriteLocations"))
+    if (settings.contains(kFavoriteLocationsKey))
     {
         SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-        QString str = settings.value("favoriteLocations", "").toString();
+        QString str = settings.value(kFavoriteLocationsKey);
         QByteArray arr = simpleCrypt.decryptToByteArray(str);
 
         QDataStream ds(&arr, QIODevice::ReadOnly);
@@ -66,7 +71,7 @@ void FavoriteLocationsStorage::readFromSettings()
 
         // try load from legacy protobuf
         if (!bLoaded) {
-            QByteArray buf = settings.value("favoriteLocations").toByteArray();
+            QByteArray buf = settings.value(kLegacyFavoriteLocationsKey);
             QSet<LocationID> lids;
             if (LegacyProtobufSupport::loadFavoriteLocations(buf, lids)) {
                 favoriteLocations_ = lids;
@@ -88,9 +93,8 @@ void FavoriteLocationsStorage::writeToSettings()
         ds << versionForSerialization_;
         ds << favoriteLocations_;
     }
-    QSettings settings;
     SimpleCrypt simpleCrypt(SIMPLE_CRYPT_KEY);
-    settings.setValue("favoriteLocations", simpleCrypt.encryptToString(arr));
+    SettingsStore::instance().setValue(kFavoriteLocationsKey, simpleCrypt.encryptToString(arr));
 
     isFavoriteLocationsSetModified_ = false;
 }
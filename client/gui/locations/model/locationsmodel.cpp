@@ -75,27 +75,70 @@ void LocationsModel::updateLocations(const LocationID &bestLocation, const QVect
         QVector<int> locationsInds = utils::findMovedLocations(locations_, newLocationsVector, isFoundMovedLocations);
         if (isFoundMovedLocations)
         {
-            // Selection sort algorithm
-            for (int i = 0; i < locationsInds.size(); i++)
-            {
-                int minz = locationsInds[i];
-                int ind = i;
-                for (int j = i + 1; j < locationsInds.size(); j++)
-                {
-                    if (locationsInds[j] < minz)
-                    {
-                        minz = locationsInds[j];
-                        ind = j;
-                    }
-                }
-                if (i != ind)
-                {
-                    beginMoveRows(QModelIndex(), ind, ind, QModelIndex(), i);
-                    locationsInds.move(ind, i);
-                    locations_.move(ind, i);
-                    endMoveRows();
-                }
-            }
+            moveLocationsToIndexes(locationsInds);
+        }
+    }
+    updateBestLocation(bestLocation);
+}
+
+void LocationsModel::updateLocations(const LocationID &bestLocation, const types::LocationsDelta &delta)
+{
+    if (delta.isReset)
+    {
+        updateLocations(bestLocation, delta.allLocations());
+        return;
+    }
+
+    for (const LocationID &lid : delta.removedLocations)
+    {
+        auto it = mapLocations_.find(lid);
+        WS_ASSERT(it != mapLocations_.end());
+        if (it == mapLocations_.end())
+        {
+            continue;
+        }
+        int removedInd = locations_.indexOf(it.value());
+        beginRemoveRows(QModelIndex(), removedInd, removedInd);
+        delete it.value();
+        mapLocations_.erase(it);
+        locations_.removeAt(removedInd);
+        endRemoveRows();
+    }
+
+    int bestLocationOffs = 0;
+    if (locations_.size() > 0 && locations_[0]->location().id.isBestLocation())
+    {
+        bestLocationOffs = 1;
+    }
+    // the remaining locations are in the same relative order, so the insertions in ascending order give the right positions
+    for (const auto &it : delta.addedLocations)
+    {
+        int ind = it.first + bestLocationOffs;
+        WS_ASSERT(ind <= locations_.size());
+        beginInsertRows(QModelIndex(), ind, ind);
+        LocationItem *li = new LocationItem(it.second);
+        mapLocations_[li->location().id] = li;
+        locations_.insert(ind, li);
+        endInsertRows();
+    }
+
+    for (const types::Location &l : delta.changedLocations)
+    {
+        auto it = mapLocations_.find(l.id);
+        WS_ASSERT(it != mapLocations_.end());
+        if (it != mapLocations_.end())
+        {
+            handleChangedLocation(locations_.indexOf(it.value()), l);
+        }
+    }
+
+    if (!delta.order.isEmpty())
+    {
+        bool isFoundMovedLocations;
+        QVector<int> locationsInds = utils::findMovedLocations(locations_, delta.order, isFoundMovedLocations);
+        if (isFoundMovedLocations)
+        {
+            moveLocationsToIndexes(locationsInds);
         }
     }
     updateBestLocation(bestLocation);
@@ -715,6 +758,32 @@ void LocationsModel::handleChangedLocation(int ind, const types::Location &newLo
     emit dataChanged(rootIndex, rootIndex);
 }
 
+// locationsInds are the target indexes for the current locations
+void LocationsModel::moveLocationsToIndexes(QVector<int> locationsInds)
+{
+    // Selection sort algorithm
+    for (int i = 0; i < locationsInds.size(); i++)
+    {
+        int minz = locationsInds[i];
+        int ind = i;
+        for (int j = i + 1; j < locationsInds.size(); j++)
+        {
+            if (locationsInds[j] < minz)
+            {
+                minz = locationsInds[j];
+                ind = j;
+            }
+        }
+        if (i != ind)
+        {
+            beginMoveRows(QModelIndex(), ind, ind, QModelIndex(), i);
+            locationsInds.move(ind, i);
+            locations_.move(ind, i);
+            endMoveRows();
+        }
+    }
+}
+
 LocationItem *LocationsModel::findAndCreateBestLocationItem(const LocationID &bestLocation)
 {
     if (!bestLocation.isValid()) {
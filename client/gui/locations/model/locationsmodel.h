@@ -4,6 +4,7 @@
 #include "favoritelocationsstorage.h"
 #include "types/location.h"
 #include "types/locationid.h"
+#include "types/locationsdelta.h"
 #include "types/pingtime.h"
 #include "locationitem.h"
 
@@ -44,6 +45,8 @@ public:
     virtual ~LocationsModel();
 
     void updateLocations(const LocationID &bestLocation, const QVector<types::Location> &newLocations);
+    // applies the changes calculated by the engine with the minimum of row insertions, removals and moves
+    void updateLocations(const LocationID &bestLocation, const types::LocationsDelta &delta);
     void updateBestLocation(const LocationID &bestLocation);
     void updateCustomConfigLocation(const types::Location &location);
     void changeConnectionSpeed(LocationID id, PingTime speed);
@@ -83,6 +86,7 @@ private:
     QVariant dataForCity(LocationItem *l, int row, int role) const;
     void clearLocations();
     void handleChangedLocation(int ind, const types::Location &newLocation);
+    void moveLocationsToIndexes(QVector<int> locationsInds);
     LocationItem *findAndCreateBestLocationItem(const LocationID &bestLocation);
 
 };
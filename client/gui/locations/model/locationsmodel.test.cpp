@@ -316,6 +316,77 @@ void TestLocationsModel::testFreeSessionStatusChange()
     QVERIFY(ind.data(gui_locations::kIsShowAsPremium).toBool() == true);
 }
 
+void TestLocationsModel::testFilter()
+{
+    gui_locations::SortedLocationsProxyModel filterModel;
+    QAbstractItemModelTester tester(&filterModel, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    filterModel.setSourceModel(locationsModel_.get());
+    filterModel.sort(0);
+
+    filterModel.setFilter("ATLANTA");
+    QCOMPARE(filterModel.rowCount(), 1);
+    QCOMPARE(filterModel.index(0, 0).data().toString(), QString("US Central"));
+    QCOMPARE(filterModel.rowCount(filterModel.index(0, 0)), 2);
+
+    // narrowing the filter while typing
+    filterModel.setFilter("gran");
+    filterModel.setFilter("granv");
+    QCOMPARE(filterModel.rowCount(), 1);
+    QCOMPARE(filterModel.rowCount(filterModel.index(0, 0)), 1);
+
+    // diacritics are ignored
+    filterModel.setFilter(QString::fromUtf8("Gránville"));
+    QCOMPARE(filterModel.rowCount(), 1);
+    QCOMPARE(gui_locations::SearchIndex::fold(QString::fromUtf8("São Paulo")), gui_locations::SearchIndex::fold("sao paulo"));
+
+    // the search index must follow the model changes: the city is renamed to "Vienna(Changed)"
+    filterModel.setFilter("vienna");
+    QCOMPARE(filterModel.rowCount(), 1);
+    filterModel.setFilter("vienna(changed)");
+    QCOMPARE(filterModel.rowCount(), 0);
+
+    QFile file(":data/tests/locationsmodel/changed_cities_captions.json");
+    file.open(QIODevice::ReadOnly);
+    QVERIFY(file.isOpen());
+    QVector<types::Location> changed = types::Location::loadLocationsFromJson(file.readAll());
+    locationsModel_->updateLocations(bestLocation_, changed);
+
+    filterModel.setFilter("vienna");
+    QCOMPARE(filterModel.rowCount(), 1);
+    filterModel.setFilter("vienna(changed)");
+    QCOMPARE(filterModel.rowCount(), 1);
+    QCOMPARE(filterModel.rowCount(filterModel.index(0, 0)), 1);
+
+    locationsModel_->updateLocations(bestLocation_, testOriginal_);
+    filterModel.setFilter("vienna");
+    filterModel.setFilter("vienna(changed)");
+    QCOMPARE(filterModel.rowCount(), 0);
+}
+
+void TestLocationsModel::testDelta()
+{
+    const QStringList files = { "deleted_locations.json", "deleted_cities.json", "changed_locations_captions.json",
+                                "changed_cities_captions.json", "changed_locations_order.json", "changed_cities_order.json" };
+    for (const QString &filename : files)
+    {
+        QFile file(":data/tests/locationsmodel/" + filename);
+        file.open(QIODevice::ReadOnly);
+        QVERIFY(file.isOpen());
+        QVector<types::Location> changed = types::Location::loadLocationsFromJson(file.readAll());
+
+        types::LocationsDelta delta = types::LocationsDelta::make(testOriginal_, changed);
+        QVERIFY(!delta.isEmpty());
+        locationsModel_->updateLocations(bestLocation_, delta);
+        QVERIFY(isModelsCorrect(bestLocation_, changed, customConfigLocation_) == true);
+
+        delta = types::LocationsDelta::make(changed, testOriginal_);
+        locationsModel_->updateLocations(bestLocation_, delta);
+        QVERIFY(isModelsCorrect(bestLocation_, testOriginal_, customConfigLocation_) == true);
+    }
+
+    QVERIFY(types::LocationsDelta::make(testOriginal_, testOriginal_).isEmpty());
+}
+
 bool TestLocationsModel::isModelsCorrect(const LocationID &bestLocation, const QVector<types::Location> &locations, const types::Location &customConfigLocation)
 {
     return isLocationsModelEqualTo(bestLocation, locations, customConfigLocation) &&
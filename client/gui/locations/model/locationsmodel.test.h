@@ -5,6 +5,7 @@
 #include <QAbstractItemModelTester>
 #include "locationsmodel.h"
 #include "proxymodels/cities_proxymodel.h"
+#include "proxymodels/sortedlocations_proxymodel.h"
 
 // tests for classes LocationsModel and CitiesModel
 // CitiesModel depends on class LocationsModel data so it makes sense to test them together
@@ -25,6 +26,8 @@ private slots:
     void testChangedOrder();
     void testChangedCaptions();
     void testFreeSessionStatusChange();
+    void testFilter();
+    void testDelta();
 
 private:
     QVector<types::Location> testOriginal_;
@@ -98,6 +98,46 @@ QVector<int> findMovedLocations(const QVector<gui_locations::LocationItem *> &or
     return v;
 }
 
+QVector<int> findMovedLocations(const QVector<gui_locations::LocationItem *> &original, const QVector<LocationID> &order, bool &outFound)
+{
+    QHash<LocationID, int> map;
+    for (int i = 0; i < order.size(); ++i)
+    {
+        map[order[i]] = i;
+    }
+
+    outFound = false;
+    QVector<int> v;
+    int offs = 0;   // to take into account the best location and custom configs location
+    for (int ind = 0; ind < original.size(); ++ind)
+    {
+        LocationID lid = original[ind]->location().id;
+        // skip the best location and custom configs location
+        if (lid.isBestLocation() || lid.isCustomConfigsLocation())
+        {
+            v << ind;
+            offs++;
+            continue;
+        }
+
+        auto it = map.find(lid);
+        if (it != map.end())
+        {
+            if (ind != (it.value() + offs))
+            {
+                outFound = true;
+            }
+            v << (it.value() + offs);
+        }
+        else
+        {
+            WS_ASSERT(false);
+        }
+    }
+
+    return v;
+}
+
 QVector<int> findRemovedCities(const QVector<types::City> &original, const CitiesVector &changed)
 {
     QVector<int> v;
@@ -32,6 +32,7 @@ QVector<int> findRemovedLocations(const QVector<gui_locations::LocationItem *> &
 QVector<int> findNewLocations(const QHash<LocationID, gui_locations::LocationItem *> &originalMapLocations, const LocationsVector &changed);
 QVector<QPair<int, int> > findChangedLocations(const QVector<gui_locations::LocationItem *> &original, const LocationsVector &changed);
 QVector<int> findMovedLocations(const QVector<gui_locations::LocationItem *> &original, const LocationsVector &changed, bool &outFound);
+QVector<int> findMovedLocations(const QVector<gui_locations::LocationItem *> &original, const QVector<LocationID> &order, bool &outFound);
 QVector<int> findRemovedCities(const QVector<types::City> &original, const CitiesVector &changed);
 QVector<int> findNewCities(const QVector<types::City> &original, const CitiesVector &changed);
 QVector<QPair<int, types::City> > findChangedCities(const QVector<types::City> &original, const CitiesVector &changed);
@@ -0,0 +1,105 @@
+#include "searchindex.h"
+
+namespace gui_locations {
+
+SearchIndex::SearchIndex() : model_(nullptr), isValid_(false)
+{
+}
+
+void SearchIndex::setModel(const QAbstractItemModel *model)
+{
+    model_ = model;
+    invalidate();
+}
+
+void SearchIndex::invalidate()
+{
+    isValid_ = false;
+}
+
+void SearchIndex::setFilter(const QString &filter)
+{
+    const QString folded = fold(filter);
+    if (!isValid_) {
+        filter_ = folded;
+        rebuildIfNeed();
+    } else if (folded != filter_) {
+        const bool isNarrowing = !filter_.isEmpty() && folded.contains(filter_);
+        match(folded, isNarrowing);
+    }
+}
+
+bool SearchIndex::isCountryAccepted(int countryRow)
+{
+    rebuildIfNeed();
+    return countriesWithMatches_.contains(countryRow);
+}
+
+bool SearchIndex::isCityAccepted(int countryRow, int cityRow)
+{
+    rebuildIfNeed();
+    return matchedCountries_.contains(countryRow) || matchedCities_.contains(cityKey(countryRow, cityRow));
+}
+
+QString SearchIndex::fold(const QString &str)
+{
+    // decompose the characters and drop the combining marks, then fold the case
+    const QString decomposed = str.normalized(QString::NormalizationForm_KD);
+    QString res;
+    res.reserve(decomposed.size());
+    for (const QChar ch : decomposed) {
+        if (ch.category() != QChar::Mark_NonSpacing)
+            res += ch;
+    }
+    return res.toCaseFolded();
+}
+
+void SearchIndex::rebuildIfNeed()
+{
+    if (isValid_)
+        return;
+
+    entries_.clear();
+    if (model_) {
+        for (int i = 0, cnt = model_->rowCount(); i < cnt; ++i) {
+            const QModelIndex mi = model_->index(i, 0);
+            entries_ << Entry { fold(mi.data().toString()), i, -1 };
+            for (int c = 0, citiesCnt = model_->rowCount(mi); c < citiesCnt; ++c)
+                entries_ << Entry { fold(model_->index(c, 0, mi).data().toString()), i, c };
+        }
+    }
+    isValid_ = true;
+    match(filter_, false);
+}
+
+void SearchIndex::match(const QString &filter, bool isNarrowing)
+{
+    QVector<int> matched;
+    if (isNarrowing) {
+        for (int ind : qAsConst(matchedEntries_)) {
+            if (entries_[ind].text.contains(filter))
+                matched << ind;
+        }
+    } else {
+        for (int ind = 0; ind < entries_.size(); ++ind) {
+            if (entries_[ind].text.contains(filter))
+                matched << ind;
+        }
+    }
+
+    filter_ = filter;
+    matchedEntries_ = matched;
+    countriesWithMatches_.clear();
+    matchedCountries_.clear();
+    matchedCities_.clear();
+    for (int ind : qAsConst(matchedEntries_)) {
+        const Entry &entry = entries_[ind];
+        countriesWithMatches_.insert(entry.countryRow);
+        if (entry.cityRow == -1)
+            matchedCountries_.insert(entry.countryRow);
+        else
+            matchedCities_.insert(cityKey(entry.countryRow, entry.cityRow));
+    }
+}
+
+} //namespace gui_locations
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QAbstractItemModel>
+#include <QSet>
+#include <QVector>
+
+namespace gui_locations {
+
+// Prebuilt search index over the captions of countries and cities of LocationsModel.
+// Captions are stored case and diacritics folded, so the filter "sao" matches "São Paulo".
+// Matches are calculated once per filter change, after that the filterAcceptsRow() checks are hash lookups.
+// When the filter is being typed (the new filter contains the previous one), only the previous matches are re-checked.
+class SearchIndex
+{
+public:
+    SearchIndex();
+
+    void setModel(const QAbstractItemModel *model);
+    // must be called when the captions or the structure of the model are changed
+    void invalidate();
+
+    void setFilter(const QString &filter);
+    bool isCountryAccepted(int countryRow);
+    bool isCityAccepted(int countryRow, int cityRow);
+
+    static QString fold(const QString &str);
+
+private:
+    struct Entry
+    {
+        QString text;
+        int countryRow;
+        int cityRow;        // -1 for a country
+    };
+
+    const QAbstractItemModel *model_;
+    bool isValid_;
+    QVector<Entry> entries_;
+    QString filter_;                    // folded filter for which the matches were calculated
+    QVector<int> matchedEntries_;       // indexes in entries_
+    QSet<int> countriesWithMatches_;    // the country or any of its cities matches the filter
+    QSet<int> matchedCountries_;        // the country caption matches the filter
+    QSet<quint64> matchedCities_;
+
+    void rebuildIfNeed();
+    void match(const QString &filter, bool isNarrowing);
+    static quint64 cityKey(int countryRow, int cityRow) { return (quint64(countryRow) << 32) | quint32(cityRow); }
+};
+
+} //namespace gui_locations
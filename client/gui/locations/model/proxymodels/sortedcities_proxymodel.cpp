@@ -1,12 +1,19 @@
 #include "sortedcities_proxymodel.h"
-#include "../../locationsmodel_roles.h"
-#include "types/locationid.h"
+#include "utils/ws_assert.h"
 
 namespace gui_locations {
 
 SortedCitiesProxyModel::SortedCitiesProxyModel(QObject *parent) : QSortFilterProxyModel(parent),
     orderLocationsType_(ORDER_LOCATION_BY_GEOGRAPHY)
 {
+    connect(&sortKeysCache_, &SortKeysCache::collationChanged, this, &SortedCitiesProxyModel::invalidate);
+}
+
+void SortedCitiesProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    // the cache must receive the source model signals before QSortFilterProxyModel re-sorts
+    sortKeysCache_.setSourceModel(sourceModel);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
 }
 
 void SortedCitiesProxyModel::setLocationOrder(ORDER_LOCATION_TYPE orderLocationType)
@@ -20,13 +27,16 @@ void SortedCitiesProxyModel::setLocationOrder(ORDER_LOCATION_TYPE orderLocationT
 
 bool SortedCitiesProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
+    const SortKeysCache::Keys leftKeys = sortKeysCache_.keys(left);
+    const SortKeysCache::Keys rightKeys = sortKeysCache_.keys(right);
+
     if (orderLocationsType_ == ORDER_LOCATION_BY_GEOGRAPHY || orderLocationsType_ == ORDER_LOCATION_BY_ALPHABETICALLY)
     {
-        return lessThanByAlphabetically(left, right);
+        return lessThanByAlphabetically(leftKeys, rightKeys);
     }
     else if (orderLocationsType_ == ORDER_LOCATION_BY_LATENCY)
     {
-        return lessThanByLatency(left, right);
+        return lessThanByLatency(leftKeys, rightKeys);
     }
     else
     {
@@ -36,18 +46,18 @@ bool SortedCitiesProxyModel::lessThan(const QModelIndex &left, const QModelIndex
 
 }
 
-bool SortedCitiesProxyModel::lessThanByAlphabetically(const QModelIndex &left, const QModelIndex &right) const
+bool SortedCitiesProxyModel::lessThanByAlphabetically(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const
 {
-    return sourceModel()->data(left).toString() < sourceModel()->data(right).toString();
+    return SortKeysCache::lessThanByCaption(left, right);
 }
 
-bool SortedCitiesProxyModel::lessThanByLatency(const QModelIndex &left, const QModelIndex &right) const
+bool SortedCitiesProxyModel::lessThanByLatency(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const
 {
-    int leftLatency = sourceModel()->data(left, kPingTime).toInt();
-    int rightLatency = sourceModel()->data(right, kPingTime).toInt();
+    int leftLatency = left.latency;
+    int rightLatency = right.latency;
     if (leftLatency == rightLatency)
     {
-        return sourceModel()->data(left).toString() < sourceModel()->data(right).toString();
+        return SortKeysCache::lessThanByCaption(left, right);
     }
     else
     {
@@ -2,6 +2,7 @@
 
 #include <QSortFilterProxyModel>
 #include "types/enums.h"
+#include "sortkeyscache.h"
 
 namespace gui_locations {
 
@@ -11,6 +12,7 @@ class SortedCitiesProxyModel : public QSortFilterProxyModel
 public:
     explicit SortedCitiesProxyModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     void setLocationOrder(ORDER_LOCATION_TYPE orderLocationType);
 
 protected:
@@ -18,10 +20,10 @@ protected:
 
 private:
     ORDER_LOCATION_TYPE orderLocationsType_;
+    SortKeysCache sortKeysCache_;
 
-    bool lessThanByAlphabetically(const QModelIndex &left, const QModelIndex &right) const;
-    bool lessThanByLatency(const QModelIndex &left, const QModelIndex &right) const;
+    bool lessThanByAlphabetically(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const;
+    bool lessThanByLatency(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const;
 };
 
 } //namespace gui_locations
-
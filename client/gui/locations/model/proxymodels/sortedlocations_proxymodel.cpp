@@ -1,12 +1,36 @@
 #include "sortedlocations_proxymodel.h"
 #include "../../locationsmodel_roles.h"
-#include "types/locationid.h"
+#include "utils/ws_assert.h"
 
 namespace gui_locations {
 
 SortedLocationsProxyModel::SortedLocationsProxyModel(QObject *parent) : QSortFilterProxyModel(parent),
     orderLocationsType_(ORDER_LOCATION_BY_GEOGRAPHY)
 {
+    connect(&sortKeysCache_, &SortKeysCache::collationChanged, this, &SortedLocationsProxyModel::invalidate);
+}
+
+void SortedLocationsProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    for (const QMetaObject::Connection &discIter : qAsConst(sourceConnections_))
+        disconnect(discIter);
+    sourceConnections_.clear();
+
+    // the caches must receive the source model signals before QSortFilterProxyModel re-sorts and re-filters
+    sortKeysCache_.setSourceModel(sourceModel);
+    searchIndex_.setModel(sourceModel);
+    if (sourceModel) {
+        auto invalidateSearchIndex = [this]() { searchIndex_.invalidate(); };
+        sourceConnections_ = QVector<QMetaObject::Connection>{
+            connect(sourceModel, &QAbstractItemModel::dataChanged, this, &SortedLocationsProxyModel::onSourceDataChanged),
+            connect(sourceModel, &QAbstractItemModel::modelReset, this, invalidateSearchIndex),
+            connect(sourceModel, &QAbstractItemModel::layoutChanged, this, invalidateSearchIndex),
+            connect(sourceModel, &QAbstractItemModel::rowsInserted, this, invalidateSearchIndex),
+            connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, invalidateSearchIndex),
+            connect(sourceModel, &QAbstractItemModel::rowsMoved, this, invalidateSearchIndex)
+        };
+    }
+    QSortFilterProxyModel::setSourceModel(sourceModel);
 }
 
 void SortedLocationsProxyModel::setLocationOrder(ORDER_LOCATION_TYPE orderLocationType)
@@ -22,23 +46,37 @@ void SortedLocationsProxyModel::setFilter(const QString &filter)
 {
     if (filter != filter_) {
         filter_ = filter;
-        invalidate();
+        if (!filter_.isEmpty())
+            searchIndex_.setFilter(filter_);
+        invalidateFilter();
     }
 }
 
 bool SortedLocationsProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
+    const SortKeysCache::Keys leftKeys = sortKeysCache_.keys(left);
+    const SortKeysCache::Keys rightKeys = sortKeysCache_.keys(right);
+
+    // keep the best location on top
+    if (leftKeys.isBestLocation && !rightKeys.isBestLocation) {
+        return true;
+    }
+
+    if (!leftKeys.isBestLocation && rightKeys.isBestLocation) {
+        return false;
+    }
+
     if (orderLocationsType_ == ORDER_LOCATION_BY_GEOGRAPHY)
     {
-        return lessThanByGeography(left, right);
+        return lessThanByGeography(left, right, leftKeys, rightKeys);
     }
     else if (orderLocationsType_ == ORDER_LOCATION_BY_ALPHABETICALLY)
     {
-        return lessThanByAlphabetically(left, right);
+        return lessThanByAlphabetically(leftKeys, rightKeys);
     }
     else if (orderLocationsType_ == ORDER_LOCATION_BY_LATENCY)
     {
-        return lessThanByLatency(left, right);
+        return lessThanByLatency(leftKeys, rightKeys);
     }
     else
     {
@@ -50,9 +88,7 @@ bool SortedLocationsProxyModel::lessThan(const QModelIndex &left, const QModelIn
 bool SortedLocationsProxyModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
 {
     QModelIndex mi = sourceModel()->index(source_row, 0, source_parent);
-    QVariant v = sourceModel()->data(mi, kLocationId);
-    LocationID lid = qvariant_cast<LocationID>(v);
-    if (lid.isStaticIpsLocation() || lid.isCustomConfigsLocation())
+    if (sortKeysCache_.keys(mi).isStaticIpsOrCustomConfigs)
         return false;
 
     if (filter_.isEmpty())
@@ -60,88 +96,43 @@ bool SortedLocationsProxyModel::filterAcceptsRow(int source_row, const QModelInd
 
     //  filtering by search string
     if (!source_parent.isValid()) {   // country
-        QModelIndex mi = sourceModel()->index(source_row, 0, source_parent);
-        if (mi.data().toString().contains(filter_, Qt::CaseInsensitive))
-            return true;
-
-        for (int i = 0, cnt = sourceModel()->rowCount(mi); i < cnt; ++i) {
-            QModelIndex childMi = sourceModel()->index(i, 0, mi);
-            if (childMi.data().toString().contains(filter_, Qt::CaseInsensitive))
-                return true;
-        }
-
+        return searchIndex_.isCountryAccepted(source_row);
     } else {    // city
-        if (source_parent.data().toString().contains(filter_, Qt::CaseInsensitive))
-            return true;
-
-        QModelIndex childMi = sourceModel()->index(source_row, 0, source_parent);
-        if (childMi.data().toString().contains(filter_, Qt::CaseInsensitive))
-            return true;
+        return searchIndex_.isCityAccepted(source_parent.row(), source_row);
     }
-
-    return false;
-
 }
 
-bool SortedLocationsProxyModel::lessThanByGeography(const QModelIndex &left, const QModelIndex &right) const
+void SortedLocationsProxyModel::onSourceDataChanged(const QModelIndex & /*topLeft*/, const QModelIndex & /*bottomRight*/, const QList<int> &roles)
 {
-    LocationID leftLid = qvariant_cast<LocationID>(sourceModel()->data(left, kLocationId));
-    LocationID rightLid = qvariant_cast<LocationID>(sourceModel()->data(right, kLocationId));
-
-    // keep the best location on top
-    if (leftLid.isBestLocation() && !rightLid.isBestLocation()) {
-        return true;
-    }
-
-    if (!leftLid.isBestLocation() && rightLid.isBestLocation()) {
-        return false;
-    }
+    // only a caption change affects the search results
+    if (roles.isEmpty() || roles.contains(Qt::DisplayRole) || roles.contains(kName))
+        searchIndex_.invalidate();
+}
 
+bool SortedLocationsProxyModel::lessThanByGeography(const QModelIndex &left, const QModelIndex &right,
+                                                    const SortKeysCache::Keys &leftKeys, const SortKeysCache::Keys &rightKeys) const
+{
     // If it is a country then sort by index
-    if (leftLid.isTopLevelLocation()) {
+    if (leftKeys.isTopLevelLocation) {
         return left.row() < right.row();
     }
 
     // cities are sorted alphabetically
-    return sourceModel()->data(left).toString() < sourceModel()->data(right).toString();
+    return SortKeysCache::lessThanByCaption(leftKeys, rightKeys);
 }
 
-bool SortedLocationsProxyModel::lessThanByAlphabetically(const QModelIndex &left, const QModelIndex &right) const
+bool SortedLocationsProxyModel::lessThanByAlphabetically(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const
 {
-    LocationID leftLid = qvariant_cast<LocationID>(sourceModel()->data(left, kLocationId));
-    LocationID rightLid = qvariant_cast<LocationID>(sourceModel()->data(right, kLocationId));
-
-    // keep the best location on top
-    if (leftLid.isBestLocation() && !rightLid.isBestLocation()) {
-        return true;
-    }
-
-    if (!leftLid.isBestLocation() && rightLid.isBestLocation()) {
-        return false;
-    }
-
-    return sourceModel()->data(left).toString() < sourceModel()->data(right).toString();
+    return SortKeysCache::lessThanByCaption(left, right);
 }
 
-bool SortedLocationsProxyModel::lessThanByLatency(const QModelIndex &left, const QModelIndex &right) const
+bool SortedLocationsProxyModel::lessThanByLatency(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const
 {
-    LocationID leftLid = qvariant_cast<LocationID>(sourceModel()->data(left, kLocationId));
-    LocationID rightLid = qvariant_cast<LocationID>(sourceModel()->data(right, kLocationId));
-
-    // keep the best location on top
-    if (leftLid.isBestLocation() && !rightLid.isBestLocation()) {
-        return true;
-    }
-
-    if (!leftLid.isBestLocation() && rightLid.isBestLocation()) {
-        return false;
-    }
-
-    int leftLatency = sourceModel()->data(left, kPingTime).toInt();
-    int rightLatency = sourceModel()->data(right, kPingTime).toInt();
+    int leftLatency = left.latency;
+    int rightLatency = right.latency;
     if (leftLatency == rightLatency)
     {
-        return sourceModel()->data(left).toString() < sourceModel()->data(right).toString();
+        return SortKeysCache::lessThanByCaption(left, right);
     }
     else
     {
@@ -162,4 +153,3 @@ bool SortedLocationsProxyModel::lessThanByLatency(const QModelIndex &left, const
 }
 
 } //namespace gui_locations
-
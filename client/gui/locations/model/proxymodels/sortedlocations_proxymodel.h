@@ -2,6 +2,8 @@
 
 #include <QSortFilterProxyModel>
 #include "types/enums.h"
+#include "searchindex.h"
+#include "sortkeyscache.h"
 
 namespace gui_locations {
 
@@ -12,6 +14,7 @@ class SortedLocationsProxyModel : public QSortFilterProxyModel
     Q_OBJECT
 public:
     explicit SortedLocationsProxyModel(QObject *parent = nullptr);
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     void setLocationOrder(ORDER_LOCATION_TYPE orderLocationType);
     void setFilter(const QString &filter);
 
@@ -19,14 +22,19 @@ protected:
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
     bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const override;
 
+private slots:
+    void onSourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
 private:
     ORDER_LOCATION_TYPE orderLocationsType_;
     QString filter_;
+    SortKeysCache sortKeysCache_;
+    mutable SearchIndex searchIndex_;
+    QVector<QMetaObject::Connection> sourceConnections_;
 
-    bool lessThanByGeography(const QModelIndex &left, const QModelIndex &right) const;
-    bool lessThanByAlphabetically(const QModelIndex &left, const QModelIndex &right) const;
-    bool lessThanByLatency(const QModelIndex &left, const QModelIndex &right) const;
+    bool lessThanByGeography(const QModelIndex &left, const QModelIndex &right, const SortKeysCache::Keys &leftKeys, const SortKeysCache::Keys &rightKeys) const;
+    bool lessThanByAlphabetically(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const;
+    bool lessThanByLatency(const SortKeysCache::Keys &left, const SortKeysCache::Keys &right) const;
 };
 
 } //namespace gui_locations
-
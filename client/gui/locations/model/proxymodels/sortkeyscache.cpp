@@ -0,0 +1,89 @@
+#include "sortkeyscache.h"
+#include "../../locationsmodel_roles.h"
+#include "languagecontroller.h"
+#include "types/locationid.h"
+
+namespace gui_locations {
+
+SortKeysCache::SortKeysCache(QObject *parent) : QObject(parent),
+    sourceModel_(nullptr)
+{
+    connect(&LanguageController::instance(), &LanguageController::languageChanged, this, &SortKeysCache::onLanguageChanged);
+    onLanguageChanged();
+}
+
+void SortKeysCache::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    for (const QMetaObject::Connection &discIter : qAsConst(sourceConnections_))
+        disconnect(discIter);
+    sourceConnections_.clear();
+    clear();
+
+    sourceModel_ = sourceModel;
+    if (sourceModel_) {
+        sourceConnections_ = QVector<QMetaObject::Connection>{
+            connect(sourceModel_, &QAbstractItemModel::dataChanged, this, &SortKeysCache::onDataChanged),
+            connect(sourceModel_, &QAbstractItemModel::modelReset, this, &SortKeysCache::clear),
+            connect(sourceModel_, &QAbstractItemModel::layoutChanged, this, &SortKeysCache::clear),
+            connect(sourceModel_, &QAbstractItemModel::rowsInserted, this, &SortKeysCache::clear),
+            connect(sourceModel_, &QAbstractItemModel::rowsRemoved, this, &SortKeysCache::clear),
+            connect(sourceModel_, &QAbstractItemModel::rowsMoved, this, &SortKeysCache::clear)
+        };
+    }
+}
+
+// Returns a copy, since a reference to the hash value may be invalidated by the next insertion
+SortKeysCache::Keys SortKeysCache::keys(const QModelIndex &sourceIndex) const
+{
+    auto it = cache_.constFind(sourceIndex);
+    if (it != cache_.constEnd())
+        return it.value();
+
+    const QString caption = sourceIndex.data().toString();
+    const LocationID lid = qvariant_cast<LocationID>(sourceIndex.data(kLocationId));
+    Keys keys { collator_.sortKey(caption), caption, sourceIndex.data(kPingTime).toInt(),
+                lid.isBestLocation(), lid.isTopLevelLocation(), lid.isStaticIpsLocation() || lid.isCustomConfigsLocation() };
+    cache_.insert(sourceIndex, keys);
+    return keys;
+}
+
+bool SortKeysCache::lessThanByCaption(const Keys &left, const Keys &right)
+{
+    int res = left.sortKey.compare(right.sortKey);
+    if (res == 0)
+        return left.caption < right.caption;
+    return res < 0;
+}
+
+void SortKeysCache::onLanguageChanged()
+{
+    const QString language = LanguageController::instance().getLanguage();
+    collator_.setLocale(language.isEmpty() ? QLocale() : QLocale(language));
+    clear();
+    emit collationChanged();
+}
+
+void SortKeysCache::onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles)
+{
+    // the ping time changes most often, so just update the latency without recalculating the collation key
+    const bool isOnlyPingTimeChanged = (roles.size() == 1 && roles[0] == kPingTime);
+
+    for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+        const QModelIndex mi = sourceModel_->index(row, 0, topLeft.parent());
+        auto it = cache_.find(mi);
+        if (it == cache_.end())
+            continue;
+
+        if (isOnlyPingTimeChanged)
+            it->latency = mi.data(kPingTime).toInt();
+        else
+            cache_.erase(it);
+    }
+}
+
+void SortKeysCache::clear()
+{
+    cache_.clear();
+}
+
+} //namespace gui_locations
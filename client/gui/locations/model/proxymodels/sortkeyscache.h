@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QCollator>
+#include <QHash>
+#include <QModelIndex>
+#include <QObject>
+
+namespace gui_locations {
+
+// Caches the per-item values the sorting/filtering proxy models need (collation key of the caption, latency, location type),
+// so that comparisons don't have to call sourceModel()->data() and convert QVariants every time.
+// The cache is filled lazily. An item is dropped when its data changes, the whole cache is dropped on any structural change of the model.
+// Must be connected to the source model before the proxy model, so that the keys are already up to date when the proxy re-sorts.
+class SortKeysCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct Keys
+    {
+        QCollatorSortKey sortKey;   // collation key of the caption for the current language
+        QString caption;            // used if the collation keys are equal or not supported on the platform
+        int latency;
+        bool isBestLocation;
+        bool isTopLevelLocation;
+        bool isStaticIpsOrCustomConfigs;
+    };
+
+    explicit SortKeysCache(QObject *parent = nullptr);
+
+    void setSourceModel(QAbstractItemModel *sourceModel);
+    Keys keys(const QModelIndex &sourceIndex) const;
+
+    static bool lessThanByCaption(const Keys &left, const Keys &right);
+
+signals:
+    // the collation has changed (the language was switched), the items must be re-sorted
+    void collationChanged();
+
+private slots:
+    void onLanguageChanged();
+    void onDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles);
+
+private:
+    QAbstractItemModel *sourceModel_;
+    QVector<QMetaObject::Connection> sourceConnections_;
+    QCollator collator_;
+    mutable QHash<QModelIndex, Keys> cache_;
+
+    void clear();
+};
+
+} //namespace gui_locations
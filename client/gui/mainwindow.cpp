@@ -30,6 +30,7 @@
 #include "utils/logger.h"
 #include "utils/writeaccessrightschecker.h"
 #include "utils/mergelog.h"
+#include "utils/settingsstore.h"
 #include "languagecontroller.h"
 #include "multipleaccountdetection/multipleaccountdetectionfactory.h"
 #include "dialogs/dialoggetusernamepassword.h"
@@ -549,9 +550,11 @@ bool MainWindow::doClose(QCloseEvent *event, bool isFromSigTerm_mac)
     // objects.
     notificationsController_.shutdown();
 
-    // Save favorites and persistent state here for the reason above.
+    // Save favorites and persistent state here for the reason above. The settings are written behind,
+    // so they are flushed right away too, ~Backend may never run.
     PersistentState::instance().save();
     backend_->locationsModelManager()->saveFavoriteLocations();
+    SettingsStore::instance().flush();
 
     if (WindscribeApplication::instance()->isExitWithRestart() || isFromSigTerm_mac || isSpontaneousCloseEvent_) {
         // Since we may process events below, disable UI updates and prevent the slot for this signal
@@ -1,10 +1,86 @@
 #include "makecustomshadow.h"
 
 #include <QPainter>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
-QT_BEGIN_NAMESPACE
-  extern void qt_blurImage(QPainter *p, QImage &blurImage, qreal radius, bool quality, bool alphaOnly, int transposed = 0 );
-QT_END_NAMESPACE
+namespace {
+
+// One box blur pass along the columns of a width x height plane, the window is 2 * r + 1 rows and the pixels outside are zero.
+// The window sums are kept for a whole row, so every loop runs over contiguous bytes and the compiler vectorizes it.
+void boxBlurColumns(const quint8 *src, quint8 *dst, int width, int height, int r)
+{
+    std::vector<quint32> sums(width, 0);
+    const quint32 scale = (1u << 16) / (2 * r + 1);     // 1 / (2r + 1) in 16.16 fixed point
+
+    for (int y = 0; y < r && y < height; ++y) {
+        const quint8 *row = src + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x)
+            sums[x] += row[x];
+    }
+    for (int y = 0; y < height; ++y) {
+        if (y + r < height) {
+            const quint8 *row = src + static_cast<size_t>(y + r) * width;
+            for (int x = 0; x < width; ++x)
+                sums[x] += row[x];
+        }
+        quint8 *out = dst + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x)
+            out[x] = static_cast<quint8>((sums[x] * scale + 0x8000) >> 16);
+        if (y - r >= 0) {
+            const quint8 *row = src + static_cast<size_t>(y - r) * width;
+            for (int x = 0; x < width; ++x)
+                sums[x] -= row[x];
+        }
+    }
+}
+
+void transpose(const quint8 *src, quint8 *dst, int width, int height)
+{
+    constexpr int kTile = 32;
+    for (int ty = 0; ty < height; ty += kTile) {
+        for (int tx = 0; tx < width; tx += kTile) {
+            for (int y = ty; y < std::min(ty + kTile, height); ++y) {
+                for (int x = tx; x < std::min(tx + kTile, width); ++x)
+                    dst[static_cast<size_t>(x) * height + y] = src[static_cast<size_t>(y) * width + x];
+            }
+        }
+    }
+}
+
+// Three box passes in each direction approximate a gaussian with sigma = radius / 2.
+// The horizontal passes run on the transposed plane, so they are column passes as well.
+constexpr int kPasses = 3;
+
+int boxRadius(qreal radius)
+{
+    const qreal sigma = radius / 2;
+    return qRound((std::sqrt(12 * sigma * sigma / kPasses + 1) - 1) / 2);
+}
+
+void blurAlphaPlane(std::vector<quint8> &plane, int width, int height, qreal radius)
+{
+    const int r = boxRadius(radius);
+    if (r < 1 || width == 0 || height == 0)
+        return;
+
+    std::vector<quint8> tmp(plane.size());
+    for (int i = 0; i < kPasses; ++i) {
+        boxBlurColumns(plane.data(), tmp.data(), width, height, r);
+        plane.swap(tmp);
+    }
+    transpose(plane.data(), tmp.data(), width, height);
+    plane.swap(tmp);
+    for (int i = 0; i < kPasses; ++i) {
+        boxBlurColumns(plane.data(), tmp.data(), height, width, r);
+        plane.swap(tmp);
+    }
+    transpose(plane.data(), tmp.data(), height, width);
+    plane.swap(tmp);
+}
+
+} // namespace
 
 // only correct for 100% scaling -- user code should scale the pixmap
 QPixmap MakeCustomShadow::makeShadowForPixmap(QPixmap &sourcePixmap, qreal distance, qreal blurRadius, const QColor& color)
@@ -18,21 +94,61 @@ QPixmap MakeCustomShadow::makeShadowForPixmap(QPixmap &sourcePixmap, qreal dista
     tmpPainter.drawPixmap(QPointF(distance, distance), sourcePixmap);
     tmpPainter.end();
 
-    // blur the alpha channel
-    QImage blurred(szi, QImage::Format_ARGB32_Premultiplied);
-    blurred.fill(0);
-    QPainter blurPainter(&blurred);
-    qt_blurImage(&blurPainter, tmp, blurRadius, false, false);
-    blurPainter.end();
+    // blur the alpha channel only, the color replaces the source colors anyway
+    const int width = szi.width();
+    const int height = szi.height();
+    std::vector<quint8> alpha(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb *>(tmp.constScanLine(y));
+        for (int x = 0; x < width; ++x)
+            alpha[static_cast<size_t>(y) * width + x] = static_cast<quint8>(qAlpha(line[x]));
+    }
+    blurAlphaPlane(alpha, width, height, blurRadius);
 
-    tmp = blurred;
-
-    // blacken the image
-    tmpPainter.begin(&tmp);
-    tmpPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-    //tmpPainter.setOpacity(0.8);
-    tmpPainter.fillRect(tmp.rect(), color);
-    tmpPainter.end();
+    // colorize the image, the same as filling the blurred image with the color in the SourceIn mode
+    QRgb colorByAlpha[256];
+    for (int a = 0; a < 256; ++a)
+        colorByAlpha[a] = qPremultiply(qRgba(color.red(), color.green(), color.blue(), color.alpha() * a / 255));
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(tmp.scanLine(y));
+        for (int x = 0; x < width; ++x)
+            line[x] = colorByAlpha[alpha[static_cast<size_t>(y) * width + x]];
+    }
 
     return QPixmap::fromImage(tmp);
 }
+
+int MakeCustomShadow::rectangleTemplateSide(qreal blurRadius)
+{
+    // a pixel of the blurred plane depends on the pixels up to kPasses * r away, so the middle pixel of this square sees all of it
+    // and the corners don't see the opposite edges
+    return 2 * kPasses * qMax(boxRadius(blurRadius), 0) + 1;
+}
+
+void MakeCustomShadow::drawShadowForRectangle(QPainter *painter, const QPoint &pos, const QSize &size, const QPixmap &templateShadow, int distance)
+{
+    // the template is the shadow of a square of rectangleTemplateSide(), the corner pieces end before its middle pixel
+    const int corner = templateShadow.width() / 2;
+    const int tw = templateShadow.width();
+    const int w = size.width() + 2 * distance;
+    const int h = size.height() + 2 * distance;
+    const int mw = w - 2 * corner;
+    const int mh = h - 2 * corner;
+
+    const int x = pos.x();
+    const int y = pos.y();
+    painter->drawPixmap(QRect(x, y, corner, corner), templateShadow, QRect(0, 0, corner, corner));
+    painter->drawPixmap(QRect(x + w - corner, y, corner, corner), templateShadow, QRect(tw - corner, 0, corner, corner));
+    painter->drawPixmap(QRect(x, y + h - corner, corner, corner), templateShadow, QRect(0, tw - corner, corner, corner));
+    painter->drawPixmap(QRect(x + w - corner, y + h - corner, corner, corner), templateShadow, QRect(tw - corner, tw - corner, corner, corner));
+    if (mw > 0) {
+        painter->drawPixmap(QRect(x + corner, y, mw, corner), templateShadow, QRect(corner, 0, 1, corner));
+        painter->drawPixmap(QRect(x + corner, y + h - corner, mw, corner), templateShadow, QRect(corner, tw - corner, 1, corner));
+    }
+    if (mh > 0) {
+        painter->drawPixmap(QRect(x, y + corner, corner, mh), templateShadow, QRect(0, corner, corner, 1));
+        painter->drawPixmap(QRect(x + w - corner, y + corner, corner, mh), templateShadow, QRect(tw - corner, corner, corner, 1));
+    }
+    if (mw > 0 && mh > 0)
+        painter->drawPixmap(QRect(x + corner, y + corner, mw, mh), templateShadow, QRect(corner, corner, 1, 1));
+}
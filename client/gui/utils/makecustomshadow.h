@@ -2,8 +2,16 @@
 
 #include <QPixmap>
 
+class QPainter;
+
 class MakeCustomShadow
 {
 public:
     static QPixmap makeShadowForPixmap(QPixmap &sourcePixmap, qreal distance, qreal blurRadius, const QColor &color);
+
+    // The shadow of a rectangle is the same along each edge and in its middle, so it is composited from the shadow of a small square
+    // (9-slice): the corners are copied and the edge and middle pixels are stretched, the result is the same as the blur of the whole rectangle.
+    // The rectangles with a side below rectangleTemplateSide() are blurred as a whole.
+    static int rectangleTemplateSide(qreal blurRadius);
+    static void drawShadowForRectangle(QPainter *painter, const QPoint &pos, const QSize &size, const QPixmap &templateShadow, int distance);
 };
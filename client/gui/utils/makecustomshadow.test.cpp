@@ -0,0 +1,126 @@
+#include <QtTest>
+#include <QPainter>
+#include "makecustomshadow.h"
+
+QT_BEGIN_NAMESPACE
+  extern void qt_blurImage(QPainter *p, QImage &blurImage, qreal radius, bool quality, bool alphaOnly, int transposed = 0 );
+QT_END_NAMESPACE
+
+class TestMakeCustomShadow : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testBlurAgainstQtBlur_data();
+    void testBlurAgainstQtBlur();
+    void testRectangleShadow_data();
+    void testRectangleShadow();
+
+private:
+    // the margin and the blur radius of ShadowManager
+    static constexpr int kDistance = 30;
+    static constexpr int kBlurRadius = 30;
+
+    static QImage blackRectangleShadow(const QSize &size);
+};
+
+QImage TestMakeCustomShadow::blackRectangleShadow(const QSize &size)
+{
+    QPixmap source(size);
+    source.fill(Qt::black);
+    return MakeCustomShadow::makeShadowForPixmap(source, kDistance, kBlurRadius, Qt::black).toImage()
+        .convertToFormat(QImage::Format_ARGB32_Premultiplied);
+}
+
+void TestMakeCustomShadow::testBlurAgainstQtBlur_data()
+{
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<bool>("isRound");
+
+    QTest::newRow("rectangle") << QSize(200, 120) << false;
+    QTest::newRow("small rectangle") << QSize(10, 40) << false;
+    QTest::newRow("ellipse") << QSize(150, 150) << true;
+}
+
+// The box blur replaced qt_blurImage (a private Qt function), the shadows must look the same:
+// the alpha of each pixel is close to the one of the previous implementation.
+void TestMakeCustomShadow::testBlurAgainstQtBlur()
+{
+    QFETCH(QSize, size);
+    QFETCH(bool, isRound);
+
+    QPixmap source(size);
+    source.fill(Qt::transparent);
+    {
+        QPainter p(&source);
+        p.setRenderHint(QPainter::Antialiasing);
+        if (isRound) {
+            p.setPen(Qt::NoPen);
+            p.setBrush(Qt::black);
+            p.drawEllipse(source.rect());
+        } else {
+            p.fillRect(source.rect(), Qt::black);
+        }
+    }
+    const QImage shadow = MakeCustomShadow::makeShadowForPixmap(source, kDistance, kBlurRadius, Qt::black).toImage();
+
+    // the previous implementation
+    QImage tmp(size + QSize(2 * kDistance, 2 * kDistance), QImage::Format_ARGB32_Premultiplied);
+    tmp.fill(0);
+    {
+        QPainter p(&tmp);
+        p.drawPixmap(QPointF(kDistance, kDistance), source);
+    }
+    QImage expected(tmp.size(), QImage::Format_ARGB32_Premultiplied);
+    expected.fill(0);
+    {
+        QPainter p(&expected);
+        qt_blurImage(&p, tmp, kBlurRadius, false, false);
+    }
+
+    QCOMPARE(shadow.size(), expected.size());
+    int maxDiff = 0;
+    qint64 sumDiff = 0;
+    for (int y = 0; y < shadow.height(); ++y) {
+        for (int x = 0; x < shadow.width(); ++x) {
+            const int diff = qAbs(qAlpha(shadow.pixel(x, y)) - qAlpha(expected.pixel(x, y)));
+            maxDiff = qMax(maxDiff, diff);
+            sumDiff += diff;
+        }
+    }
+    const double meanDiff = static_cast<double>(sumDiff) / (shadow.width() * shadow.height());
+    qInfo() << "max alpha difference:" << maxDiff << "mean:" << meanDiff;
+    QVERIFY(maxDiff <= 32);
+    QVERIFY(meanDiff <= 6.0);
+}
+
+void TestMakeCustomShadow::testRectangleShadow_data()
+{
+    const int side = MakeCustomShadow::rectangleTemplateSide(kBlurRadius);
+    QTest::addColumn<QSize>("size");
+
+    QTest::newRow("template") << QSize(side, side);
+    QTest::newRow("one more pixel") << QSize(side + 1, side);
+    QTest::newRow("tall") << QSize(side, side + 57);
+    QTest::newRow("window") << QSize(350, 620);
+}
+
+// the 9-slice shadow is the same as the blur of the whole rectangle
+void TestMakeCustomShadow::testRectangleShadow()
+{
+    QFETCH(QSize, size);
+
+    const int side = MakeCustomShadow::rectangleTemplateSide(kBlurRadius);
+    const QPixmap templateShadow = QPixmap::fromImage(blackRectangleShadow(QSize(side, side)));
+
+    QImage composited(size + QSize(2 * kDistance, 2 * kDistance), QImage::Format_ARGB32_Premultiplied);
+    composited.fill(0);
+    {
+        QPainter p(&composited);
+        MakeCustomShadow::drawShadowForRectangle(&p, QPoint(0, 0), size, templateShadow, kDistance);
+    }
+    QCOMPARE(composited, blackRectangleShadow(size));
+}
+
+QTEST_MAIN(TestMakeCustomShadow)
+#include "makecustomshadow.test.moc"
@@ -6,7 +6,7 @@
 
 extern qreal g_pixelRatio;
 
-ShadowManager::ShadowManager(QObject *parent) : QObject(parent)
+ShadowManager::ShadowManager(QObject *parent) : QObject(parent), shadowCache_(SHADOW_CACHE_SIZE_KB)
 {
 
 }
@@ -23,12 +23,13 @@ void ShadowManager::addPixmap(const QPixmap &pixmap, int x, int y, int id, bool
     so.isVisible = isVisible;
     so.opacity = 1.0;
     so.pixmap = pixmap;
+    so.sourceKey = pixmap.cacheKey();
     so.posX = x;
     so.posY = y;
     objects_ << so;
     if (isVisible)
     {
-        updateShadow();
+        updateShadowRegion(shadowRect(so));
     }
 }
 
@@ -45,12 +46,13 @@ void ShadowManager::addRectangle(const QRect &rc, int id, bool isVisible)
     so.opacity = 1.0;
     so.pixmap = QPixmap(rc.width(), rc.height());
     so.pixmap.fill(QColor(0, 0, 0));
+    so.sourceKey = 0;
     so.posX = rc.left();
     so.posY = rc.top();
     objects_ << so;
     if (isVisible)
     {
-        updateShadow();
+        updateShadowRegion(shadowRect(so));
     }
 }
 
@@ -68,6 +70,7 @@ void ShadowManager::changeRectangleSize(int id, const QRect &newRc)
         return;
     }
 
+    const QRect oldShadowRect = shadowRect(objects_[ind]);
     if (objects_[ind].pixmap.width() != newRc.width() || objects_[ind].pixmap.height() != newRc.height())
     {
         objects_[ind].pixmap = QPixmap(newRc.width(), newRc.height());
@@ -78,7 +81,7 @@ void ShadowManager::changeRectangleSize(int id, const QRect &newRc)
 
     if (objects_[ind].isVisible)
     {
-        updateShadow();
+        updateShadowRegion(oldShadowRect.united(shadowRect(objects_[ind])));
     }
 }
 
@@ -95,13 +98,14 @@ void ShadowManager::changePixmapPos(int id, int x, int y)
         return;
     }
 
-    if (objects_[ind].posX != x || objects_[ind].posX != y)
+    if (objects_[ind].posX != x || objects_[ind].posY != y)
     {
+        const QRect oldShadowRect = shadowRect(objects_[ind]);
         objects_[ind].posX = x;
         objects_[ind].posY = y;
         if (objects_[ind].isVisible)
         {
-            updateShadow();
+            updateShadowRegion(oldShadowRect.united(shadowRect(objects_[ind])));
         }
     }
 }
@@ -123,7 +127,7 @@ void ShadowManager::setVisible(int id, bool isVisible)
     if (objects_[ind].isVisible != isVisible)
     {
         objects_[ind].isVisible = isVisible;
-        updateShadow();
+        updateShadowRegion(shadowRect(objects_[ind]));
     }
 }
 
@@ -144,7 +148,7 @@ void ShadowManager::setOpacity(int id, qreal opacity, bool withUpdateShadow)
     objects_[ind].opacity = opacity;
     if (withUpdateShadow && objects_[ind].isVisible)
     {
-        updateShadow();
+        updateShadowRegion(shadowRect(objects_[ind]));
     }
 }
 
@@ -158,8 +162,9 @@ void ShadowManager::removeObject(int id)
     int ind = findObjectIndById(id);
     if (ind != -1)
     {
+        const QRect oldShadowRect = shadowRect(objects_[ind]);
         objects_.remove(ind);
-        updateShadow();
+        updateShadowRegion(oldShadowRect);
     }
 }
 
@@ -218,26 +223,79 @@ void ShadowManager::updateShadow()
     }
 
     QRect rcBounding = calcBoundingRect();
+    currentShadow_ = QPixmap(rcBounding.width() + 2 * SHADOW_MARGIN, rcBounding.height() + 2 * SHADOW_MARGIN);
+    currentShadow_.fill(Qt::transparent);
+    paintShadows(currentShadow_.rect());
+
+    emit shadowUpdated();
+}
+
+void ShadowManager::updateShadowRegion(const QRect &rc)
+{
+    QRect rcBounding = calcBoundingRect();
+    if (currentShadow_.width() != rcBounding.width() + 2 * SHADOW_MARGIN ||
+        currentShadow_.height() != rcBounding.height() + 2 * SHADOW_MARGIN)
+    {
+        updateShadow();
+        return;
+    }
 
-    QPixmap pixmap(rcBounding.width() , rcBounding.height() );
-    pixmap.fill(Qt::transparent);
+    paintShadows(rc);
+    emit shadowUpdated();
+}
 
+void ShadowManager::paintShadows(const QRect &rc)
+{
+    QPainter painter(&currentShadow_);
+    painter.setClipRect(rc);
+    painter.setCompositionMode(QPainter::CompositionMode_Source);
+    painter.fillRect(rc, Qt::transparent);
+    painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+    for (const ShadowObject &so : qAsConst(objects_))
     {
-        QPainter painter(&pixmap);
-        for (const ShadowObject &so : qAsConst(objects_))
+        if (so.isVisible && shadowRect(so).intersects(rc))
         {
-            if (so.isVisible)
+            painter.setOpacity(so.opacity);
+            const int templateSide = MakeCustomShadow::rectangleTemplateSide(SHADOW_MARGIN);
+            if (so.sourceKey == 0 && so.pixmap.width() >= templateSide && so.pixmap.height() >= templateSide)
+            {
+                // the rectangles change their size in the animations, their shadows are composited from the one of a small square
+                if (rectangleTemplateShadow_.isNull())
+                {
+                    ShadowObject square = so;
+                    square.pixmap = QPixmap(templateSide, templateSide);
+                    square.pixmap.fill(QColor(0, 0, 0));
+                    rectangleTemplateShadow_ = shadowForObject(square);
+                }
+                MakeCustomShadow::drawShadowForRectangle(&painter, QPoint(so.posX, so.posY), so.pixmap.size(), rectangleTemplateShadow_, SHADOW_MARGIN);
+            }
+            else
             {
-                painter.setOpacity(so.opacity);
-                painter.drawPixmap(so.posX, so.posY, so.pixmap);
+                painter.drawPixmap(so.posX, so.posY, shadowForObject(so));
             }
         }
     }
+}
 
-    currentShadow_ = MakeCustomShadow::makeShadowForPixmap(pixmap, SHADOW_MARGIN, SHADOW_MARGIN, QColor(0, 0, 0, 225));
+QRect ShadowManager::shadowRect(const ShadowObject &so) const
+{
+    // the shadow of an object is drawn at the object position, the object is in its middle
+    return QRect(so.posX, so.posY, so.pixmap.width() + 2 * SHADOW_MARGIN, so.pixmap.height() + 2 * SHADOW_MARGIN);
+}
 
-    emit shadowUpdated();
+QPixmap ShadowManager::shadowForObject(const ShadowObject &so)
+{
+    const QColor color(0, 0, 0, 225);
+    const ShadowKey key { so.sourceKey, so.pixmap.size(), SHADOW_MARGIN, SHADOW_MARGIN, color.rgba() };
+    if (const QPixmap *cached = shadowCache_.object(key))
+    {
+        return *cached;
+    }
 
+    QPixmap source = so.pixmap;
+    QPixmap shadow = MakeCustomShadow::makeShadowForPixmap(source, SHADOW_MARGIN, SHADOW_MARGIN, color);
+    shadowCache_.insert(key, new QPixmap(shadow), shadow.width() * shadow.height() * 4 / 1024 + 1);
+    return shadow;
 }
 
 int ShadowManager::findObjectIndById(int id) const
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <QCache>
 #include <QObject>
 #include <QPixmap>
 
-// todo: maybe optimize for better speed
+// The shadow of each object is blurred once and cached by (source pixmap, distance, radius, color), so moving an object or changing
+// its visibility or opacity only composites the cached shadows again, within the changed region of currentShadow_.
+// The shadows of overlapping objects are composited after the blur instead of being blurred together, the difference is not visible.
+// The shadows of the rectangles are composited from the corners and edges of one blurred square, so resizing them blurs nothing.
 class ShadowManager : public QObject
 {
     Q_OBJECT
@@ -35,6 +39,7 @@ signals:
 
 private:
     static constexpr int SHADOW_MARGIN = 30;
+    static constexpr int SHADOW_CACHE_SIZE_KB = 32 * 1024;
     QPixmap currentShadow_;
 
     struct ShadowObject
@@ -45,11 +50,36 @@ private:
         int posX;
         int posY;
         QPixmap pixmap;
+        qint64 sourceKey;       // the cache key of the pixmap, 0 for a rectangle (a black pixmap, its size is in the key)
     };
 
+    struct ShadowKey
+    {
+        qint64 sourceKey;
+        QSize size;
+        int distance;
+        int radius;
+        QRgb color;
+
+        bool operator==(const ShadowKey &other) const
+        {
+            return sourceKey == other.sourceKey && size == other.size && distance == other.distance &&
+                   radius == other.radius && color == other.color;
+        }
+        friend size_t qHash(const ShadowKey &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.sourceKey, key.size.width(), key.size.height(), key.distance, key.radius, key.color);
+        }
+    };
 
     QVector<ShadowObject> objects_;
+    QCache<ShadowKey, QPixmap> shadowCache_;    // the cost is in kilobytes
+    QPixmap rectangleTemplateShadow_;           // the shadow of a small black square, the shadows of the big rectangles are composited from it
 
     QRect calcBoundingRect();
     int findObjectIndById(int id) const;
+    QRect shadowRect(const ShadowObject &so) const;
+    QPixmap shadowForObject(const ShadowObject &so);
+    void updateShadowRegion(const QRect &rc);
+    void paintShadows(const QRect &rc);
 };
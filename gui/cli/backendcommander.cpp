@@ -80,6 +80,12 @@ void BackendCommander::onConnectionNewCommand(IPC::Command *command, IPC::Connec
         if (cliArgs_.cliCommand() == CLI_COMMAND_STATUS) {
             onStatusResponse(command);
         }
+        else if (cliArgs_.cliCommand() == CLI_COMMAND_METRICS) {
+            // the metrics don't need the login
+            if (!bCommandSent_) {
+                sendCommand();
+            }
+        }
         else {
             onLoginStateResponse(command);
         }
@@ -101,6 +107,10 @@ void BackendCommander::onConnectionNewCommand(IPC::Command *command, IPC::Connec
     else if (bCommandSent_ && command->getStringId() == IPC::CliCommands::SignedOut::getCommandStringId()) {
         emit finished(0, tr("Signed out"));
     }
+    else if (bCommandSent_ && command->getStringId() == IPC::CliCommands::Metrics::getCommandStringId()) {
+        IPC::CliCommands::Metrics *cmd = static_cast<IPC::CliCommands::Metrics *>(command);
+        emit finished(0, cmd->text_);
+    }
     else if (bCommandSent_ && command->getStringId() == IPC::CliCommands::LoginResult::getCommandStringId()) {
         IPC::CliCommands::LoginResult *cmd = static_cast<IPC::CliCommands::LoginResult *>(command);
         if (cmd->isLoggedIn_) {
@@ -188,6 +198,10 @@ void BackendCommander::sendCommand()
     else if (cliArgs_.cliCommand() == CLI_COMMAND_STATUS) {
         sendStateCommand();
     }
+    else if (cliArgs_.cliCommand() == CLI_COMMAND_METRICS) {
+        IPC::CliCommands::GetMetrics cmd;
+        connection_->sendCommand(cmd);
+    }
 
     bCommandSent_ = true;
 }
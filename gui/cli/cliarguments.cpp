@@ -94,6 +94,10 @@ void CliArguments::processArguments()
         {
             cliCommand_ = CLI_COMMAND_STATUS;
         }
+        else if (arg1 == "metrics")
+        {
+            cliCommand_ = CLI_COMMAND_METRICS;
+        }
     }
 }
 
@@ -14,7 +14,8 @@ enum CliCommand {
     CLI_COMMAND_LOCATIONS,
     CLI_COMMAND_LOGIN,
     CLI_COMMAND_SIGN_OUT,
-    CLI_COMMAND_STATUS
+    CLI_COMMAND_STATUS,
+    CLI_COMMAND_METRICS
 };
 
 class CliArguments
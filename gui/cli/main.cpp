@@ -66,6 +66,7 @@ int main(int argc, char *argv[])
         std::cout << "firewall on|off             - Turn firewall ON/OFF" << std::endl;
         std::cout << "locations                   - View a list of available locations" << std::endl;
         std::cout << "login \"username\" \"password\" [2FA code] - login with given username and password, and optional two-factor authentication code" << std::endl;
+        std::cout << "metrics                     - Print the engine metrics in the Prometheus text format" << std::endl;
         std::cout << "signout [on|off]            - Sign out of the application, and optionally leave the firewall ON/OFF" << std::endl;
         std::cout << "status                      - View the connected/disconnected state of the application" << std::endl;
         return 0;
@@ -96,6 +97,11 @@ int main(int argc, char *argv[])
             logAndCout(QCoreApplication::tr("The application is not running, signout not required."));
             return 0;
         }
+        else if (cliArgs.cliCommand() == CLI_COMMAND_METRICS)
+        {
+            logAndCout(QCoreApplication::tr("The application is not running, no metrics to show."));
+            return 1;
+        }
 
         logAndCout(QCoreApplication::tr("No GUI instance detected, starting one now..."));
 
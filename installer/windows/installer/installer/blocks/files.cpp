@@ -1,5 +1,6 @@
 #include "files.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <shlobj_core.h>
 
@@ -56,33 +57,27 @@ int Files::executeStep()
         fillPathList();
 
         archive_->calcTotal(fileList_, pathList_);
-        curFileInd_ = 0;
+        archive_->startExtraction();
         state_++;
         return 0;
     }
 
-    SRes res = archive_->extractionFile(curFileInd_);
-    if (res != SZ_OK)
-    {
-        archive_->finish();
-        Log::instance().out(L"Failed to extract file at index %u.", curFileInd_);
-        return -1;
+    // the archive is extracted on its own threads, the steps only report the progress
+    if (!archive_->waitForExtraction(100)) {
+        return (std::min)(archive_->getExtractionProgress(), 99);
     }
 
-    if (curFileInd_ >= (archive_->getNumFiles() - 1))
-    {
-        archive_->finish();
-        if (!copyLibs()) {
-            Log::instance().out(L"Failed to copy libs");
-            return -1;
-        }
-        return moveFiles();
+    archive_->finish();
+    if (archive_->extractionResult() != SZ_OK) {
+        Log::instance().out(L"Failed to extract files: %ls", archive_->getLastError().c_str());
+        return -1;
     }
 
-    int progress = ((double)curFileInd_ / (double)archive_->getNumFiles()) * 100.0;
-    curFileInd_++;
-
-    return progress;
+    if (!copyLibs()) {
+        Log::instance().out(L"Failed to copy libs");
+        return -1;
+    }
+    return moveFiles();
 }
 
 void Files::fillPathList()
@@ -17,7 +17,6 @@ public:
  private:
    std::unique_ptr<Archive> archive_;
    int state_ = 0;
-   unsigned int curFileInd_ = 0;
    std::list<std::wstring> fileList_;
    std::list<std::wstring> pathList_;
    std::wstring installPath_;